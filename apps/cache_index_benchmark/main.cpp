@@ -0,0 +1,153 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <lamure/ren/cache_index.h>
+#include <lamure/ren/clock_cache_index.h>
+
+// hammers a cache index from several threads the way the cut update,
+// ray queries and loaders use it: look a node up, aquire and release it
+// on a hit, reserve and apply a slot on a miss. node popularity follows
+// a zipf distribution. every thread works on its own model, so no two
+// threads apply the same node.
+
+char* get_cmd_option(char** begin, char** end, const std::string & option) {
+    char** it = std::find(begin, end, option);
+    if (it != end && ++it != end)
+        return *it;
+    return 0;
+}
+
+bool cmd_option_exists(char** begin, char** end, const std::string& option) {
+    return std::find(begin, end, option) != end;
+}
+
+struct run_result {
+    double seconds_;
+    uint64_t operations_;
+    uint64_t hits_;
+};
+
+run_result run(lamure::ren::cache_index& index, const uint32_t num_threads, const uint64_t operations_per_thread,
+               const lamure::node_t num_nodes, const double zipf_exponent) {
+    using namespace lamure;
+
+    //inverse cdf of the zipf distribution, shared by all threads
+    std::vector<double> cdf(num_nodes);
+    double sum = 0.0;
+    for (node_t node_id = 0; node_id < num_nodes; ++node_id) {
+        sum += 1.0 / std::pow(double(node_id + 1), zipf_exponent);
+        cdf[node_id] = sum;
+    }
+    for (auto& value : cdf) {
+        value /= sum;
+    }
+
+    std::atomic<uint64_t> hits(0);
+    std::vector<std::thread> threads;
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    for (uint32_t thread_id = 0; thread_id < num_threads; ++thread_id) {
+        threads.push_back(std::thread([&, thread_id] {
+            std::mt19937 rng(thread_id);
+            std::uniform_real_distribution<double> uniform(0.0, 1.0);
+            const model_t model_id = model_t(thread_id);
+            const view_t view_id = view_t(thread_id);
+            uint64_t thread_hits = 0;
+
+            for (uint64_t i = 0; i < operations_per_thread; ++i) {
+                const node_t node_id = node_t(std::lower_bound(cdf.begin(), cdf.end(), uniform(rng)) - cdf.begin());
+
+                if (index.try_aquire_slot(view_id, model_id, node_id)) {
+                    index.release_slot(view_id, model_id, node_id);
+                    ++thread_hits;
+                }
+                else if (index.num_free_slots() > num_threads) {
+                    const slot_t slot_id = index.reserve_slot();
+                    index.apply_slot(slot_id, model_id, node_id);
+                }
+            }
+
+            hits += thread_hits;
+        }));
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    run_result result;
+    result.seconds_ = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+    result.operations_ = operations_per_thread * num_threads;
+    result.hits_ = hits;
+    return result;
+}
+
+void report(const std::string& name, const run_result& result) {
+    std::cout << name << ": " << result.operations_ / result.seconds_ / 1e6 << " M ops/s, "
+              << "hit rate " << 100.0 * result.hits_ / result.operations_ << " %" << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+
+    if (cmd_option_exists(argv, argv+argc, "-h")) {
+        std::cout << "Usage: " << argv[0] << " <flags>\n" <<
+            "INFO: cache_index_benchmark\n" <<
+            "\t-t: number of threads (default: 16)\n" <<
+            "\t-s: number of slots (default: 65536)\n" <<
+            "\t-n: number of nodes per thread (default: 65536)\n" <<
+            "\t-o: operations per thread (default: 1000000)\n" <<
+            "\t-z: zipf exponent of the node popularity (default: 0.9)\n" <<
+            std::endl;
+        return 0;
+    }
+
+    using namespace lamure;
+    using namespace lamure::ren;
+
+    uint32_t num_threads = 16;
+    slot_t num_slots = 65536;
+    node_t num_nodes = 65536;
+    uint64_t operations_per_thread = 1000000;
+    double zipf_exponent = 0.9;
+
+    if (cmd_option_exists(argv, argv+argc, "-t")) num_threads = std::max(1, atoi(get_cmd_option(argv, argv+argc, "-t")));
+    if (cmd_option_exists(argv, argv+argc, "-s")) num_slots = atol(get_cmd_option(argv, argv+argc, "-s"));
+    if (cmd_option_exists(argv, argv+argc, "-n")) num_nodes = atol(get_cmd_option(argv, argv+argc, "-n"));
+    if (cmd_option_exists(argv, argv+argc, "-o")) operations_per_thread = atoll(get_cmd_option(argv, argv+argc, "-o"));
+    if (cmd_option_exists(argv, argv+argc, "-z")) zipf_exponent = atof(get_cmd_option(argv, argv+argc, "-z"));
+
+    if (num_slots <= 2 * num_threads) {
+        std::cerr << "need more slots than twice the number of threads" << std::endl;
+        return 1;
+    }
+
+    std::cout << "threads: " << num_threads << ", slots: " << num_slots
+              << ", nodes: " << uint64_t(num_nodes) * num_threads << std::endl;
+
+    {
+        cache_index index(model_t(num_threads), num_slots);
+        report("lru", run(index, num_threads, operations_per_thread, num_nodes, zipf_exponent));
+    }
+    {
+        clock_cache_index index(model_t(num_threads), num_slots);
+        report("clock", run(index, num_threads, operations_per_thread, num_nodes, zipf_exponent));
+    }
+
+    return 0;
+}
@@ -0,0 +1,193 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <lamure/ren/config.h>
+#include <lamure/ren/cut_update_index.h>
+#include <lamure/ren/cut_update_pool.h>
+#include <lamure/ren/model_database.h>
+#include <lamure/ren/node_kernels.h>
+
+// replays a recorded camera session (.csn, as written by the rendering app)
+// through cut_update_pool::analyse_cut without a gpu context. the actions
+// are applied immediately, so the cuts follow the camera without budget
+// limits, and the time spent analysing the previous cuts is reported per
+// frame.
+
+char* get_cmd_option(char** begin, char** end, const std::string & option) {
+    char** it = std::find(begin, end, option);
+    if (it != end && ++it != end)
+        return *it;
+    return 0;
+}
+
+bool cmd_option_exists(char** begin, char** end, const std::string& option) {
+    return std::find(begin, end, option) != end;
+}
+
+std::vector<scm::math::mat4d> parse_camera_session_file(const std::string& session_file_path) {
+    std::ifstream camera_session_file(session_file_path);
+    std::string line;
+    std::vector<scm::math::mat4d> view_matrices;
+
+    while (std::getline(camera_session_file, line)) {
+        scm::math::mat4d view_matrix;
+        std::istringstream line_stream(line);
+        for (int i = 0; i < 16; ++i) {
+            line_stream >> view_matrix[i];
+        }
+        if (line_stream) {
+            view_matrices.push_back(view_matrix);
+        }
+    }
+    return view_matrices;
+}
+
+// applies the actions of cut_update_pool::analyse_cut the way the cut update
+// does without budget limits: splits and must-collapses are approved,
+// collapses that are only needed under memory pressure are rejected
+void resolve_actions(lamure::ren::cut_update_index& index, const std::vector<lamure::ren::cut_update_index::action>& actions) {
+    typedef lamure::ren::cut_update_index::queue_t queue_t;
+
+    for (const auto& action : actions) {
+        if (action.queue_ == queue_t::COLLAPSE_ON_NEED || action.queue_ == queue_t::MAYBE_COLLAPSE) {
+            index.reject_action(action);
+        }
+        else {
+            index.approve_action(action);
+        }
+    }
+}
+
+int main(int argc, char *argv[]) {
+
+    if (argc == 1 ||
+        cmd_option_exists(argv, argv+argc, "-h") ||
+        !cmd_option_exists(argv, argv+argc, "-f") ||
+        !cmd_option_exists(argv, argv+argc, "-c")) {
+        std::cout << "Usage: " << argv[0] << " <flags>\n" <<
+            "INFO: cut_update_benchmark\n" <<
+            "\t-f: input .bvh file, or a text file listing one .bvh per line\n" <<
+            "\t-c: recorded camera session (.csn)\n" <<
+            "\t-t: error threshold (default: " << LAMURE_DEFAULT_THRESHOLD << ")\n" <<
+            "\t-r: frames per recorded view, lets the cut converge (default: 1)\n" <<
+            "\t-w, -e: viewport width and height (default: 1920, 1080)\n" <<
+            "\t-v: print the time of every frame\n" <<
+            std::endl;
+        return 0;
+    }
+
+    using namespace lamure;
+    using namespace lamure::ren;
+
+    const std::string input_file = get_cmd_option(argv, argv+argc, "-f");
+    const std::string session_file = get_cmd_option(argv, argv+argc, "-c");
+
+    float threshold = LAMURE_DEFAULT_THRESHOLD;
+    uint32_t frames_per_view = 1;
+    float width = 1920.f;
+    float height = 1080.f;
+    if (cmd_option_exists(argv, argv+argc, "-t")) threshold = atof(get_cmd_option(argv, argv+argc, "-t"));
+    if (cmd_option_exists(argv, argv+argc, "-r")) frames_per_view = std::max(1, atoi(get_cmd_option(argv, argv+argc, "-r")));
+    if (cmd_option_exists(argv, argv+argc, "-w")) width = atof(get_cmd_option(argv, argv+argc, "-w"));
+    if (cmd_option_exists(argv, argv+argc, "-e")) height = atof(get_cmd_option(argv, argv+argc, "-e"));
+
+    std::vector<std::string> model_files;
+    if (input_file.size() > 4 && input_file.substr(input_file.size() - 4) == ".bvh") {
+        model_files.push_back(input_file);
+    }
+    else {
+        std::ifstream list_file(input_file);
+        std::string line;
+        while (std::getline(list_file, line)) {
+            if (!line.empty()) model_files.push_back(line);
+        }
+    }
+
+    model_database* database = model_database::get_instance();
+    for (const auto& model_file : model_files) {
+        database->add_model(model_file, model_file);
+    }
+    database->apply();
+
+    const std::vector<scm::math::mat4d> views = parse_camera_session_file(session_file);
+    if (views.empty() || database->num_models() == 0) {
+        std::cerr << "nothing to replay" << std::endl;
+        return 1;
+    }
+
+    const float near_plane = 0.01f;
+    const float opening_angle = 30.f;
+    scm::math::mat4f projection_matrix;
+    scm::math::perspective_matrix(projection_matrix, opening_angle, width / height, near_plane, 1000.f);
+    const float top_minus_bottom = 2.f * near_plane * std::tan(scm::math::deg2rad(opening_angle) * 0.5f);
+
+    cut_update_index index;
+    index.update_policy(1);
+
+    // node data and threshold as cut_update_pool::prepare sets them up
+    std::vector<bvh_soa> node_data;
+    for (model_t model_id = 0; model_id < index.num_models(); ++model_id) {
+        node_data.emplace_back(*database->get_model(model_id)->get_bvh());
+    }
+    threshold = std::min(std::max(threshold, LAMURE_MIN_THRESHOLD), LAMURE_MAX_THRESHOLD);
+
+    std::vector<std::vector<cut_update_index::action>> actions(index.num_models());
+    std::vector<double> frame_milliseconds;
+    size_t total_cut_size = 0;
+
+    for (const auto& view : views) {
+        for (uint32_t repetition = 0; repetition < frames_per_view; ++repetition) {
+            const node_view_params params = node_view_params::make(scm::math::mat4f::identity(), scm::math::mat4f(view), projection_matrix, near_plane,
+                                                                   height / top_minus_bottom, 1.f);
+
+            index.swap_cuts();
+
+            auto start = std::chrono::high_resolution_clock::now();
+            for (model_t model_id = 0; model_id < index.num_models(); ++model_id) {
+                cut_update_pool::analyse_cut(index, node_data[model_id], params, 0, model_id, threshold, false, actions[model_id]);
+            }
+            frame_milliseconds.push_back(std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count());
+
+            for (model_t model_id = 0; model_id < index.num_models(); ++model_id) {
+                // the first cut is the root, as in cut_update_pool::prepare
+                if (index.get_previous_cut(0, model_id).empty()) {
+                    index.approve_action(cut_update_index::action(cut_update_index::queue_t::KEEP, 0, model_id, 0, 0.f));
+                }
+                resolve_actions(index, actions[model_id]);
+                total_cut_size += index.get_current_cut(0, model_id).size();
+            }
+        }
+    }
+
+    std::vector<double> sorted_milliseconds = frame_milliseconds;
+    std::sort(sorted_milliseconds.begin(), sorted_milliseconds.end());
+    double sum = 0.0;
+    for (const auto ms : frame_milliseconds) sum += ms;
+
+    std::cout << "frames: " << frame_milliseconds.size() << ", models: " << index.num_models()
+              << ", avg cut size: " << total_cut_size / frame_milliseconds.size() << std::endl;
+    std::cout << "cut analysis per frame: avg " << sum / frame_milliseconds.size() << " ms, "
+              << "median " << sorted_milliseconds[sorted_milliseconds.size() / 2] << " ms, "
+              << "max " << sorted_milliseconds.back() << " ms" << std::endl;
+
+    if (cmd_option_exists(argv, argv+argc, "-v")) {
+        for (size_t i = 0; i < frame_milliseconds.size(); ++i) {
+            std::cout << i << " " << frame_milliseconds[i] << std::endl;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,115 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group 
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+
+#include <lamure/pre/external_sort.h>
+
+// sorts a synthetic surfel_disk_array under a fixed memory limit and
+// reports the run creation and merge phases of external_sort separately.
+
+char* get_cmd_option(char** begin, char** end, const std::string & option) {
+    char** it = std::find(begin, end, option);
+    if (it != end && ++it != end)
+        return *it;
+    return 0;
+}
+
+bool cmd_option_exists(char** begin, char** end, const std::string& option) {
+    return std::find(begin, end, option) != end;
+}
+
+int main(int argc, char *argv[]) {
+
+    if (cmd_option_exists(argv, argv+argc, "-h") ||
+        !cmd_option_exists(argv, argv+argc, "-f")) {
+        std::cout << "Usage: " << argv[0] << " <flags> -f <file>\n" <<
+            "INFO: external_sort_benchmark\n" <<
+            "\t-f: scratch file for the synthetic surfels\n" <<
+            "\t    (-f flag is required)\n" <<
+            "\t-n: number of surfels (default: 1000000000)\n" <<
+            "\t-m: memory limit in MB (default: 4096)\n" <<
+            "\t-a: sort axis 0, 1 or 2 (default: 0)\n" <<
+            "\t-v: verify the order of the result\n" <<
+            std::endl;
+        return 0;
+    }
+
+    using namespace lamure;
+    using namespace lamure::pre;
+
+    std::string file_name = std::string(get_cmd_option(argv, argv + argc, "-f"));
+    size_t num_surfels = 1000000000ull;
+    size_t memory_limit = 4096ull * 1024 * 1024;
+    uint8_t axis = 0;
+
+    if (cmd_option_exists(argv, argv+argc, "-n")) num_surfels = atol(get_cmd_option(argv, argv+argc, "-n"));
+    if (cmd_option_exists(argv, argv+argc, "-m")) memory_limit = atol(get_cmd_option(argv, argv+argc, "-m")) * 1024ull * 1024ull;
+    if (cmd_option_exists(argv, argv+argc, "-a")) axis = (uint8_t)atoi(get_cmd_option(argv, argv+argc, "-a"));
+
+    shared_surfel_file file = std::make_shared<surfel_file>();
+    file->open(file_name, true);
+
+    // generate in chunks so the input itself respects the memory limit
+    std::cout << "generating " << num_surfels << " surfels" << std::endl;
+    {
+        const size_t chunk_size = std::max<size_t>(1, std::min(num_surfels, memory_limit / sizeof(surfel) / 2));
+        std::mt19937_64 rng(42);
+        std::uniform_real_distribution<real> dist(-1000.0, 1000.0);
+
+        surfel_vector chunk;
+        for (size_t generated = 0; generated < num_surfels; generated += chunk.size()) {
+            chunk.resize(std::min(chunk_size, num_surfels - generated));
+            for (auto& s : chunk) {
+                s = surfel(vec3r(dist(rng), dist(rng), dist(rng)), vec4b(128, 128, 128, 255), 0.01);
+            }
+            file->append(&chunk);
+        }
+    }
+
+    surfel_disk_array array(file, 0, num_surfels);
+
+    external_sort::statistics stats;
+    auto start = std::chrono::high_resolution_clock::now();
+    external_sort::sort(array, memory_limit, surfel::compare(axis), &stats);
+    double total_seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+    std::cout << "surfels: " << num_surfels << ", memory limit: " << memory_limit / 1024 / 1024 << " MB, runs: " << stats.runs_count << std::endl;
+    std::cout << "run creation: " << stats.run_creation_seconds << " s" << std::endl;
+    std::cout << "merge: " << stats.merge_seconds << " s" << std::endl;
+    std::cout << "total: " << total_seconds << " s, " << num_surfels / total_seconds << " surfels/s" << std::endl;
+
+    if (cmd_option_exists(argv, argv+argc, "-v")) {
+        const surfel::compare_function compare = surfel::compare(axis);
+        const size_t chunk_size = std::max<size_t>(2, memory_limit / sizeof(surfel) / 2);
+        surfel_vector chunk(chunk_size);
+        surfel last;
+        bool ok = true;
+        for (size_t offset = 0; offset < num_surfels && ok; offset += chunk_size) {
+            size_t length = std::min(chunk_size, num_surfels - offset);
+            file->read(&chunk, 0, offset, length);
+            for (size_t i = 0; i < length; ++i) {
+                if ((offset > 0 || i > 0) && compare(chunk[i], last)) {
+                    std::cout << "verification failed at surfel " << offset + i << std::endl;
+                    ok = false;
+                    break;
+                }
+                last = chunk[i];
+            }
+        }
+        if (ok) {
+            std::cout << "verification passed" << std::endl;
+        }
+    }
+
+    file->close(true);
+    return 0;
+}
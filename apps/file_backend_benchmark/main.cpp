@@ -0,0 +1,125 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group 
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#include <boost/filesystem.hpp>
+
+#include <lamure/pre/builder.h>
+#include <lamure/pre/io/file.h>
+
+// runs builder::construct() on the same input once per file backend, each
+// in its own subdirectory of the working directory, and reports wall times.
+
+char* get_cmd_option(char** begin, char** end, const std::string & option) {
+    char** it = std::find(begin, end, option);
+    if (it != end && ++it != end)
+        return *it;
+    return 0;
+}
+
+bool cmd_option_exists(char** begin, char** end, const std::string& option) {
+    return std::find(begin, end, option) != end;
+}
+
+int main(int argc, char *argv[]) {
+
+    if (cmd_option_exists(argv, argv+argc, "-h") ||
+        !cmd_option_exists(argv, argv+argc, "-f") ||
+        !cmd_option_exists(argv, argv+argc, "-w")) {
+        std::cout << "Usage: " << argv[0] << " <flags> -f <input> -w <working directory>\n" <<
+            "INFO: file_backend_benchmark\n" <<
+            "\t-f: input point cloud, any format accepted by the preprocessing\n" <<
+            "\t-w: working directory, receives one subdirectory per backend\n" <<
+            "\t    (-f and -w flags are required)\n" <<
+            "\t-d: desired surfels per node (default: 1024)\n" <<
+            "\t-m: memory budget in GB (default: 8)\n" <<
+            "\t-b: buffer size in MB (default: 150)\n" <<
+            "\t-k: keep the output of both runs\n" <<
+            std::endl;
+        return 0;
+    }
+
+    using namespace lamure;
+    using namespace lamure::pre;
+    namespace fs = boost::filesystem;
+
+    const fs::path input_file = fs::canonical(get_cmd_option(argv, argv + argc, "-f"));
+    const fs::path working_directory = fs::absolute(get_cmd_option(argv, argv + argc, "-w"));
+
+    size_t surfels_per_node = 1024;
+    float memory_budget = 8.f;
+    size_t buffer_size = 150ull * 1024 * 1024;
+
+    if (cmd_option_exists(argv, argv+argc, "-d")) surfels_per_node = atol(get_cmd_option(argv, argv+argc, "-d"));
+    if (cmd_option_exists(argv, argv+argc, "-m")) memory_budget = std::max(1.f, float(atof(get_cmd_option(argv, argv+argc, "-m"))));
+    if (cmd_option_exists(argv, argv+argc, "-b")) buffer_size = std::max(20l, atol(get_cmd_option(argv, argv+argc, "-b"))) * 1024ull * 1024ull;
+
+    builder::descriptor desc;
+    desc.input_file                   = input_file.string();
+    desc.max_fan_factor               = 2;
+    desc.surfels_per_node             = surfels_per_node;
+    desc.final_stage                  = 5;
+    desc.recompute_leaf_normals       = false;
+    desc.recompute_leaf_radii         = false;
+    desc.keep_intermediate_files      = false;
+    desc.resample                     = false;
+    desc.memory_budget                = memory_budget;
+    desc.radius_multiplier            = 0.7f;
+    desc.buffer_size                  = buffer_size;
+    desc.number_of_neighbours         = 40;
+    desc.translate_to_origin          = true;
+    desc.number_of_outlier_neighbours = 24;
+    desc.outlier_ratio                = 0.f;
+    desc.rep_radius_algo              = rep_radius_algorithm::geometric_mean;
+    desc.reduction_algo               = reduction_algorithm::ndc;
+    desc.radius_computation_algo      = radius_computation_algorithm::average_distance;
+    desc.normal_computation_algo      = normal_computation_algorithm::plane_fitting;
+
+    struct run
+    {
+        std::string name;
+        file_backend backend;
+        double seconds;
+    };
+    run runs[] = {{"stream", file_backend::stream, 0.0},
+                  {"mapped", file_backend::mapped, 0.0}};
+
+    for (auto& r : runs) {
+        const fs::path directory = working_directory / r.name;
+        fs::create_directories(directory);
+
+        desc.working_directory = fs::canonical(directory).string();
+        desc.io_backend = r.backend;
+
+        std::cout << "constructing with the " << r.name << " backend" << std::endl;
+        auto start = std::chrono::steady_clock::now();
+        {
+            builder b(desc);
+            if (!b.construct()) {
+                std::cerr << "construction with the " << r.name << " backend failed" << std::endl;
+                return 1;
+            }
+        }
+        r.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        if (!cmd_option_exists(argv, argv+argc, "-k")) {
+            fs::remove_all(directory);
+        }
+    }
+
+    for (const auto& r : runs) {
+        std::cout << r.name << ": " << r.seconds << " s" << std::endl;
+    }
+    std::cout << "speedup: " << runs[0].seconds / runs[1].seconds << std::endl;
+
+    set_default_file_backend(file_backend::stream);
+    return 0;
+}
@@ -0,0 +1,100 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include <boost/filesystem.hpp>
+
+#include <lamure/pre/io/converter.h>
+#include <lamure/pre/io/format_bin.h>
+#include <lamure/pre/io/format_ply.h>
+#include <lamure/pre/io/format_xyz.h>
+
+// converts an xyz or ply file to bin with the chunked parallel reader and
+// with the per-surfel reader and reports the ingestion rate of both.
+
+char* get_cmd_option(char** begin, char** end, const std::string & option) {
+    char** it = std::find(begin, end, option);
+    if (it != end && ++it != end)
+        return *it;
+    return 0;
+}
+
+bool cmd_option_exists(char** begin, char** end, const std::string& option) {
+    return std::find(begin, end, option) != end;
+}
+
+double convert(lamure::pre::format_abstract& format_in, const std::string& input_file,
+               const std::string& output_file, const bool chunked) {
+    lamure::pre::format_bin format_out;
+    lamure::pre::converter conv(format_in, format_out, 256 * 1024 * 1024);
+    conv.set_chunked_reading(chunked);
+
+    auto start = std::chrono::high_resolution_clock::now();
+    conv.convert(input_file, output_file);
+    return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+int main(int argc, char *argv[]) {
+
+    if (argc == 1 ||
+        cmd_option_exists(argv, argv+argc, "-h") ||
+        !cmd_option_exists(argv, argv+argc, "-f")) {
+        std::cout << "Usage: " << argv[0] << " <flags>\n" <<
+            "INFO: ingestion_benchmark\n" <<
+            "\t-f: input file (.xyz or .ply)\n" <<
+            "\t-o: output directory (default: directory of the input file)\n" <<
+            "\t-l: also measure the per-surfel reader\n" <<
+            std::endl;
+        return 0;
+    }
+
+    namespace fs = boost::filesystem;
+    using namespace lamure::pre;
+
+    const fs::path input_file = fs::canonical(fs::path(get_cmd_option(argv, argv+argc, "-f")));
+    fs::path output_dir = input_file.parent_path();
+    if (cmd_option_exists(argv, argv+argc, "-o")) {
+        output_dir = fs::path(get_cmd_option(argv, argv+argc, "-o"));
+    }
+    const bool measure_legacy = cmd_option_exists(argv, argv+argc, "-l");
+
+    std::unique_ptr<format_abstract> format_in;
+    const std::string extension = input_file.extension().string();
+    if (extension == ".xyz") {
+        format_in.reset(new format_xyz());
+    }
+    else if (extension == ".ply") {
+        format_in.reset(new format_ply());
+    }
+    else {
+        std::cerr << "unsupported input format: " << extension << std::endl;
+        return 1;
+    }
+
+    const double megabytes = fs::file_size(input_file) / 1024.0 / 1024.0;
+    const fs::path output_file = output_dir / (input_file.stem().string() + "_ingestion_benchmark.bin");
+
+    std::cout << "input: " << input_file.string() << " (" << megabytes << " MB)" << std::endl;
+
+    double chunked_seconds = convert(*format_in, input_file.string(), output_file.string(), true);
+    std::cout << "chunked: " << chunked_seconds << " s, " << megabytes / chunked_seconds << " MB/s" << std::endl;
+
+    if (measure_legacy) {
+        double legacy_seconds = convert(*format_in, input_file.string(), output_file.string(), false);
+        std::cout << "per-surfel: " << legacy_seconds << " s, " << megabytes / legacy_seconds << " MB/s" << std::endl;
+        std::cout << "speedup: " << legacy_seconds / chunked_seconds << std::endl;
+    }
+
+    fs::remove(output_file);
+
+    return 0;
+}
@@ -0,0 +1,163 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <lamure/ren/node_kernels.h>
+
+// evaluates node errors and frustum flags for a synthetic set of nodes,
+// once per node the way cut_update_pool::calculate_node_error did (map
+// lookups and a matrix product per node) and with the batched kernels,
+// both for scattered node ids and for consecutive ranges.
+
+char* get_cmd_option(char** begin, char** end, const std::string & option) {
+    char** it = std::find(begin, end, option);
+    if (it != end && ++it != end)
+        return *it;
+    return 0;
+}
+
+bool cmd_option_exists(char** begin, char** end, const std::string& option) {
+    return std::find(begin, end, option) != end;
+}
+
+double measure(const size_t iterations, const std::function<void()>& kernel) {
+    kernel();
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        kernel();
+    }
+    return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count() / iterations;
+}
+
+void report(const std::string& name, const size_t count, const double seconds) {
+    std::cout << name << ": " << seconds * 1000.0 << " ms/frame, "
+              << count / seconds / 1e6 << " M nodes/s" << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+
+    if (cmd_option_exists(argv, argv+argc, "-h")) {
+        std::cout << "Usage: " << argv[0] << " <flags>\n" <<
+            "INFO: node_error_benchmark\n" <<
+            "\t-n: number of nodes per frame (default: 1000000)\n" <<
+            "\t-i: number of frames (default: 20)\n" <<
+            std::endl;
+        return 0;
+    }
+
+    using namespace lamure;
+    using namespace lamure::ren;
+
+    size_t num_nodes = 1000000;
+    size_t iterations = 20;
+
+    if (cmd_option_exists(argv, argv+argc, "-n")) num_nodes = atol(get_cmd_option(argv, argv+argc, "-n"));
+    if (cmd_option_exists(argv, argv+argc, "-i")) iterations = atol(get_cmd_option(argv, argv+argc, "-i"));
+
+    std::cout << "kernels: " << node_kernels::instruction_set_name() << std::endl;
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> position(-100.f, 100.f);
+    std::uniform_real_distribution<float> size(0.01f, 2.f);
+
+    bvh_soa nodes;
+    nodes.resize(node_t(num_nodes));
+    nodes.set_first_refinable_node(3);
+    for (node_t node_id = 0; node_id < num_nodes; ++node_id) {
+        scm::math::vec3f centroid(position(rng), position(rng), position(rng));
+        scm::math::vec3f half_extent(size(rng), size(rng), size(rng));
+        nodes.set_node(node_id, centroid, size(rng) * 0.1f, scm::gl::boxf(centroid - half_extent, centroid + half_extent));
+    }
+
+    std::vector<node_t> scattered_ids(num_nodes);
+    std::iota(scattered_ids.begin(), scattered_ids.end(), 0);
+    std::shuffle(scattered_ids.begin(), scattered_ids.end(), rng);
+
+    // per frame state the way the cut update pool keeps it
+    std::map<model_t, scm::math::mat4f> model_transforms;
+    std::map<view_t, scm::math::mat4f> view_matrices;
+    std::map<view_t, float> height_divided_by_top_minus_bottoms;
+    std::map<view_t, float> lod_viewport_scalings;
+
+    const float near_plane = 0.1f;
+    scm::math::mat4f projection_matrix;
+    scm::math::perspective_matrix(projection_matrix, 60.f, 16.f / 9.f, near_plane, 1000.f);
+
+    model_transforms[0] = scm::math::make_translation(0.f, 0.f, -150.f);
+    view_matrices[0] = scm::math::mat4f::identity();
+    height_divided_by_top_minus_bottoms[0] = 1080.f / (2.f * near_plane * std::tan(scm::math::deg2rad(30.f)));
+    lod_viewport_scalings[0] = 1.f;
+
+    const node_view_params params = node_view_params::make(model_transforms[0], view_matrices[0], projection_matrix, near_plane,
+                                                           height_divided_by_top_minus_bottoms[0], lod_viewport_scalings[0]);
+
+    std::vector<float> reference_errors(num_nodes), errors(num_nodes);
+    std::vector<uint8_t> reference_flags(num_nodes), flags(num_nodes);
+
+    double per_node_seconds = measure(iterations, [&] {
+        for (size_t i = 0; i < num_nodes; ++i) {
+            const node_t node_id = scattered_ids[i];
+            const scm::math::mat4f& model_matrix = model_transforms[0];
+            const scm::math::mat4f& view_matrix = view_matrices[0];
+            if (node_id < nodes.first_refinable_node()) {
+                reference_errors[i] = 100.f;
+                continue;
+            }
+            float radius_scaling = scm::math::length(model_matrix * scm::math::vec4f(1.0f, 0.f, 0.f, 0.f));
+            float representative_radius = nodes.extent()[node_id] * radius_scaling;
+            scm::math::vec4f centroid(nodes.centroid_x()[node_id], nodes.centroid_y()[node_id], nodes.centroid_z()[node_id], 1.f);
+            scm::math::vec4f view_position = view_matrix * model_matrix * centroid;
+            reference_errors[i] = lod_viewport_scalings[0] * std::abs(2.0f * representative_radius * (near_plane / -view_position.z) * height_divided_by_top_minus_bottoms[0]);
+        }
+    });
+    report("per node, errors only", num_nodes, per_node_seconds);
+
+    double scalar_seconds = measure(iterations, [&] {
+        node_kernels::scalar::evaluate(nodes, params, scattered_ids.data(), num_nodes, reference_errors.data(), reference_flags.data()); });
+    report("scalar, scattered ids", num_nodes, scalar_seconds);
+
+    double simd_seconds = measure(iterations, [&] {
+        node_kernels::evaluate(nodes, params, scattered_ids.data(), num_nodes, errors.data(), flags.data()); });
+    report("vectorized, scattered ids", num_nodes, simd_seconds);
+
+    double deviation = 0.0;
+    size_t flag_mismatches = 0;
+    for (size_t i = 0; i < num_nodes; ++i) {
+        deviation = std::max(deviation, (double)std::abs(reference_errors[i] - errors[i]) / std::max(1.f, std::abs(reference_errors[i])));
+        flag_mismatches += reference_flags[i] != flags[i];
+    }
+
+    double scalar_range_seconds = measure(iterations, [&] {
+        node_kernels::scalar::evaluate_range(nodes, params, 0, num_nodes, reference_errors.data(), reference_flags.data()); });
+    report("scalar, range", num_nodes, scalar_range_seconds);
+
+    double simd_range_seconds = measure(iterations, [&] {
+        node_kernels::evaluate_range(nodes, params, 0, num_nodes, errors.data(), flags.data()); });
+    report("vectorized, range", num_nodes, simd_range_seconds);
+
+    for (size_t i = 0; i < num_nodes; ++i) {
+        deviation = std::max(deviation, (double)std::abs(reference_errors[i] - errors[i]) / std::max(1.f, std::abs(reference_errors[i])));
+        flag_mismatches += reference_flags[i] != flags[i];
+    }
+
+    size_t visible = std::count(flags.begin(), flags.end(), 1);
+    std::cout << "in frustum: " << visible << " of " << num_nodes << ", "
+              << "max relative deviation " << deviation << ", "
+              << "frustum flag mismatches " << flag_mismatches << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,244 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group 
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <lamure/ren/lod_stream.h>
+#include <lamure/ren/node_file_registry.h>
+#include <lamure/ren/node_loader.h>
+
+// measures the node throughput of the out-of-core loader data path
+// on a synthetic set of .lod files. "stream" mimics the former
+// ooc_pool behaviour (open/read/close per node, copy under a global lock),
+// "registry" reads through persistent handles directly into the slots,
+// "batched" keeps a fixed number of jobs in flight on a node_loader.
+
+char* get_cmd_option(char** begin, char** end, const std::string & option) {
+    char** it = std::find(begin, end, option);
+    if (it != end && ++it != end)
+        return *it;
+    return 0;
+}
+
+bool cmd_option_exists(char** begin, char** end, const std::string& option) {
+    return std::find(begin, end, option) != end;
+}
+
+struct node_job {
+    uint32_t model_id_;
+    uint32_t node_id_;
+    size_t   slot_id_;
+};
+
+void generate_lod_files(const std::vector<std::string>& file_names, const size_t num_nodes, const size_t node_size) {
+    std::vector<char> node(node_size);
+    for (size_t i = 0; i < file_names.size(); ++i) {
+        std::ifstream existing(file_names[i], std::ios::binary | std::ios::ate);
+        if (existing.good() && (size_t)existing.tellg() == num_nodes * node_size) {
+            continue;
+        }
+        std::ofstream out(file_names[i], std::ios::binary | std::ios::trunc);
+        for (size_t node_id = 0; node_id < num_nodes; ++node_id) {
+            std::fill(node.begin(), node.end(), (char)((node_id + i) & 0xFF));
+            out.write(node.data(), node_size);
+        }
+        out.close();
+    }
+}
+
+template<typename func_t>
+double run_threads(const uint32_t num_threads, func_t func) {
+    std::vector<std::thread> threads;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (uint32_t i = 0; i < num_threads; ++i) {
+        threads.push_back(std::thread(func));
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+}
+
+void report(const std::string& name, const size_t num_jobs, const size_t node_size, const double seconds) {
+    std::cout << name << ": " << num_jobs << " nodes in " << seconds << " s, "
+              << num_jobs / seconds << " nodes/s, "
+              << (num_jobs * node_size) / seconds / (1024.0 * 1024.0) << " MB/s" << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+
+    if (cmd_option_exists(argv, argv+argc, "-h") ||
+        !cmd_option_exists(argv, argv+argc, "-d")) {
+        std::cout << "Usage: " << argv[0] << " <flags> -d <directory>\n" <<
+            "INFO: ooc_loading_benchmark\n" <<
+            "\t-d: directory for the synthetic .lod set\n" <<
+            "\t    (-d flag is required)\n" <<
+            "\t-m: number of models (default: 8)\n" <<
+            "\t-n: nodes per model (default: 16384)\n" <<
+            "\t-s: node size in bytes (default: 65536)\n" <<
+            "\t-t: number of loader threads (default: 8)\n" <<
+            "\t-j: number of node jobs (default: 200000)\n" <<
+            "\t-q: queue depth of the batched loader (default: 64)\n" <<
+            std::endl;
+        return 0;
+    }
+
+    std::string directory = std::string(get_cmd_option(argv, argv + argc, "-d"));
+    uint32_t num_models = 8;
+    size_t num_nodes = 16384;
+    size_t node_size = 65536;
+    uint32_t num_threads = 8;
+    size_t num_jobs = 200000;
+    uint32_t queue_depth = 64;
+
+    if (cmd_option_exists(argv, argv+argc, "-m")) num_models = atoi(get_cmd_option(argv, argv+argc, "-m"));
+    if (cmd_option_exists(argv, argv+argc, "-n")) num_nodes = atol(get_cmd_option(argv, argv+argc, "-n"));
+    if (cmd_option_exists(argv, argv+argc, "-s")) node_size = atol(get_cmd_option(argv, argv+argc, "-s"));
+    if (cmd_option_exists(argv, argv+argc, "-t")) num_threads = atoi(get_cmd_option(argv, argv+argc, "-t"));
+    if (cmd_option_exists(argv, argv+argc, "-j")) num_jobs = atol(get_cmd_option(argv, argv+argc, "-j"));
+    if (cmd_option_exists(argv, argv+argc, "-q")) queue_depth = atoi(get_cmd_option(argv, argv+argc, "-q"));
+
+    std::vector<std::string> file_names;
+    for (uint32_t model_id = 0; model_id < num_models; ++model_id) {
+        file_names.push_back(directory + "/synthetic_" + std::to_string(model_id) + ".lod");
+    }
+
+    std::cout << "generating " << num_models << " x " << num_nodes << " nodes of " << node_size << " bytes" << std::endl;
+    generate_lod_files(file_names, num_nodes, node_size);
+
+    //random jobs over all models, slots are recycled round robin
+    const size_t num_slots = 4096;
+    std::vector<node_job> jobs(num_jobs);
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<uint32_t> model_dist(0, num_models-1);
+    std::uniform_int_distribution<uint32_t> node_dist(0, (uint32_t)num_nodes-1);
+    for (size_t i = 0; i < num_jobs; ++i) {
+        jobs[i].model_id_ = model_dist(rng);
+        jobs[i].node_id_ = node_dist(rng);
+        jobs[i].slot_id_ = i % num_slots;
+    }
+
+    std::vector<char> cache_data(num_slots * node_size);
+
+    //former ooc_pool data path
+    {
+        std::atomic<size_t> next_job(0);
+        std::mutex mutex;
+        std::vector<size_t> history;
+        double seconds = run_threads(num_threads, [&]() {
+            std::vector<char> local_cache(node_size);
+            while (true) {
+                size_t i = next_job++;
+                if (i >= num_jobs) break;
+                const node_job& job = jobs[i];
+                lamure::ren::lod_stream access;
+                access.open(file_names[job.model_id_]);
+                access.read(local_cache.data(), job.node_id_ * node_size, node_size);
+                access.close();
+
+                std::lock_guard<std::mutex> lock(mutex);
+                memcpy(cache_data.data() + job.slot_id_ * node_size, local_cache.data(), node_size);
+                history.push_back(i);
+            }
+        });
+        report("stream", num_jobs, node_size, seconds);
+    }
+
+    //persistent handles, positional reads into the slot
+    {
+        lamure::ren::node_file_registry registry;
+        for (const auto& file_name : file_names) {
+            registry.register_file(file_name);
+        }
+
+        std::atomic<size_t> next_job(0);
+        std::mutex mutex;
+        std::vector<size_t> history;
+        double seconds = run_threads(num_threads, [&]() {
+            while (true) {
+                size_t i = next_job++;
+                if (i >= num_jobs) break;
+                const node_job& job = jobs[i];
+                registry.read(job.model_id_, cache_data.data() + job.slot_id_ * node_size, job.node_id_ * node_size, node_size);
+
+                std::lock_guard<std::mutex> lock(mutex);
+                history.push_back(i);
+            }
+        });
+        report("registry", num_jobs, node_size, seconds);
+    }
+
+    //asynchronous batches, completion order is arbitrary
+    {
+        lamure::ren::node_file_registry registry;
+        for (const auto& file_name : file_names) {
+            registry.register_file(file_name);
+        }
+
+        std::unique_ptr<lamure::ren::node_loader> loader(lamure::ren::node_loader::create(&registry, queue_depth));
+
+        std::vector<std::chrono::high_resolution_clock::time_point> start_times(num_jobs);
+        std::vector<double> latencies;
+        latencies.reserve(num_jobs);
+
+        size_t next_job = 0;
+        size_t num_in_flight = 0;
+        size_t queue_depth_sum = 0;
+        size_t num_waits = 0;
+        std::vector<lamure::ren::node_loader::request> batch;
+        std::vector<uint64_t> completed_tags;
+
+        auto start = std::chrono::high_resolution_clock::now();
+        while (next_job < num_jobs || num_in_flight > 0) {
+            batch.clear();
+            while (num_in_flight + batch.size() < loader->queue_depth() && next_job < num_jobs) {
+                const node_job& job = jobs[next_job];
+                start_times[next_job] = std::chrono::high_resolution_clock::now();
+                batch.push_back(lamure::ren::node_loader::request{job.model_id_, cache_data.data() + job.slot_id_ * node_size,
+                                                                  job.node_id_ * node_size, node_size, next_job});
+                ++next_job;
+            }
+            if (!batch.empty()) {
+                loader->submit(batch);
+                num_in_flight += batch.size();
+            }
+
+            queue_depth_sum += num_in_flight;
+            ++num_waits;
+
+            completed_tags.clear();
+            loader->wait(completed_tags);
+            auto now = std::chrono::high_resolution_clock::now();
+            for (const auto tag : completed_tags) {
+                latencies.push_back(std::chrono::duration<double, std::micro>(now - start_times[tag]).count());
+            }
+            num_in_flight -= completed_tags.size();
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+        report(std::string("batched (") + loader->name() + ")", num_jobs, node_size, seconds);
+
+        std::sort(latencies.begin(), latencies.end());
+        std::cout << "  avg. queue depth: " << (double)queue_depth_sum / std::max<size_t>(num_waits, 1)
+                  << ", latency p50: " << latencies[latencies.size() / 2] << " us"
+                  << ", p99: " << latencies[(latencies.size() * 99) / 100] << " us" << std::endl;
+    }
+
+    return 0;
+}
@@ -122,6 +122,12 @@ int main(int argc, const char *argv[])
          po::value<int>()->default_value(150),
          "buffer size in megabytes")
 
+        ("io-backend",
+         po::value<std::string>()->default_value("stream"),
+         "Backend for intermediate file access. Possible values:\n"
+         "  stream - buffered file streams\n"
+         "  mapped - mmap reads and pwrite writes, concurrent on disjoint ranges (POSIX only)")
+
         ("prov-file",
          po::value<std::string>()->default_value(""),
          "Optional ascii-file with provanance attribs per point. Extensions supported: \n"
@@ -382,6 +388,9 @@ int main(int argc, const char *argv[])
         desc.outlier_ratio                = std::max(0.0f, vm["outlier-ratio"].as<float>() );
         desc.number_of_outlier_neighbours = std::max(vm["num-outlier-neighbours"].as<int>(), 1);
         desc.radius_multiplier            = vm["radius-multiplier"].as<float>();
+        desc.io_backend                   = vm["io-backend"].as<std::string>() == "mapped"
+                                            ? lamure::pre::file_backend::mapped
+                                            : lamure::pre::file_backend::stream;
 
         //optional prov file
         desc.prov_file                    = vm["prov-file"].as<std::string>();
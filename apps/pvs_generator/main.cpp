@@ -15,14 +15,17 @@
 #include <lamure/pvs/visibility_test_id_histogram_renderer.h>
 #include <lamure/pvs/visibility_test_id_histogram_renderer_corners.h>
 #include <lamure/pvs/visibility_test_simple_randomized_id_histogram_renderer.h>
+#include <lamure/pvs/visibility_test_ray_caster.h>
 
 #include <lamure/pvs/grid.h>
 #include <lamure/pvs/grid_octree.h>
 #include <lamure/pvs/grid_octree_compressed.h>
+#include <lamure/pvs/grid_octree_indexed.h>
 #include <lamure/pvs/grid_octree_hierarchical.h>
 #include <lamure/pvs/grid_octree_hierarchical_v2.h>
 #include <lamure/pvs/grid_irregular.h>
 #include <lamure/pvs/grid_irregular_compressed.h>
+#include <lamure/pvs/grid_irregular_indexed.h>
 
 #include <lamure/pvs/grid_optimizer_octree.h>
 #include <lamure/pvs/grid_optimizer_octree_hierarchical.h>
@@ -70,8 +73,8 @@ int main(int argc, char** argv)
                                "Allowed Options");
     desc.add_options()
       ("pvs-file,p", po::value<std::string>(&pvs_output_file_path), "specify output file of calculated pvs data (.pvs)")
-      ("vistest", po::value<std::string>(&visibility_test_type)->default_value("hrc"), "specify type of visibility test to be used. Default is histogram renderer with corners. (histogram renderer 'hr', histogram renderer with corners 'hrc', simple randomized histogram renderer 'srhr')")
-      ("gridtype", po::value<std::string>(&grid_type)->default_value("irregular_compressed"), "specify type of grid to store visibility data. Default is irregular compressed grid. ('regular', 'regular_compressed', 'irregular', 'irregular_compressed', octree', 'octree_compressed', octree_hierarchical', 'octree_hierarchical_v2', 'octree_hierarchical_v3')")
+      ("vistest", po::value<std::string>(&visibility_test_type)->default_value("hrc"), "specify type of visibility test to be used. Default is histogram renderer with corners. (histogram renderer 'hr', histogram renderer with corners 'hrc', simple randomized histogram renderer 'srhr', CPU ray caster without OpenGL 'rc')")
+      ("gridtype", po::value<std::string>(&grid_type)->default_value("irregular_compressed"), "specify type of grid to store visibility data. Default is irregular compressed grid. ('regular', 'regular_compressed', 'regular_indexed', 'irregular', 'irregular_compressed', 'irregular_indexed', octree', 'octree_compressed', 'octree_indexed', octree_hierarchical', 'octree_hierarchical_v2', 'octree_hierarchical_v3')")
       ("gridsize", po::value<unsigned int>(&grid_size)->default_value(1), "specify size/depth of the grid used for the visibility test (depends on chosen grid type)")
       ("oversize", po::value<double>(&oversize_factor)->default_value(1.5), "factor the grid bounds will be scaled by. Default is 1.5 (so grid bounds will exceed scene bounds by factor of 1.5)")
       ("optithresh", po::value<float>(&optimization_threshold)->default_value(-1.0f), "specify the threshold at which common data are converged (percent value between 0 and 1). Negative values will deactivate optimization process. Default value is -1.0, so grid optimization is deactivated.")
@@ -106,6 +109,10 @@ int main(int argc, char** argv)
     {
         vt = new lamure::pvs::visibility_test_simple_randomized_id_histogram_renderer();
     }
+    else if(visibility_test_type == "rc")
+    {
+        vt = new lamure::pvs::visibility_test_ray_caster();
+    }
     else
     {
         std::cout << "Invalid visibility test: " << visibility_test_type << ".\n" << desc;
@@ -209,7 +216,8 @@ int main(int argc, char** argv)
         std::cout << "Start grid optimization..." << std::endl;
 
         if(grid_type == lamure::pvs::grid_octree::get_grid_identifier() ||
-            grid_type == lamure::pvs::grid_octree_compressed::get_grid_identifier())
+            grid_type == lamure::pvs::grid_octree_compressed::get_grid_identifier() ||
+            grid_type == lamure::pvs::grid_octree_indexed::get_grid_identifier())
         {
             lamure::pvs::grid_optimizer_octree optimizer;
             optimizer.optimize_grid(test_grid, optimization_threshold);
@@ -221,7 +229,8 @@ int main(int argc, char** argv)
             optimizer.optimize_grid(test_grid, optimization_threshold);
         }
         else if(grid_type == lamure::pvs::grid_irregular::get_grid_identifier() ||
-            grid_type == lamure::pvs::grid_irregular_compressed::get_grid_identifier())
+            grid_type == lamure::pvs::grid_irregular_compressed::get_grid_identifier() ||
+            grid_type == lamure::pvs::grid_irregular_indexed::get_grid_identifier())
         {
             lamure::pvs::grid_optimizer_irregular optimizer;
             optimizer.optimize_grid(test_grid, optimization_threshold);
@@ -15,13 +15,16 @@
 
 #include <lamure/pvs/grid_regular.h>
 #include <lamure/pvs/grid_regular_compressed.h>
+#include <lamure/pvs/grid_regular_indexed.h>
 #include <lamure/pvs/grid_octree.h>
 #include <lamure/pvs/grid_octree_compressed.h>
+#include <lamure/pvs/grid_octree_indexed.h>
 #include <lamure/pvs/grid_octree_hierarchical.h>
 #include <lamure/pvs/grid_octree_hierarchical_v2.h>
 #include <lamure/pvs/grid_octree_hierarchical_v3.h>
 #include <lamure/pvs/grid_irregular.h>
 #include <lamure/pvs/grid_irregular_compressed.h>
+#include <lamure/pvs/grid_irregular_indexed.h>
 
 #include <lamure/pvs/grid_optimizer_octree.h>
 #include <lamure/pvs/grid_optimizer_octree_hierarchical.h>
@@ -30,6 +33,34 @@
 #include <boost/program_options.hpp>
 #include <boost/filesystem.hpp>
 
+bool is_convertible_grid_type(const std::string& grid_type)
+{
+    return grid_type == lamure::pvs::grid_regular::get_grid_identifier() ||
+        grid_type == lamure::pvs::grid_regular_compressed::get_grid_identifier() ||
+        grid_type == lamure::pvs::grid_regular_indexed::get_grid_identifier() ||
+        grid_type == lamure::pvs::grid_octree_hierarchical_v3::get_grid_identifier() ||
+        grid_type == lamure::pvs::grid_irregular::get_grid_identifier() ||
+        grid_type == lamure::pvs::grid_irregular_compressed::get_grid_identifier() ||
+        grid_type == lamure::pvs::grid_irregular_indexed::get_grid_identifier();
+}
+
+// Passes the block settings to grids storing their visibility in a visibility block file, other grids ignore them.
+void set_block_settings(lamure::pvs::grid* output_grid, const lamure::pvs::visibility_block_settings& settings)
+{
+    if(lamure::pvs::grid_regular_indexed* regular_grid = dynamic_cast<lamure::pvs::grid_regular_indexed*>(output_grid))
+    {
+        regular_grid->set_block_settings(settings);
+    }
+    else if(lamure::pvs::grid_octree_indexed* octree_grid = dynamic_cast<lamure::pvs::grid_octree_indexed*>(output_grid))
+    {
+        octree_grid->set_block_settings(settings);
+    }
+    else if(lamure::pvs::grid_irregular_indexed* irregular_grid = dynamic_cast<lamure::pvs::grid_irregular_indexed*>(output_grid))
+    {
+        irregular_grid->set_block_settings(settings);
+    }
+}
+
 int main(int argc, char** argv)
 {
     // Read additional data from input parameters.
@@ -38,6 +69,10 @@ int main(int argc, char** argv)
     std::string pvs_output_file_path = "";
     std::string output_grid_type = "";
     float optimization_threshold = 1.0f;
+    std::string block_codec = "";
+    std::string block_coding = "";
+    int block_compression_level = 1;
+    unsigned int num_threads = 0;
 
     namespace po = boost::program_options;
     namespace fs = boost::filesystem;
@@ -54,8 +89,12 @@ int main(int argc, char** argv)
       ("pvs-file", po::value<std::string>(&pvs_input_file_path), "specify input file of calculated pvs data (.pvs)")
       ("2nd-pvs-file", po::value<std::string>(&second_pvs_input_file_path), "(optional) specify second input file of calculated pvs data (.pvs) to join visibility with first pvs file")
       ("output-file", po::value<std::string>(&pvs_output_file_path), "specify output file of converted visibility data (.pvs)")
-      ("gridtype", po::value<std::string>(&output_grid_type), "specify type of grid to store visibility data. If no grid type is given, the input grid type will be used. ('regular', 'regular_compressed', 'irregular', 'irregular_compressed', octree', 'octree_compressed', octree_hierarchical', 'octree_hierarchical_v2', 'octree_hierarchical_v3')")
-      ("optithresh", po::value<float>(&optimization_threshold)->default_value(-1.0f), "specify the threshold at which common data are converged (percent value between 0 and 1). Negative values will deactivate optimization process. Default value is -1.0, so grid optimization is deactivated.");
+      ("gridtype", po::value<std::string>(&output_grid_type), "specify type of grid to store visibility data. If no grid type is given, the input grid type will be used. ('regular', 'regular_compressed', 'regular_indexed', 'irregular', 'irregular_compressed', 'irregular_indexed', octree', 'octree_compressed', 'octree_indexed', octree_hierarchical', 'octree_hierarchical_v2', 'octree_hierarchical_v3')")
+      ("optithresh", po::value<float>(&optimization_threshold)->default_value(-1.0f), "specify the threshold at which common data are converged (percent value between 0 and 1). Negative values will deactivate optimization process. Default value is -1.0, so grid optimization is deactivated.")
+      ("block-codec", po::value<std::string>(&block_codec)->default_value("deflate"), "(indexed grid types only) compression of the cell blocks ('none', 'deflate')")
+      ("block-level", po::value<int>(&block_compression_level)->default_value(1), "(indexed grid types only) deflate level from 1 (fastest) to 9 (smallest)")
+      ("block-coding", po::value<std::string>(&block_coding)->default_value("run_length"), "(indexed grid types only) coding of the node bitsets before compression ('bitset', 'run_length')")
+      ("threads", po::value<unsigned int>(&num_threads)->default_value(0), "(indexed grid types only) threads encoding the cell blocks, 0 uses all hardware threads");
       ;
 
     po::variables_map vm;
@@ -101,13 +140,9 @@ int main(int argc, char** argv)
         return 0;
     }
 
-    if(input_grid->get_grid_type() != lamure::pvs::grid_regular::get_grid_identifier() && 
-        input_grid->get_grid_type() != lamure::pvs::grid_regular_compressed::get_grid_identifier() && 
-        input_grid->get_grid_type() != lamure::pvs::grid_octree_hierarchical_v3::get_grid_identifier() &&
-        input_grid->get_grid_type() != lamure::pvs::grid_irregular::get_grid_identifier() &&
-        input_grid->get_grid_type() != lamure::pvs::grid_irregular_compressed::get_grid_identifier())
+    if(!is_convertible_grid_type(input_grid->get_grid_type()))
     {
-        std::cout << "Input grid must be of regular, regular compressed or hierarchical v3 grid type. Irregular works as well, yet should be unoptimized." << std::endl;
+        std::cout << "Input grid must be of regular, regular compressed, regular indexed or hierarchical v3 grid type. Irregular works as well, yet should be unoptimized." << std::endl;
         return 0;
     }
     else
@@ -138,13 +173,9 @@ int main(int argc, char** argv)
             return 0;
         }
 
-        if(second_input_grid->get_grid_type() != lamure::pvs::grid_regular::get_grid_identifier() && 
-            second_input_grid->get_grid_type() != lamure::pvs::grid_regular_compressed::get_grid_identifier() && 
-            second_input_grid->get_grid_type() != lamure::pvs::grid_octree_hierarchical_v3::get_grid_identifier() &&
-            second_input_grid->get_grid_type() != lamure::pvs::grid_irregular::get_grid_identifier() &&
-            second_input_grid->get_grid_type() != lamure::pvs::grid_irregular_compressed::get_grid_identifier())
+        if(!is_convertible_grid_type(second_input_grid->get_grid_type()))
         {
-            std::cout << "Input grid must be of regular, regular compressed or hierarchical v3 grid type. Irregular works as well, yet should be unoptimized." << std::endl;
+            std::cout << "Input grid must be of regular, regular compressed, regular indexed or hierarchical v3 grid type. Irregular works as well, yet should be unoptimized." << std::endl;
             return 0;
         }
 
@@ -169,7 +200,8 @@ int main(int argc, char** argv)
     }
 
     if(output_grid_type == lamure::pvs::grid_irregular::get_grid_identifier() ||
-        output_grid_type == lamure::pvs::grid_irregular_compressed::get_grid_identifier())
+        output_grid_type == lamure::pvs::grid_irregular_compressed::get_grid_identifier() ||
+        output_grid_type == lamure::pvs::grid_irregular_indexed::get_grid_identifier())
     {
         // Special case if grid is irregular. Get smallest cell size and calculate number cells per axis.
         scm::math::vec3d smallest_cell_size = input_grid->get_cell_at_index(0)->get_size();
@@ -209,7 +241,8 @@ int main(int argc, char** argv)
 
         size_t num_cells = depth;
         if(output_grid_type == lamure::pvs::grid_regular::get_grid_identifier() || 
-            output_grid_type == lamure::pvs::grid_regular_compressed::get_grid_identifier())
+            output_grid_type == lamure::pvs::grid_regular_compressed::get_grid_identifier() ||
+            output_grid_type == lamure::pvs::grid_regular_indexed::get_grid_identifier())
         {
             num_cells = cells_per_axis;
         }
@@ -223,6 +256,40 @@ int main(int argc, char** argv)
         return 0;
     }
 
+    lamure::pvs::visibility_block_settings block_settings;
+    block_settings.compression_level = block_compression_level;
+    block_settings.num_threads = num_threads;
+
+    if(block_codec == "none")
+    {
+        block_settings.codec = lamure::pvs::visibility_block_codec::none;
+    }
+    else if(block_codec == "deflate")
+    {
+        block_settings.codec = lamure::pvs::visibility_block_codec::deflate;
+    }
+    else
+    {
+        std::cout << "Invalid block codec.\n" << desc;
+        return 0;
+    }
+
+    if(block_coding == "bitset")
+    {
+        block_settings.coding = lamure::pvs::visibility_block_coding::bitset;
+    }
+    else if(block_coding == "run_length")
+    {
+        block_settings.coding = lamure::pvs::visibility_block_coding::run_length;
+    }
+    else
+    {
+        std::cout << "Invalid block coding.\n" << desc;
+        return 0;
+    }
+
+    set_block_settings(output_grid, block_settings);
+
     std::cout << "Finished preparations." << std::endl;
 
     // Copy visibility data.
@@ -243,18 +310,24 @@ int main(int argc, char** argv)
             second_input_grid->load_cell_visibility_from_file(second_pvs_input_file_path, input_cell_index);
         }
 
+        // Visibility is copied as bitset words, joined with the second input if there is one.
         for(lamure::model_t model_index = 0; model_index < ids.size(); ++model_index)
         {
-            for(lamure::node_t node_index = 0; node_index < ids[model_index]; ++node_index)
+            std::vector<uint64_t> words((ids[model_index] + 63) / 64);
+            input_cell->copy_visibility_words(model_index, ids[model_index], words.data());
+
+            if(second_input_cell != nullptr)
             {
-                bool visibility = input_cell->get_visibility(model_index, node_index);
-                output_grid->set_cell_visibility(cell_index, model_index, node_index, visibility);
+                std::vector<uint64_t> second_words(words.size());
+                second_input_cell->copy_visibility_words(model_index, ids[model_index], second_words.data());
 
-                if(second_input_cell != nullptr && !visibility)
+                for(size_t word_index = 0; word_index < words.size(); ++word_index)
                 {
-                    output_grid->set_cell_visibility(cell_index, model_index, node_index, second_input_cell->get_visibility(model_index, node_index));
+                    words[word_index] |= second_words[word_index];
                 }
             }
+
+            output_grid->union_cell_visibility(cell_index, model_index, words.data(), ids[model_index]);
         }
 
         input_grid->clear_cell_visibility(input_cell_index);
@@ -280,7 +353,8 @@ int main(int argc, char** argv)
         std::cout << "Start grid optimization..." << std::endl;
 
         if(output_grid_type == lamure::pvs::grid_octree::get_grid_identifier() ||
-            output_grid_type == lamure::pvs::grid_octree_compressed::get_grid_identifier())
+            output_grid_type == lamure::pvs::grid_octree_compressed::get_grid_identifier() ||
+            output_grid_type == lamure::pvs::grid_octree_indexed::get_grid_identifier())
         {
             lamure::pvs::grid_optimizer_octree optimizer;
             optimizer.optimize_grid(output_grid, optimization_threshold);
@@ -292,7 +366,8 @@ int main(int argc, char** argv)
             optimizer.optimize_grid(output_grid, optimization_threshold);
         }
         else if(output_grid_type == lamure::pvs::grid_irregular::get_grid_identifier() ||
-            output_grid_type == lamure::pvs::grid_irregular_compressed::get_grid_identifier())
+            output_grid_type == lamure::pvs::grid_irregular_compressed::get_grid_identifier() ||
+            output_grid_type == lamure::pvs::grid_irregular_indexed::get_grid_identifier())
         {
             lamure::pvs::grid_optimizer_irregular optimizer;
             optimizer.optimize_grid(output_grid, optimization_threshold);
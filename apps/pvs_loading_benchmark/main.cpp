@@ -0,0 +1,254 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <lamure/pvs/pvs_database.h>
+#include <lamure/pvs/grid_regular_compressed.h>
+#include <lamure/pvs/grid_regular_indexed.h>
+
+#include <boost/program_options.hpp>
+#include <boost/filesystem.hpp>
+
+double milliseconds_since(const std::chrono::steady_clock::time_point& start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+std::string get_grid_file_path(const std::string& pvs_file_path)
+{
+    std::string grid_file_path = pvs_file_path;
+    grid_file_path.resize(grid_file_path.length() - 3);
+    return grid_file_path + "grid";
+}
+
+// Synthetic visibility of a cell: alternating runs of invisible and visible nodes, like the subtrees of the LOD hierarchies
+// which are seen from a view cell.
+void create_cell_visibility(const lamure::node_t& num_nodes, const double& density, std::mt19937_64& generator, std::vector<uint64_t>& words)
+{
+    const double mean_run_length = 64.0;
+    std::exponential_distribution<double> visible_run_distribution(1.0 / mean_run_length);
+    std::exponential_distribution<double> invisible_run_distribution(density / ((1.0 - density) * mean_run_length));
+
+    words.assign((num_nodes + 63) / 64, 0);
+    size_t node_index = (size_t)invisible_run_distribution(generator);
+
+    while(node_index < num_nodes)
+    {
+        size_t run_end = std::min((size_t)num_nodes, node_index + 1 + (size_t)visible_run_distribution(generator));
+
+        for(; node_index < run_end; ++node_index)
+        {
+            words[node_index / 64] |= (uint64_t)1 << (node_index % 64);
+        }
+
+        node_index += 1 + (size_t)invisible_run_distribution(generator);
+    }
+}
+
+// Writes the same synthetic visibility once gzip compressed and once in the variants of the indexed block format.
+std::vector<std::string> write_synthetic_files(const std::string& output_dir, const size_t& cells_per_axis, const std::vector<lamure::node_t>& ids, const double& density, const unsigned int& seed)
+{
+    lamure::pvs::grid_regular_compressed compressed_grid(cells_per_axis, 1.0, scm::math::vec3d(0.0, 0.0, 0.0), ids);
+    lamure::pvs::grid_regular_indexed indexed_grid(cells_per_axis, 1.0, scm::math::vec3d(0.0, 0.0, 0.0), ids);
+
+    std::mt19937_64 generator(seed);
+    std::vector<uint64_t> words;
+
+    for(size_t cell_index = 0; cell_index < compressed_grid.get_cell_count(); ++cell_index)
+    {
+        for(lamure::model_t model_index = 0; model_index < ids.size(); ++model_index)
+        {
+            create_cell_visibility(ids[model_index], density, generator, words);
+            compressed_grid.union_cell_visibility(cell_index, model_index, words.data(), ids[model_index]);
+            indexed_grid.union_cell_visibility(cell_index, model_index, words.data(), ids[model_index]);
+        }
+    }
+
+    std::vector<std::string> pvs_file_paths;
+
+    auto save_grid = [&](const lamure::pvs::grid& grid, const std::string& name)
+    {
+        std::string pvs_file_path = (boost::filesystem::path(output_dir) / ("synthetic_" + name + ".pvs")).string();
+
+        auto start = std::chrono::steady_clock::now();
+        grid.save_grid_to_file(get_grid_file_path(pvs_file_path));
+        grid.save_visibility_to_file(pvs_file_path);
+        std::cout << "wrote " << pvs_file_path << " in " << milliseconds_since(start) << " ms" << std::endl;
+
+        pvs_file_paths.push_back(pvs_file_path);
+    };
+
+    save_grid(compressed_grid, "gzip");
+
+    struct block_variant
+    {
+        std::string name;
+        lamure::pvs::visibility_block_codec codec;
+        lamure::pvs::visibility_block_coding coding;
+    };
+
+    std::vector<block_variant> variants = {
+        {"indexed_deflate_run_length", lamure::pvs::visibility_block_codec::deflate, lamure::pvs::visibility_block_coding::run_length},
+        {"indexed_deflate_bitset", lamure::pvs::visibility_block_codec::deflate, lamure::pvs::visibility_block_coding::bitset},
+        {"indexed_none_run_length", lamure::pvs::visibility_block_codec::none, lamure::pvs::visibility_block_coding::run_length},
+    };
+
+    for(const block_variant& variant : variants)
+    {
+        lamure::pvs::visibility_block_settings settings;
+        settings.codec = variant.codec;
+        settings.coding = variant.coding;
+
+        indexed_grid.set_block_settings(settings);
+        save_grid(indexed_grid, variant.name);
+    }
+
+    return pvs_file_paths;
+}
+
+// Loads single cells in random order like a viewer jumping through the scene and reports the latency per cell.
+void benchmark_file(const std::string& pvs_file_path, const size_t& num_samples, const unsigned int& seed)
+{
+    lamure::pvs::grid* cell_grid = lamure::pvs::pvs_database::get_instance()->load_grid_from_file(get_grid_file_path(pvs_file_path));
+
+    if(cell_grid == nullptr)
+    {
+        std::cout << "Error loading grid of " << pvs_file_path << std::endl;
+        return;
+    }
+
+    std::vector<size_t> cell_indices(cell_grid->get_cell_count());
+    std::iota(cell_indices.begin(), cell_indices.end(), 0);
+    std::shuffle(cell_indices.begin(), cell_indices.end(), std::mt19937_64(seed));
+
+    if(num_samples > 0 && num_samples < cell_indices.size())
+    {
+        cell_indices.resize(num_samples);
+    }
+
+    std::vector<double> latencies;
+    size_t num_visible_nodes = 0;
+
+    for(const size_t& cell_index : cell_indices)
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        if(!cell_grid->load_cell_visibility_from_file(pvs_file_path, cell_index))
+        {
+            std::cout << "Error loading cell " << cell_index << " of " << pvs_file_path << std::endl;
+            delete cell_grid;
+            return;
+        }
+
+        latencies.push_back(milliseconds_since(start));
+
+        num_visible_nodes += cell_grid->get_cell_at_index(cell_index)->popcount();
+        cell_grid->clear_cell_visibility(cell_index);
+    }
+
+    std::string grid_type = cell_grid->get_grid_type();
+    delete cell_grid;
+
+    // Loading the whole file with a fresh grid.
+    auto start = std::chrono::steady_clock::now();
+    lamure::pvs::grid* full_grid = lamure::pvs::pvs_database::get_instance()->load_grid_from_file(get_grid_file_path(pvs_file_path), pvs_file_path);
+    double full_load_time = milliseconds_since(start);
+    delete full_grid;
+
+    // The first load also reads (or maps) the index of the file.
+    double first_latency = latencies.front();
+    std::vector<double> sorted_latencies = latencies;
+    std::sort(sorted_latencies.begin(), sorted_latencies.end());
+
+    auto percentile = [&](const double& fraction)
+    {
+        return sorted_latencies[std::min(sorted_latencies.size() - 1, (size_t)(fraction * sorted_latencies.size()))];
+    };
+
+    std::cout << pvs_file_path << " (" << grid_type << ")" << std::endl;
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "  file size:         " << boost::filesystem::file_size(pvs_file_path) / (1024.0 * 1024.0) << " MB" << std::endl;
+    std::cout << "  sampled cells:     " << latencies.size() << " (" << num_visible_nodes / latencies.size() << " visible nodes per cell)" << std::endl;
+    std::cout << "  first cell:        " << first_latency << " ms" << std::endl;
+    std::cout << "  per cell mean:     " << std::accumulate(latencies.begin(), latencies.end(), 0.0) / latencies.size() << " ms" << std::endl;
+    std::cout << "  per cell median:   " << percentile(0.5) << " ms" << std::endl;
+    std::cout << "  per cell 99%:      " << percentile(0.99) << " ms" << std::endl;
+    std::cout << "  per cell max:      " << sorted_latencies.back() << " ms" << std::endl;
+    std::cout << "  whole file:        " << full_load_time << " ms" << std::endl;
+    std::cout.unsetf(std::ios::floatfield);
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<std::string> pvs_file_paths;
+    std::string output_dir = "";
+    size_t cells_per_axis = 16;
+    lamure::model_t num_models = 1;
+    lamure::node_t num_nodes = 200000;
+    double density = 0.2;
+    size_t num_samples = 0;
+    unsigned int seed = 1;
+
+    namespace po = boost::program_options;
+    namespace fs = boost::filesystem;
+
+    const std::string exec_name = (argc > 0) ? fs::basename(argv[0]) : "";
+
+    po::options_description desc("Usage: " + exec_name + " [OPTION]... [PVS-FILE]...\n\n"
+                               "Measures the latency of loading the visibility of single view cells, as when the viewer enters a cell which is not loaded yet.\n"
+                               "Without input files, synthetic visibility is written in the compressed and indexed formats and measured.\n\n"
+                               "Allowed Options");
+    desc.add_options()
+      ("help", "print help message")
+      ("pvs-file", po::value<std::vector<std::string>>(&pvs_file_paths), "pvs files to measure, the grid files are expected next to them")
+      ("output-dir", po::value<std::string>(&output_dir), "directory of the synthetic files, defaults to the temporary directory")
+      ("cells", po::value<size_t>(&cells_per_axis)->default_value(16), "cells per axis of the synthetic regular grid")
+      ("models", po::value<lamure::model_t>(&num_models)->default_value(1), "number of synthetic models")
+      ("nodes", po::value<lamure::node_t>(&num_nodes)->default_value(200000), "number of nodes per synthetic model")
+      ("density", po::value<double>(&density)->default_value(0.2), "approximate fraction of visible nodes per synthetic cell")
+      ("samples", po::value<size_t>(&num_samples)->default_value(0), "number of randomly chosen cells to load from each file, 0 loads all cells")
+      ("seed", po::value<unsigned int>(&seed)->default_value(1), "seed of the synthetic visibility and the order of the loaded cells");
+      ;
+
+    po::positional_options_description positional_options;
+    positional_options.add("pvs-file", -1);
+
+    po::variables_map vm;
+    po::store(po::command_line_parser(argc, argv).options(desc).positional(positional_options).run(), vm);
+    po::notify(vm);
+
+    if(vm.count("help") || cells_per_axis == 0 || num_models == 0 || num_nodes == 0 || density <= 0.0 || density >= 1.0)
+    {
+        std::cout << desc;
+        return 0;
+    }
+
+    if(pvs_file_paths.empty())
+    {
+        if(output_dir == "")
+        {
+            output_dir = fs::temp_directory_path().string();
+        }
+
+        pvs_file_paths = write_synthetic_files(output_dir, cells_per_axis, std::vector<lamure::node_t>(num_models, num_nodes), density, seed);
+    }
+
+    for(const std::string& pvs_file_path : pvs_file_paths)
+    {
+        benchmark_file(pvs_file_path, num_samples, seed);
+    }
+
+    return 0;
+}
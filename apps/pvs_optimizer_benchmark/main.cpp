@@ -0,0 +1,271 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <lamure/pvs/bitset_kernels.h>
+#include <lamure/pvs/grid_irregular.h>
+#include <lamure/pvs/grid_octree.h>
+#include <lamure/pvs/grid_octree_hierarchical.h>
+#include <lamure/pvs/grid_octree_node.h>
+#include <lamure/pvs/view_cell_regular.h>
+
+#include <lamure/pvs/grid_optimizer_irregular.h>
+#include <lamure/pvs/grid_optimizer_octree.h>
+#include <lamure/pvs/grid_optimizer_octree_hierarchical.h>
+
+#include <boost/program_options.hpp>
+#include <boost/filesystem.hpp>
+
+// Synthetic visibility: every octree node on the path to a leaf adds its own random nodes,
+// so siblings share most of their visibility and differ by the part added in the leaves.
+void fill_octree_node(lamure::pvs::grid_octree_node* node, const lamure::pvs::view_cell_regular& inherited, const std::vector<lamure::node_t>& ids, const double& fraction_per_level, std::mt19937_64& generator)
+{
+    lamure::pvs::view_cell_regular visibility = inherited;
+
+    for(lamure::model_t model_index = 0; model_index < ids.size(); ++model_index)
+    {
+        std::uniform_int_distribution<lamure::node_t> node_distribution(0, ids[model_index] - 1);
+        size_t num_added_nodes = (size_t)(fraction_per_level * ids[model_index]);
+
+        for(size_t added_index = 0; added_index < num_added_nodes; ++added_index)
+        {
+            visibility.set_visibility(model_index, node_distribution(generator), true);
+        }
+    }
+
+    if(node->has_children())
+    {
+        for(size_t child_index = 0; child_index < 8; ++child_index)
+        {
+            fill_octree_node(node->get_child_at_index(child_index), visibility, ids, fraction_per_level, generator);
+        }
+    }
+    else
+    {
+        node->union_with(&visibility);
+    }
+}
+
+void fill_octree(lamure::pvs::grid_octree* octree, const size_t& octree_depth, const std::vector<lamure::node_t>& ids, const double& density, const unsigned int& seed)
+{
+    std::mt19937_64 generator(seed);
+    fill_octree_node(octree->get_root_node(), lamure::pvs::view_cell_regular(), ids, density / (double)octree_depth, generator);
+}
+
+// Applies func to every octree node whose children are leaves.
+void for_each_leaf_parent(lamure::pvs::grid_octree_node* node, const std::function<void(lamure::pvs::grid_octree_node*)>& func)
+{
+    if(!node->has_children())
+    {
+        return;
+    }
+
+    if(!node->get_child_at_index(0)->has_children())
+    {
+        func(node);
+        return;
+    }
+
+    for(size_t child_index = 0; child_index < 8; ++child_index)
+    {
+        for_each_leaf_parent(node->get_child_at_index(child_index), func);
+    }
+}
+
+double seconds_since(const std::chrono::steady_clock::time_point& start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv)
+{
+    size_t octree_depth = 5;
+    lamure::model_t num_models = 1;
+    lamure::node_t num_nodes = 100000;
+    double density = 0.3;
+    float optimization_threshold = 0.9f;
+    size_t num_irregular_cells = 6;
+    unsigned int seed = 1;
+
+    namespace po = boost::program_options;
+    namespace fs = boost::filesystem;
+
+    const std::string exec_name = (argc > 0) ? fs::basename(argv[0]) : "";
+
+    po::options_description desc("Usage: " + exec_name + " [OPTION]...\n\n"
+                               "Compares merging view cells node by node with the bulk visibility operations and times the grid optimizers on a synthetic grid.\n\n"
+                               "Allowed Options");
+    desc.add_options()
+      ("help", "print help message")
+      ("depth", po::value<size_t>(&octree_depth)->default_value(5), "octree depth of the synthetic grid, the octree has 8^(depth-1) cells (7 gives 64^3 cells)")
+      ("models", po::value<lamure::model_t>(&num_models)->default_value(1), "number of models")
+      ("nodes", po::value<lamure::node_t>(&num_nodes)->default_value(100000), "number of nodes per model")
+      ("density", po::value<double>(&density)->default_value(0.3), "approximate fraction of visible nodes per cell")
+      ("optithresh", po::value<float>(&optimization_threshold)->default_value(0.9f), "equality threshold passed to the optimizers")
+      ("irregular-cells", po::value<size_t>(&num_irregular_cells)->default_value(6), "cells per axis of the irregular grid, its optimizer compares all pairs of cells")
+      ("seed", po::value<unsigned int>(&seed)->default_value(1), "seed of the synthetic visibility");
+      ;
+
+    po::variables_map vm;
+    po::store(po::command_line_parser(argc, argv).options(desc).run(), vm);
+    po::notify(vm);
+
+    if(vm.count("help") || octree_depth < 2 || num_models == 0 || num_nodes == 0)
+    {
+        std::cout << desc;
+        return 0;
+    }
+
+    std::vector<lamure::node_t> ids(num_models, num_nodes);
+
+    std::cout << "bitset kernels: " << lamure::pvs::bitset_kernels::instruction_set_name() << std::endl;
+
+    // Merge the leaves of every leaf parent like the octree optimizer, once node by node and once with the bulk operations.
+    {
+        lamure::pvs::grid_octree octree(octree_depth, 1.0, scm::math::vec3d(0.0, 0.0, 0.0), ids);
+        fill_octree(&octree, octree_depth, ids, density, seed);
+
+        size_t checksum_per_node = 0;
+        size_t checksum_bulk = 0;
+
+        auto start = std::chrono::steady_clock::now();
+        for_each_leaf_parent(octree.get_root_node(), [&](lamure::pvs::grid_octree_node* node)
+        {
+            lamure::pvs::grid_octree_node tmp_node;
+
+            for(size_t child_index = 0; child_index < 8; ++child_index)
+            {
+                lamure::pvs::grid_octree_node* child_node = node->get_child_at_index(child_index);
+
+                for(lamure::model_t model_index = 0; model_index < num_models; ++model_index)
+                {
+                    for(lamure::node_t node_index = 0; node_index < num_nodes; ++node_index)
+                    {
+                        if(child_node->get_visibility(model_index, node_index))
+                        {
+                            tmp_node.set_visibility(model_index, node_index, true);
+                        }
+                    }
+                }
+            }
+
+            checksum_per_node += tmp_node.view_cell::popcount();
+
+            for(size_t child_index = 0; child_index < 8; ++child_index)
+            {
+                checksum_per_node += node->get_child_at_index(child_index)->view_cell::popcount();
+            }
+        });
+        double per_node_seconds = seconds_since(start);
+
+        start = std::chrono::steady_clock::now();
+        for_each_leaf_parent(octree.get_root_node(), [&](lamure::pvs::grid_octree_node* node)
+        {
+            lamure::pvs::grid_octree_node tmp_node;
+
+            for(size_t child_index = 0; child_index < 8; ++child_index)
+            {
+                tmp_node.union_with(node->get_child_at_index(child_index));
+            }
+
+            checksum_bulk += tmp_node.popcount();
+
+            for(size_t child_index = 0; child_index < 8; ++child_index)
+            {
+                checksum_bulk += node->get_child_at_index(child_index)->popcount();
+            }
+        });
+        double bulk_seconds = seconds_since(start);
+
+        std::cout << "leaf merge, " << octree.get_cell_count() << " cells: node by node " << per_node_seconds << " s, bulk " << bulk_seconds << " s, speedup " << per_node_seconds / bulk_seconds
+                  << (checksum_per_node == checksum_bulk ? "" : " (RESULTS DIFFER)") << std::endl;
+    }
+
+    // Optimizers.
+    {
+        lamure::pvs::grid_octree octree(octree_depth, 1.0, scm::math::vec3d(0.0, 0.0, 0.0), ids);
+        fill_octree(&octree, octree_depth, ids, density, seed);
+        size_t num_cells = octree.get_cell_count();
+
+        auto start = std::chrono::steady_clock::now();
+        lamure::pvs::grid_optimizer_octree optimizer;
+        optimizer.optimize_grid(&octree, optimization_threshold);
+
+        std::cout << "grid_optimizer_octree: " << seconds_since(start) << " s, " << num_cells << " -> " << octree.get_cell_count() << " cells" << std::endl;
+    }
+
+    {
+        lamure::pvs::grid_octree_hierarchical octree(octree_depth, 1.0, scm::math::vec3d(0.0, 0.0, 0.0), ids);
+        fill_octree(&octree, octree_depth, ids, density, seed);
+
+        auto start = std::chrono::steady_clock::now();
+        lamure::pvs::grid_optimizer_octree_hierarchical optimizer;
+        optimizer.optimize_grid(&octree, optimization_threshold);
+
+        std::cout << "grid_optimizer_octree_hierarchical: " << seconds_since(start) << " s" << std::endl;
+    }
+
+    {
+        double cell_size = 1.0 / (double)num_irregular_cells;
+        lamure::pvs::grid_irregular irregular_grid(num_irregular_cells, num_irregular_cells, num_irregular_cells, cell_size, scm::math::vec3d(0.0, 0.0, 0.0), ids);
+
+        // Blocks of 2x2x2 cells share their visibility apart from a few nodes.
+        std::mt19937_64 generator(seed);
+        size_t num_blocks = (num_irregular_cells + 1) / 2;
+        std::vector<lamure::pvs::view_cell_regular> block_visibility(num_blocks * num_blocks * num_blocks);
+
+        for(lamure::pvs::view_cell_regular& visibility : block_visibility)
+        {
+            for(lamure::model_t model_index = 0; model_index < num_models; ++model_index)
+            {
+                std::uniform_int_distribution<lamure::node_t> node_distribution(0, num_nodes - 1);
+
+                for(size_t added_index = 0; added_index < (size_t)(density * num_nodes); ++added_index)
+                {
+                    visibility.set_visibility(model_index, node_distribution(generator), true);
+                }
+            }
+        }
+
+        for(size_t cell_index = 0; cell_index < irregular_grid.get_cell_count(); ++cell_index)
+        {
+            size_t x = cell_index % num_irregular_cells;
+            size_t y = (cell_index / num_irregular_cells) % num_irregular_cells;
+            size_t z = cell_index / (num_irregular_cells * num_irregular_cells);
+            const lamure::pvs::view_cell_regular& visibility = block_visibility[(z / 2 * num_blocks + y / 2) * num_blocks + x / 2];
+
+            std::map<lamure::model_t, std::vector<lamure::node_t>> visible_indices = visibility.get_visible_indices();
+
+            for(const auto& model_indices : visible_indices)
+            {
+                for(const lamure::node_t& node_index : model_indices.second)
+                {
+                    irregular_grid.set_cell_visibility(cell_index, model_indices.first, node_index, true);
+                }
+            }
+        }
+
+        size_t num_cells = irregular_grid.get_cell_count();
+
+        auto start = std::chrono::steady_clock::now();
+        lamure::pvs::grid_optimizer_irregular optimizer;
+
+        // The irregular optimizer relates common nodes to all nodes, not to the visible ones.
+        optimizer.optimize_grid(&irregular_grid, optimization_threshold * (float)density);
+
+        std::cout << "grid_optimizer_irregular: " << seconds_since(start) << " s, " << num_cells << " cells" << std::endl;
+    }
+
+    return 0;
+}
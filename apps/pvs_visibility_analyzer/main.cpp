@@ -18,7 +18,7 @@
 #include <boost/program_options.hpp>
 #include <boost/filesystem.hpp>
 
-void compare_grid_visibility(std::string visibility_path_one, std::string visibility_path_two, unsigned int num_steps);
+bool compare_grid_visibility(std::string visibility_path_one, std::string visibility_path_two, unsigned int num_steps, double tolerance);
 
 int main(int argc, char** argv)
 {
@@ -26,6 +26,7 @@ int main(int argc, char** argv)
     std::string pvs_input_file_path = "";
     std::string second_pvs_input_file_path = "";
     unsigned int num_steps = 11;
+    double tolerance = -1.0;
 
     namespace po = boost::program_options;
     namespace fs = boost::filesystem;
@@ -41,7 +42,8 @@ int main(int argc, char** argv)
     desc.add_options()
       ("pvs-file,p", po::value<std::string>(&pvs_input_file_path), "specify input file of calculated pvs data (.pvs)")
       ("2nd-pvs-file", po::value<std::string>(&second_pvs_input_file_path), "specify input file of calculated pvs data (.pvs)")
-      ("numsteps,n", po::value<unsigned int>(&num_steps)->default_value(11), "specify the number of intervals the occlusion values will be split into");
+      ("numsteps,n", po::value<unsigned int>(&num_steps)->default_value(11), "specify the number of intervals the occlusion values will be split into")
+      ("tolerance", po::value<double>(&tolerance)->default_value(-1.0), "specify the percentage of nodes the visibility of a cell may differ by when comparing two data sets, e.g. the GPU and CPU visibility tests. The nodes visible in only one of the data sets count as difference. Negative values disable the check (default).");
       ;
 
     po::variables_map vm;
@@ -91,7 +93,10 @@ int main(int argc, char** argv)
     else
     {
         // Two data sets given. Check difference between data sets.
-        compare_grid_visibility(pvs_input_file_path, second_pvs_input_file_path, num_steps);
+        if(!compare_grid_visibility(pvs_input_file_path, second_pvs_input_file_path, num_steps, tolerance))
+        {
+            return 1;
+        }
     }
 
     std::cout << "done" << std::endl;
@@ -99,7 +104,7 @@ int main(int argc, char** argv)
     return 0;
 }
 
-void compare_grid_visibility(std::string visibility_path_one, std::string visibility_path_two, unsigned int num_steps)
+bool compare_grid_visibility(std::string visibility_path_one, std::string visibility_path_two, unsigned int num_steps, double tolerance)
 {
     std::vector<size_t> difference_percent_interval_counter;
     difference_percent_interval_counter.resize(num_steps);
@@ -122,7 +127,7 @@ void compare_grid_visibility(std::string visibility_path_one, std::string visibi
     if(grid_one->get_cell_count() != grid_two->get_cell_count())
     {
         std::cout << "Grids to compare have unequal number of cells." << std::endl;
-        return;
+        return false;
     }
 
     std::cout << "Visibility data loaded, starting comparison..." << std::endl;
@@ -136,6 +141,9 @@ void compare_grid_visibility(std::string visibility_path_one, std::string visibi
     double highest_visibility_difference = 0.0;
     double lowest_visibility_difference = 100.0;
 
+    double highest_visibility_mismatch = 0.0;
+    size_t num_cells_beyond_tolerance = 0;
+
     std::string output_file_name = visibility_path_one;
     output_file_name.resize(output_file_name.length() - 4);
     output_file_name += "_visibility_comparison.txt";
@@ -147,27 +155,23 @@ void compare_grid_visibility(std::string visibility_path_one, std::string visibi
     {
         std::cout << "Not able to create output file. Visibility comparison aborted." << std::endl;
         std::cout << "Theoretic path: " << output_file_name << std::endl;
-        return;
+        return false;
     }
 
     // Iterate over view cells and models to colect visibility data.
     for(size_t cell_index = 0; cell_index < grid_one->get_cell_count(); ++cell_index)
     {
-        size_t cell_num_visible_nodes_common = 0;
-        size_t cell_num_visible_nodes_one = 0;
-        size_t cell_num_visible_nodes_two = 0;
-
         size_t cell_num_nodes = 0;
 
-        const lamure::pvs::view_cell_regular* view_cell_one = (const lamure::pvs::view_cell_regular*)grid_one->get_cell_at_index(cell_index);
-        const lamure::pvs::view_cell_regular* view_cell_two = (const lamure::pvs::view_cell_regular*)grid_two->get_cell_at_index(cell_index);
+        const lamure::pvs::view_cell* view_cell_one = grid_one->get_cell_at_index(cell_index);
+        const lamure::pvs::view_cell* view_cell_two = grid_two->get_cell_at_index(cell_index);
+
+        size_t cell_num_visible_nodes_common = view_cell_one->intersect_count(view_cell_two);
+        size_t cell_num_visible_nodes_one = view_cell_one->popcount();
+        size_t cell_num_visible_nodes_two = view_cell_two->popcount();
 
         for(size_t model_index = 0; model_index < grid_one->get_num_models(); ++model_index)
         {
-            cell_num_visible_nodes_common += (view_cell_one->get_bitset(model_index) & view_cell_two->get_bitset(model_index)).count();
-            cell_num_visible_nodes_one += view_cell_one->get_bitset(model_index).count();
-            cell_num_visible_nodes_two += view_cell_two->get_bitset(model_index).count();
-
             cell_num_nodes += grid_one->get_num_nodes(model_index);
         }
 
@@ -176,6 +180,15 @@ void compare_grid_visibility(std::string visibility_path_one, std::string visibi
         double cell_visibility_two = ((double)cell_num_visible_nodes_two / (double)cell_num_nodes) * 100.0;
         double cell_visibility_common = ((double)cell_num_visible_nodes_common / (double)cell_num_nodes) * 100.0;
         double cell_visibility_difference = std::abs(cell_visibility_one - cell_visibility_two);
+
+        // Nodes visible in only one of the grids, unlike the difference above this also catches different nodes of equal count.
+        double cell_visibility_mismatch = cell_visibility_one + cell_visibility_two - 2.0 * cell_visibility_common;
+        highest_visibility_mismatch = std::max(highest_visibility_mismatch, cell_visibility_mismatch);
+
+        if(tolerance >= 0.0 && cell_visibility_mismatch > tolerance)
+        {
+            ++num_cells_beyond_tolerance;
+        }
         
         // Check for highest or lowest visibility in grid.
         if(cell_visibility_difference > highest_visibility_difference)
@@ -225,6 +238,7 @@ void compare_grid_visibility(std::string visibility_path_one, std::string visibi
     file_out << "visible only by two: " << visibility_two_only << std::endl;
     file_out << "\nhighest difference in cell: " << highest_visibility_difference << std::endl;
     file_out << "lowest difference in cell: " << lowest_visibility_difference << std::endl;
+    file_out << "highest mismatch in cell: " << highest_visibility_mismatch << std::endl;
 
     size_t num_cells = grid_one->get_cell_count();
     file_out << std::endl;
@@ -238,4 +252,12 @@ void compare_grid_visibility(std::string visibility_path_one, std::string visibi
     file_out.close();
 
     std::cout << "Results written to " << output_file_name << std::endl;
+
+    if(tolerance >= 0.0)
+    {
+        std::cout << num_cells_beyond_tolerance << "/" << num_cells << " cells differ by more than " << tolerance << " percent of the nodes (highest mismatch " << highest_visibility_mismatch << ")" << std::endl;
+        return num_cells_beyond_tolerance == 0;
+    }
+
+    return true;
 }
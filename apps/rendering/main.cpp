@@ -148,6 +148,10 @@ int main(int argc, char** argv)
 
     std::string pvs_file_path = "";
     bool pvs_culling = true;
+    bool map_out_of_core = false;
+    bool clock_cache_replacement = false;
+    unsigned prefetch_frames = 0;
+    unsigned prefetch_budget = 1024;
 
     po::options_description desc("Usage: " + exec_name + " [OPTION]... INPUT\n\n"
                                "Allowed Options");
@@ -159,6 +163,10 @@ int main(int argc, char** argv)
       ("vram,v", po::value<unsigned>(&video_memory_budget)->default_value(2048), "specify graphics memory budget in MB (default=2048)")
       ("mem,m", po::value<unsigned>(&main_memory_budget)->default_value(4096), "specify main memory budget in MB (default=4096)")
       ("upload,u", po::value<unsigned>(&max_upload_budget)->default_value(64), "specify maximum video memory upload budget per frame in MB (default=64)")
+      ("mmap", po::value<bool>(&map_out_of_core)->default_value(false), "map the lod files instead of copying nodes into main memory, if the dataset fits into main memory (default=false)")
+      ("clock-cache", po::value<bool>(&clock_cache_replacement)->default_value(false), "use CLOCK replacement with a sharded index for the caches instead of the locked lru list (default=false)")
+      ("prefetch-frames", po::value<unsigned>(&prefetch_frames)->default_value(0), "request nodes for the camera motion extrapolated this many frames ahead, 0 disables (default=0)")
+      ("prefetch-budget", po::value<unsigned>(&prefetch_budget)->default_value(1024), "maximum number of speculative node requests per cut update (default=1024)")
       ("measurement-file", po::value<std::string>(&measurement_file_path)->default_value(""), "specify camera session for quality measurement_file (default = \"\")")
       ("measurement-interpolate", po::value<bool>(&measurement_file_interpolation)->default_value(false), "allow interpolation between measurement transformations (default=false)")
       ("measurement-stepsize", po::value<float>(&measurement_interpolation_stepsize)->default_value(1.0f), "if interpolation is activated, this will be the stepsize in spatial units between interpolation points")
@@ -257,6 +265,10 @@ int main(int argc, char** argv)
     policy->set_max_upload_budget_in_mb(max_upload_budget); //8
     policy->set_render_budget_in_mb(video_memory_budget); //2048
     policy->set_out_of_core_budget_in_mb(main_memory_budget); //4096, 8192
+    policy->set_out_of_core_mapping(map_out_of_core);
+    policy->set_clock_cache_replacement(clock_cache_replacement);
+    policy->set_prefetch_frames(prefetch_frames);
+    policy->set_prefetch_budget_in_nodes(prefetch_budget);
     policy->set_window_width(window_width);
     policy->set_window_height(window_height);
 
@@ -0,0 +1,153 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <lamure/pre/surfel_kernels.h>
+#include <lamure/pre/surfel_soa.h>
+
+// runs the scalar and the compiled-in vectorized surfel kernels on the same
+// synthetic positions and reports throughput and the largest deviation.
+
+char* get_cmd_option(char** begin, char** end, const std::string & option) {
+    char** it = std::find(begin, end, option);
+    if (it != end && ++it != end)
+        return *it;
+    return 0;
+}
+
+bool cmd_option_exists(char** begin, char** end, const std::string& option) {
+    return std::find(begin, end, option) != end;
+}
+
+double measure(const size_t iterations, const std::function<void()>& kernel) {
+    kernel();
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        kernel();
+    }
+    return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count() / iterations;
+}
+
+void report(const std::string& name, const size_t count, const double scalar_seconds, const double simd_seconds, const double deviation) {
+    std::cout << name << ": scalar " << count / scalar_seconds / 1e6 << " M/s, "
+              << "vectorized " << count / simd_seconds / 1e6 << " M/s, "
+              << "speedup " << scalar_seconds / simd_seconds << ", "
+              << "max deviation " << deviation << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+
+    if (cmd_option_exists(argv, argv+argc, "-h")) {
+        std::cout << "Usage: " << argv[0] << " <flags>\n" <<
+            "INFO: surfel_kernel_benchmark\n" <<
+            "\t-n: number of surfels per call (default: 4096)\n" <<
+            "\t-i: number of iterations (default: 10000)\n" <<
+            std::endl;
+        return 0;
+    }
+
+    using namespace lamure;
+    using namespace lamure::pre;
+
+    size_t num_surfels = 4096;
+    size_t iterations = 10000;
+
+    if (cmd_option_exists(argv, argv+argc, "-n")) num_surfels = atol(get_cmd_option(argv, argv+argc, "-n"));
+    if (cmd_option_exists(argv, argv+argc, "-i")) iterations = atol(get_cmd_option(argv, argv+argc, "-i"));
+
+    std::cout << "kernels: " << surfel_kernels::instruction_set_name(surfel_kernels::active_instruction_set()) << std::endl;
+
+    std::mt19937_64 rng(42);
+    std::uniform_real_distribution<real> dist(-1000.0, 1000.0);
+
+    surfel_soa positions;
+    positions.reserve(num_surfels);
+    for (size_t i = 0; i < num_surfels; ++i) {
+        positions.push_back(vec3r(dist(rng), dist(rng), dist(rng)));
+    }
+
+    const real* x = positions.x();
+    const real* y = positions.y();
+    const real* z = positions.z();
+    const vec3r center(dist(rng), dist(rng), dist(rng));
+
+    {
+        aligned_vector<real> scalar_result(num_surfels);
+        aligned_vector<real> simd_result(num_surfels);
+        double scalar_seconds = measure(iterations, [&] {
+            surfel_kernels::scalar::squared_distances(x, y, z, num_surfels, center, scalar_result.data()); });
+        double simd_seconds = measure(iterations, [&] {
+            surfel_kernels::squared_distances(x, y, z, num_surfels, center, simd_result.data()); });
+
+        double deviation = 0.0;
+        for (size_t i = 0; i < num_surfels; ++i) {
+            deviation = std::max(deviation, std::abs(scalar_result[i] - simd_result[i]));
+        }
+        report("squared_distances", num_surfels, scalar_seconds, simd_seconds, deviation);
+    }
+
+    {
+        vec3r scalar_min, scalar_max, simd_min, simd_max;
+        double scalar_seconds = measure(iterations, [&] {
+            scalar_min = vec3r(std::numeric_limits<real>::max());
+            scalar_max = vec3r(std::numeric_limits<real>::lowest());
+            surfel_kernels::scalar::bounding_box(x, y, z, num_surfels, scalar_min, scalar_max); });
+        double simd_seconds = measure(iterations, [&] {
+            simd_min = vec3r(std::numeric_limits<real>::max());
+            simd_max = vec3r(std::numeric_limits<real>::lowest());
+            surfel_kernels::bounding_box(x, y, z, num_surfels, simd_min, simd_max); });
+
+        double deviation = 0.0;
+        for (int axis = 0; axis < 3; ++axis) {
+            deviation = std::max(deviation, std::abs(scalar_min[axis] - simd_min[axis]));
+            deviation = std::max(deviation, std::abs(scalar_max[axis] - simd_max[axis]));
+        }
+        report("bounding_box", num_surfels, scalar_seconds, simd_seconds, deviation);
+    }
+
+    {
+        vec3r scalar_sum, simd_sum;
+        double scalar_seconds = measure(iterations, [&] {
+            scalar_sum = surfel_kernels::scalar::sum(x, y, z, num_surfels); });
+        double simd_seconds = measure(iterations, [&] {
+            simd_sum = surfel_kernels::sum(x, y, z, num_surfels); });
+
+        double deviation = 0.0;
+        for (int axis = 0; axis < 3; ++axis) {
+            deviation = std::max(deviation, std::abs(scalar_sum[axis] - simd_sum[axis]));
+        }
+        report("sum", num_surfels, scalar_seconds, simd_seconds, deviation);
+    }
+
+    {
+        real scalar_scatter[6], simd_scatter[6];
+        double scalar_seconds = measure(iterations, [&] {
+            std::fill(scalar_scatter, scalar_scatter + 6, 0.0);
+            surfel_kernels::scalar::accumulate_covariance(x, y, z, num_surfels, center, scalar_scatter); });
+        double simd_seconds = measure(iterations, [&] {
+            std::fill(simd_scatter, simd_scatter + 6, 0.0);
+            surfel_kernels::accumulate_covariance(x, y, z, num_surfels, center, simd_scatter); });
+
+        // summation order differs, so compare relative to the magnitude
+        double deviation = 0.0;
+        for (int i = 0; i < 6; ++i) {
+            deviation = std::max(deviation, std::abs(scalar_scatter[i] - simd_scatter[i]) / std::max(1.0, std::abs(scalar_scatter[i])));
+        }
+        report("accumulate_covariance", num_surfels, scalar_seconds, simd_seconds, deviation);
+    }
+
+    return 0;
+}
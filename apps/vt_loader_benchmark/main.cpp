@@ -0,0 +1,149 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <lamure/vt/VTConfig.h>
+#include <lamure/vt/ooc/TileProvider.h>
+
+// loads a random set of tiles from one or more atlases (as written by
+// vt_preprocessing, e.g. from vt_raw_converter images) through the tile
+// provider without a gl context and reports tiles/s for a number of loader
+// threads. every run draws different tiles, but the page cache of the os
+// still helps later runs, so drop it between runs for cold numbers.
+
+char* get_cmd_option(char** begin, char** end, const std::string & option) {
+    char** it = std::find(begin, end, option);
+    if (it != end && ++it != end)
+        return *it;
+    return 0;
+}
+
+bool cmd_option_exists(char** begin, char** end, const std::string& option) {
+    return std::find(begin, end, option) != end;
+}
+
+double run(const std::vector<std::string>& atlas_files, const uint32_t num_threads, const size_t num_tiles,
+           const size_t cache_size_in_bytes, const uint32_t seed, size_t& tile_byte_size) {
+    vt::VTConfig::get_instance().set_num_loader_threads(num_threads);
+
+    vt::ooc::TileProvider provider;
+
+    std::vector<vt::pre::AtlasFile*> atlases;
+    for (const auto& atlas_file : atlas_files) {
+        atlases.push_back(provider.loadResource(atlas_file.c_str()));
+    }
+    tile_byte_size = atlases.front()->getTileByteSize();
+
+    std::mt19937_64 rng(seed);
+    std::uniform_int_distribution<size_t> atlas_dist(0, atlases.size() - 1);
+
+    std::vector<std::pair<vt::pre::AtlasFile*, uint64_t>> tiles;
+    std::set<std::pair<vt::pre::AtlasFile*, uint64_t>> drawn;
+    uint64_t max_tiles = 0;
+    for (auto atlas : atlases) {
+        max_tiles += atlas->getTotalTiles();
+    }
+    while (tiles.size() < std::min<uint64_t>(num_tiles, max_tiles)) {
+        vt::pre::AtlasFile* atlas = atlases[atlas_dist(rng)];
+        std::uniform_int_distribution<uint64_t> tile_dist(0, atlas->getTotalTiles() - 1);
+        auto tile = std::make_pair(atlas, tile_dist(rng));
+        if (drawn.insert(tile).second) {
+            tiles.push_back(tile);
+        }
+    }
+
+    provider.start(cache_size_in_bytes);
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    float priority = (float)tiles.size();
+    for (const auto& tile : tiles) {
+        provider.getTile(tile.first, tile.second, priority, 0);
+        priority -= 1.f;
+    }
+
+    while (!provider.wait(std::chrono::milliseconds(100))) {
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+    provider.stop();
+
+    return tiles.size() / seconds;
+}
+
+int main(int argc, char *argv[]) {
+
+    if (argc == 1 ||
+        cmd_option_exists(argv, argv+argc, "-h") ||
+        !cmd_option_exists(argv, argv+argc, "-f")) {
+        std::cout << "Usage: " << argv[0] << " <flags>\n" <<
+            "INFO: vt_loader_benchmark\n" <<
+            "\t-f: input .atlas file, or a text file listing one .atlas per line\n" <<
+            "\t-n: number of tiles per run (default: 20000)\n" <<
+            "\t-m: ram cache size in MB (default: 4096)\n" <<
+            "\t-t: loader threads, 0 uses one per hardware thread (default: sweep 1, 2, 4, ... up to the hardware threads)\n" <<
+            std::endl;
+        return 0;
+    }
+
+    const std::string input_file = get_cmd_option(argv, argv+argc, "-f");
+
+    size_t num_tiles = 20000;
+    size_t cache_size_in_mb = 4096;
+    if (cmd_option_exists(argv, argv+argc, "-n")) num_tiles = atol(get_cmd_option(argv, argv+argc, "-n"));
+    if (cmd_option_exists(argv, argv+argc, "-m")) cache_size_in_mb = atol(get_cmd_option(argv, argv+argc, "-m"));
+
+    std::vector<std::string> atlas_files;
+    if (input_file.size() > 6 && input_file.substr(input_file.size() - 6) == ".atlas") {
+        atlas_files.push_back(input_file);
+    }
+    else {
+        std::ifstream list_file(input_file);
+        std::string line;
+        while (std::getline(list_file, line)) {
+            if (!line.empty()) atlas_files.push_back(line);
+        }
+    }
+
+    if (atlas_files.empty()) {
+        std::cerr << "no atlas files given" << std::endl;
+        return 1;
+    }
+
+    std::vector<uint32_t> thread_counts;
+    if (cmd_option_exists(argv, argv+argc, "-t")) {
+        thread_counts.push_back(atoi(get_cmd_option(argv, argv+argc, "-t")));
+    }
+    else {
+        const uint32_t hardware_threads = std::max(std::thread::hardware_concurrency(), 1u);
+        for (uint32_t num_threads = 1; num_threads < hardware_threads; num_threads *= 2) {
+            thread_counts.push_back(num_threads);
+        }
+        thread_counts.push_back(hardware_threads);
+    }
+
+    std::cout << "atlases: " << atlas_files.size() << ", tiles per run: " << num_tiles << std::endl;
+
+    for (size_t i = 0; i < thread_counts.size(); ++i) {
+        size_t tile_byte_size = 0;
+        double tiles_per_second = run(atlas_files, thread_counts[i], num_tiles, cache_size_in_mb * 1024 * 1024, uint32_t(i + 1), tile_byte_size);
+        std::cout << "loader threads: " << thread_counts[i] << ", " << tiles_per_second << " tiles/s, "
+                  << tiles_per_second * tile_byte_size / (1024.0 * 1024.0) << " MB/s" << std::endl;
+    }
+
+    return 0;
+}
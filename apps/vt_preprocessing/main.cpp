@@ -11,6 +11,7 @@
 #include <lamure/vt/pre/DeltaECalculator.h>
 
 #include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <cstring>
 #include <iostream>
@@ -73,14 +74,14 @@ const char *printPxFormat(Bitmap::PIXEL_FORMAT pxFormat){
 }
 
 int process(const int argc, const char **argv){
-    if(argc != 10){
+    if(argc != 10 && argc != 11){
         std::cout << "Wrong count of parameters." << std::endl;
         std::cout << "Expected parameters:" << std::endl;
         std::cout << "\t<image file> <image pixel format (r, rgb, rgba, jpg)>" << std::endl;
         std::cout << "\t<image width> <image height>" << std::endl;
         std::cout << "\t<tile width> <tile height> <padding>" << std::endl;
         std::cout << "\t<out file (without extension)> <out pixel format (r, rgb, rgba, jpg)>" << std::endl;
-        std::cout << "\t<max memory usage (in GB)>" << std::endl;
+        std::cout << "\t<max memory usage (in GB)> [threads (default: one per hardware thread)]" << std::endl;
 
         return 1;
     }
@@ -178,10 +179,29 @@ int process(const int argc, const char **argv){
     //convert from GB to Byte
     maxMemory *= 1024*1024*1024;
 
+    size_t threadCount = 0;
+
+    if(argc == 11){
+        stream.clear();
+        stream.write(argv[10], std::strlen(argv[10]));
+
+        if (!(stream >> threadCount)) {
+            std::cerr << "Invalid thread count \"" << argv[10] << "\"." << std::endl;
+
+            return 1;
+        }
+    }
+
     Preprocessor pre(argv[0], inPixelFormat, imageWidth, imageHeight);
 
+    pre.setThreadCount(threadCount);
     pre.setOutput(argv[7], outPixelFormat, AtlasFile::LAYOUT::PACKED, tileWidth, tileHeight, padding);
+
+    auto start = std::chrono::high_resolution_clock::now();
     pre.run(maxMemory);
+    auto seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+    std::cout << "Processed " << (imageWidth * imageHeight / 1e6) << " MP in " << seconds << " s (" << (imageWidth * imageHeight / 1e6 / seconds) << " MP/s)." << std::endl;
 
     return 0;
 }
@@ -382,7 +402,7 @@ void benchmarkPreprocessing(const char *folderName, size_t tileWidth, size_t til
     std::string benchmarkFileName = std::string(folderName) + "/benchmark_process.csv";
     std::ofstream benchmarkFile(benchmarkFileName, std::ios::trunc);
 
-    benchmarkFile << "img_width;img_height;img_size_in_byte;tile_width;tile_height;tile_padding;levels;atlas_file_size_in_byte;max_mem_usage;process_time_in_ms;delta_time_in_ms;" << std::endl;
+    benchmarkFile << "img_width;img_height;img_size_in_byte;tile_width;tile_height;tile_padding;levels;atlas_file_size_in_byte;max_mem_usage;process_time_in_ms;megapixels_per_second;delta_time_in_ms;" << std::endl;
 
     for(size_t level = 0; level < levels; ++level){
         size_t imgTileWidth = (1 << level);
@@ -412,8 +432,10 @@ void benchmarkPreprocessing(const char *folderName, size_t tileWidth, size_t til
         delta.calculate(maxMemorySize);
         auto deltaDuration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now() - start);
 
-        std::cout << processDuration.count() << std::endl;
-        benchmarkFile << imgWidth << ";" << imgHeight << ";" << imgFileSize << ";" << tileWidth << ";" << tileHeight << ";" << padding << ";" << (level + 1) << ";" << atlasFileSize << ";" << maxMemorySize << ";" << processDuration.count() << ";" << deltaDuration.count() << ";" << std::endl;
+        double megapixelsPerSecond = imgWidth * imgHeight / 1e3 / std::max<double>(processDuration.count(), 1.0);
+
+        std::cout << processDuration.count() << " ms, " << megapixelsPerSecond << " MP/s" << std::endl;
+        benchmarkFile << imgWidth << ";" << imgHeight << ";" << imgFileSize << ";" << tileWidth << ";" << tileHeight << ";" << padding << ";" << (level + 1) << ";" << atlasFileSize << ";" << maxMemorySize << ";" << processDuration.count() << ";" << megapixelsPerSecond << ";" << deltaDuration.count() << ";" << std::endl;
     }
 
     benchmarkFile.close();
@@ -0,0 +1,167 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <list>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <lamure/vt/TileRequestPriorityQueue.h>
+
+// pushes, reprioritizes and pops synthetic tile requests through the
+// loader queue for a number of pending requests, and through a sorted list
+// that is searched linearly on insert the way the queue used to work.
+
+char* get_cmd_option(char** begin, char** end, const std::string & option) {
+    char** it = std::find(begin, end, option);
+    if (it != end && ++it != end)
+        return *it;
+    return 0;
+}
+
+bool cmd_option_exists(char** begin, char** end, const std::string& option) {
+    return std::find(begin, end, option) != end;
+}
+
+struct sorted_list_queue {
+    std::list<vt::ooc::TileRequest*> requests_;
+
+    void push(vt::ooc::TileRequest* request) {
+        auto it = requests_.begin();
+        while (it != requests_.end() && (*it)->getPriority() < request->getPriority()) {
+            ++it;
+        }
+        requests_.insert(it, request);
+    }
+
+    void set_priority(vt::ooc::TileRequest* request, float priority) {
+        requests_.remove(request);
+        request->setPriority(priority);
+        push(request);
+    }
+
+    vt::ooc::TileRequest* pop() {
+        auto request = requests_.back();
+        requests_.pop_back();
+        return request;
+    }
+};
+
+double measure(const std::function<void()>& kernel) {
+    auto start = std::chrono::high_resolution_clock::now();
+    kernel();
+    return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+void report(const std::string& name, const size_t count, const double seconds) {
+    std::cout << "  " << name << ": " << count / seconds / 1e6 << " M ops/s" << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+
+    if (cmd_option_exists(argv, argv+argc, "-h")) {
+        std::cout << "Usage: " << argv[0] << " <flags>\n" <<
+            "INFO: vt_request_queue_benchmark\n" <<
+            "\t-l: largest number of pending requests the sorted list is measured for (default: 20000)\n" <<
+            "\t-u: fraction of requests that are requested again with a higher priority (default: 0.25)\n" <<
+            std::endl;
+        return 0;
+    }
+
+    size_t max_list_size = 20000;
+    float update_fraction = 0.25f;
+
+    if (cmd_option_exists(argv, argv+argc, "-l")) max_list_size = atol(get_cmd_option(argv, argv+argc, "-l"));
+    if (cmd_option_exists(argv, argv+argc, "-u")) update_fraction = atof(get_cmd_option(argv, argv+argc, "-u"));
+
+    for (size_t num_requests : {10000, 100000, 1000000}) {
+        std::mt19937 rng(42);
+        std::uniform_real_distribution<float> priority(0.f, 1000.f);
+
+        std::vector<vt::ooc::TileRequest> requests(num_requests);
+        std::vector<float> priorities(num_requests);
+        for (size_t i = 0; i < num_requests; ++i) {
+            requests[i].setId(i);
+            priorities[i] = priority(rng);
+        }
+
+        const size_t num_updates = size_t(update_fraction * num_requests);
+        std::vector<size_t> updated(num_updates);
+        std::uniform_int_distribution<size_t> request_dist(0, num_requests - 1);
+        for (auto& i : updated) {
+            i = request_dist(rng);
+        }
+
+        std::cout << num_requests << " pending requests" << std::endl;
+
+        {
+            vt::TileRequestPriorityQueue<float> queue;
+            for (size_t i = 0; i < num_requests; ++i) {
+                requests[i].setPriority(priorities[i]);
+            }
+
+            report("heap, push", num_requests, measure([&] {
+                for (auto& request : requests) {
+                    vt::ooc::TileRequest* req = &request;
+                    queue.push(req);
+                }
+            }));
+            report("heap, priority update", num_updates, measure([&] {
+                for (size_t i : updated) {
+                    queue.setPriority(&requests[i], requests[i].getPriority() + 500.f);
+                }
+            }));
+
+            float previous = std::numeric_limits<float>::max();
+            bool ordered = true;
+            report("heap, pop", num_requests, measure([&] {
+                vt::ooc::TileRequest* req;
+                while (queue.pop(req, std::chrono::milliseconds::zero())) {
+                    ordered &= req->getPriority() <= previous;
+                    previous = req->getPriority();
+                }
+            }));
+            if (!ordered) {
+                std::cerr << "  heap popped requests out of order" << std::endl;
+                return 1;
+            }
+        }
+
+        if (num_requests > max_list_size) {
+            continue;
+        }
+
+        {
+            sorted_list_queue queue;
+            for (size_t i = 0; i < num_requests; ++i) {
+                requests[i].setPriority(priorities[i]);
+            }
+
+            report("sorted list, push", num_requests, measure([&] {
+                for (auto& request : requests) {
+                    queue.push(&request);
+                }
+            }));
+            report("sorted list, priority update", num_updates, measure([&] {
+                for (size_t i : updated) {
+                    queue.set_priority(&requests[i], requests[i].getPriority() + 500.f);
+                }
+            }));
+            report("sorted list, pop", num_requests, measure([&] {
+                while (!queue.requests_.empty()) {
+                    queue.pop();
+                }
+            }));
+        }
+    }
+
+    return 0;
+}
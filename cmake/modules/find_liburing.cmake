@@ -0,0 +1,42 @@
+##############################################################################
+# search paths
+##############################################################################
+SET(LIBURING_INCLUDE_SEARCH_DIRS
+    ${GLOBAL_EXT_DIR}/liburing/include
+    /usr/include
+    /usr/local/include
+)
+
+SET(LIBURING_LIBRARY_SEARCH_DIRS
+    ${GLOBAL_EXT_DIR}/liburing/lib
+    /usr/lib
+    /usr/local/lib
+)
+
+##############################################################################
+# search include and library
+##############################################################################
+#  LIBURING_FOUND - System has liburing
+#  LIBURING_INCLUDE_DIR - The liburing include directory
+#  LIBURING_LIBRARY - The library needed to use liburing
+
+find_path(LIBURING_INCLUDE_DIR
+          NAMES liburing.h
+          PATHS ${LIBURING_INCLUDE_SEARCH_DIRS}
+         )
+
+find_library(LIBURING_LIBRARY
+             NAMES uring
+             PATHS ${LIBURING_LIBRARY_SEARCH_DIRS}
+            )
+
+##############################################################################
+# verify
+##############################################################################
+IF ( NOT LIBURING_INCLUDE_DIR OR NOT LIBURING_LIBRARY )
+    SET(LIBURING_FOUND FALSE)
+    MESSAGE(STATUS "--  liburing not found, out-of-core loading falls back to threaded reads")
+ELSE ( NOT LIBURING_INCLUDE_DIR OR NOT LIBURING_LIBRARY )
+    SET(LIBURING_FOUND TRUE)
+    MESSAGE(STATUS "--  found liburing")
+ENDIF ( NOT LIBURING_INCLUDE_DIR OR NOT LIBURING_LIBRARY )
@@ -70,8 +70,40 @@ public:
                                const uint8_t fan_factor,
                                const size_t memory_limit);
 */
+
+    /**
+    * Out-of-core counterpart of sort_and_split. Instead of sorting, the
+    * surfels of sa are partitioned into fan_factor equally sized children
+    * along split_axis with a few streaming passes: splitters are sampled,
+    * surfels are scattered into buckets in target with buffered sequential
+    * writes and only the buckets containing a child boundary are resolved
+    * in memory. target and scratch must cover the same range as sa in
+    * other files; scratch is only used if a boundary bucket does not fit
+    * into memory_limit. The children in out refer to target.
+    */
+    static void partition_and_split(const surfel_disk_array &sa,
+                                    splitted_array<surfel_disk_array> &out,
+                                    const surfel_disk_array &target,
+                                    const surfel_disk_array &scratch,
+                                    const bounding_box &box,
+                                    const uint8_t split_axis,
+                                    const uint8_t fan_factor,
+                                    const size_t memory_limit,
+                                    const size_t buffer_size);
+
 private:
 
+    // moves the surfels of source to target such that every surfel before
+    // each of the given ranks is not greater along split_axis than any
+    // surfel after it. returns the split plane for each rank.
+    static std::vector<real> partition_at_ranks(const surfel_disk_array &source,
+                                                const surfel_disk_array &target,
+                                                const surfel_disk_array &scratch,
+                                                const uint8_t split_axis,
+                                                const std::vector<size_t> &ranks,
+                                                const size_t memory_limit,
+                                                const size_t buffer_size);
+
     template<class T>
     static void split_surfel_array(T &sa,
                                    splitted_array<T> &out,
@@ -79,6 +111,12 @@ private:
                                    const uint8_t split_axis,
                                    const uint8_t fan_factor);
 
+    template<class T>
+    static void compute_child_boxes(splitted_array<T> &out,
+                                    const std::vector<real> &splits,
+                                    const bounding_box &box,
+                                    const uint8_t split_axis);
+
 };
 
 }
@@ -49,6 +49,7 @@ public:
         bool translate_to_origin;
         uint16_t number_of_outlier_neighbours;
         float outlier_ratio;
+        file_backend io_backend = file_backend::stream;
 
         rep_radius_algorithm rep_radius_algo;
         reduction_algorithm reduction_algo;
@@ -95,6 +95,19 @@ class PREPROCESSING_DLL bvh
 
     std::vector<std::pair<surfel_id_t, real>> get_nearest_neighbours(const surfel_id_t target_surfel, const uint32_t num_neighbours, const bool do_local_search = false) const;
 
+    /**
+     * Get the nearest neighbours of every surfel in a node at once.
+     *
+     * Equivalent to calling get_nearest_neighbours for each surfel of the node, but
+     * the node's kd-tree and the query scratch are shared by all queries.
+     *
+     * \param[in] node_id         In-core node to query
+     * \param[in] num_neighbours  Number of neighbours per surfel
+     * \param[out] neighbours     One neighbour list per surfel of the node
+     */
+    void get_nearest_neighbours_batch(const node_id_type node_id, const uint32_t num_neighbours, std::vector<std::vector<std::pair<surfel_id_t, real>>> &neighbours,
+                                      const bool do_local_search = false) const;
+
     std::vector<std::pair<surfel_id_t, real>> get_nearest_neighbours_in_nodes(const surfel_id_t target_surfel, const std::vector<node_id_type> &target_nodes, const uint32_t num_neighbours) const;
 
     std::vector<std::pair<surfel_id_t, real>> get_natural_neighbours(const surfel_id_t &target_surfel, std::vector<std::pair<surfel_id_t, real>> const &nearest_neighbours) const;
@@ -150,6 +163,12 @@ class PREPROCESSING_DLL bvh
     void spawn_compute_bounding_boxes_downsweep_jobs(const uint32_t slice_left, const uint32_t slice_right);
     void spawn_compute_bounding_boxes_upsweep_jobs(const uint32_t first_node_of_level, const uint32_t last_node_of_level, const int32_t level);
     void spawn_split_node_jobs(size_t &slice_left, size_t &slice_right, size_t &new_slice_left, size_t &new_slice_right, const uint32_t level);
+    void spawn_partition_node_jobs(const size_t slice_left, const size_t slice_right, const uint32_t level, const surfel_disk_array &target, const surfel_disk_array &scratch);
+
+    void create_node_lod(const uint32_t node_index, const reduction_strategy &reduction_strgy, const bool do_resample, const bool unload_children);
+    void compute_node_attributes(const uint32_t node_index, const normal_computation_strategy &normal_strategy, const radius_computation_strategy &radius_strategy,
+                                 const bool is_leaf_level, bool compute_normals, bool compute_radii);
+    void compute_node_bounding_box(const uint32_t node_index, const int32_t level);
 
     void thread_remove_outlier_jobs(const uint32_t start_marker, const uint32_t end_marker, const uint32_t num_outliers, const uint16_t num_neighbours,
                                     std::vector<std::pair<surfel_id_t, real>> &intermediate_outliers_for_thread);
@@ -160,6 +179,8 @@ class PREPROCESSING_DLL bvh
     void thread_compute_bounding_boxes_upsweep(const uint32_t start_marker, const uint32_t end_marker, const bool update_percentage, const int32_t level, const uint32_t num_threads);
     void thread_split_node_jobs(size_t &slice_left, size_t &slice_right, size_t &new_slice_left, size_t &new_slice_right, const bool update_percentage, const int32_t level,
                                 const uint32_t num_threads);
+    void thread_partition_node_jobs(const size_t slice_left, const size_t slice_right, const uint32_t level, const surfel_disk_array &target, const surfel_disk_array &scratch,
+                                    const size_t memory_limit);
     void thread_resample(const uint32_t start_marker, const uint32_t end_marker, const bool update_percentage);
 
   private:
@@ -189,6 +210,8 @@ class PREPROCESSING_DLL bvh
 
     vec3r translation_ = vec3r(0.0); ///< translation of surfels
 
+    void collect_nearest_neighbours(const surfel_id_t target_surfel, const surfel_kd_tree &target_tree, const bool do_local_search, knn_heap &heap) const;
+
     void downsweep_subtree_in_core(const bvh_node &node, size_t &disk_leaf_destination, uint32_t &processed_nodes, uint8_t &percent_processed, 
         shared_surfel_file leaf_level_access, shared_prov_file prov_leaf_level_access);
 
@@ -196,6 +219,9 @@ class PREPROCESSING_DLL bvh
     void get_descendant_nodes(const node_id_type node, std::vector<node_id_type> &result, const node_id_type desired_depth, const std::unordered_set<size_t> &excluded_nodes) const;
 
     surfel_mem_array resample_node(uint32_t node_id) const;
+
+    // drops the kd-trees cached by the nodes once a batch phase is finished
+    void release_kd_trees();
 };
 
 using bvh_ptr = std::shared_ptr<bvh>;
@@ -15,6 +15,7 @@
 #include <lamure/pre/surfel_mem_array.h>
 #include <lamure/pre/surfel_disk_array.h>
 #include <lamure/pre/node_statistics.h>
+#include <lamure/pre/surfel_kd_tree.h>
 
 #include <typeinfo>
 #include <iostream>
@@ -98,6 +99,20 @@ public:
     surfel_mem_array &mem_array() { return mem_array_; }
     const surfel_mem_array & mem_array() const { return mem_array_; }
 
+    /**
+     * Returns a kd-tree over the surfel positions of the in-core array.
+     *
+     * The tree is built on first use and cached. It is rebuilt if mem_array_
+     * has been rebound to other surfel data since. Safe to call concurrently.
+     */
+    std::shared_ptr<const surfel_kd_tree> kd_tree() const;
+
+    /**
+     * Drops the cached kd-tree. Trees are not counted in the memory budget,
+     * so they are released when mem_array_ is unloaded or a batch phase ends.
+     */
+    void release_kd_tree() const;
+
     surfel_disk_array &disk_array() { return disk_array_; }
     const surfel_disk_array & disk_array() const { return disk_array_; }
 
@@ -184,6 +199,8 @@ private:
     surfel_mem_array mem_array_;
     surfel_disk_array disk_array_;
 
+    mutable std::shared_ptr<const surfel_kd_tree> kd_tree_;
+
     //prov_mem_array prov_mem_array_;
     //prov_disk_array prov_disk_array_;
 
@@ -31,6 +31,12 @@ enum class radius_computation_algorithm
     natural_neighbours = 1
 };
 
+enum class file_backend
+{
+    stream = 0,
+    mapped = 1
+};
+
 enum class reduction_algorithm
 {
     ndc = 0,
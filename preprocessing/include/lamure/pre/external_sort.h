@@ -9,6 +9,8 @@
 #define PRE_EXTERNAL_SORT_H_
 
 #include <lamure/pre/surfel_disk_array.h>
+#include <deque>
+#include <future>
 #include <vector>
 #include <lamure/pre/logger.h>
 
@@ -21,9 +23,18 @@ class PREPROCESSING_DLL external_sort
 {
 public:
 
+    // wall time of the two phases of the last external sort
+    struct statistics
+    {
+        double run_creation_seconds;
+        double merge_seconds;
+        uint32_t runs_count;
+    };
+
     static void sort(surfel_disk_array &array,
                      const size_t memory_limit,
-                     const surfel::compare_function &compare);
+                     const surfel::compare_function &compare,
+                     statistics *stats = nullptr);
 
 private:
     explicit external_sort(const size_t memory_limit,
@@ -31,56 +42,66 @@ private:
     external_sort(const external_sort &) = delete;
     external_sort &operator=(const external_sort &) = delete;
 
-    class buffer
+    // runs queued file operations on a background thread in order
+    class io_worker;
+
+    // double-buffered sequential reader of one sorted run. the back
+    // buffer is filled by the io_worker while the front one is consumed.
+    class run_reader
     {
     public:
-        surfel_disk_array run;
-        surfel_vector data;
-        size_t size;
-        size_t candidate_pos;
-        size_t file_offset;
-
-        buffer(const surfel_disk_array &array, const size_t buffer_size)
-            : run(array)
-        {
-            size = buffer_size;
-            candidate_pos = size;
-            file_offset = 0;
-            data = surfel_vector(size);
-        }
+        run_reader(const surfel_disk_array &run,
+                   const size_t block_size,
+                   io_worker &worker);
+        ~run_reader();
 
-        bool front(surfel &s)
+        const surfel *head() const
         {
-            invalidate();
-            if (size > 0) {
-                s = data[candidate_pos];
-                return true;
-            }
-            else
-                return false;
+            return candidate_pos_ < front_size_ ? &front_[candidate_pos_] : nullptr;
         }
 
         void pop_front()
         {
-            assert(size > 0);
-            candidate_pos++;
+            assert(candidate_pos_ < front_size_);
+            if (++candidate_pos_ >= front_size_)
+                swap_buffers();
         }
 
     private:
-        void invalidate()
-        {
-            if (size > 0 && candidate_pos >= size) {
-                if (file_offset >= run.length()) {
-                    size = 0;
-                    return;
-                }
-
-                size = std::min(size, run.length() - file_offset);
-                run.get_file()->read(&data, 0, run.offset() + file_offset, size);
-                file_offset += size;
-                candidate_pos = 0;
-            }
-        }
+        void prefetch();
+        void swap_buffers();
+
+        surfel_disk_array run_;
+        io_worker *worker_;
+        size_t block_size_;
+        size_t file_offset_;
+
+        surfel_vector front_;
+        surfel_vector back_;
+        size_t front_size_;
+        size_t back_size_;
+        size_t candidate_pos_;
+        std::shared_future<void> pending_;
+    };
+
+    // tournament tree over the run heads; internal nodes keep the loser
+    // of their match, so replacing the winner costs log2(runs) compares
+    class loser_tree
+    {
+    public:
+        loser_tree(std::deque<run_reader> &readers,
+                   const surfel::compare_function &compare);
+
+        // index of the run holding the smallest head, -1 if all are exhausted
+        int winner() const { return readers_[tree_[0]].head() ? int(tree_[0]) : -1; }
+        void replay(const uint32_t run_id);
+
+    private:
+        bool less(const uint32_t left, const uint32_t right) const;
+
+        std::deque<run_reader> &readers_;
+        const surfel::compare_function &compare_;
+        std::vector<uint32_t> tree_;
     };
 
     void create_runs(surfel_disk_array &array,
@@ -0,0 +1,174 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#ifndef PRE_CHUNKED_READER_H_
+#define PRE_CHUNKED_READER_H_
+
+#include <lamure/pre/platform.h>
+#include <lamure/pre/surfel.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <string>
+
+namespace lamure
+{
+namespace pre
+{
+
+/**
+* Reads a byte range of a file in large blocks that end at a line or record
+* boundary, parses the blocks concurrently on the shared task_scheduler and
+* hands the parsed surfels to the consumer in file order.
+*
+* At most a fixed number of blocks is in flight, and their buffers are
+* reused, so memory use does not depend on the size of the file.
+*/
+class PREPROCESSING_DLL chunked_reader
+{
+public:
+    // parses [begin, end) and appends the surfels to result
+    typedef std::function<void(const char *begin, const char *end, surfel_vector &result)> parse_function;
+    typedef std::function<void(surfel_vector &surfels)> chunk_callback_function;
+
+    explicit chunked_reader(const size_t block_size = 32 * 1024 * 1024);
+
+    // record_size 0 splits blocks after a newline, any other value
+    // splits them at multiples of record_size from begin_offset
+    void read(const std::string &filename,
+              const size_t begin_offset,
+              const size_t end_offset,
+              const size_t record_size,
+              const parse_function &parse,
+              const chunk_callback_function &callback);
+
+    const size_t bytes_read() const { return bytes_read_; }
+    const double seconds() const { return seconds_; }
+
+    // parses a decimal floating point number after leading blanks and
+    // advances cursor past it. numbers of up to 15 significant digits and
+    // small exponents are converted exactly without strtod.
+    static bool parse_real(const char *&cursor, const char *end, real &value);
+    static bool parse_uint(const char *&cursor, const char *end, uint32_t &value);
+
+    // moves cursor behind the next newline
+    static void skip_line(const char *&cursor, const char *end);
+
+private:
+    size_t block_size_;
+    size_t bytes_read_;
+    double seconds_;
+};
+
+inline bool chunked_reader::
+parse_real(const char *&cursor, const char *end, real &value)
+{
+    static const double powers_of_ten[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+    const char *p = cursor;
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) ++p;
+    if (p == end || *p == '\n') {
+        cursor = p;
+        return false;
+    }
+
+    const char *token = p;
+    bool negative = false;
+    if (*p == '-' || *p == '+') {
+        negative = (*p == '-');
+        ++p;
+    }
+
+    uint64_t mantissa = 0;
+    int32_t digits = 0;
+    int32_t exponent = 0;
+    bool any_digit = false;
+
+    for (; p < end && *p >= '0' && *p <= '9'; ++p) {
+        any_digit = true;
+        if (mantissa == 0 && *p == '0') continue;
+        if (digits < 19) { mantissa = mantissa * 10 + uint64_t(*p - '0'); ++digits; }
+        else ++exponent;
+    }
+    if (p < end && *p == '.') {
+        for (++p; p < end && *p >= '0' && *p <= '9'; ++p) {
+            any_digit = true;
+            if (mantissa == 0 && *p == '0') { --exponent; continue; }
+            if (digits < 19) { mantissa = mantissa * 10 + uint64_t(*p - '0'); ++digits; --exponent; }
+        }
+    }
+    if (any_digit && p < end && (*p == 'e' || *p == 'E')) {
+        const char *e = p + 1;
+        bool negative_exponent = false;
+        if (e < end && (*e == '-' || *e == '+')) {
+            negative_exponent = (*e == '-');
+            ++e;
+        }
+        if (e < end && *e >= '0' && *e <= '9') {
+            int32_t explicit_exponent = 0;
+            for (; e < end && *e >= '0' && *e <= '9'; ++e) {
+                if (explicit_exponent < 100000) explicit_exponent = explicit_exponent * 10 + (*e - '0');
+            }
+            exponent += negative_exponent ? -explicit_exponent : explicit_exponent;
+            p = e;
+        }
+    }
+
+    if (any_digit && digits <= 15 && exponent >= -22 && exponent <= 22) {
+        double v = double(mantissa);
+        v = exponent < 0 ? v / powers_of_ten[-exponent] : v * powers_of_ten[exponent];
+        value = negative ? -v : v;
+        cursor = p;
+        return true;
+    }
+
+    // long mantissas, large exponents, nan and inf
+    while (p < end && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n') ++p;
+    const std::string copy(token, p);
+    char *parsed_end = nullptr;
+    value = std::strtod(copy.c_str(), &parsed_end);
+    cursor = p;
+    return parsed_end != copy.c_str();
+}
+
+inline bool chunked_reader::
+parse_uint(const char *&cursor, const char *end, uint32_t &value)
+{
+    const char *p = cursor;
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) ++p;
+    if (p == end || *p < '0' || *p > '9') {
+        cursor = p;
+        return false;
+    }
+
+    uint32_t v = 0;
+    for (; p < end && *p >= '0' && *p <= '9'; ++p) {
+        v = v * 10 + uint32_t(*p - '0');
+    }
+    // tolerate colors written as floating point numbers
+    if (p < end && *p == '.') {
+        for (++p; p < end && *p >= '0' && *p <= '9'; ++p) {}
+    }
+    value = v;
+    cursor = p;
+    return true;
+}
+
+inline void chunked_reader::
+skip_line(const char *&cursor, const char *end)
+{
+    while (cursor < end && *cursor != '\n') ++cursor;
+    if (cursor < end) ++cursor;
+}
+
+} // namespace pre
+} // namespace lamure
+
+#endif // PRE_CHUNKED_READER_H_
@@ -36,7 +36,8 @@ public:
           override_color_(false),
           scale_factor_(1.0),
           new_radius_(0.0),
-          discarded_(0)
+          discarded_(0),
+          chunked_reading_(true)
     {
         surfels_in_buffer_ = buffer_size / sizeof(surfel);
     }
@@ -74,6 +75,10 @@ public:
     void set_surfel_callback(const surfel_modifier_function &callback)
     { surfel_callback_ = callback; }
 
+    // parse the input in parallel blocks if the input format supports it
+    void set_chunked_reading(const bool chunked_reading)
+    { chunked_reading_ = chunked_reading; }
+
 private:
 
     bool flush_ready_ = false;
@@ -83,6 +88,7 @@ private:
     std::condition_variable cv_;
 
     void append_surfel(const surfel &surfel);
+    void append_surfels(const surfel_vector &surfels);
     void flush_buffer();
     const bool is_degenerate(const surfel &s) const;
 
@@ -101,6 +107,7 @@ private:
     real new_radius_;
     vec3b new_color_;
     size_t discarded_;
+    bool chunked_reading_;
 
 };
 
@@ -9,10 +9,13 @@
 #define PRE_FILE_H_
 
 #include <lamure/pre/platform.h>
+#include <lamure/pre/common.h>
 #include <lamure/pre/surfel.h>
 #include <lamure/pre/prov.h>
 
+#include <atomic>
 #include <mutex>
+#include <shared_mutex>
 #include <fstream>
 #include <vector>
 #include <string>
@@ -21,6 +24,13 @@
 namespace lamure {
 namespace pre {
 
+// backend used by files opened afterwards. the mapped backend reads through
+// mmap and writes with pwrite, so accesses to disjoint ranges of one file do
+// not serialize. it is only available on POSIX systems; elsewhere files
+// always use the stream backend.
+PREPROCESSING_DLL void set_default_file_backend(const file_backend backend);
+PREPROCESSING_DLL file_backend default_file_backend();
+
 template<typename T>
 class PREPROCESSING_DLL file
 {
@@ -61,9 +71,24 @@ private:
     mutable std::fstream stream_;
     std::string file_name_;
 
+    file_backend backend_ = file_backend::stream;
+
+    // mapped backend
+    static const size_t max_io_bytes = 64 * 1024 * 1024;
+    int fd_ = -1;
+    std::atomic<size_t> size_in_bytes_{0};
+    mutable std::shared_timed_mutex mapping_mutex_;
+    mutable char *mapping_ = nullptr;
+    mutable size_t mapped_bytes_ = 0;
+
     void write_data(char *data, const size_t offset_in_file, const size_t length);
     void read_data(char *data, const size_t offset_in_file, const size_t length) const;
 
+#ifndef _WIN32
+    const bool write_at(const char *data, const size_t offset_in_bytes, const size_t bytes);
+    void remap() const;
+#endif
+
 };
 
 } // namespace pre
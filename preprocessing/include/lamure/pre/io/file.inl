@@ -5,10 +5,18 @@
 // Faculty of Media, Bauhaus-Universitaet Weimar
 // http://www.uni-weimar.de/medien/vr
 
+#include <algorithm>
 #include <stdexcept>
 #include <cstdio>
 #include <cstring>
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 #include <lamure/pre/logger.h>
 
 namespace lamure {
@@ -237,6 +245,26 @@ open(const std::string &file_name, const bool truncate)
     }
 
     file_name_ = file_name;
+    backend_ = default_file_backend();
+
+    if (backend_ == file_backend::mapped) {
+        int flags = O_RDWR;
+        if (truncate)
+            flags |= O_CREAT | O_TRUNC;
+
+        fd_ = ::open(file_name_.c_str(), flags, 0644);
+        if (fd_ < 0) {
+            LOGGER_ERROR("Failed to open file: \"" << file_name_ <<
+                                                   "\". " << strerror(errno));
+            return;
+        }
+
+        struct stat file_stat;
+        fstat(fd_, &file_stat);
+        size_in_bytes_ = size_t(file_stat.st_size);
+        return;
+    }
+
     std::ios::openmode mode = std::ios::in |
         std::ios::out |
         std::ios::binary;
@@ -258,13 +286,28 @@ void file<T>::
 close(const bool remove)
 {
     if (is_open()) {
-        stream_.flush();
-        stream_.close();
-        if (stream_.fail()) {
-            LOGGER_ERROR("Failed to close file: \"" << file_name_ <<
-                                                    "\". " << strerror(errno));
+        if (backend_ == file_backend::mapped) {
+            if (mapping_ != nullptr) {
+                munmap(mapping_, mapped_bytes_);
+                mapping_ = nullptr;
+                mapped_bytes_ = 0;
+            }
+            if (::close(fd_)) {
+                LOGGER_ERROR("Failed to close file: \"" << file_name_ <<
+                                                        "\". " << strerror(errno));
+            }
+            fd_ = -1;
+            size_in_bytes_ = 0;
+        }
+        else {
+            stream_.flush();
+            stream_.close();
+            if (stream_.fail()) {
+                LOGGER_ERROR("Failed to close file: \"" << file_name_ <<
+                                                        "\". " << strerror(errno));
+            }
+            stream_.exceptions(std::ifstream::failbit);
         }
-        stream_.exceptions(std::ifstream::failbit);
 
         if (remove)
             if (std::remove(file_name_.c_str())) {
@@ -279,6 +322,8 @@ template<typename T>
 const bool file<T>::
 is_open() const
 {
+    if (backend_ == file_backend::mapped)
+        return fd_ >= 0;
     return stream_.is_open();
 }
 
@@ -286,9 +331,13 @@ template<typename T>
 const size_t file<T>::
 get_size() const
 {
+    assert(is_open());
+
+    if (backend_ == file_backend::mapped)
+        return size_in_bytes_ / sizeof(T);
+
     std::lock_guard<std::mutex> lock(read_write_mutex_);
 
-    assert(is_open());
     stream_.seekg(0, stream_.end);
     size_t len = stream_.tellg();
     stream_.seekg(0, stream_.beg);
@@ -306,12 +355,25 @@ append(const std::vector<T> *data,
        const size_t offset_in_mem,
        const size_t length)
 {
-    std::lock_guard<std::mutex> lock(read_write_mutex_);
-
     assert(is_open());
     assert(length > 0);
     assert(offset_in_mem + length <= data->size());
 
+    if (backend_ == file_backend::mapped) {
+        // reserving the range is the only serialized step, so concurrent
+        // appends write their data in parallel
+        const size_t bytes = length * sizeof(T);
+        const size_t offset_in_bytes = size_in_bytes_.fetch_add(bytes);
+        if (!write_at(reinterpret_cast<const char *>(&(*data)[offset_in_mem]), offset_in_bytes, bytes)) {
+            LOGGER_ERROR("append failed. file: \"" << file_name_ <<
+                                                   "\". (mem offset: " << offset_in_mem <<
+                                                   ", len: " << length << "). " << strerror(errno));
+        }
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(read_write_mutex_);
+
     stream_.seekp(0, stream_.end);
     stream_.write(reinterpret_cast<char *>(
                       const_cast<T *>(&(*data)[offset_in_mem])),
@@ -384,6 +446,22 @@ write_data(char *data, const size_t offset_in_file, const size_t length)
 {
     assert(is_open());
 
+    if (backend_ == file_backend::mapped) {
+        const size_t offset_in_bytes = offset_in_file * sizeof(T);
+        const size_t bytes = length * sizeof(T);
+        if (!write_at(data, offset_in_bytes, bytes)) {
+            LOGGER_ERROR("write failed. file: \"" << file_name_ <<
+                                                  "\". (offset: " << offset_in_file <<
+                                                  ", len: " << length << "). " << strerror(errno));
+            return;
+        }
+
+        size_t size = size_in_bytes_.load();
+        while (size < offset_in_bytes + bytes &&
+               !size_in_bytes_.compare_exchange_weak(size, offset_in_bytes + bytes)) {}
+        return;
+    }
+
     std::lock_guard<std::mutex> lock(read_write_mutex_);
     stream_.seekp(offset_in_file * sizeof(T));
     stream_.write(data, length * sizeof(T));
@@ -402,6 +480,33 @@ read_data(char *data, const size_t offset_in_file, const size_t length) const
 {
     assert(is_open());
 
+    if (backend_ == file_backend::mapped) {
+        const size_t offset_in_bytes = offset_in_file * sizeof(T);
+        const size_t bytes = length * sizeof(T);
+
+        {
+            std::shared_lock<std::shared_timed_mutex> lock(mapping_mutex_);
+            if (offset_in_bytes + bytes <= mapped_bytes_) {
+                memcpy(data, mapping_ + offset_in_bytes, bytes);
+                return;
+            }
+        }
+
+        // the file has grown past the mapping since it was created
+        std::unique_lock<std::shared_timed_mutex> lock(mapping_mutex_);
+        if (offset_in_bytes + bytes > mapped_bytes_) {
+            remap();
+        }
+        if (offset_in_bytes + bytes > mapped_bytes_) {
+            LOGGER_ERROR("read failed. file: \"" << file_name_ <<
+                                                 "\". (offset: " << offset_in_file <<
+                                                 ", len: " << length << "). read past the end of the file");
+            return;
+        }
+        memcpy(data, mapping_ + offset_in_bytes, bytes);
+        return;
+    }
+
     std::lock_guard<std::mutex> lock(read_write_mutex_);
     stream_.seekg(offset_in_file * sizeof(T));
     stream_.read(data, length * sizeof(T));
@@ -413,6 +518,53 @@ read_data(char *data, const size_t offset_in_file, const size_t length) const
     }
     stream_.exceptions(std::ifstream::failbit | std::ifstream::badbit);
 }
+
+template<typename T>
+const bool file<T>::
+write_at(const char *data, const size_t offset_in_bytes, const size_t bytes)
+{
+    // large writes go out in few system calls, but pwrite may still
+    // return early
+    size_t written = 0;
+    while (written < bytes) {
+        const ssize_t result = pwrite(fd_, data + written,
+                                      std::min(bytes - written, max_io_bytes),
+                                      off_t(offset_in_bytes + written));
+        if (result < 0) {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+        written += size_t(result);
+    }
+    return true;
+}
+
+template<typename T>
+void file<T>::
+remap() const
+{
+    if (mapping_ != nullptr) {
+        munmap(mapping_, mapped_bytes_);
+        mapping_ = nullptr;
+        mapped_bytes_ = 0;
+    }
+
+    // map what is on disk, appends may have reserved more than that
+    struct stat file_stat;
+    if (fstat(fd_, &file_stat) || file_stat.st_size == 0) {
+        return;
+    }
+
+    void *mapping = mmap(nullptr, size_t(file_stat.st_size), PROT_READ, MAP_SHARED, fd_, 0);
+    if (mapping == MAP_FAILED) {
+        LOGGER_ERROR("Failed to map file: \"" << file_name_ <<
+                                              "\". " << strerror(errno));
+        return;
+    }
+    mapping_ = static_cast<char *>(mapping);
+    mapped_bytes_ = size_t(file_stat.st_size);
+}
 #endif
 }
 } // namespace lamure
@@ -29,6 +29,7 @@ public:
     &)>
     surfel_callback_funtion;
     typedef std::function<bool(surfel_vector & )> buffer_callback_function;
+    typedef std::function<void(surfel_vector & )> chunk_callback_function;
 
     explicit format_abstract()
         : has_normals_(false),
@@ -49,6 +50,13 @@ public:
 protected:
 
     virtual void read(const std::string &filename, surfel_callback_funtion callback) = 0;
+
+    // formats whose input splits into independently parsable blocks
+    // override this to parse it in parallel. the surfels arrive in file
+    // order. returns false if the file has to be read with read() instead.
+    virtual bool read_chunks(const std::string &filename, chunk_callback_function callback)
+    { return false; }
+
     virtual void write(const std::string &filename, buffer_callback_function callback) = 0;
 
     bool has_normals_;
@@ -29,6 +29,7 @@ public:
 
 protected:
     virtual void read(const std::string &filename, surfel_callback_funtion callback) override;
+    virtual bool read_chunks(const std::string &filename, chunk_callback_function callback) override;
     virtual void write(const std::string &filename, buffer_callback_function callback) override;
 
 };
@@ -42,6 +42,8 @@ public:
                                 const uint32_t surfels_per_node,
                                 const bvh &tree,
                                 const size_t start_node_id) const override;
+
+    bool queries_neighbourhood() const override { return true; }
 private:
 
     real
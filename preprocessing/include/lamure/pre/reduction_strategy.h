@@ -24,6 +24,11 @@ class reduction_strategy
 
     virtual surfel_mem_array create_lod(real &reduction_error, const std::vector<surfel_mem_array *> &input, const uint32_t surfels_per_node, const bvh &tree, const size_t start_node_id) const = 0;
 
+    // true if create_lod queries nodes other than the input children, e.g.
+    // through nearest neighbour searches. such strategies only run once the
+    // whole child level is finished.
+    virtual bool queries_neighbourhood() const { return false; }
+
     void interpolate_approx_natural_neighbours(surfel &surfel_to_update, std::vector<surfel> const &input_surfels, const bvh &tree, size_t const num_nearest_neighbours = 24) const;
 };
 
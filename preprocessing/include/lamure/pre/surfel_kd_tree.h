@@ -0,0 +1,117 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#ifndef PRE_SURFEL_KD_TREE_H_
+#define PRE_SURFEL_KD_TREE_H_
+
+#include <lamure/pre/platform.h>
+#include <lamure/types.h>
+#include <lamure/pre/surfel_mem_array.h>
+#include <lamure/pre/surfel_soa.h>
+
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace lamure
+{
+namespace pre
+{
+
+/**
+* Fixed-capacity max-heap on squared distances, used to collect the k
+* nearest neighbours of one query across several kd-trees. The storage
+* is kept between queries, so a heap reused per thread does not allocate.
+*/
+class PREPROCESSING_DLL knn_heap
+{
+public:
+    typedef std::pair<surfel_id_t, real> entry;
+
+    void                reset(const uint32_t capacity);
+
+    const uint32_t      capacity() const { return capacity_; }
+    const size_t        size() const { return entries_.size(); }
+    const bool          full() const { return entries_.size() >= capacity_; }
+
+    // squared distance a candidate has to undercut to be inserted
+    const real          bound() const {
+                            if (capacity_ == 0) return real(0);
+                            return full() ? entries_.front().second : std::numeric_limits<real>::max();
+                        }
+
+    void                push(const surfel_id_t& id, const real distance);
+
+    // writes the neighbours ordered by ascending distance to result and
+    // leaves the heap empty
+    void                extract(std::vector<entry>& result);
+
+private:
+    std::vector<entry>  entries_;
+    uint32_t            capacity_ = 0;
+};
+
+/**
+* Flat, implicitly balanced kd-tree over the surfel positions of one
+* surfel_mem_array. It is built once and is immutable afterwards, so any
+* number of threads may query it concurrently.
+*/
+class PREPROCESSING_DLL surfel_kd_tree
+{
+public:
+                        surfel_kd_tree(const surfel_mem_array& array,
+                                       const uint32_t leaf_size = 16);
+                        surfel_kd_tree(const surfel_kd_tree&) = delete;
+                        surfel_kd_tree& operator=(const surfel_kd_tree&) = delete;
+
+    const size_t        size() const { return x_.size(); }
+
+    // true if the tree was built for exactly this array and the
+    // underlying surfel vector has not been released since. surfels
+    // moved within the same vector are not detected.
+    const bool          is_built_for(const surfel_mem_array& array) const;
+
+    // adds all surfels closer than heap.bound() to heap, labelled with
+    // node_id. the surfel with index excluded_surfel is skipped.
+    void                nearest_neighbours(const vec3r& center,
+                                           const node_id_type node_id,
+                                           const size_t excluded_surfel,
+                                           knn_heap& heap) const;
+
+private:
+    void                build(const uint32_t tree_node,
+                              const size_t first,
+                              const size_t last,
+                              std::vector<size_t>& order,
+                              aligned_vector<real>& scratch,
+                              std::vector<size_t>& index_scratch);
+
+    struct split
+    {
+        real            position_;
+        uint8_t         axis_;
+    };
+
+    std::weak_ptr<std::vector<surfel>> data_;
+    size_t              offset_;
+
+    uint32_t            leaf_size_;
+
+    // position streams and surfel indices, permuted into tree order
+    aligned_vector<real> x_;
+    aligned_vector<real> y_;
+    aligned_vector<real> z_;
+    std::vector<size_t> indices_;
+
+    // split planes of the inner nodes in implicit heap layout
+    std::vector<split>  splits_;
+};
+
+}
+} // namespace lamure
+
+#endif // PRE_SURFEL_KD_TREE_H_
@@ -0,0 +1,77 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#ifndef PRE_SURFEL_KERNELS_H_
+#define PRE_SURFEL_KERNELS_H_
+
+#include <lamure/pre/platform.h>
+#include <lamure/types.h>
+
+namespace lamure
+{
+namespace pre
+{
+
+/**
+* Vectorized loops over structure-of-arrays surfel positions (see
+* surfel_soa). The instruction set is chosen at compile time: AVX-512 if
+* the library is built with LAMURE_ENABLE_AVX512, AVX2 with
+* LAMURE_ENABLE_AVX2, the scalar versions otherwise. The scalar versions
+* are always available as reference.
+*
+* The pointers need not be aligned.
+*/
+namespace surfel_kernels
+{
+
+enum class instruction_set
+{
+    scalar,
+    avx2,
+    avx512
+};
+
+PREPROCESSING_DLL instruction_set active_instruction_set();
+PREPROCESSING_DLL const char*     instruction_set_name(const instruction_set set);
+
+// result[i] = |(x[i], y[i], z[i]) - center|^2
+PREPROCESSING_DLL void squared_distances(const real* x, const real* y, const real* z, const size_t count,
+                                         const vec3r& center, real* result);
+
+// expands min and max by the positions
+PREPROCESSING_DLL void bounding_box(const real* x, const real* y, const real* z, const size_t count,
+                                    vec3r& min, vec3r& max);
+
+PREPROCESSING_DLL vec3r sum(const real* x, const real* y, const real* z, const size_t count);
+
+// accumulates the upper triangle of the scatter matrix around center into
+// result: xx, xy, xz, yy, yz, zz
+PREPROCESSING_DLL void accumulate_covariance(const real* x, const real* y, const real* z, const size_t count,
+                                             const vec3r& center, real* result);
+
+namespace scalar
+{
+
+PREPROCESSING_DLL void squared_distances(const real* x, const real* y, const real* z, const size_t count,
+                                         const vec3r& center, real* result);
+
+PREPROCESSING_DLL void bounding_box(const real* x, const real* y, const real* z, const size_t count,
+                                    vec3r& min, vec3r& max);
+
+PREPROCESSING_DLL vec3r sum(const real* x, const real* y, const real* z, const size_t count);
+
+PREPROCESSING_DLL void accumulate_covariance(const real* x, const real* y, const real* z, const size_t count,
+                                             const vec3r& center, real* result);
+
+}
+
+}
+
+}
+} // namespace lamure
+
+#endif // PRE_SURFEL_KERNELS_H_
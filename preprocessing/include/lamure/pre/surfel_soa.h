@@ -0,0 +1,119 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#ifndef PRE_SURFEL_SOA_H_
+#define PRE_SURFEL_SOA_H_
+
+#include <lamure/pre/platform.h>
+#include <lamure/types.h>
+#include <lamure/pre/surfel_mem_array.h>
+
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#ifdef _MSC_VER
+#include <malloc.h>
+#endif
+
+namespace lamure
+{
+namespace pre
+{
+
+/**
+* Allocator returning storage aligned to one cache line, which is also the
+* width of the widest vector registers the surfel kernels use.
+*/
+template<typename T>
+class aligned_allocator
+{
+public:
+    typedef T value_type;
+
+    static const size_t alignment = 64;
+
+    aligned_allocator() {}
+    template<typename U>
+    aligned_allocator(const aligned_allocator<U>&) {}
+
+    T*                  allocate(const size_t n) {
+                            if (n == 0) return nullptr;
+                            const size_t bytes = ((n * sizeof(T) + alignment - 1) / alignment) * alignment;
+#ifdef _MSC_VER
+                            void* p = _aligned_malloc(bytes, alignment);
+#else
+                            void* p = aligned_alloc(alignment, bytes);
+#endif
+                            if (!p) throw std::bad_alloc();
+                            return static_cast<T*>(p);
+                        }
+
+    void                deallocate(T* p, const size_t) {
+#ifdef _MSC_VER
+                            _aligned_free(p);
+#else
+                            free(p);
+#endif
+                        }
+
+    template<typename U>
+    bool                operator==(const aligned_allocator<U>&) const { return true; }
+    template<typename U>
+    bool                operator!=(const aligned_allocator<U>&) const { return false; }
+};
+
+template<typename T>
+using aligned_vector = std::vector<T, aligned_allocator<T>>;
+
+/**
+* Structure-of-arrays copy of surfels. Every attribute lives in its own
+* aligned stream, so loops that only need positions do not pull colors
+* and normals into the cache and can be vectorized over several surfels.
+*/
+class PREPROCESSING_DLL surfel_soa
+{
+public:
+                        surfel_soa() {}
+    explicit            surfel_soa(const surfel_mem_array& array);
+
+    void                assign(const surfel_mem_array& array);
+    void                reserve(const size_t capacity);
+    void                clear();
+
+    void                push_back(const surfel& s);
+    void                push_back(const vec3r& position);
+
+    const size_t        size() const { return x_.size(); }
+    const bool          empty() const { return x_.empty(); }
+
+    const real*         x() const { return x_.data(); }
+    const real*         y() const { return y_.data(); }
+    const real*         z() const { return z_.data(); }
+    const real*         radius() const { return radius_.data(); }
+    const float*        normal_x() const { return normal_x_.data(); }
+    const float*        normal_y() const { return normal_y_.data(); }
+    const float*        normal_z() const { return normal_z_.data(); }
+
+    const vec3r         position(const size_t index) const {
+                            return vec3r(x_[index], y_[index], z_[index]);
+                        }
+
+private:
+    aligned_vector<real>  x_;
+    aligned_vector<real>  y_;
+    aligned_vector<real>  z_;
+    aligned_vector<real>  radius_;
+    aligned_vector<float> normal_x_;
+    aligned_vector<float> normal_y_;
+    aligned_vector<float> normal_z_;
+};
+
+}
+} // namespace lamure
+
+#endif // PRE_SURFEL_SOA_H_
@@ -0,0 +1,109 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#ifndef PRE_TASK_SCHEDULER_H_
+#define PRE_TASK_SCHEDULER_H_
+
+#include <lamure/pre/platform.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace lamure
+{
+namespace pre
+{
+
+/**
+* Pool of worker threads with one task deque per worker. A worker runs the
+* newest task of its own deque first and steals the oldest task of another
+* worker when it runs dry. Tasks may submit further tasks, which is how
+* dependency graphs are expressed: the task completing the last dependency
+* of another task submits it.
+*
+* Every task carries a label. Run times are accumulated per label.
+*/
+class PREPROCESSING_DLL task_scheduler
+{
+public:
+    typedef std::function<void()> task;
+
+    struct task_statistics
+    {
+        size_t          num_tasks_;
+        double          total_seconds_;
+        double          max_seconds_;
+    };
+
+    explicit            task_scheduler(const uint32_t num_threads = std::thread::hardware_concurrency());
+                        task_scheduler(const task_scheduler&) = delete;
+                        task_scheduler& operator=(const task_scheduler&) = delete;
+    virtual             ~task_scheduler();
+
+    // pool shared by the preprocessing library
+    static task_scheduler& shared();
+
+    const uint32_t      num_threads() const { return uint32_t(workers_.size()); }
+
+    // label must outlive the scheduler, e.g. a string literal
+    void                submit(const char* label, task t);
+
+    // blocks until all submitted tasks, including the ones submitted by
+    // tasks, have completed. rethrows the first exception thrown by a task.
+    // must not be called from a task.
+    void                wait();
+
+    std::map<std::string, task_statistics> statistics() const;
+    void                reset_statistics();
+
+private:
+    struct entry
+    {
+        const char*     label_;
+        task            task_;
+    };
+
+    struct worker
+    {
+        std::mutex      mutex_;
+        std::deque<entry> tasks_;
+        std::thread     thread_;
+    };
+
+    void                run(const uint32_t worker_id);
+    bool                pop(const uint32_t worker_id, entry& e);
+    void                execute(entry& e);
+
+    std::vector<std::unique_ptr<worker>> workers_;
+
+    std::mutex          signal_mutex_;
+    std::condition_variable work_signal_;
+    std::condition_variable done_signal_;
+    size_t              num_queued_;
+    size_t              num_pending_;
+    bool                shutdown_;
+    std::atomic<uint32_t> next_worker_;
+
+    std::exception_ptr  exception_;
+
+    mutable std::mutex  statistics_mutex_;
+    std::map<std::string, task_statistics> statistics_;
+};
+
+}
+} // namespace lamure
+
+#endif // PRE_TASK_SCHEDULER_H_
@@ -17,11 +17,63 @@
 #endif
 
 #include <cstring>
+#include <map>
+#include <random>
 
 namespace lamure {
 namespace pre 
 {
 
+namespace {
+
+inline real split_key(const surfel& s, const uint8_t axis) { return s.pos()[axis]; }
+inline real split_key(const surfel_ext& s, const uint8_t axis) { return s.surfel_.pos()[axis]; }
+
+template <class T>
+std::vector<real> select_in_core(std::vector<T>& elements,
+                                 const std::vector<size_t>& ranks,
+                                 const uint8_t axis)
+{
+    auto compare = [axis](const T& left, const T& right) {
+        return split_key(left, axis) < split_key(right, axis);
+    };
+
+    std::vector<real> splits;
+    size_t first = 0;
+    for (const size_t rank : ranks) {
+        std::nth_element(elements.begin() + first, elements.begin() + rank, elements.end(), compare);
+        real p0 = split_key(*std::max_element(elements.begin(), elements.begin() + rank, compare), axis);
+        real p1 = split_key(elements[rank], axis);
+        splits.push_back((p1 - p0) / 2.0 + p0);
+        first = rank;
+    }
+    return splits;
+}
+
+void copy_disk_array(const surfel_disk_array& source,
+                     const surfel_disk_array& target,
+                     const size_t surfels_in_buffer)
+{
+    surfel_vector surfels;
+    prov_vector provs;
+
+    for (size_t i = 0; i < source.length(); i += surfels_in_buffer) {
+        const size_t len = std::min(surfels_in_buffer, source.length() - i);
+
+        surfels.resize(len);
+        source.get_file()->read(&surfels, 0, source.offset() + i, len);
+        target.get_file()->write(&surfels, 0, target.offset() + i, len);
+
+        if (source.has_provenance()) {
+            provs.resize(len);
+            source.get_prov_file()->read(&provs, 0, source.offset() + i, len);
+            target.get_prov_file()->write(&provs, 0, target.offset() + i, len);
+        }
+    }
+}
+
+}
+
 bounding_box basic_algorithms::
 compute_aabb(const surfel_mem_array& sa,
             const bool parallelize)
@@ -317,6 +369,16 @@ split_surfel_array(T& sa,
         splits.push_back((p1 - p0) / 2.0 + p0);
     }
 
+    compute_child_boxes<T>(out, splits, box, split_axis);
+}
+
+template <class T>
+void basic_algorithms::
+compute_child_boxes(splitted_array<T>& out,
+                    const std::vector<real>& splits,
+                    const bounding_box& box,
+                    const uint8_t split_axis)
+{
     for (size_t i = 0; i < out.size(); ++i) {
         vec3r child_max = box.max();
         vec3r child_min = box.min();
@@ -336,6 +398,270 @@ split_surfel_array(T& sa,
     }
 }
 
+void basic_algorithms::
+partition_and_split(const surfel_disk_array& sa,
+                    splitted_array<surfel_disk_array>& out,
+                    const surfel_disk_array& target,
+                    const surfel_disk_array& scratch,
+                    const bounding_box& box,
+                    const uint8_t split_axis,
+                    const uint8_t fan_factor,
+                    const size_t memory_limit,
+                    const size_t buffer_size)
+{
+    assert(!sa.is_empty());
+    assert(sa.length() >= fan_factor);
+    assert(target.offset() == sa.offset() && target.length() == sa.length());
+    assert(scratch.offset() == sa.offset() && scratch.length() == sa.length());
+
+    // same child sizes as split_surfel_array
+    const size_t child_size = sa.length() / fan_factor;
+    size_t remainder = sa.length() % fan_factor;
+
+    std::vector<size_t> ranks;
+    size_t child_first = 0;
+
+    for (uint32_t i = 0; i < fan_factor; ++i) {
+        size_t child_length = child_size;
+        if (remainder > 0) {
+            ++child_length;
+            --remainder;
+        }
+
+        out.push_back(std::make_pair(surfel_disk_array(target, target.offset() + child_first, child_length), bounding_box()));
+
+        child_first += child_length;
+        if (i < fan_factor - 1u)
+            ranks.push_back(child_first);
+    }
+
+    const std::vector<real> splits = partition_at_ranks(sa, target, scratch, split_axis, ranks, memory_limit, buffer_size);
+
+    compute_child_boxes<surfel_disk_array>(out, splits, box, split_axis);
+}
+
+std::vector<real> basic_algorithms::
+partition_at_ranks(const surfel_disk_array& source,
+                   const surfel_disk_array& target,
+                   const surfel_disk_array& scratch,
+                   const uint8_t split_axis,
+                   const std::vector<size_t>& ranks,
+                   const size_t memory_limit,
+                   const size_t buffer_size)
+{
+    assert(!ranks.empty());
+
+    const bool provenance = source.has_provenance();
+    const size_t length = source.length();
+    const size_t element_size = sizeof(surfel) + (provenance ? sizeof(prov_data) : 0);
+    // provenance is selected as surfel_ext, which needs a second copy
+    const size_t in_core_element_size = element_size * (provenance ? 2 : 1);
+    const size_t surfels_in_buffer = std::max<size_t>(1, buffer_size / element_size);
+
+    // the range fits into memory: select directly. source and target
+    // may be the same array here since everything is read before writing.
+    if (length * in_core_element_size <= memory_limit) {
+        surfel_vector surfels(length);
+        source.get_file()->read(&surfels, 0, source.offset(), length);
+
+        if (!provenance) {
+            std::vector<real> splits = select_in_core(surfels, ranks, split_axis);
+            target.get_file()->write(&surfels, 0, target.offset(), length);
+            return splits;
+        }
+
+        prov_vector provs(length);
+        source.get_prov_file()->read(&provs, 0, source.offset(), length);
+
+        std::vector<surfel_ext> elements(length);
+        for (size_t i = 0; i < length; ++i) {
+            elements[i].surfel_ = surfels[i];
+            elements[i].prov_ = provs[i];
+        }
+
+        std::vector<real> splits = select_in_core(elements, ranks, split_axis);
+
+        for (size_t i = 0; i < length; ++i) {
+            surfels[i] = elements[i].surfel_;
+            provs[i] = elements[i].prov_;
+        }
+        target.get_file()->write(&surfels, 0, target.offset(), length);
+        target.get_prov_file()->write(&provs, 0, target.offset(), length);
+        return splits;
+    }
+
+    // sample splitters from random blocks of the range. the number of
+    // splitters is chosen such that a bucket is expected to take a
+    // quarter of the memory limit at most.
+    const size_t sample_block = std::min<size_t>(64, length);
+    const size_t num_splitters = std::min<size_t>(1024,
+        std::max<size_t>(16 * ranks.size(), 4 * length * in_core_element_size / memory_limit + 1));
+    const size_t num_sample_blocks = std::max<size_t>(1, 16 * num_splitters / sample_block);
+
+    std::vector<real> splitters;
+    {
+        std::mt19937_64 rng(source.offset() + length);
+        std::uniform_int_distribution<size_t> block_offset(0, length - sample_block);
+
+        std::vector<real> samples;
+        samples.reserve(num_sample_blocks * sample_block);
+
+        surfel_vector block(sample_block);
+        for (size_t i = 0; i < num_sample_blocks; ++i) {
+            source.get_file()->read(&block, 0, source.offset() + block_offset(rng), sample_block);
+            for (const auto& s : block) {
+                samples.push_back(split_key(s, split_axis));
+            }
+        }
+        std::sort(samples.begin(), samples.end());
+
+        for (size_t i = 1; i <= num_splitters; ++i) {
+            real splitter = samples[i * samples.size() / (num_splitters + 1)];
+            if (splitters.empty() || splitters.back() < splitter)
+                splitters.push_back(splitter);
+        }
+    }
+
+    // even buckets hold the keys between two splitters, odd buckets the
+    // keys equal to a splitter. the latter never need to be ordered, so
+    // duplicate coordinates cannot blow up a bucket that must be selected.
+    const size_t num_buckets = 2 * splitters.size() + 1;
+    auto classify = [&splitters](const real key) -> size_t {
+        const size_t i = std::lower_bound(splitters.begin(), splitters.end(), key) - splitters.begin();
+        return (i < splitters.size() && splitters[i] == key) ? 2 * i + 1 : 2 * i;
+    };
+
+    // count pass
+    std::vector<size_t> counts(num_buckets, 0);
+    std::vector<real> key_min(num_buckets, std::numeric_limits<real>::max());
+    std::vector<real> key_max(num_buckets, std::numeric_limits<real>::lowest());
+    {
+        surfel_vector surfels;
+        for (size_t i = 0; i < length; i += surfels_in_buffer) {
+            const size_t len = std::min(surfels_in_buffer, length - i);
+            surfels.resize(len);
+            source.get_file()->read(&surfels, 0, source.offset() + i, len);
+
+            for (const auto& s : surfels) {
+                const real key = split_key(s, split_axis);
+                const size_t b = classify(key);
+                ++counts[b];
+                key_min[b] = std::min(key_min[b], key);
+                key_max[b] = std::max(key_max[b], key);
+            }
+        }
+    }
+
+    std::vector<size_t> bucket_begin(num_buckets + 1, 0);
+    for (size_t b = 0; b < num_buckets; ++b) {
+        bucket_begin[b + 1] = bucket_begin[b] + counts[b];
+    }
+
+    // ranks on a bucket edge or inside an equality bucket are settled by
+    // the counts alone, the others are collected per bucket
+    std::vector<real> splits(ranks.size());
+    std::map<size_t, std::vector<size_t>> boundary_ranks;
+
+    for (size_t k = 0; k < ranks.size(); ++k) {
+        const size_t rank = ranks[k];
+        assert(rank > 0 && rank < length);
+
+        const size_t b = std::upper_bound(bucket_begin.begin(), bucket_begin.end(), rank) - bucket_begin.begin() - 1;
+
+        if (rank == bucket_begin[b]) {
+            size_t left = b - 1;
+            while (counts[left] == 0)
+                --left;
+            splits[k] = (key_min[b] - key_max[left]) / 2.0 + key_max[left];
+        }
+        else if (b % 2 == 1) {
+            splits[k] = splitters[b / 2];
+        }
+        else {
+            boundary_ranks[b].push_back(k);
+        }
+    }
+
+    // scatter pass
+    {
+        const size_t bucket_capacity = std::max<size_t>(256, surfels_in_buffer / num_buckets);
+
+        std::vector<surfel_vector> bucket_surfels(num_buckets);
+        std::vector<prov_vector> bucket_provs(provenance ? num_buckets : 0);
+        std::vector<size_t> cursors(num_buckets);
+        for (size_t b = 0; b < num_buckets; ++b) {
+            cursors[b] = target.offset() + bucket_begin[b];
+        }
+
+        auto flush = [&](const size_t b) {
+            const size_t len = bucket_surfels[b].size();
+            if (len == 0)
+                return;
+            target.get_file()->write(&bucket_surfels[b], 0, cursors[b], len);
+            bucket_surfels[b].clear();
+            if (provenance) {
+                target.get_prov_file()->write(&bucket_provs[b], 0, cursors[b], len);
+                bucket_provs[b].clear();
+            }
+            cursors[b] += len;
+        };
+
+        surfel_vector surfels;
+        prov_vector provs;
+        for (size_t i = 0; i < length; i += surfels_in_buffer) {
+            const size_t len = std::min(surfels_in_buffer, length - i);
+            surfels.resize(len);
+            source.get_file()->read(&surfels, 0, source.offset() + i, len);
+            if (provenance) {
+                provs.resize(len);
+                source.get_prov_file()->read(&provs, 0, source.offset() + i, len);
+            }
+
+            for (size_t j = 0; j < len; ++j) {
+                const size_t b = classify(split_key(surfels[j], split_axis));
+                bucket_surfels[b].push_back(surfels[j]);
+                if (provenance)
+                    bucket_provs[b].push_back(provs[j]);
+                if (bucket_surfels[b].size() == bucket_capacity)
+                    flush(b);
+            }
+        }
+
+        for (size_t b = 0; b < num_buckets; ++b) {
+            flush(b);
+        }
+    }
+
+    // select inside the buckets that contain a boundary. a bucket that
+    // does not fit into memory is partitioned again through scratch.
+    for (const auto& boundary : boundary_ranks) {
+        const size_t b = boundary.first;
+
+        std::vector<size_t> local_ranks;
+        for (const size_t k : boundary.second) {
+            local_ranks.push_back(ranks[k] - bucket_begin[b]);
+        }
+
+        const surfel_disk_array bucket(target, target.offset() + bucket_begin[b], counts[b]);
+        const surfel_disk_array bucket_scratch(scratch, scratch.offset() + bucket_begin[b], counts[b]);
+
+        std::vector<real> bucket_splits;
+        if (counts[b] * in_core_element_size <= memory_limit) {
+            bucket_splits = partition_at_ranks(bucket, bucket, bucket_scratch, split_axis, local_ranks, memory_limit, buffer_size);
+        }
+        else {
+            bucket_splits = partition_at_ranks(bucket, bucket_scratch, bucket, split_axis, local_ranks, memory_limit, buffer_size);
+            copy_disk_array(bucket_scratch, bucket, surfels_in_buffer);
+        }
+
+        for (size_t i = 0; i < boundary.second.size(); ++i) {
+            splits[boundary.second[i]] = bucket_splits[i];
+        }
+    }
+
+    return splits;
+}
+
 basic_algorithms::surfel_group_properties basic_algorithms::
 compute_properties(const surfel_mem_array& sa,
                    const rep_radius_algorithm rep_radius_algo,
@@ -19,6 +19,7 @@
 #include <lamure/pre/io/format_ply.h>
 #include <lamure/pre/io/format_bin.h>
 #include <lamure/pre/io/converter.h>
+#include <lamure/pre/io/file.h>
 #include <lamure/pre/io/format_xyz_prov.h>
 
 #include <lamure/pre/normal_computation_plane_fitting.h>
@@ -58,6 +59,9 @@ builder(const descriptor &desc)
 {
     memory_limit_ = calculate_memory_limit();
 
+    // all files of the build are opened through pre::file
+    set_default_file_backend(desc_.io_backend);
+
     base_path_ = fs::path(desc_.working_directory)
         / fs::path(desc_.input_file).stem().string();
 }
@@ -19,13 +19,16 @@
 #include <lamure/pre/bvh_stream.h>
 #include <lamure/pre/plane.h>
 #include <lamure/pre/serialized_surfel.h>
+#include <lamure/pre/task_scheduler.h>
 #include <lamure/sphere.h>
 #include <lamure/utils.h>
 
 #include <lamure/pre/normal_computation_plane_fitting.h>
 #include <lamure/pre/radius_computation_average_distance.h>
 
+#include <atomic>
 #include <fstream>
+#include <functional>
 #include <iostream>
 #include <limits>
 #include <map>
@@ -241,11 +244,8 @@ void bvh::downsweep(
     uint32_t final_depth = std::max(0.0, std::ceil(std::log(input.length() / double(in_core_surfel_capacity)) / std::log(double(fan_factor_))));
 
     assert(final_depth <= depth_);
-    if (final_depth != 0) {
-      LOGGER_ERROR("The dataset does not fit in the specified memory budget. Use flag -m and choose more gigabytes");
-    }
 
-    //LOGGER_INFO("Tree depth to switch in-core: " << final_depth);
+    LOGGER_INFO("Tree depth to switch in-core: " << final_depth);
 
     // construct root node
     nodes_[0] = bvh_node(0, 0, bounding_box(), input);
@@ -260,8 +260,8 @@ void bvh::downsweep(
     }
     else
     {
-        LOGGER_ERROR("Compute root bounding box out-of-core NOT SUPPORTED");
-        //input_bb = basic_algorithms::compute_aabb(nodes_[0].disk_array(), buffer_size_);
+        LOGGER_TRACE("Compute root bounding box out-of-core");
+        input_bb = basic_algorithms::compute_aabb(nodes_[0].disk_array(), buffer_size_);
     }
     LOGGER_TRACE("Root AABB: " << input_bb.min() << " - " << input_bb.max());
 
@@ -301,55 +301,45 @@ void bvh::downsweep(
     uint32_t processed_nodes = 0;
     uint8_t percent_processed = 0;
 
-    if (final_depth != 0) {
-        LOGGER_ERROR("out-of-core NOT SUPPORTED");
-    }
-    /*
-    for(uint32_t level = 0; level < final_depth; ++level)
-    {
-        LOGGER_TRACE("Process out-of-core level: " << level);
-
-        size_t new_slice_left = 0, new_slice_right = 0;
+    // every out-of-core level is partitioned from one level file into the
+    // other. the file a level is read from serves as scratch space for the
+    // buckets that have to be partitioned again.
+    shared_surfel_file level_files[2];
+    shared_prov_file prov_level_files[2];
+    surfel_disk_array level_arrays[2];
 
-        for(size_t nid = slice_left; nid <= slice_right; ++nid)
+    if(final_depth != 0)
+    {
+        for(uint32_t i = 0; i < 2; ++i)
         {
-            bvh_node &current_node = nodes_[nid];
-            // make sure that current node is out-of-core
-            assert(current_node.is_out_of_core());
-
-            // split and compute child bounding boxes
-            basic_algorithms::splitted_array<surfel_disk_array> surfel_arrays;
-
-            basic_algorithms::sort_and_split(current_node.disk_array(), surfel_arrays, current_node.get_bounding_box(), current_node.get_bounding_box().get_longest_axis(), fan_factor_, memory_limit_);
-
-            // iterate through children
-            for(size_t i = 0; i < surfel_arrays.size(); ++i)
+            level_files[i] = std::make_shared<surfel_file>();
+            level_files[i]->open(add_to_path(base_path_, ".lvtmp" + std::to_string(i)).string(), true);
+            if(input.has_provenance())
             {
-                uint32_t child_id = get_child_id(nid, i);
-                nodes_[child_id] = bvh_node(child_id, level + 1, surfel_arrays[i].second, surfel_arrays[i].first);
-                if(nid == slice_left && i == 0)
-                    new_slice_left = child_id;
-                if(nid == slice_right && i == surfel_arrays.size() - 1)
-                    new_slice_right = child_id;
+                prov_level_files[i] = std::make_shared<prov_file>();
+                prov_level_files[i]->open(add_to_path(base_path_, ".plvtmp" + std::to_string(i)).string(), true);
+                level_arrays[i] = surfel_disk_array(level_files[i], prov_level_files[i], 0, input.length());
             }
-
-            current_node.reset();
-
-            // percent counter
-            ++processed_nodes;
-            uint8_t new_percent_processed = (uint8_t)((float)(processed_nodes / first_leaf_ * 100));
-            if(percent_processed != new_percent_processed)
+            else
             {
-                percent_processed = new_percent_processed;
-                // std::cout << "\r" << (uint8_t)percent_processed << "% processed" << std::flush;
+                level_arrays[i] = surfel_disk_array(level_files[i], 0, input.length());
             }
         }
+    }
+
+    for(uint32_t level = 0; level < final_depth; ++level)
+    {
+        LOGGER_TRACE("Process out-of-core level: " << level);
+
+        spawn_partition_node_jobs(slice_left, slice_right, level, level_arrays[level % 2], level_arrays[(level + 1) % 2]);
+
+        processed_nodes += slice_right - slice_left + 1;
 
         // expand the slice
-        slice_left = new_slice_left;
-        slice_right = new_slice_right;
+        slice_left = get_child_id(slice_left, 0);
+        slice_right = get_child_id(slice_right, fan_factor_ - 1);
     }
-*/
+
     // construct next level in-core
     for(size_t nid = slice_left; nid <= slice_right; ++nid)
     {
@@ -371,6 +361,13 @@ void bvh::downsweep(
     if (prov_file_disk_access && prov_file_disk_access->is_open()) {
         prov_file_disk_access->close();
     }
+    for(uint32_t i = 0; i < 2; ++i)
+    {
+        if(level_files[i])
+            level_files[i]->close(true);
+        if(prov_level_files[i])
+            prov_level_files[i]->close(true);
+    }
     state_ = state_type::after_downsweep;
 
 }
@@ -422,6 +419,11 @@ void bvh::downsweep_subtree_in_core(const bvh_node &node, size_t &disk_leaf_dest
 
 void bvh::compute_normal_and_radius(const bvh_node *source_node, const normal_computation_strategy &normal_computation_strategy, const radius_computation_strategy &radius_computation_strategy, bool compute_normals, bool compute_radii)
 {
+    uint16_t num_nearest_neighbours_to_search = std::max(radius_computation_strategy.number_of_neighbours(), normal_computation_strategy.number_of_neighbours());
+
+    std::vector<std::vector<std::pair<surfel_id_t, real>>> nearest_neighbours;
+    get_nearest_neighbours_batch(source_node->node_id(), num_nearest_neighbours_to_search, nearest_neighbours);
+
     for(size_t k = 0; k < max_surfels_per_node_; ++k)
     {
         if(k < source_node->mem_array().length())
@@ -429,9 +431,7 @@ void bvh::compute_normal_and_radius(const bvh_node *source_node, const normal_co
             // read surfel
             surfel surf = source_node->mem_array().read_surfel(k);
 
-            uint16_t num_nearest_neighbours_to_search = std::max(radius_computation_strategy.number_of_neighbours(), normal_computation_strategy.number_of_neighbours());
-
-            auto const &max_nearest_neighbours = get_nearest_neighbours(surfel_id_t(source_node->node_id(), k), num_nearest_neighbours_to_search);
+            auto const &max_nearest_neighbours = nearest_neighbours[k];
             
             // compute radius
             if (compute_radii) {
@@ -489,193 +489,114 @@ void bvh::get_descendant_nodes(const node_id_type node, std::vector<node_id_type
     }
 }
 
-std::vector<std::pair<surfel_id_t, real>> bvh::get_nearest_neighbours(surfel_id_t const target_surfel, uint32_t const number_of_neighbours, bool const do_local_search) const
+void bvh::collect_nearest_neighbours(surfel_id_t const target_surfel, surfel_kd_tree const &target_tree, bool const do_local_search, knn_heap &heap) const
 {
     node_id_type current_node = target_surfel.node_idx;
-    std::unordered_set<size_t> processed_nodes;
     vec3r center = nodes_[target_surfel.node_idx].mem_array().read_surfel_ref(target_surfel.surfel_idx).pos();
 
-    std::vector<std::pair<surfel_id_t, real>> candidates;
-    real max_candidate_distance = std::numeric_limits<real>::max();
-
     // check own node
-    for(size_t i = 0; i < nodes_[current_node].mem_array().length(); ++i)
-    {
-        if(i != target_surfel.surfel_idx)
-        {
-            surfel const& current_surfel = nodes_[current_node].mem_array().read_surfel_ref(i);
-            real distance_to_center = scm::math::length_sqr(center - current_surfel.pos());
-
-            if(candidates.size() < number_of_neighbours || (distance_to_center < max_candidate_distance))
-            {
-                // we found a neighbor which is closer than our most distant neighbor 
-                if(candidates.size() == number_of_neighbours) {
-                    candidates.pop_back();
-                }
-
-                candidates.emplace_back(surfel_id_t{current_node, i}, distance_to_center);
-
-                for(uint16_t k = candidates.size() - 1; k > 0; --k)
-                {
-                    if(candidates[k].second < candidates[k - 1].second)
-                    {
-                        std::swap(candidates[k], candidates[k - 1]);
-                    }
-                    else
-                        break;
-                }
-
-                max_candidate_distance = candidates.back().second;
-            }
-        }
-    }
+    target_tree.nearest_neighbours(center, current_node, target_surfel.surfel_idx, heap);
 
     if(do_local_search)
     {
-        return candidates;
+        return;
     }
 
-    processed_nodes.insert(current_node);
+    // check rest of kd-bvh. the nodes at the target depth below an ancestor
+    // form a contiguous id range, which contains the range searched so far
+    const uint32_t target_depth = nodes_[target_surfel.node_idx].depth();
+    node_id_type searched_first = current_node, searched_last = current_node;
 
-    // check rest of kd-bvh
-    sphere candidates_sphere = sphere(center, sqrt(max_candidate_distance));
+    sphere candidates_sphere = sphere(center, sqrt(heap.bound()));
 
     while((!nodes_[current_node].get_bounding_box().contains(candidates_sphere)) && (current_node != 0))
     {
         current_node = get_parent_id(current_node);
 
-        std::vector<node_id_type> unvisited_descendant_nodes;
-
-        get_descendant_nodes(current_node, unvisited_descendant_nodes, nodes_[target_surfel.node_idx].depth(), processed_nodes);
+        node_id_type first = current_node, last = current_node;
+        for(uint32_t depth = nodes_[current_node].depth(); depth < target_depth; ++depth)
+        {
+            first = get_child_id(first, 0);
+            last = get_child_id(last, fan_factor_ - 1);
+        }
 
-        for(auto adjacent_node : unvisited_descendant_nodes)
+        for(node_id_type adjacent_node = first; adjacent_node <= last; ++adjacent_node)
         {
-            if(candidates_sphere.intersects_or_contains(nodes_[adjacent_node].get_bounding_box()))
+            if(adjacent_node >= searched_first && adjacent_node <= searched_last)
             {
-                // assert(nodes_[adjacent_node].is_out_of_core());
-
-                for(size_t i = 0; i < nodes_[adjacent_node].mem_array().length(); ++i)
-                {
-                    if(!(adjacent_node == target_surfel.node_idx && i == target_surfel.surfel_idx))
-                    {
-                        const surfel &current_surfel = nodes_[adjacent_node].mem_array().read_surfel_ref(i);
-                        real distance_to_center = scm::math::length_sqr(center - current_surfel.pos());
-
-                        if(candidates.size() < number_of_neighbours || (distance_to_center < max_candidate_distance))
-                        {
-                            // we found a neighbor which is closer than our most distant neighbor 
-                            if(candidates.size() == number_of_neighbours) {
-                                candidates.pop_back();
-                            }
-
-                            candidates.emplace_back(surfel_id_t{adjacent_node, i}, distance_to_center);
-
-                            for(uint16_t k = candidates.size() - 1; k > 0; --k)
-                            {
-                                if(candidates[k].second < candidates[k - 1].second)
-                                {
-                                    std::swap(candidates[k], candidates[k - 1]);
-                                }
-                                else
-                                    break;
-                            }
-
-                            max_candidate_distance = candidates.back().second;
-                        }
-                    }
-                }
+                continue;
+            }
 
-                processed_nodes.insert(adjacent_node);
-                candidates_sphere = sphere(center, sqrt(max_candidate_distance));
+            if(candidates_sphere.intersects_or_contains(nodes_[adjacent_node].get_bounding_box()))
+            {
+                nodes_[adjacent_node].kd_tree()->nearest_neighbours(center, adjacent_node, std::numeric_limits<size_t>::max(), heap);
+                candidates_sphere = sphere(center, sqrt(heap.bound()));
             }
         }
+
+        searched_first = first;
+        searched_last = last;
     }
+}
+
+std::vector<std::pair<surfel_id_t, real>> bvh::get_nearest_neighbours(surfel_id_t const target_surfel, uint32_t const number_of_neighbours, bool const do_local_search) const
+{
+    knn_heap heap;
+    heap.reset(number_of_neighbours);
 
+    collect_nearest_neighbours(target_surfel, *nodes_[target_surfel.node_idx].kd_tree(), do_local_search, heap);
+
+    std::vector<std::pair<surfel_id_t, real>> candidates;
+    heap.extract(candidates);
     return candidates;
 }
 
+void bvh::get_nearest_neighbours_batch(const node_id_type node_id, const uint32_t number_of_neighbours, std::vector<std::vector<std::pair<surfel_id_t, real>>> &neighbours,
+                                       const bool do_local_search) const
+{
+    const size_t num_surfels = nodes_[node_id].mem_array().length();
+    const std::shared_ptr<const surfel_kd_tree> tree = nodes_[node_id].kd_tree();
+
+    knn_heap heap;
+    heap.reset(number_of_neighbours);
+
+    neighbours.resize(num_surfels);
+    for(size_t i = 0; i < num_surfels; ++i)
+    {
+        collect_nearest_neighbours(surfel_id_t(node_id, i), *tree, do_local_search, heap);
+        heap.extract(neighbours[i]);
+    }
+}
+
 std::vector<std::pair<surfel_id_t, real>> bvh::get_nearest_neighbours_in_nodes(const surfel_id_t target_surfel, const std::vector<node_id_type> &target_nodes,
                                                                                const uint32_t number_of_neighbours) const
 {
     node_id_type current_node = target_surfel.node_idx;
     vec3r center = nodes_[target_surfel.node_idx].mem_array().read_surfel_ref(target_surfel.surfel_idx).pos();
 
-    std::vector<std::pair<surfel_id_t, real>> candidates;
-    real max_candidate_distance = std::numeric_limits<real>::infinity();
+    knn_heap heap;
+    heap.reset(number_of_neighbours);
 
     // check own node
-    for(size_t i = 0; i < nodes_[current_node].mem_array().length(); ++i)
-    {
-        if(i != target_surfel.surfel_idx)
-        {
-            const surfel &current_surfel = nodes_[current_node].mem_array().read_surfel_ref(i);
-            real distance_to_center = scm::math::length_sqr(center - current_surfel.pos());
-
-            if(candidates.size() < number_of_neighbours || (distance_to_center < max_candidate_distance))
-            {
-                if(candidates.size() == number_of_neighbours)
-                    candidates.pop_back();
-
-                candidates.emplace_back(surfel_id_t{current_node, i}, distance_to_center);
-
-                for(uint16_t k = candidates.size() - 1; k > 0; --k)
-                {
-                    if(candidates[k].second < candidates[k - 1].second)
-                    {
-                        std::swap(candidates[k], candidates[k - 1]);
-                    }
-                    else
-                        break;
-                }
-
-                max_candidate_distance = candidates.back().second;
-            }
-        }
-    }
+    nodes_[current_node].kd_tree()->nearest_neighbours(center, current_node, target_surfel.surfel_idx, heap);
 
     // check remaining nodes in vector
-    sphere candidates_sphere = sphere(center, sqrt(max_candidate_distance));
+    sphere candidates_sphere = sphere(center, sqrt(heap.bound()));
     for(auto adjacent_node : target_nodes)
     {
         if(adjacent_node != current_node)
         {
             if(candidates_sphere.intersects_or_contains(nodes_[adjacent_node].get_bounding_box()))
             {
-                // assert(nodes_[adjacent_node].is_out_of_core());
-
-                for(size_t i = 0; i < nodes_[adjacent_node].mem_array().length(); ++i)
-                {
-                    if(!(adjacent_node == target_surfel.node_idx && i == target_surfel.surfel_idx))
-                    {
-                        const surfel &current_surfel = nodes_[adjacent_node].mem_array().read_surfel_ref(i);
-                        real distance_to_center = scm::math::length_sqr(center - current_surfel.pos());
-
-                        if(candidates.size() < number_of_neighbours || (distance_to_center < max_candidate_distance))
-                        {
-                            if(candidates.size() == number_of_neighbours)
-                                candidates.pop_back();
-
-                            candidates.emplace_back(surfel_id_t{adjacent_node, i}, distance_to_center);
-
-                            for(uint16_t k = candidates.size() - 1; k > 0; --k)
-                            {
-                                if(candidates[k].second < candidates[k - 1].second)
-                                {
-                                    std::swap(candidates[k], candidates[k - 1]);
-                                }
-                                else
-                                    break;
-                            }
-
-                            max_candidate_distance = candidates.back().second;
-                        }
-                    }
-                }
+                nodes_[adjacent_node].kd_tree()->nearest_neighbours(center, adjacent_node, std::numeric_limits<size_t>::max(), heap);
             }
 
-            candidates_sphere = sphere(center, sqrt(max_candidate_distance));
+            candidates_sphere = sphere(center, sqrt(heap.bound()));
         }
     }
+
+    std::vector<std::pair<surfel_id_t, real>> candidates;
+    heap.extract(candidates);
     return candidates;
 }
 
@@ -841,59 +762,49 @@ std::vector<std::pair<surfel, real>> bvh::get_locally_natural_neighbours(std::ve
 
 void bvh::spawn_create_lod_jobs(const uint32_t first_node_of_level, const uint32_t last_node_of_level, const reduction_strategy &reduction_strgy, const bool resample)
 {
-    uint32_t const num_threads = std::thread::hardware_concurrency();
+    task_scheduler &scheduler = task_scheduler::shared();
+    uint32_t const num_threads = scheduler.num_threads();
 
     working_queue_head_counter_.initialize(first_node_of_level); // let the threads fetch a node idx
-    std::vector<std::thread> threads;
 
     for(uint32_t thread_idx = 0; thread_idx < num_threads; ++thread_idx)
     {
         bool update_percentage = (0 == thread_idx);
-        threads.push_back(std::thread(&bvh::thread_create_lod, this, first_node_of_level, last_node_of_level, update_percentage, std::cref(reduction_strgy), resample));
+        scheduler.submit("create_lod", std::bind(&bvh::thread_create_lod, this, first_node_of_level, last_node_of_level, update_percentage, std::cref(reduction_strgy), resample));
     }
 
-    for(auto &thread : threads)
-    {
-        thread.join();
-    }
+    scheduler.wait();
 }
 
 void bvh::spawn_compute_attribute_jobs(const uint32_t first_node_of_level, const uint32_t last_node_of_level, const normal_computation_strategy &normal_strategy,
                                        const radius_computation_strategy &radius_strategy, const bool is_leaf_level, bool compute_normals, bool compute_radii)
 {
-    uint32_t const num_threads = std::thread::hardware_concurrency();
+    task_scheduler &scheduler = task_scheduler::shared();
+    uint32_t const num_threads = scheduler.num_threads();
     working_queue_head_counter_.initialize(first_node_of_level); // let the threads fetch a node idx
-    std::vector<std::thread> threads;
 
     for(uint32_t thread_idx = 0; thread_idx < num_threads; ++thread_idx)
     {
         bool update_percentage = (0 == thread_idx);
-        threads.push_back(
-            std::thread(&bvh::thread_compute_attributes, this, first_node_of_level, last_node_of_level, update_percentage, std::cref(normal_strategy), std::cref(radius_strategy), is_leaf_level, compute_normals, compute_radii));
+        scheduler.submit("compute_attributes", std::bind(&bvh::thread_compute_attributes, this, first_node_of_level, last_node_of_level, update_percentage, std::cref(normal_strategy), std::cref(radius_strategy), is_leaf_level, compute_normals, compute_radii));
     }
 
-    for(auto &thread : threads)
-    {
-        thread.join();
-    }
+    scheduler.wait();
 }
 
 void bvh::spawn_compute_bounding_boxes_downsweep_jobs(const uint32_t slice_left, const uint32_t slice_right)
 {
-    uint32_t const num_threads = std::thread::hardware_concurrency();
+    task_scheduler &scheduler = task_scheduler::shared();
+    uint32_t const num_threads = scheduler.num_threads();
     working_queue_head_counter_.initialize(0); // let the threads fetch a local thread idx
-    std::vector<std::thread> threads;
 
     for(uint32_t thread_idx = 0; thread_idx < num_threads; ++thread_idx)
     {
         bool update_percentage = (0 == thread_idx);
-        threads.push_back(std::thread(&bvh::thread_compute_bounding_boxes_downsweep, this, slice_left, slice_right, update_percentage, num_threads));
+        scheduler.submit("compute_bounding_boxes_downsweep", std::bind(&bvh::thread_compute_bounding_boxes_downsweep, this, slice_left, slice_right, update_percentage, num_threads));
     }
 
-    for(auto &thread : threads)
-    {
-        thread.join();
-    }
+    scheduler.wait();
 }
 
 void bvh::resample_based_on_overlap(surfel_mem_array const &joined_input, surfel_mem_array &output_mem_array, std::vector<surfel_id_t> const &resample_candidates) const
@@ -1026,39 +937,48 @@ std::vector<surfel_id_t> bvh::find_resample_candidates(const uint32_t node_idx)
 
 void bvh::spawn_compute_bounding_boxes_upsweep_jobs(const uint32_t first_node_of_level, const uint32_t last_node_of_level, const int32_t level)
 {
-    uint32_t const num_threads = std::thread::hardware_concurrency();
+    task_scheduler &scheduler = task_scheduler::shared();
+    uint32_t const num_threads = scheduler.num_threads();
     working_queue_head_counter_.initialize(0); // let the threads fetch a local thread idx
-    std::vector<std::thread> threads;
 
     for(uint32_t thread_idx = 0; thread_idx < num_threads; ++thread_idx)
     {
         bool update_percentage = (0 == thread_idx);
-        threads.push_back(std::thread(&bvh::thread_compute_bounding_boxes_upsweep, this, first_node_of_level, last_node_of_level, update_percentage, level, num_threads));
+        scheduler.submit("compute_bounding_boxes_upsweep", std::bind(&bvh::thread_compute_bounding_boxes_upsweep, this, first_node_of_level, last_node_of_level, update_percentage, level, num_threads));
     }
 
-    for(auto &thread : threads)
-    {
-        thread.join();
-    }
+    scheduler.wait();
 }
 
 void bvh::spawn_split_node_jobs(size_t &slice_left, size_t &slice_right, size_t &new_slice_left, size_t &new_slice_right, const uint32_t level)
 {
-    uint32_t const num_threads = std::thread::hardware_concurrency();
+    task_scheduler &scheduler = task_scheduler::shared();
+    uint32_t const num_threads = scheduler.num_threads();
     working_queue_head_counter_.initialize(0); // let the threads fetch a local thread idx
-    std::vector<std::thread> threads;
 
     for(uint32_t thread_idx = 0; thread_idx < num_threads; ++thread_idx)
     {
         bool update_percentage = (0 == thread_idx);
-        threads.push_back(
-            std::thread(&bvh::thread_split_node_jobs, this, std::ref(slice_left), std::ref(slice_right), std::ref(new_slice_left), std::ref(new_slice_right), update_percentage, level, num_threads));
+        scheduler.submit("split_node", std::bind(&bvh::thread_split_node_jobs, this, std::ref(slice_left), std::ref(slice_right), std::ref(new_slice_left), std::ref(new_slice_right), update_percentage, level, num_threads));
     }
 
-    for(auto &thread : threads)
+    scheduler.wait();
+}
+
+void bvh::spawn_partition_node_jobs(const size_t slice_left, const size_t slice_right, const uint32_t level, const surfel_disk_array &target, const surfel_disk_array &scratch)
+{
+    // sibling subtrees are partitioned concurrently, each with an equal
+    // share of the memory budget
+    task_scheduler &scheduler = task_scheduler::shared();
+    uint32_t const num_threads = std::min<size_t>(scheduler.num_threads(), slice_right - slice_left + 1);
+    working_queue_head_counter_.initialize(0);
+
+    for(uint32_t thread_idx = 0; thread_idx < num_threads; ++thread_idx)
     {
-        thread.join();
+        scheduler.submit("partition_node", std::bind(&bvh::thread_partition_node_jobs, this, slice_left, slice_right, level, std::cref(target), std::cref(scratch), memory_limit_ / num_threads));
     }
+
+    scheduler.wait();
 }
 
 void bvh::thread_create_lod(const uint32_t start_marker, const uint32_t end_marker, const bool update_percentage, const reduction_strategy &reduction_strgy, const bool do_resample)
@@ -1067,87 +987,92 @@ void bvh::thread_create_lod(const uint32_t start_marker, const uint32_t end_mark
 
     while(node_index < end_marker)
     {
-        bvh_node *current_node = &nodes_.at(node_index);
-        // If a node has no data yet, calculate it based on child nodes.
-        if(!current_node->is_in_core() && !current_node->is_out_of_core())
-        {
-            std::vector<surfel_mem_array> resampled_arrays;
-            std::vector<surfel_mem_array *> input_mem_arrays;
+        create_node_lod(node_index, reduction_strgy, do_resample, true);
+        node_index = working_queue_head_counter_.increment_head();
+    }
+}
 
-            // simplified data will be stored here
-            surfel_mem_array reduction_result = surfel_mem_array(std::make_shared<surfel_vector>(surfel_vector()), 0, 0);
+void bvh::create_node_lod(const uint32_t node_index, const reduction_strategy &reduction_strgy, const bool do_resample, const bool unload_children)
+{
+    bvh_node *current_node = &nodes_.at(node_index);
+    // If a node has no data yet, calculate it based on child nodes.
+    if(!current_node->is_in_core() && !current_node->is_out_of_core())
+    {
+        std::vector<surfel_mem_array> resampled_arrays;
+        std::vector<surfel_mem_array *> input_mem_arrays;
 
-            if(do_resample)
-            {
-                if (current_node->has_provenance()) {
-                    throw std::runtime_error("resampling not supported for PROVENANCE");
-                }
-                for(uint8_t child_index = 0; child_index < fan_factor_; ++child_index)
-                {
-                    size_t child_id = this->get_child_id(current_node->node_id(), child_index);
-                    resampled_arrays.push_back(resample_node(child_id));
-                }
-                for(uint8_t child_index = 0; child_index < fan_factor_; ++child_index)
-                {
-                    input_mem_arrays.push_back(&resampled_arrays[child_index]);
-                }
+        // simplified data will be stored here
+        surfel_mem_array reduction_result = surfel_mem_array(std::make_shared<surfel_vector>(surfel_vector()), 0, 0);
+
+        if(do_resample)
+        {
+            if (current_node->has_provenance()) {
+                throw std::runtime_error("resampling not supported for PROVENANCE");
             }
-            else
+            for(uint8_t child_index = 0; child_index < fan_factor_; ++child_index)
             {
-                bool child_has_provenance = false;
-                for(uint8_t child_index = 0; child_index < fan_factor_; ++child_index)
-                {
-                    size_t child_id = this->get_child_id(current_node->node_id(), child_index);
-                    bvh_node *child_node = &nodes_.at(child_id);
-
-                    input_mem_arrays.push_back(&child_node->mem_array());
-                    child_has_provenance = child_node->has_provenance();
-                }                
-                if (child_has_provenance) {
-                    reduction_result = surfel_mem_array(
-                        std::make_shared<surfel_vector>(surfel_vector()),
-                        std::make_shared<prov_vector>(prov_vector()), 0, 0);
-                }
+                size_t child_id = this->get_child_id(current_node->node_id(), child_index);
+                resampled_arrays.push_back(resample_node(child_id));
             }
-
-            real reduction_error;
-
-            reduction_strategy *p_reduction_strgy = (reduction_strategy *)&reduction_strgy;
-            if(reduction_strategy_provenance *cast = dynamic_cast<reduction_strategy_provenance *>(p_reduction_strgy))
+            for(uint8_t child_index = 0; child_index < fan_factor_; ++child_index)
             {
-                std::vector<reduction_strategy_provenance::LoDMetaData> deviations;
-                reduction_result = cast->create_lod(reduction_error, input_mem_arrays, deviations, max_surfels_per_node_, (*this), get_child_id(current_node->node_id(), 0));
-                //cast->output_lod(deviations, node_index);
+                input_mem_arrays.push_back(&resampled_arrays[child_index]);
             }
-            else
+        }
+        else
+        {
+            bool child_has_provenance = false;
+            for(uint8_t child_index = 0; child_index < fan_factor_; ++child_index)
             {
-                if (reduction_result.has_provenance()) {
-                    std::cout << "ERROR: Only reduction_strategy_provenance supported for PROVENANCE" << std::endl;
-                    throw std::runtime_error("Only reduction_strategy_provenance supported for PROVENANCE");
-                }
-                reduction_result = reduction_strgy.create_lod(reduction_error, input_mem_arrays, max_surfels_per_node_, (*this), get_child_id(current_node->node_id(), 0));
+                size_t child_id = this->get_child_id(current_node->node_id(), child_index);
+                bvh_node *child_node = &nodes_.at(child_id);
+
+                input_mem_arrays.push_back(&child_node->mem_array());
+                child_has_provenance = child_node->has_provenance();
+            }                
+            if (child_has_provenance) {
+                reduction_result = surfel_mem_array(
+                    std::make_shared<surfel_vector>(surfel_vector()),
+                    std::make_shared<prov_vector>(prov_vector()), 0, 0);
             }
+        }
 
-            current_node->reset(reduction_result);
-            current_node->set_reduction_error(reduction_error);
+        real reduction_error;
+
+        reduction_strategy *p_reduction_strgy = (reduction_strategy *)&reduction_strgy;
+        if(reduction_strategy_provenance *cast = dynamic_cast<reduction_strategy_provenance *>(p_reduction_strgy))
+        {
+            std::vector<reduction_strategy_provenance::LoDMetaData> deviations;
+            reduction_result = cast->create_lod(reduction_error, input_mem_arrays, deviations, max_surfels_per_node_, (*this), get_child_id(current_node->node_id(), 0));
+            //cast->output_lod(deviations, node_index);
+        }
+        else
+        {
+            if (reduction_result.has_provenance()) {
+                std::cout << "ERROR: Only reduction_strategy_provenance supported for PROVENANCE" << std::endl;
+                throw std::runtime_error("Only reduction_strategy_provenance supported for PROVENANCE");
+            }
+            reduction_result = reduction_strgy.create_lod(reduction_error, input_mem_arrays, max_surfels_per_node_, (*this), get_child_id(current_node->node_id(), 0));
+        }
 
-            // Unload all child nodes, if not in leaf level
-            if(get_depth_of_node(current_node->node_id()) != depth())
+        current_node->reset(reduction_result);
+        current_node->set_reduction_error(reduction_error);
+
+        // Unload all child nodes, if not in leaf level
+        if(unload_children && get_depth_of_node(current_node->node_id()) != depth())
+        {
+            for(uint8_t child_index = 0; child_index < fan_factor_; ++child_index)
             {
-                for(uint8_t child_index = 0; child_index < fan_factor_; ++child_index)
-                {
-                    size_t child_id = get_child_id(current_node->node_id(), child_index);
-                    bvh_node &child_node = nodes_.at(child_id);
+                size_t child_id = get_child_id(current_node->node_id(), child_index);
+                bvh_node &child_node = nodes_.at(child_id);
 
-                    if(child_node.is_in_core())
-                    {
-                        child_node.mem_array().reset();
-                    }
+                if(child_node.is_in_core())
+                {
+                    child_node.mem_array().reset();
+                    child_node.release_kd_tree();
                 }
             }
         }
-
-        node_index = working_queue_head_counter_.increment_head();
     }
 }
 
@@ -1204,20 +1129,7 @@ void bvh::thread_compute_attributes(const uint32_t start_marker, const uint32_t
 
     while(node_index < end_marker)
     {
-        bvh_node *current_node = &nodes_.at(node_index);
-
-        // Calculate and set node properties.
-        if(is_leaf_level)
-        {
-            uint16_t number_of_neighbours = 100;
-            auto normal_comp_algo = normal_computation_plane_fitting(number_of_neighbours);
-            auto radius_comp_algo = radius_computation_average_distance(number_of_neighbours, 1.0f);
-            compute_normal_and_radius(current_node, normal_comp_algo, radius_comp_algo, compute_normals, compute_radii);
-        }
-        else
-        {
-            compute_normal_and_radius(current_node, normal_strategy, radius_strategy, compute_normals, compute_radii);
-        }
+        compute_node_attributes(node_index, normal_strategy, radius_strategy, is_leaf_level, compute_normals, compute_radii);
 
         if(update_percentage)
         {
@@ -1232,6 +1144,25 @@ void bvh::thread_compute_attributes(const uint32_t start_marker, const uint32_t
     }
 };
 
+void bvh::compute_node_attributes(const uint32_t node_index, const normal_computation_strategy &normal_strategy, const radius_computation_strategy &radius_strategy,
+                                  const bool is_leaf_level, bool compute_normals, bool compute_radii)
+{
+    bvh_node *current_node = &nodes_.at(node_index);
+
+    // Calculate and set node properties.
+    if(is_leaf_level)
+    {
+        uint16_t number_of_neighbours = 100;
+        auto normal_comp_algo = normal_computation_plane_fitting(number_of_neighbours);
+        auto radius_comp_algo = radius_computation_average_distance(number_of_neighbours, 1.0f);
+        compute_normal_and_radius(current_node, normal_comp_algo, radius_comp_algo, compute_normals, compute_radii);
+    }
+    else
+    {
+        compute_normal_and_radius(current_node, normal_strategy, radius_strategy, compute_normals, compute_radii);
+    }
+}
+
 void bvh::thread_compute_bounding_boxes_downsweep(const uint32_t slice_left, const uint32_t slice_right, const bool update_percentage, const uint32_t num_threads)
 {
     uint32_t thread_idx = working_queue_head_counter_.increment_head();
@@ -1277,36 +1208,41 @@ void bvh::thread_compute_bounding_boxes_upsweep(const uint32_t start_marker, con
             break;
         }
 
-        bvh_node *current_node = &nodes_.at(node_index);
+        compute_node_bounding_box(node_index, level);
+    }
+}
+
+void bvh::compute_node_bounding_box(const uint32_t node_index, const int32_t level)
+{
+    bvh_node *current_node = &nodes_.at(node_index);
 
-        basic_algorithms::surfel_group_properties props = basic_algorithms::compute_properties(current_node->mem_array(), rep_radius_algo_);
+    basic_algorithms::surfel_group_properties props = basic_algorithms::compute_properties(current_node->mem_array(), rep_radius_algo_);
 
-        current_node->set_max_surfel_radius_deviation(props.max_radius_deviation);
+    current_node->set_max_surfel_radius_deviation(props.max_radius_deviation);
 
-        bounding_box node_bounding_box;
-        node_bounding_box.expand(props.bbox);
+    bounding_box node_bounding_box;
+    node_bounding_box.expand(props.bbox);
 
-        if(level < int32_t(depth_))
+    if(level < int32_t(depth_))
+    {
+        for(int32_t child_index = 0; child_index < fan_factor_; ++child_index)
         {
-            for(int32_t child_index = 0; child_index < fan_factor_; ++child_index)
-            {
-                uint32_t child_id = this->get_child_id(current_node->node_id(), child_index);
-                bvh_node *child_node = &nodes_.at(child_id);
+            uint32_t child_id = this->get_child_id(current_node->node_id(), child_index);
+            bvh_node *child_node = &nodes_.at(child_id);
 
-                node_bounding_box.expand(child_node->get_bounding_box());
-            }
+            node_bounding_box.expand(child_node->get_bounding_box());
         }
+    }
 
-        current_node->set_avg_surfel_radius(props.rep_radius);
-        current_node->set_centroid(props.centroid);
+    current_node->set_avg_surfel_radius(props.rep_radius);
+    current_node->set_centroid(props.centroid);
 
-        current_node->set_bounding_box(node_bounding_box);
-        current_node->calculate_statistics();
+    current_node->set_bounding_box(node_bounding_box);
+    current_node->calculate_statistics();
 
-        if (node_index == 0) {
-            std::cout << "min: " << node_bounding_box.min() << std::endl;
-            std::cout << "max: " << node_bounding_box.max() << std::endl;
-        }
+    if (node_index == 0) {
+        std::cout << "min: " << node_bounding_box.min() << std::endl;
+        std::cout << "max: " << node_bounding_box.max() << std::endl;
     }
 }
 
@@ -1319,9 +1255,12 @@ void bvh::thread_remove_outlier_jobs(const uint32_t start_marker, const uint32_t
     {
         bvh_node *current_node = &nodes_.at(node_idx);
 
+        std::vector<std::vector<std::pair<surfel_id_t, real>>> nearest_neighbours;
+        get_nearest_neighbours_batch(node_idx, num_neighbours, nearest_neighbours);
+
         for(size_t surfel_idx = 0; surfel_idx < current_node->mem_array().length(); ++surfel_idx)
         {
-            std::vector<std::pair<surfel_id_t, real>> const nearest_neighbour_vector = get_nearest_neighbours(surfel_id_t(node_idx, surfel_idx), num_neighbours);
+            std::vector<std::pair<surfel_id_t, real>> const &nearest_neighbour_vector = nearest_neighbours[surfel_idx];
 
             double avg_dist = 0.0;
 
@@ -1412,6 +1351,38 @@ void bvh::thread_split_node_jobs(size_t &slice_left, size_t &slice_right, size_t
     }
 }
 
+void bvh::thread_partition_node_jobs(const size_t slice_left, const size_t slice_right, const uint32_t level, const surfel_disk_array &target, const surfel_disk_array &scratch,
+                                     const size_t memory_limit)
+{
+    uint32_t node_index = slice_left + working_queue_head_counter_.increment_head();
+
+    while(node_index <= slice_right)
+    {
+        bvh_node &current_node = nodes_[node_index];
+        // make sure that current node is out-of-core
+        assert(current_node.is_out_of_core());
+
+        const surfel_disk_array &node_array = current_node.disk_array();
+
+        // split and compute child bounding boxes
+        basic_algorithms::splitted_array<surfel_disk_array> surfel_arrays;
+        basic_algorithms::partition_and_split(node_array, surfel_arrays, surfel_disk_array(target, node_array.offset(), node_array.length()),
+                                              surfel_disk_array(scratch, node_array.offset(), node_array.length()), current_node.get_bounding_box(),
+                                              current_node.get_bounding_box().get_longest_axis(), fan_factor_, memory_limit, buffer_size_);
+
+        // iterate through children
+        for(size_t i = 0; i < surfel_arrays.size(); ++i)
+        {
+            uint32_t child_id = get_child_id(node_index, i);
+            nodes_[child_id] = bvh_node(child_id, level + 1, surfel_arrays[i].second, surfel_arrays[i].first);
+        }
+
+        current_node.reset();
+
+        node_index = slice_left + working_queue_head_counter_.increment_head();
+    }
+}
+
 void bvh::upsweep(const reduction_strategy &reduction_strgy, const normal_computation_strategy &normal_strategy, const radius_computation_strategy &radius_strategy,
                   bool resample, bool recompute_leaf_normals, bool recompute_leaf_radii)
 {
@@ -1448,70 +1419,177 @@ void bvh::upsweep(const reduction_strategy &reduction_strgy, const normal_comput
     }
 
 
-    // Start at bottom level and move up towards root.
-    for(int32_t level = depth_; level >= 0; --level)
+    // Loading is not thread-safe, so load the leaf level before starting parallel operations.
+    for(uint32_t node_index = first_leaf_; node_index < nodes_.size(); ++node_index)
     {
-        LOGGER_TRACE("Entering level: " << level);
+        bvh_node *current_node = &nodes_.at(node_index);
+        if(current_node->is_out_of_core())
+        {
+            current_node->load_from_disk();
+        }
+    }
 
-        uint32_t first_node_of_level = get_first_node_id_of_depth(level);
-        uint32_t last_node_of_level = get_first_node_id_of_depth(level) + get_length_of_depth(level);
+    // The levels are processed as a task graph instead of one barrier per
+    // stage. A node is reduced as soon as its own children are finished.
+    // Attributes and bounding boxes still wait for their whole level, since
+    // neighbour queries may reach into any node of the same level. Strategies
+    // that query neighbours while reducing wait for the whole child level.
+    task_scheduler &scheduler = task_scheduler::shared();
+    scheduler.reset_statistics();
 
+    bool const wait_for_child_level = resample || reduction_strgy.queries_neighbourhood();
 
-        // Loading is not thread-safe, so load everything before starting parallel operations.
-        for(uint32_t node_index = first_node_of_level; node_index < last_node_of_level; ++node_index)
+    std::vector<std::atomic<uint32_t>> children_pending(nodes_.size());
+    std::vector<std::atomic<uint32_t>> lods_pending(depth_ + 1);
+    std::vector<std::atomic<uint32_t>> attributes_pending(depth_ + 1);
+    std::vector<std::atomic<uint32_t>> finishes_pending(depth_ + 1);
+
+    for(auto &pending : children_pending)
+    {
+        pending = fan_factor_;
+    }
+    for(int32_t level = depth_; level >= 0; --level)
+    {
+        lods_pending[level] = get_length_of_depth(level);
+        attributes_pending[level] = get_length_of_depth(level);
+        finishes_pending[level] = get_length_of_depth(level);
+    }
+
+    std::function<void(uint32_t, int32_t)> submit_lod;
+    std::function<void(int32_t)> start_attributes;
+    std::function<void(int32_t)> start_finish;
+
+    submit_lod = [&](uint32_t node_index, int32_t level)
+    {
+        scheduler.submit("create_lod", [&, node_index, level]
         {
-            bvh_node *current_node = &nodes_.at(node_index);
-            // if necessary, load leaf-level nodes from disk
-            if(level == int32_t(depth_) && current_node->is_out_of_core())
+            create_node_lod(node_index, reduction_strgy, resample, false);
+
+            if(--lods_pending[level] == 0)
             {
-                current_node->load_from_disk();   
+                // children are not needed anymore once their whole level is reduced
+                uint32_t first_child = get_first_node_id_of_depth(level + 1);
+                uint32_t last_child = first_child + get_length_of_depth(level + 1);
+                for(uint32_t child_id = first_child; child_id < last_child; ++child_id)
+                {
+                    bvh_node &child_node = nodes_.at(child_id);
+                    if(child_node.is_in_core())
+                    {
+                        child_node.mem_array().reset();
+                        child_node.release_kd_tree();
+                    }
+                }
+
+                LOGGER_TRACE("Entering level: " << level);
+                start_attributes(level);
             }
-        }
+        });
+    };
 
-        // Iterate over nodes of current tree level.
-        // First apply reduction strategy, since calculation of attributes might depend on surfel data of nodes in same level.
-        if(level != int32_t(depth_))
-        {
-            spawn_create_lod_jobs(first_node_of_level, last_node_of_level, reduction_strgy, resample);
-        }
+    start_attributes = [&](int32_t level)
+    {
+        bool compute_normals = true;
+        bool compute_radii = true;
 
         // skip the leaf level attribute computation if it was not requested or necessary
-        if(level != int32_t(depth_)) {
-            spawn_compute_attribute_jobs(first_node_of_level, last_node_of_level, normal_strategy, radius_strategy, false, true, true);
+        if(level == int32_t(depth_))
+        {
+            compute_normals = recompute_leaf_normals;
+            compute_radii = recompute_leaf_radii;
         }
-        else if (recompute_leaf_normals || recompute_leaf_radii) {
-            spawn_compute_attribute_jobs(first_node_of_level, last_node_of_level, normal_strategy, radius_strategy, false, recompute_leaf_normals, recompute_leaf_radii);
+        if(!compute_normals && !compute_radii)
+        {
+            start_finish(level);
+            return;
         }
 
-        spawn_compute_bounding_boxes_upsweep_jobs(first_node_of_level, last_node_of_level, level);
+        uint32_t first_node_of_level = get_first_node_id_of_depth(level);
+        uint32_t last_node_of_level = first_node_of_level + get_length_of_depth(level);
+        for(uint32_t node_index = first_node_of_level; node_index < last_node_of_level; ++node_index)
+        {
+            scheduler.submit("compute_attributes", [&, node_index, level, compute_normals, compute_radii]
+            {
+                compute_node_attributes(node_index, normal_strategy, radius_strategy, false, compute_normals, compute_radii);
 
-        std::cout << std::endl;
+                if(--attributes_pending[level] == 0)
+                {
+                    start_finish(level);
+                }
+            });
+        }
+    };
 
-        real mean_radius_sd = 0.0;
-        unsigned counter = 1;
+    start_finish = [&](int32_t level)
+    {
+        uint32_t first_node_of_level = get_first_node_id_of_depth(level);
+        uint32_t last_node_of_level = first_node_of_level + get_length_of_depth(level);
         for(uint32_t node_index = first_node_of_level; node_index < last_node_of_level; ++node_index)
         {
-            bvh_node *current_node = &nodes_.at(node_index);
+            scheduler.submit("finish_node", [&, node_index, level, first_node_of_level, last_node_of_level]
+            {
+                compute_node_bounding_box(node_index, level);
 
-            mean_radius_sd = mean_radius_sd + (*current_node).node_stats().radius_sd();
-            counter++;
+                bvh_node *current_node = &nodes_.at(node_index);
 
-            // compute node offset in file
-            int32_t nid = current_node->node_id();
-            for(uint32_t write_level = 0; write_level < uint32_t(level); ++write_level)
-                nid -= uint32_t(pow(fan_factor_, write_level));
-            nid = std::max(0, nid);
+                // compute node offset in file
+                int32_t nid = current_node->node_id();
+                for(uint32_t write_level = 0; write_level < uint32_t(level); ++write_level)
+                    nid -= uint32_t(pow(fan_factor_, write_level));
+                nid = std::max(0, nid);
 
-            // save computed node to disk
-            if (current_node->has_provenance()) {
-                current_node->flush_to_disk(level_temp_files[level], prov_temp_files[level], size_t(nid) * max_surfels_per_node_, false);
-            }
-            else {
-                current_node->flush_to_disk(level_temp_files[level], size_t(nid) * max_surfels_per_node_, false);
-            }
+                // save computed node to disk
+                if (current_node->has_provenance()) {
+                    current_node->flush_to_disk(level_temp_files[level], prov_temp_files[level], size_t(nid) * max_surfels_per_node_, false);
+                }
+                else {
+                    current_node->flush_to_disk(level_temp_files[level], size_t(nid) * max_surfels_per_node_, false);
+                }
+
+                if(level > 0 && !wait_for_child_level)
+                {
+                    uint32_t parent_id = get_parent_id(node_index);
+                    if(--children_pending[parent_id] == 0)
+                    {
+                        submit_lod(parent_id, level - 1);
+                    }
+                }
+
+                if(--finishes_pending[level] == 0)
+                {
+                    real mean_radius_sd = 0.0;
+                    unsigned counter = 1;
+                    for(uint32_t level_node_index = first_node_of_level; level_node_index < last_node_of_level; ++level_node_index)
+                    {
+                        mean_radius_sd = mean_radius_sd + nodes_.at(level_node_index).node_stats().radius_sd();
+                        counter++;
+                    }
+                    mean_radius_sd = mean_radius_sd / counter;
+                    std::cout << "average radius deviation pro level: " << mean_radius_sd << "\n";
+
+                    if(level > 0 && wait_for_child_level)
+                    {
+                        uint32_t first_parent = get_first_node_id_of_depth(level - 1);
+                        uint32_t last_parent = first_parent + get_length_of_depth(level - 1);
+                        for(uint32_t parent_id = first_parent; parent_id < last_parent; ++parent_id)
+                        {
+                            submit_lod(parent_id, level - 1);
+                        }
+                    }
+                }
+            });
         }
-        mean_radius_sd = mean_radius_sd / counter;
-        std::cout << "average radius deviation pro level: " << mean_radius_sd << "\n";
+    };
+
+    // Start at bottom level and move up towards root.
+    LOGGER_TRACE("Entering level: " << depth_);
+    start_attributes(depth_);
+    scheduler.wait();
+    release_kd_trees();
+
+    for(auto const &stats : scheduler.statistics())
+    {
+        LOGGER_INFO("Upsweep task " << stats.first << ": " << stats.second.num_tasks_ << " tasks, " << stats.second.total_seconds_ << " s total, "
+                    << stats.second.max_seconds_ << " s max");
     }
 
     // TODO: Inject a call to provenance method, collecting level data into one file
@@ -1586,21 +1664,19 @@ void bvh::resample()
     spawn_compute_attribute_jobs(first_node_of_level, last_node_of_level, normal_comp_algo, radius_comp_algo, false, true, true);
 
     // spawn_resample jobs directly instead of calling another function
-    uint32_t const num_threads = std::thread::hardware_concurrency();
+    task_scheduler &scheduler = task_scheduler::shared();
+    uint32_t const num_threads = scheduler.num_threads();
 
     working_queue_head_counter_.initialize(first_node_of_level); // let the threads fetch a node idx
-    std::vector<std::thread> threads;
 
     for(uint32_t thread_idx = 0; thread_idx < num_threads; ++thread_idx)
     {
         bool update_percentage = (0 == thread_idx);
-        threads.push_back(std::thread(&bvh::thread_resample, this, first_node_of_level, last_node_of_level, update_percentage));
+        scheduler.submit("resample", std::bind(&bvh::thread_resample, this, first_node_of_level, last_node_of_level, update_percentage));
     }
 
-    for(auto &thread : threads)
-    {
-        thread.join();
-    }
+    scheduler.wait();
+    release_kd_trees();
 
     real mean_radius_sd = 0.0;
     unsigned counter = 1;
@@ -1621,7 +1697,8 @@ surfel_vector bvh::remove_outliers_statistically(uint32_t num_outliers, uint16_t
 {
     std::vector<std::vector<std::pair<surfel_id_t, real>>> intermediate_outliers;
 
-    uint32_t const num_threads = std::thread::hardware_concurrency();
+    task_scheduler &scheduler = task_scheduler::shared();
+    uint32_t const num_threads = scheduler.num_threads();
     intermediate_outliers.resize(num_threads);
     // already_resized.resize(omp_get_max_threads())
 
@@ -1636,20 +1713,16 @@ surfel_vector bvh::remove_outliers_statistically(uint32_t num_outliers, uint16_t
     }
 
     working_queue_head_counter_.initialize(first_leaf_);
-    std::vector<std::thread> threads;
 
     for(uint32_t thread_idx = 0; thread_idx < num_threads; ++thread_idx)
     {
         //start thread to remove outliers on subset of surfels
-        threads.push_back(std::thread(&bvh::thread_remove_outlier_jobs, this, 
-                                       first_leaf_, nodes_.size(), num_outliers, num_neighbours, 
+        scheduler.submit("remove_outliers", std::bind(&bvh::thread_remove_outlier_jobs, this, first_leaf_, nodes_.size(), num_outliers, num_neighbours, 
                                        std::ref(intermediate_outliers[thread_idx])));
     }
 
-    for(auto& thread : threads)
-    {
-        thread.join();
-    }
+    scheduler.wait();
+    release_kd_trees();
 
     std::vector<std::pair<surfel_id_t, real>> final_outliers;
 
@@ -1746,6 +1819,14 @@ void bvh::serialize_surfels_to_file(const std::string &lod_output_file, const st
     }
 }
 
+void bvh::release_kd_trees()
+{
+    for(auto const &n : nodes_)
+    {
+        n.release_kd_tree();
+    }
+}
+
 void bvh::reset_nodes()
 {
     for(auto &n : nodes_)
@@ -63,6 +63,26 @@ reset()
 {
     mem_array_.reset();
     disk_array_.reset();
+    release_kd_tree();
+}
+
+void bvh_node::
+release_kd_tree() const
+{
+    std::atomic_store(&kd_tree_, std::shared_ptr<const surfel_kd_tree>());
+}
+
+std::shared_ptr<const surfel_kd_tree> bvh_node::
+kd_tree() const
+{
+    std::shared_ptr<const surfel_kd_tree> tree = std::atomic_load(&kd_tree_);
+    if (!tree || !tree->is_built_for(mem_array_)) {
+        // concurrent callers may build the same tree twice, which is
+        // harmless since trees are immutable
+        tree = std::make_shared<const surfel_kd_tree>(mem_array_);
+        std::atomic_store(&kd_tree_, tree);
+    }
+    return tree;
 }
 
 void bvh_node::
@@ -83,6 +103,7 @@ void bvh_node::
 load_from_disk()
 {
     assert(is_out_of_core());
+    release_kd_tree();
     if (has_provenance()) {
       mem_array_.reset(disk_array_.read_all(), disk_array_.read_all_prov(), 0, disk_array_.length());
     }
@@ -102,8 +123,10 @@ flush_to_disk(const shared_surfel_file &file,
     disk_array_.write_all(mem_array_.surfel_mem_data(), mem_array_.offset());
 
 
-    if (dealloc_mem_array)
+    if (dealloc_mem_array) {
         mem_array_.reset();
+        release_kd_tree();
+    }
 }
 
 void bvh_node::
@@ -117,8 +140,10 @@ flush_to_disk(const shared_surfel_file &surfel_file,
     disk_array_.reset(surfel_file, prov_file, offset_in_file, mem_array_.length());
     disk_array_.write_all(mem_array_.surfel_mem_data(), mem_array_.prov_mem_data(), mem_array_.offset());
 
-    if (dealloc_mem_array)
+    if (dealloc_mem_array) {
         mem_array_.reset();
+        release_kd_tree();
+    }
 }
 
 void bvh_node::
@@ -135,8 +160,10 @@ flush_to_disk(const bool dealloc_mem_array)
       disk_array_.write_all(mem_array_.surfel_mem_data(), mem_array_.offset());
     }
 
-    if (dealloc_mem_array)
+    if (dealloc_mem_array) {
         mem_array_.reset();
+        release_kd_tree();
+    }
 }
 
 }
@@ -13,7 +13,12 @@
 #include <parallel/algorithm>
 #endif
 
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
 #include <numeric>
+#include <thread>
 
 namespace lamure
 {
@@ -26,6 +31,176 @@ const size_t MIN_MERGE_BUFFER_SIZE = 3;
 
 const std::string TEMP_FILE_EXT = ".runs";
 
+class external_sort::io_worker
+{
+public:
+    io_worker()
+        : shutdown_(false),
+          thread_(&io_worker::run, this)
+    {}
+
+    ~io_worker()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            shutdown_ = true;
+        }
+        signal_.notify_all();
+        thread_.join();
+    }
+
+    std::shared_future<void> enqueue(const std::function<void()> &task)
+    {
+        auto packaged = std::make_shared<std::packaged_task<void()>>(task);
+        std::shared_future<void> result = packaged->get_future().share();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            tasks_.push_back(packaged);
+        }
+        signal_.notify_one();
+        return result;
+    }
+
+private:
+    void run()
+    {
+        while (true) {
+            std::shared_ptr<std::packaged_task<void()>> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                signal_.wait(lock, [&] { return shutdown_ || !tasks_.empty(); });
+                if (tasks_.empty())
+                    break;
+                task = tasks_.front();
+                tasks_.pop_front();
+            }
+            (*task)();
+        }
+    }
+
+    std::mutex mutex_;
+    std::condition_variable signal_;
+    std::deque<std::shared_ptr<std::packaged_task<void()>>> tasks_;
+    bool shutdown_;
+    std::thread thread_;
+};
+
+external_sort::run_reader::
+run_reader(const surfel_disk_array &run,
+           const size_t block_size,
+           io_worker &worker)
+    : run_(run),
+      worker_(&worker),
+      block_size_(std::max<size_t>(block_size, 1)),
+      file_offset_(0),
+      front_(block_size_),
+      back_(block_size_),
+      front_size_(0),
+      back_size_(0),
+      candidate_pos_(0)
+{
+    prefetch();
+    swap_buffers();
+}
+
+external_sort::run_reader::
+~run_reader()
+{
+    // the io_worker must not write into a destroyed buffer
+    if (pending_.valid())
+        pending_.wait();
+}
+
+void external_sort::run_reader::
+prefetch()
+{
+    if (file_offset_ >= run_.length()) {
+        back_size_ = 0;
+        pending_ = std::shared_future<void>();
+        return;
+    }
+
+    back_size_ = std::min(block_size_, run_.length() - file_offset_);
+
+    shared_surfel_file file = run_.get_file();
+    surfel_vector *target = &back_;
+    const size_t offset = run_.offset() + file_offset_;
+    const size_t length = back_size_;
+
+    pending_ = worker_->enqueue([file, target, offset, length]
+                                { file->read(target, 0, offset, length); });
+    file_offset_ += back_size_;
+}
+
+void external_sort::run_reader::
+swap_buffers()
+{
+    // get() rethrows a failed read
+    if (pending_.valid())
+        pending_.get();
+
+    std::swap(front_, back_);
+    front_size_ = back_size_;
+    candidate_pos_ = 0;
+
+    prefetch();
+}
+
+external_sort::loser_tree::
+loser_tree(std::deque<run_reader> &readers,
+           const surfel::compare_function &compare)
+    : readers_(readers),
+      compare_(compare),
+      tree_(std::max<size_t>(readers.size(), 1), 0)
+{
+    const size_t k = readers_.size();
+    if (k < 2)
+        return;
+
+    // leaves live at [k, 2k), node n plays the winners of 2n and 2n + 1
+    std::vector<uint32_t> winners(2 * k);
+    for (size_t i = 0; i < k; ++i)
+        winners[k + i] = uint32_t(i);
+
+    for (size_t n = k - 1; n > 0; --n) {
+        const uint32_t left = winners[2 * n];
+        const uint32_t right = winners[2 * n + 1];
+        if (less(right, left)) {
+            winners[n] = right;
+            tree_[n] = left;
+        }
+        else {
+            winners[n] = left;
+            tree_[n] = right;
+        }
+    }
+    tree_[0] = winners[1];
+}
+
+bool external_sort::loser_tree::
+less(const uint32_t left, const uint32_t right) const
+{
+    // exhausted runs lose every match
+    const surfel *left_head = readers_[left].head();
+    if (!left_head)
+        return false;
+    const surfel *right_head = readers_[right].head();
+    if (!right_head)
+        return true;
+    return compare_(*left_head, *right_head);
+}
+
+void external_sort::loser_tree::
+replay(const uint32_t run_id)
+{
+    uint32_t winner = run_id;
+    for (size_t n = (readers_.size() + run_id) / 2; n > 0; n /= 2) {
+        if (less(tree_[n], winner))
+            std::swap(tree_[n], winner);
+    }
+    tree_[0] = winner;
+}
+
 external_sort::
 external_sort(const size_t memory_limit,
               const surfel::compare_function &compare)
@@ -37,7 +212,8 @@ external_sort(const size_t memory_limit,
 void external_sort::
 sort(surfel_disk_array &array,
      const size_t memory_limit,
-     const surfel::compare_function &compare)
+     const surfel::compare_function &compare,
+     statistics *stats)
 {
     assert(!array.is_empty());
     assert(array.get_file());
@@ -70,15 +246,37 @@ sort(surfel_disk_array &array,
                         "buffers that store less than " <<
                                                         MIN_MERGE_BUFFER_SIZE << " surfels.");
 
+    if (stats) {
+        stats->run_creation_seconds = 0.0;
+        stats->merge_seconds = 0.0;
+        stats->runs_count = runs_count;
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+
     if (runs_count > 1u) {
         // external sort
         es.runs_file_->open(array.get_file()->file_name() + TEMP_FILE_EXT, true);
         LOGGER_TRACE("create runs");
         es.create_runs(array, run_length, runs_count);
+
+        auto runs_created = std::chrono::high_resolution_clock::now();
+
         LOGGER_TRACE("merge");
         es.merge(array, merge_buffer_size);
         es.runs_file_->close(true);
         es.runs_.clear();
+
+        auto merged = std::chrono::high_resolution_clock::now();
+        const double run_creation_seconds = std::chrono::duration<double>(runs_created - start).count();
+        const double merge_seconds = std::chrono::duration<double>(merged - runs_created).count();
+
+        LOGGER_INFO("Run creation: " << run_creation_seconds << " s, merge: " << merge_seconds << " s.");
+
+        if (stats) {
+            stats->run_creation_seconds = run_creation_seconds;
+            stats->merge_seconds = merge_seconds;
+        }
     }
     else {
         // internal sort for a single run
@@ -90,6 +288,11 @@ sort(surfel_disk_array &array,
         __gnu_parallel::sort(data->begin(), data->end(), es.compare_);
 #endif
         array.write_all(data, 0);
+
+        if (stats) {
+            stats->run_creation_seconds = std::chrono::duration<double>(
+                std::chrono::high_resolution_clock::now() - start).count();
+        }
     }
 }
 
@@ -156,47 +359,63 @@ create_runs(surfel_disk_array &array,
 void external_sort::
 merge(surfel_disk_array &array, const size_t buffer_size)
 {
-    size_t file_offset = 0;
-    surfel_vector output;
-    output.reserve(buffer_size);
+    // every run and the output get two blocks of half the buffer size,
+    // so the memory footprint matches the single-buffered layout
+    const size_t block_size = std::max<size_t>(buffer_size / 2, 1);
 
-    std::vector<buffer> buffers;
-    for (auto r: runs_)
-        buffers.push_back(buffer(r, buffer_size));
+    // the output buffers outlive the write worker, which finishes a pending
+    // write before it is destroyed, also if an error ends the merge early
+    surfel_vector output(block_size);
+    surfel_vector output_back(block_size);
 
-    surfel least;
-    int least_idx;
+    // the workers outlive the readers, which wait for their last read
+    io_worker read_worker;
+    io_worker write_worker;
 
-    do {
-        least_idx = -1;
-        for (size_t i = 0; i < buffers.size(); ++i) {
-            surfel current_surfel;
+    // a deque keeps the readers in place, their buffers are filled asynchronously
+    std::deque<run_reader> readers;
+    for (const auto &r: runs_)
+        readers.emplace_back(r, block_size, read_worker);
 
-            if (buffers[i].front(current_surfel) && (least_idx == -1 ||
-                compare_(current_surfel, least))) {
-                least = current_surfel;
-                least_idx = i;
-            }
-        }
-        if (least_idx != -1) {
-            buffers[least_idx].pop_front();
-            output.push_back(least);
-            if (output.size() >= buffer_size) {
-                array.get_file()->write(&output, 0, array.offset() + file_offset,
-                                    output.size());
-                file_offset += output.size();
-                output.clear();
-            }
-        }
-    }
-    while (least_idx != -1);
+    loser_tree tree(readers, compare_);
 
-    if (output.size() > 0) {
-        array.get_file()->write(&output, 0, array.offset() + file_offset,
-                            output.size());
-        file_offset += output.size();
-        output.clear();
+    size_t file_offset = 0;
+    size_t output_size = 0;
+    std::shared_future<void> pending_write;
+
+    auto flush = [&]() {
+        // get() rethrows a failed write
+        if (pending_write.valid())
+            pending_write.get();
+
+        std::swap(output, output_back);
+
+        shared_surfel_file file = array.get_file();
+        surfel_vector *data = &output_back;
+        const size_t offset = array.offset() + file_offset;
+        const size_t length = output_size;
+
+        pending_write = write_worker.enqueue([file, data, offset, length]
+                                             { file->write(data, 0, offset, length); });
+        file_offset += output_size;
+        output_size = 0;
+    };
+
+    int run_id;
+    while ((run_id = tree.winner()) != -1) {
+        output[output_size++] = *readers[run_id].head();
+        readers[run_id].pop_front();
+        tree.replay(uint32_t(run_id));
+
+        if (output_size >= block_size)
+            flush();
     }
+
+    if (output_size > 0)
+        flush();
+    if (pending_write.valid())
+        pending_write.get();
+
     assert(file_offset == array.length());
 }
 
@@ -0,0 +1,203 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#include <lamure/pre/io/chunked_reader.h>
+
+#include <lamure/pre/logger.h>
+#include <lamure/pre/task_scheduler.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace lamure
+{
+namespace pre
+{
+
+namespace {
+
+struct block
+{
+    std::vector<char>   data_;
+    surfel_vector       surfels_;
+    bool                done_;
+    std::exception_ptr  exception_;
+};
+
+// waits for all submitted blocks on every exit of read(), the parse tasks
+// refer to its mutex and condition variable
+struct in_flight_guard
+{
+    std::mutex &mutex_;
+    std::condition_variable &block_done_;
+    std::deque<std::shared_ptr<block>> &in_flight_;
+
+    ~in_flight_guard()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (auto &b : in_flight_) {
+            block_done_.wait(lock, [&]{ return b->done_; });
+        }
+    }
+};
+
+}
+
+chunked_reader::
+chunked_reader(const size_t block_size)
+: block_size_(std::max<size_t>(block_size, 4096)),
+  bytes_read_(0),
+  seconds_(0.0)
+{
+}
+
+void chunked_reader::
+read(const std::string &filename,
+     const size_t begin_offset,
+     const size_t end_offset,
+     const size_t record_size,
+     const parse_function &parse,
+     const chunk_callback_function &callback)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    std::ifstream stream(filename, std::ios::in | std::ios::binary);
+    if (!stream.is_open())
+        throw std::runtime_error("Unable to open file: " + filename);
+
+    stream.seekg(begin_offset);
+
+    task_scheduler &scheduler = task_scheduler::shared();
+    const size_t max_in_flight = 2 * size_t(scheduler.num_threads()) + 1;
+
+    std::mutex mutex;
+    std::condition_variable block_done;
+
+    std::deque<std::shared_ptr<block>> in_flight;
+    in_flight_guard guard{mutex, block_done, in_flight};
+    std::vector<std::shared_ptr<block>> unused;
+    std::vector<char> carry;
+
+    const size_t total_bytes = end_offset - begin_offset;
+    size_t remaining = total_bytes;
+    uint8_t percent_processed = 0;
+
+    while (remaining > 0 || !carry.empty() || !in_flight.empty()) {
+
+        // keep the workers busy while the consumer waits for the oldest block
+        while ((remaining > 0 || !carry.empty()) && in_flight.size() < max_in_flight) {
+            std::shared_ptr<block> b;
+            if (unused.empty()) {
+                b = std::make_shared<block>();
+            }
+            else {
+                b = unused.back();
+                unused.pop_back();
+            }
+
+            b->data_.assign(carry.begin(), carry.end());
+            carry.clear();
+
+            size_t size = b->data_.size();
+            size_t cut = size;
+            while (remaining > 0) {
+                const size_t count = std::min(block_size_, remaining);
+                b->data_.resize(size + count);
+                stream.read(b->data_.data() + size, count);
+                if (size_t(stream.gcount()) != count) {
+                    throw std::runtime_error("Failed to read file: " + filename);
+                }
+                size += count;
+                remaining -= count;
+
+                if (remaining == 0) {
+                    cut = size;
+                    break;
+                }
+                if (record_size > 0) {
+                    cut = (size / record_size) * record_size;
+                }
+                else {
+                    const char *first = b->data_.data();
+                    const char *last = first + size;
+                    while (last != first && *(last - 1) != '\n') --last;
+                    cut = size_t(last - first);
+                }
+                // a single line or record longer than the block keeps reading
+                if (cut > 0) {
+                    break;
+                }
+            }
+
+            carry.assign(b->data_.begin() + cut, b->data_.begin() + size);
+            b->data_.resize(cut);
+            b->surfels_.clear();
+            b->done_ = false;
+            b->exception_ = nullptr;
+
+            in_flight.push_back(b);
+            scheduler.submit("parse_block", [b, &parse, &mutex, &block_done] {
+                try {
+                    parse(b->data_.data(), b->data_.data() + b->data_.size(), b->surfels_);
+                }
+                catch (...) {
+                    b->exception_ = std::current_exception();
+                }
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    b->done_ = true;
+                }
+                block_done.notify_all();
+            });
+        }
+
+        if (in_flight.empty()) {
+            continue;
+        }
+
+        std::shared_ptr<block> front = in_flight.front();
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            block_done.wait(lock, [&]{ return front->done_; });
+        }
+        in_flight.pop_front();
+
+        if (front->exception_) {
+            // the guard lets the remaining blocks finish before their buffers go away
+            std::rethrow_exception(front->exception_);
+        }
+
+        callback(front->surfels_);
+        unused.push_back(front);
+
+        const size_t processed = total_bytes - remaining;
+        uint8_t new_percent_processed = uint8_t(total_bytes > 0 ? (processed * 100) / total_bytes : 100);
+        if (percent_processed < new_percent_processed) {
+            percent_processed = new_percent_processed;
+            std::cout << "\r" << (int) percent_processed << "% processed" << std::flush;
+        }
+    }
+
+    std::cout << std::endl;
+
+    bytes_read_ = total_bytes;
+    seconds_ = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    LOGGER_TRACE("Parsed " << total_bytes / 1024 / 1024 << " MB in " << seconds_ << " s");
+}
+
+} // namespace pre
+} // namespace lamure
@@ -45,10 +45,18 @@ convert(const std::string &input_filename,
                        out_format_.write(output_filename, buf_callback);
                    });
 
-    // read input
-    in_format_.read(input_filename,
-                    [&](const surfel &s)
-                    { this->append_surfel(s); });
+    // read input. parsed chunks arrive in file order on this thread,
+    // so the modifiers see the surfels in the same order as before
+    bool read_in_chunks = chunked_reading_ &&
+        in_format_.read_chunks(input_filename,
+                               [&](surfel_vector &surfels)
+                               { this->append_surfels(surfels); });
+
+    if (!read_in_chunks) {
+        in_format_.read(input_filename,
+                        [&](const surfel &s)
+                        { this->append_surfel(s); });
+    }
 
     flush_buffer();
     {
@@ -156,6 +164,14 @@ append_surfel(const surfel &surf)
     }
 }
 
+void converter::
+append_surfels(const surfel_vector &surfels)
+{
+    for (const auto &s : surfels) {
+        append_surfel(s);
+    }
+}
+
 void converter::
 flush_buffer()
 {
@@ -0,0 +1,36 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group 
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#include <lamure/pre/io/file.h>
+
+namespace lamure {
+namespace pre {
+
+namespace {
+
+std::atomic<file_backend> selected_file_backend(file_backend::stream);
+
+}
+
+void
+set_default_file_backend(const file_backend backend)
+{
+#ifdef _WIN32
+    (void)backend;
+#else
+    selected_file_backend = backend;
+#endif
+}
+
+file_backend
+default_file_backend()
+{
+    return selected_file_backend;
+}
+
+} // namespace pre
+} // namespace lamure
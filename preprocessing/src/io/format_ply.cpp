@@ -9,8 +9,12 @@
 
 #include <lamure/pre/io/ply/ply.h>
 #include <lamure/pre/io/ply/ply_parser.h>
+#include <lamure/pre/io/chunked_reader.h>
 
 #include <boost/filesystem.hpp>
+#include <cstring>
+#include <fstream>
+#include <sstream>
 #include <stdexcept>
 #include <tuple>
 #include <memory>
@@ -79,6 +83,221 @@ read(const std::string &filename, surfel_callback_funtion callback)
     
 }
 
+namespace {
+
+enum class ply_target
+{
+    ignore, x, y, z, nx, ny, nz, red, green, blue
+};
+
+struct ply_property
+{
+    size_t              offset_;
+    uint8_t             size_;
+    char                kind_;      // 'i' signed, 'u' unsigned, 'f' floating point
+    ply_target          target_;
+};
+
+bool parse_ply_type(const std::string &name, uint8_t &size, char &kind)
+{
+    if (name == "char" || name == "int8")           { size = 1; kind = 'i'; }
+    else if (name == "uchar" || name == "uint8")    { size = 1; kind = 'u'; }
+    else if (name == "short" || name == "int16")    { size = 2; kind = 'i'; }
+    else if (name == "ushort" || name == "uint16")  { size = 2; kind = 'u'; }
+    else if (name == "int" || name == "int32")      { size = 4; kind = 'i'; }
+    else if (name == "uint" || name == "uint32")    { size = 4; kind = 'u'; }
+    else if (name == "float" || name == "float32")  { size = 4; kind = 'f'; }
+    else if (name == "double" || name == "float64") { size = 8; kind = 'f'; }
+    else return false;
+    return true;
+}
+
+ply_target target_of(const std::string &name)
+{
+    if (name == "x") return ply_target::x;
+    if (name == "y") return ply_target::y;
+    if (name == "z") return ply_target::z;
+    if (name == "nx") return ply_target::nx;
+    if (name == "ny") return ply_target::ny;
+    if (name == "nz") return ply_target::nz;
+    if (name == "red" || name == "diffuse_red") return ply_target::red;
+    if (name == "green" || name == "diffuse_green") return ply_target::green;
+    if (name == "blue" || name == "diffuse_blue") return ply_target::blue;
+    return ply_target::ignore;
+}
+
+inline double read_binary_value(const char *data, const ply_property &property)
+{
+    switch (property.kind_) {
+        case 'f':
+            if (property.size_ == 4) { float v; memcpy(&v, data, 4); return v; }
+            else { double v; memcpy(&v, data, 8); return v; }
+        case 'i':
+            if (property.size_ == 1) { int8_t v; memcpy(&v, data, 1); return v; }
+            if (property.size_ == 2) { int16_t v; memcpy(&v, data, 2); return v; }
+            { int32_t v; memcpy(&v, data, 4); return v; }
+        default:
+            if (property.size_ == 1) { uint8_t v; memcpy(&v, data, 1); return v; }
+            if (property.size_ == 2) { uint16_t v; memcpy(&v, data, 2); return v; }
+            { uint32_t v; memcpy(&v, data, 4); return v; }
+    }
+}
+
+inline void assign(surfel &s, const ply_target target, const double value)
+{
+    switch (target) {
+        case ply_target::x: s.pos().x = value; break;
+        case ply_target::y: s.pos().y = value; break;
+        case ply_target::z: s.pos().z = value; break;
+        case ply_target::nx: s.normal().x = float(value); break;
+        case ply_target::ny: s.normal().y = float(value); break;
+        case ply_target::nz: s.normal().z = float(value); break;
+        case ply_target::red: s.color().x = uint8_t(value); break;
+        case ply_target::green: s.color().y = uint8_t(value); break;
+        case ply_target::blue: s.color().z = uint8_t(value); break;
+        default: break;
+    }
+}
+
+}
+
+bool format_ply::
+read_chunks(const std::string &filename, chunk_callback_function callback)
+{
+    std::ifstream ply_file_stream(filename, std::ios::in | std::ios::binary);
+
+    if (!ply_file_stream.is_open())
+        throw std::runtime_error("Unable to open file: " + filename);
+
+    // only the vertex element is read, so it has to come first and must
+    // not contain lists. everything else goes through the ply_parser.
+    std::string line;
+    std::string format;
+    std::vector<ply_property> properties;
+    size_t num_vertices = 0;
+    size_t record_size = 0;
+    bool in_vertex_element = false;
+    bool seen_element = false;
+
+    if (!std::getline(ply_file_stream, line) || line.compare(0, 3, "ply") != 0)
+        return false;
+
+    while (std::getline(ply_file_stream, line)) {
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+
+        std::istringstream tokens(line);
+        std::string keyword;
+        tokens >> keyword;
+
+        if (keyword == "end_header") {
+            break;
+        }
+        else if (keyword == "format") {
+            tokens >> format;
+        }
+        else if (keyword == "element") {
+            std::string name;
+            tokens >> name;
+            if (!seen_element) {
+                if (name != "vertex")
+                    return false;
+                tokens >> num_vertices;
+                in_vertex_element = true;
+            }
+            else {
+                in_vertex_element = false;
+            }
+            seen_element = true;
+        }
+        else if (keyword == "property" && in_vertex_element) {
+            std::string type, name;
+            tokens >> type >> name;
+
+            ply_property property;
+            if (type == "list" || !parse_ply_type(type, property.size_, property.kind_))
+                return false;
+            property.offset_ = record_size;
+            property.target_ = target_of(name);
+            record_size += property.size_;
+            properties.push_back(property);
+        }
+    }
+
+    if (!ply_file_stream || properties.empty())
+        return false;
+
+    const uint16_t endianness_probe = 1;
+    const bool little_endian_host = *reinterpret_cast<const uint8_t *>(&endianness_probe) == 1;
+
+    const bool binary = (format == "binary_little_endian");
+    if ((!binary && format != "ascii") || (binary && !little_endian_host))
+        return false;
+
+    const size_t data_offset = size_t(ply_file_stream.tellg());
+    ply_file_stream.seekg(0, std::ios::end);
+    const size_t file_size = size_t(ply_file_stream.tellg());
+    ply_file_stream.close();
+
+    chunked_reader::parse_function parse;
+    size_t end_offset = file_size;
+
+    if (binary) {
+        end_offset = std::min(file_size, data_offset + num_vertices * record_size);
+        parse = [&properties, record_size](const char *begin, const char *end, surfel_vector &result)
+        {
+            const size_t count = size_t(end - begin) / record_size;
+            result.reserve(result.size() + count);
+            for (size_t i = 0; i < count; ++i) {
+                const char *record = begin + i * record_size;
+                surfel s;
+                for (const auto &property : properties) {
+                    if (property.target_ != ply_target::ignore)
+                        assign(s, property.target_, read_binary_value(record + property.offset_, property));
+                }
+                result.push_back(s);
+            }
+        };
+    }
+    else {
+        parse = [&properties](const char *begin, const char *end, surfel_vector &result)
+        {
+            const char *cursor = begin;
+            while (cursor < end) {
+                surfel s;
+                bool complete = true;
+                for (const auto &property : properties) {
+                    real value;
+                    if (!chunked_reader::parse_real(cursor, end, value)) {
+                        complete = false;
+                        break;
+                    }
+                    assign(s, property.target_, value);
+                }
+                chunked_reader::skip_line(cursor, end);
+                if (complete)
+                    result.push_back(s);
+            }
+        };
+    }
+
+    // ascii files may have further elements behind the vertices, their
+    // lines are parsed as well but not passed on
+    size_t remaining = num_vertices;
+    chunked_reader reader;
+    reader.read(filename, data_offset, end_offset, binary ? record_size : 0, parse,
+        [&](surfel_vector &surfels)
+        {
+            if (surfels.size() > remaining)
+                surfels.resize(remaining);
+            remaining -= surfels.size();
+            if (!surfels.empty())
+                callback(surfels);
+        });
+
+    return true;
+}
+
 void format_ply::
 write(const std::string &filename, buffer_callback_function callback)
 {
@@ -6,6 +6,7 @@
 // http://www.uni-weimar.de/medien/vr
 
 #include <lamure/pre/io/format_xyz.h>
+#include <lamure/pre/io/chunked_reader.h>
 
 #include <stdexcept>
 #include <fstream>
@@ -66,6 +67,54 @@ read(const std::string &filename, surfel_callback_funtion callback)
     xyz_file_stream.close();
 }
 
+namespace {
+
+void parse_xyz_block(const char *begin, const char *end, surfel_vector &result)
+{
+    // a line holds at least six short numbers
+    result.reserve(result.size() + size_t(end - begin) / 24);
+
+    const char *cursor = begin;
+    while (cursor < end) {
+        real pos[3];
+        uint32_t color[4] = {0, 0, 0, 255};
+
+        if (!chunked_reader::parse_real(cursor, end, pos[0]) ||
+            !chunked_reader::parse_real(cursor, end, pos[1]) ||
+            !chunked_reader::parse_real(cursor, end, pos[2])) {
+            chunked_reader::skip_line(cursor, end);
+            continue;
+        }
+        for (int c = 0; c < 4; ++c) {
+            if (!chunked_reader::parse_uint(cursor, end, color[c]))
+                break;
+        }
+        chunked_reader::skip_line(cursor, end);
+
+        result.emplace_back(vec3r(pos[0], pos[1], pos[2]),
+                            vec4b(color[0], color[1], color[2], color[3]));
+    }
+}
+
+}
+
+bool format_xyz::
+read_chunks(const std::string &filename, chunk_callback_function callback)
+{
+    std::ifstream xyz_file_stream(filename, std::ios::in | std::ios::binary | std::ios::ate);
+
+    if (!xyz_file_stream.is_open())
+        throw std::runtime_error("Unable to open file: " +
+            filename);
+
+    const size_t file_size = size_t(xyz_file_stream.tellg());
+    xyz_file_stream.close();
+
+    chunked_reader reader;
+    reader.read(filename, 0, file_size, 0, &parse_xyz_block, callback);
+    return true;
+}
+
 void format_xyz::
 write(const std::string &filename, buffer_callback_function callback)
 {
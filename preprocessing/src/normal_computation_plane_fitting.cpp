@@ -9,6 +9,8 @@
 
 #include <lamure/pre/bvh.h>
 #include <lamure/pre/normal_computation_plane_fitting.h>
+#include <lamure/pre/surfel_kernels.h>
+#include <lamure/pre/surfel_soa.h>
 
 namespace lamure
 {
@@ -179,51 +181,44 @@ compute_normal(const bvh &tree,
         return vec3f(0.0, 0.0, 0.0);
     }
 
-    double summed_distance = 0.0f;
-    double max_distance = 0.0f;
-    vec3r cen = vec3r(0.0, 0.0, 0.0);
+    // gather the neighbour positions into streams for the kernels. surfels
+    // at the position of the target do not contribute.
+    thread_local surfel_soa neighbour_positions;
+    neighbour_positions.clear();
 
     for (const auto &neighbour_ids : nearest_neighbours_ids) {
         vec3r neighbour_pos = bvh_nodes[neighbour_ids.first.node_idx].mem_array().read_surfel_ref(neighbour_ids.first.surfel_idx).pos();
         if (neighbour_pos == poi) {
             continue;
         }
-
-        cen += neighbour_pos;
-
-        real distance = scm::math::length(poi - neighbour_pos);
-        summed_distance += distance;
-        max_distance = std::max(distance, max_distance);
+        neighbour_positions.push_back(neighbour_pos);
     }
 
-    scm::math::vec3d centroid = cen * (1.0 / (real) num_neighbours);
+    const real *x = neighbour_positions.x();
+    const real *y = neighbour_positions.y();
+    const real *z = neighbour_positions.z();
+    const size_t num_positions = neighbour_positions.size();
 
-    if (max_distance >= 0.01) {
-        //    return false;
-    }
+    vec3r cen = surfel_kernels::sum(x, y, z, num_positions);
+    scm::math::vec3d centroid = cen * (1.0 / (real) num_neighbours);
 
     //produce covariance matrix
-    scm::math::mat3d covariance_mat = scm::math::mat3d::zero();
-
-    for (const auto &neighbour_ids : nearest_neighbours_ids) {
-        vec3r neighbour_pos = bvh_nodes[neighbour_ids.first.node_idx].mem_array().read_surfel_ref(neighbour_ids.first.surfel_idx).pos();
-        if (neighbour_pos == poi) {
-            continue;
-        }
+    real scatter[6] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+    surfel_kernels::accumulate_covariance(x, y, z, num_positions, centroid, scatter);
 
-        covariance_mat.m00 += std::pow(neighbour_pos.x - centroid.x, 2);
-        covariance_mat.m01 += (neighbour_pos.x - centroid.x) * (neighbour_pos.y - centroid.y);
-        covariance_mat.m02 += (neighbour_pos.x - centroid.x) * (neighbour_pos.z - centroid.z);
+    scm::math::mat3d covariance_mat = scm::math::mat3d::zero();
 
-        covariance_mat.m03 += (neighbour_pos.y - centroid.y) * (neighbour_pos.x - centroid.x);
-        covariance_mat.m04 += std::pow(neighbour_pos.y - centroid.y, 2);
-        covariance_mat.m05 += (neighbour_pos.y - centroid.y) * (neighbour_pos.z - centroid.z);
+    covariance_mat.m00 = scatter[0];
+    covariance_mat.m01 = scatter[1];
+    covariance_mat.m02 = scatter[2];
 
-        covariance_mat.m06 += (neighbour_pos.z - centroid.z) * (neighbour_pos.x - centroid.x);
-        covariance_mat.m07 += (neighbour_pos.z - centroid.z) * (neighbour_pos.y - centroid.y);
-        covariance_mat.m08 += std::pow(neighbour_pos.z - centroid.z, 2);
+    covariance_mat.m03 = scatter[1];
+    covariance_mat.m04 = scatter[3];
+    covariance_mat.m05 = scatter[4];
 
-    }
+    covariance_mat.m06 = scatter[2];
+    covariance_mat.m07 = scatter[4];
+    covariance_mat.m08 = scatter[5];
 
     //solve for eigenvectors
     real *eigenvalues = new real[3];
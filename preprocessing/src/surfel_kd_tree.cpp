@@ -0,0 +1,224 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#include <lamure/pre/surfel_kd_tree.h>
+#include <lamure/pre/surfel_kernels.h>
+
+#include <algorithm>
+#include <array>
+#include <numeric>
+
+namespace lamure
+{
+namespace pre
+{
+
+namespace {
+
+inline bool farther(const knn_heap::entry& left, const knn_heap::entry& right)
+{
+    return left.second < right.second;
+}
+
+}
+
+void knn_heap::
+reset(const uint32_t capacity)
+{
+    capacity_ = capacity;
+    entries_.clear();
+    entries_.reserve(capacity);
+}
+
+void knn_heap::
+push(const surfel_id_t& id, const real distance)
+{
+    if (entries_.size() < capacity_) {
+        entries_.emplace_back(id, distance);
+        std::push_heap(entries_.begin(), entries_.end(), farther);
+    }
+    else if (capacity_ > 0 && distance < entries_.front().second) {
+        std::pop_heap(entries_.begin(), entries_.end(), farther);
+        entries_.back() = entry(id, distance);
+        std::push_heap(entries_.begin(), entries_.end(), farther);
+    }
+}
+
+void knn_heap::
+extract(std::vector<entry>& result)
+{
+    std::sort_heap(entries_.begin(), entries_.end(), farther);
+    result.assign(entries_.begin(), entries_.end());
+    entries_.clear();
+}
+
+surfel_kd_tree::
+surfel_kd_tree(const surfel_mem_array& array,
+               const uint32_t leaf_size)
+: data_(array.surfel_mem_data()),
+  offset_(array.offset()),
+  leaf_size_(std::max(leaf_size, 1u))
+{
+    const size_t num_surfels = array.length();
+
+    x_.resize(num_surfels);
+    y_.resize(num_surfels);
+    z_.resize(num_surfels);
+    indices_.resize(num_surfels);
+    for (size_t i = 0; i < num_surfels; ++i) {
+        const vec3r pos = array.read_surfel_ref(i).pos();
+        x_[i] = pos.x;
+        y_[i] = pos.y;
+        z_[i] = pos.z;
+        indices_[i] = i;
+    }
+
+    // every level halves the ranges, so the number of levels above the
+    // leaves bounds the size of the implicit layout
+    uint32_t num_levels = 0;
+    for (size_t range = num_surfels; range > leaf_size_; range = (range + 1) / 2) {
+        ++num_levels;
+    }
+    splits_.resize((size_t(1) << num_levels) - 1);
+
+    if (num_surfels > 0) {
+        std::vector<size_t> order;
+        aligned_vector<real> scratch;
+        std::vector<size_t> index_scratch;
+        build(0, 0, num_surfels, order, scratch, index_scratch);
+    }
+}
+
+void surfel_kd_tree::
+build(const uint32_t tree_node,
+      const size_t first,
+      const size_t last,
+      std::vector<size_t>& order,
+      aligned_vector<real>& scratch,
+      std::vector<size_t>& index_scratch)
+{
+    const size_t count = last - first;
+    if (count <= leaf_size_) {
+        return;
+    }
+
+    vec3r min(std::numeric_limits<real>::max());
+    vec3r max(std::numeric_limits<real>::lowest());
+    surfel_kernels::bounding_box(&x_[first], &y_[first], &z_[first], count, min, max);
+
+    uint8_t axis = 0;
+    if (max[1] - min[1] > max[axis] - min[axis]) axis = 1;
+    if (max[2] - min[2] > max[axis] - min[axis]) axis = 2;
+
+    const real* key = axis == 0 ? &x_[first] : (axis == 1 ? &y_[first] : &z_[first]);
+
+    const size_t mid = count / 2;
+    order.resize(count);
+    std::iota(order.begin(), order.end(), size_t(0));
+    std::nth_element(order.begin(), order.begin() + mid, order.end(),
+        [key](const size_t left, const size_t right) {
+            return key[left] < key[right];
+        });
+
+    splits_[tree_node].position_ = key[order[mid]];
+    splits_[tree_node].axis_ = axis;
+
+    // apply the partition to all streams, so the children are contiguous
+    scratch.resize(count);
+    for (aligned_vector<real>* stream : {&x_, &y_, &z_}) {
+        real* values = stream->data() + first;
+        for (size_t i = 0; i < count; ++i) {
+            scratch[i] = values[order[i]];
+        }
+        std::copy(scratch.begin(), scratch.end(), values);
+    }
+    index_scratch.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        index_scratch[i] = indices_[first + order[i]];
+    }
+    std::copy(index_scratch.begin(), index_scratch.end(), indices_.begin() + first);
+
+    build(2 * tree_node + 1, first, first + mid, order, scratch, index_scratch);
+    build(2 * tree_node + 2, first + mid, last, order, scratch, index_scratch);
+}
+
+const bool surfel_kd_tree::
+is_built_for(const surfel_mem_array& array) const
+{
+    // an expired pointer never compares equal to live surfel data, even if
+    // new data has been allocated at the same address
+    return data_.lock() == array.surfel_mem_data() &&
+           offset_ == array.offset() && size() == array.length();
+}
+
+void surfel_kd_tree::
+nearest_neighbours(const vec3r& center,
+                   const node_id_type node_id,
+                   const size_t excluded_surfel,
+                   knn_heap& heap) const
+{
+    struct range
+    {
+        uint32_t        tree_node_;
+        size_t          first_;
+        size_t          last_;
+        real            distance_;
+    };
+
+    if (x_.empty()) {
+        return;
+    }
+
+    // at most one far side is deferred per level
+    std::array<range, 64> stack;
+    size_t stack_size = 0;
+    stack[stack_size++] = range{0, 0, x_.size(), real(0)};
+
+    std::array<real, 64> distances;
+
+    while (stack_size > 0) {
+        range current = stack[--stack_size];
+        if (current.distance_ >= heap.bound()) {
+            continue;
+        }
+
+        while (current.last_ - current.first_ > leaf_size_) {
+            const split& s = splits_[current.tree_node_];
+            const size_t mid = current.first_ + (current.last_ - current.first_) / 2;
+            const real offset = center[s.axis_] - s.position_;
+
+            range left{2 * current.tree_node_ + 1, current.first_, mid, current.distance_};
+            range right{2 * current.tree_node_ + 2, mid, current.last_, current.distance_};
+
+            range& near_side = offset < 0 ? left : right;
+            range& far_side = offset < 0 ? right : left;
+
+            far_side.distance_ = std::max(current.distance_, offset * offset);
+            if (far_side.distance_ < heap.bound()) {
+                stack[stack_size++] = far_side;
+            }
+            current = near_side;
+        }
+
+        for (size_t chunk = current.first_; chunk < current.last_; chunk += distances.size()) {
+            const size_t count = std::min(distances.size(), current.last_ - chunk);
+            surfel_kernels::squared_distances(&x_[chunk], &y_[chunk], &z_[chunk], count, center, distances.data());
+
+            for (size_t i = 0; i < count; ++i) {
+                if (indices_[chunk + i] == excluded_surfel) {
+                    continue;
+                }
+                if (distances[i] < heap.bound()) {
+                    heap.push(surfel_id_t(node_id, indices_[chunk + i]), distances[i]);
+                }
+            }
+        }
+    }
+}
+
+}
+} // namespace lamure
@@ -0,0 +1,385 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#include <lamure/pre/surfel_kernels.h>
+
+#include <algorithm>
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace lamure
+{
+namespace pre
+{
+namespace surfel_kernels
+{
+
+namespace scalar
+{
+
+void
+squared_distances(const real* x, const real* y, const real* z, const size_t count,
+                  const vec3r& center, real* result)
+{
+    for (size_t i = 0; i < count; ++i) {
+        const real dx = x[i] - center.x;
+        const real dy = y[i] - center.y;
+        const real dz = z[i] - center.z;
+        result[i] = dx * dx + dy * dy + dz * dz;
+    }
+}
+
+void
+bounding_box(const real* x, const real* y, const real* z, const size_t count,
+             vec3r& min, vec3r& max)
+{
+    for (size_t i = 0; i < count; ++i) {
+        min.x = std::min(min.x, x[i]);
+        min.y = std::min(min.y, y[i]);
+        min.z = std::min(min.z, z[i]);
+        max.x = std::max(max.x, x[i]);
+        max.y = std::max(max.y, y[i]);
+        max.z = std::max(max.z, z[i]);
+    }
+}
+
+vec3r
+sum(const real* x, const real* y, const real* z, const size_t count)
+{
+    vec3r result(0.0, 0.0, 0.0);
+    for (size_t i = 0; i < count; ++i) {
+        result.x += x[i];
+        result.y += y[i];
+        result.z += z[i];
+    }
+    return result;
+}
+
+void
+accumulate_covariance(const real* x, const real* y, const real* z, const size_t count,
+                      const vec3r& center, real* result)
+{
+    for (size_t i = 0; i < count; ++i) {
+        const real dx = x[i] - center.x;
+        const real dy = y[i] - center.y;
+        const real dz = z[i] - center.z;
+        result[0] += dx * dx;
+        result[1] += dx * dy;
+        result[2] += dx * dz;
+        result[3] += dy * dy;
+        result[4] += dy * dz;
+        result[5] += dz * dz;
+    }
+}
+
+}
+
+#if defined(__AVX512F__)
+
+namespace {
+
+const size_t lanes = 8;
+
+inline __m512d multiply_add(const __m512d a, const __m512d b, const __m512d c) { return _mm512_fmadd_pd(a, b, c); }
+
+}
+
+void
+squared_distances(const real* x, const real* y, const real* z, const size_t count,
+                  const vec3r& center, real* result)
+{
+    const __m512d cx = _mm512_set1_pd(center.x);
+    const __m512d cy = _mm512_set1_pd(center.y);
+    const __m512d cz = _mm512_set1_pd(center.z);
+
+    size_t i = 0;
+    for (; i + lanes <= count; i += lanes) {
+        const __m512d dx = _mm512_sub_pd(_mm512_loadu_pd(x + i), cx);
+        const __m512d dy = _mm512_sub_pd(_mm512_loadu_pd(y + i), cy);
+        const __m512d dz = _mm512_sub_pd(_mm512_loadu_pd(z + i), cz);
+        __m512d d = _mm512_mul_pd(dx, dx);
+        d = multiply_add(dy, dy, d);
+        d = multiply_add(dz, dz, d);
+        _mm512_storeu_pd(result + i, d);
+    }
+    scalar::squared_distances(x + i, y + i, z + i, count - i, center, result + i);
+}
+
+void
+bounding_box(const real* x, const real* y, const real* z, const size_t count,
+             vec3r& min, vec3r& max)
+{
+    __m512d min_x = _mm512_set1_pd(min.x), max_x = _mm512_set1_pd(max.x);
+    __m512d min_y = _mm512_set1_pd(min.y), max_y = _mm512_set1_pd(max.y);
+    __m512d min_z = _mm512_set1_pd(min.z), max_z = _mm512_set1_pd(max.z);
+
+    size_t i = 0;
+    for (; i + lanes <= count; i += lanes) {
+        const __m512d px = _mm512_loadu_pd(x + i);
+        const __m512d py = _mm512_loadu_pd(y + i);
+        const __m512d pz = _mm512_loadu_pd(z + i);
+        min_x = _mm512_min_pd(min_x, px); max_x = _mm512_max_pd(max_x, px);
+        min_y = _mm512_min_pd(min_y, py); max_y = _mm512_max_pd(max_y, py);
+        min_z = _mm512_min_pd(min_z, pz); max_z = _mm512_max_pd(max_z, pz);
+    }
+
+    min = vec3r(_mm512_reduce_min_pd(min_x), _mm512_reduce_min_pd(min_y), _mm512_reduce_min_pd(min_z));
+    max = vec3r(_mm512_reduce_max_pd(max_x), _mm512_reduce_max_pd(max_y), _mm512_reduce_max_pd(max_z));
+    scalar::bounding_box(x + i, y + i, z + i, count - i, min, max);
+}
+
+vec3r
+sum(const real* x, const real* y, const real* z, const size_t count)
+{
+    __m512d sx = _mm512_setzero_pd();
+    __m512d sy = _mm512_setzero_pd();
+    __m512d sz = _mm512_setzero_pd();
+
+    size_t i = 0;
+    for (; i + lanes <= count; i += lanes) {
+        sx = _mm512_add_pd(sx, _mm512_loadu_pd(x + i));
+        sy = _mm512_add_pd(sy, _mm512_loadu_pd(y + i));
+        sz = _mm512_add_pd(sz, _mm512_loadu_pd(z + i));
+    }
+
+    vec3r result = scalar::sum(x + i, y + i, z + i, count - i);
+    result.x += _mm512_reduce_add_pd(sx);
+    result.y += _mm512_reduce_add_pd(sy);
+    result.z += _mm512_reduce_add_pd(sz);
+    return result;
+}
+
+void
+accumulate_covariance(const real* x, const real* y, const real* z, const size_t count,
+                      const vec3r& center, real* result)
+{
+    const __m512d cx = _mm512_set1_pd(center.x);
+    const __m512d cy = _mm512_set1_pd(center.y);
+    const __m512d cz = _mm512_set1_pd(center.z);
+
+    __m512d xx = _mm512_setzero_pd(), xy = _mm512_setzero_pd(), xz = _mm512_setzero_pd();
+    __m512d yy = _mm512_setzero_pd(), yz = _mm512_setzero_pd(), zz = _mm512_setzero_pd();
+
+    size_t i = 0;
+    for (; i + lanes <= count; i += lanes) {
+        const __m512d dx = _mm512_sub_pd(_mm512_loadu_pd(x + i), cx);
+        const __m512d dy = _mm512_sub_pd(_mm512_loadu_pd(y + i), cy);
+        const __m512d dz = _mm512_sub_pd(_mm512_loadu_pd(z + i), cz);
+        xx = multiply_add(dx, dx, xx);
+        xy = multiply_add(dx, dy, xy);
+        xz = multiply_add(dx, dz, xz);
+        yy = multiply_add(dy, dy, yy);
+        yz = multiply_add(dy, dz, yz);
+        zz = multiply_add(dz, dz, zz);
+    }
+
+    result[0] += _mm512_reduce_add_pd(xx);
+    result[1] += _mm512_reduce_add_pd(xy);
+    result[2] += _mm512_reduce_add_pd(xz);
+    result[3] += _mm512_reduce_add_pd(yy);
+    result[4] += _mm512_reduce_add_pd(yz);
+    result[5] += _mm512_reduce_add_pd(zz);
+    scalar::accumulate_covariance(x + i, y + i, z + i, count - i, center, result);
+}
+
+instruction_set
+active_instruction_set()
+{
+    return instruction_set::avx512;
+}
+
+#elif defined(__AVX2__)
+
+namespace {
+
+const size_t lanes = 4;
+
+inline __m256d multiply_add(const __m256d a, const __m256d b, const __m256d c)
+{
+#if defined(__FMA__)
+    return _mm256_fmadd_pd(a, b, c);
+#else
+    return _mm256_add_pd(_mm256_mul_pd(a, b), c);
+#endif
+}
+
+inline real horizontal_add(const __m256d v)
+{
+    const __m128d pair = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(pair, _mm_unpackhi_pd(pair, pair)));
+}
+
+inline real horizontal_min(const __m256d v)
+{
+    const __m128d pair = _mm_min_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+    return _mm_cvtsd_f64(_mm_min_sd(pair, _mm_unpackhi_pd(pair, pair)));
+}
+
+inline real horizontal_max(const __m256d v)
+{
+    const __m128d pair = _mm_max_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+    return _mm_cvtsd_f64(_mm_max_sd(pair, _mm_unpackhi_pd(pair, pair)));
+}
+
+}
+
+void
+squared_distances(const real* x, const real* y, const real* z, const size_t count,
+                  const vec3r& center, real* result)
+{
+    const __m256d cx = _mm256_set1_pd(center.x);
+    const __m256d cy = _mm256_set1_pd(center.y);
+    const __m256d cz = _mm256_set1_pd(center.z);
+
+    size_t i = 0;
+    for (; i + lanes <= count; i += lanes) {
+        const __m256d dx = _mm256_sub_pd(_mm256_loadu_pd(x + i), cx);
+        const __m256d dy = _mm256_sub_pd(_mm256_loadu_pd(y + i), cy);
+        const __m256d dz = _mm256_sub_pd(_mm256_loadu_pd(z + i), cz);
+        __m256d d = _mm256_mul_pd(dx, dx);
+        d = multiply_add(dy, dy, d);
+        d = multiply_add(dz, dz, d);
+        _mm256_storeu_pd(result + i, d);
+    }
+    scalar::squared_distances(x + i, y + i, z + i, count - i, center, result + i);
+}
+
+void
+bounding_box(const real* x, const real* y, const real* z, const size_t count,
+             vec3r& min, vec3r& max)
+{
+    __m256d min_x = _mm256_set1_pd(min.x), max_x = _mm256_set1_pd(max.x);
+    __m256d min_y = _mm256_set1_pd(min.y), max_y = _mm256_set1_pd(max.y);
+    __m256d min_z = _mm256_set1_pd(min.z), max_z = _mm256_set1_pd(max.z);
+
+    size_t i = 0;
+    for (; i + lanes <= count; i += lanes) {
+        const __m256d px = _mm256_loadu_pd(x + i);
+        const __m256d py = _mm256_loadu_pd(y + i);
+        const __m256d pz = _mm256_loadu_pd(z + i);
+        min_x = _mm256_min_pd(min_x, px); max_x = _mm256_max_pd(max_x, px);
+        min_y = _mm256_min_pd(min_y, py); max_y = _mm256_max_pd(max_y, py);
+        min_z = _mm256_min_pd(min_z, pz); max_z = _mm256_max_pd(max_z, pz);
+    }
+
+    min = vec3r(horizontal_min(min_x), horizontal_min(min_y), horizontal_min(min_z));
+    max = vec3r(horizontal_max(max_x), horizontal_max(max_y), horizontal_max(max_z));
+    scalar::bounding_box(x + i, y + i, z + i, count - i, min, max);
+}
+
+vec3r
+sum(const real* x, const real* y, const real* z, const size_t count)
+{
+    __m256d sx = _mm256_setzero_pd();
+    __m256d sy = _mm256_setzero_pd();
+    __m256d sz = _mm256_setzero_pd();
+
+    size_t i = 0;
+    for (; i + lanes <= count; i += lanes) {
+        sx = _mm256_add_pd(sx, _mm256_loadu_pd(x + i));
+        sy = _mm256_add_pd(sy, _mm256_loadu_pd(y + i));
+        sz = _mm256_add_pd(sz, _mm256_loadu_pd(z + i));
+    }
+
+    vec3r result = scalar::sum(x + i, y + i, z + i, count - i);
+    result.x += horizontal_add(sx);
+    result.y += horizontal_add(sy);
+    result.z += horizontal_add(sz);
+    return result;
+}
+
+void
+accumulate_covariance(const real* x, const real* y, const real* z, const size_t count,
+                      const vec3r& center, real* result)
+{
+    const __m256d cx = _mm256_set1_pd(center.x);
+    const __m256d cy = _mm256_set1_pd(center.y);
+    const __m256d cz = _mm256_set1_pd(center.z);
+
+    __m256d xx = _mm256_setzero_pd(), xy = _mm256_setzero_pd(), xz = _mm256_setzero_pd();
+    __m256d yy = _mm256_setzero_pd(), yz = _mm256_setzero_pd(), zz = _mm256_setzero_pd();
+
+    size_t i = 0;
+    for (; i + lanes <= count; i += lanes) {
+        const __m256d dx = _mm256_sub_pd(_mm256_loadu_pd(x + i), cx);
+        const __m256d dy = _mm256_sub_pd(_mm256_loadu_pd(y + i), cy);
+        const __m256d dz = _mm256_sub_pd(_mm256_loadu_pd(z + i), cz);
+        xx = multiply_add(dx, dx, xx);
+        xy = multiply_add(dx, dy, xy);
+        xz = multiply_add(dx, dz, xz);
+        yy = multiply_add(dy, dy, yy);
+        yz = multiply_add(dy, dz, yz);
+        zz = multiply_add(dz, dz, zz);
+    }
+
+    result[0] += horizontal_add(xx);
+    result[1] += horizontal_add(xy);
+    result[2] += horizontal_add(xz);
+    result[3] += horizontal_add(yy);
+    result[4] += horizontal_add(yz);
+    result[5] += horizontal_add(zz);
+    scalar::accumulate_covariance(x + i, y + i, z + i, count - i, center, result);
+}
+
+instruction_set
+active_instruction_set()
+{
+    return instruction_set::avx2;
+}
+
+#else
+
+void
+squared_distances(const real* x, const real* y, const real* z, const size_t count,
+                  const vec3r& center, real* result)
+{
+    scalar::squared_distances(x, y, z, count, center, result);
+}
+
+void
+bounding_box(const real* x, const real* y, const real* z, const size_t count,
+             vec3r& min, vec3r& max)
+{
+    scalar::bounding_box(x, y, z, count, min, max);
+}
+
+vec3r
+sum(const real* x, const real* y, const real* z, const size_t count)
+{
+    return scalar::sum(x, y, z, count);
+}
+
+void
+accumulate_covariance(const real* x, const real* y, const real* z, const size_t count,
+                      const vec3r& center, real* result)
+{
+    scalar::accumulate_covariance(x, y, z, count, center, result);
+}
+
+instruction_set
+active_instruction_set()
+{
+    return instruction_set::scalar;
+}
+
+#endif
+
+const char*
+instruction_set_name(const instruction_set set)
+{
+    switch (set) {
+        case instruction_set::avx512: return "avx512";
+        case instruction_set::avx2: return "avx2";
+        default: return "scalar";
+    }
+}
+
+}
+}
+} // namespace lamure
@@ -0,0 +1,83 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#include <lamure/pre/surfel_soa.h>
+
+namespace lamure
+{
+namespace pre
+{
+
+surfel_soa::
+surfel_soa(const surfel_mem_array& array)
+{
+    assign(array);
+}
+
+void surfel_soa::
+assign(const surfel_mem_array& array)
+{
+    clear();
+    reserve(array.length());
+    for (size_t i = 0; i < array.length(); ++i) {
+        push_back(array.read_surfel_ref(i));
+    }
+}
+
+void surfel_soa::
+reserve(const size_t capacity)
+{
+    x_.reserve(capacity);
+    y_.reserve(capacity);
+    z_.reserve(capacity);
+    radius_.reserve(capacity);
+    normal_x_.reserve(capacity);
+    normal_y_.reserve(capacity);
+    normal_z_.reserve(capacity);
+}
+
+void surfel_soa::
+clear()
+{
+    x_.clear();
+    y_.clear();
+    z_.clear();
+    radius_.clear();
+    normal_x_.clear();
+    normal_y_.clear();
+    normal_z_.clear();
+}
+
+void surfel_soa::
+push_back(const surfel& s)
+{
+    const vec3r pos = s.pos();
+    const vec3f normal = s.normal();
+
+    x_.push_back(pos.x);
+    y_.push_back(pos.y);
+    z_.push_back(pos.z);
+    radius_.push_back(s.radius());
+    normal_x_.push_back(normal.x);
+    normal_y_.push_back(normal.y);
+    normal_z_.push_back(normal.z);
+}
+
+void surfel_soa::
+push_back(const vec3r& position)
+{
+    x_.push_back(position.x);
+    y_.push_back(position.y);
+    z_.push_back(position.z);
+    radius_.push_back(real(0));
+    normal_x_.push_back(0.f);
+    normal_y_.push_back(0.f);
+    normal_z_.push_back(0.f);
+}
+
+}
+} // namespace lamure
@@ -0,0 +1,214 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#include <lamure/pre/task_scheduler.h>
+
+#include <algorithm>
+#include <chrono>
+
+namespace lamure
+{
+namespace pre
+{
+
+namespace {
+
+// identifies the scheduler and worker the calling thread belongs to, so
+// tasks submitted from a task go to the submitting worker's own deque
+thread_local const task_scheduler* current_scheduler = nullptr;
+thread_local uint32_t current_worker = 0;
+
+}
+
+task_scheduler::
+task_scheduler(const uint32_t num_threads)
+: num_queued_(0),
+  num_pending_(0),
+  shutdown_(false),
+  next_worker_(0)
+{
+    const uint32_t count = std::max(num_threads, 1u);
+    for (uint32_t i = 0; i < count; ++i) {
+        workers_.emplace_back(new worker);
+    }
+    for (uint32_t i = 0; i < count; ++i) {
+        workers_[i]->thread_ = std::thread(&task_scheduler::run, this, i);
+    }
+}
+
+task_scheduler::
+~task_scheduler()
+{
+    {
+        std::lock_guard<std::mutex> lock(signal_mutex_);
+        shutdown_ = true;
+    }
+    work_signal_.notify_all();
+
+    for (auto& w : workers_) {
+        if (w->thread_.joinable()) {
+            w->thread_.join();
+        }
+    }
+}
+
+task_scheduler& task_scheduler::
+shared()
+{
+    static task_scheduler scheduler;
+    return scheduler;
+}
+
+void task_scheduler::
+submit(const char* label, task t)
+{
+    const uint32_t worker_id = (current_scheduler == this)
+        ? current_worker
+        : next_worker_++ % uint32_t(workers_.size());
+
+    {
+        std::lock_guard<std::mutex> lock(signal_mutex_);
+        ++num_queued_;
+        ++num_pending_;
+    }
+    {
+        std::lock_guard<std::mutex> lock(workers_[worker_id]->mutex_);
+        workers_[worker_id]->tasks_.push_back(entry{label, std::move(t)});
+    }
+    work_signal_.notify_one();
+}
+
+void task_scheduler::
+wait()
+{
+    std::unique_lock<std::mutex> lock(signal_mutex_);
+    done_signal_.wait(lock, [&]{ return num_pending_ == 0; });
+
+    if (exception_) {
+        std::exception_ptr e = exception_;
+        exception_ = nullptr;
+        std::rethrow_exception(e);
+    }
+}
+
+std::map<std::string, task_scheduler::task_statistics> task_scheduler::
+statistics() const
+{
+    std::lock_guard<std::mutex> lock(statistics_mutex_);
+    return statistics_;
+}
+
+void task_scheduler::
+reset_statistics()
+{
+    std::lock_guard<std::mutex> lock(statistics_mutex_);
+    statistics_.clear();
+}
+
+bool task_scheduler::
+pop(const uint32_t worker_id, entry& e)
+{
+    // newest own task first, it is most likely to find its data in cache
+    {
+        worker& own = *workers_[worker_id];
+        std::lock_guard<std::mutex> lock(own.mutex_);
+        if (!own.tasks_.empty()) {
+            e = std::move(own.tasks_.back());
+            own.tasks_.pop_back();
+            return true;
+        }
+    }
+
+    // steal the oldest task of another worker
+    const uint32_t num_workers = uint32_t(workers_.size());
+    for (uint32_t i = 1; i < num_workers; ++i) {
+        worker& victim = *workers_[(worker_id + i) % num_workers];
+        std::lock_guard<std::mutex> lock(victim.mutex_);
+        if (!victim.tasks_.empty()) {
+            e = std::move(victim.tasks_.front());
+            victim.tasks_.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void task_scheduler::
+execute(entry& e)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+
+    try {
+        e.task_();
+    }
+    catch (...) {
+        std::lock_guard<std::mutex> lock(signal_mutex_);
+        if (!exception_) {
+            exception_ = std::current_exception();
+        }
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+    {
+        std::lock_guard<std::mutex> lock(statistics_mutex_);
+        auto it = statistics_.find(e.label_);
+        if (it == statistics_.end()) {
+            it = statistics_.insert(std::make_pair(std::string(e.label_), task_statistics{0, 0.0, 0.0})).first;
+        }
+        ++it->second.num_tasks_;
+        it->second.total_seconds_ += seconds;
+        it->second.max_seconds_ = std::max(it->second.max_seconds_, seconds);
+    }
+
+    // release captured state before the task counts as done
+    e.task_ = nullptr;
+}
+
+void task_scheduler::
+run(const uint32_t worker_id)
+{
+    current_scheduler = this;
+    current_worker = worker_id;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(signal_mutex_);
+            work_signal_.wait(lock, [&]{ return shutdown_ || num_queued_ > 0; });
+            if (shutdown_) {
+                break;
+            }
+        }
+
+        entry e;
+        if (!pop(worker_id, e)) {
+            // another worker took it between the signal and the pop
+            std::this_thread::yield();
+            continue;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(signal_mutex_);
+            --num_queued_;
+        }
+
+        execute(e);
+
+        bool done = false;
+        {
+            std::lock_guard<std::mutex> lock(signal_mutex_);
+            done = (--num_pending_ == 0);
+        }
+        if (done) {
+            done_signal_.notify_all();
+        }
+    }
+
+    current_scheduler = nullptr;
+}
+
+}
+} // namespace lamure
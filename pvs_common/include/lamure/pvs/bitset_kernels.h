@@ -0,0 +1,52 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#ifndef LAMURE_PVS_BITSET_KERNELS_H
+#define LAMURE_PVS_BITSET_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include <lamure/pvs/pvs.h>
+
+namespace lamure
+{
+namespace pvs
+{
+
+// Operations on visibility bitsets stored as arrays of 64-bit words. The AVX2 versions are
+// built with LAMURE_ENABLE_AVX2 or LAMURE_ENABLE_AVX512 like the node kernels of the renderer,
+// the scalar versions are the reference.
+namespace bitset_kernels
+{
+
+PVS_COMMON_DLL const char* instruction_set_name();
+
+// Number of set bits in the given words.
+PVS_COMMON_DLL size_t popcount(const uint64_t* words, const size_t& num_words);
+
+// Number of bits set in both word arrays.
+PVS_COMMON_DLL size_t intersect_count(const uint64_t* words_one, const uint64_t* words_two, const size_t& num_words);
+
+// Sets all bits of the source words in the destination words.
+PVS_COMMON_DLL void union_with(uint64_t* destination_words, const uint64_t* source_words, const size_t& num_words);
+
+namespace scalar
+{
+
+PVS_COMMON_DLL size_t popcount(const uint64_t* words, const size_t& num_words);
+PVS_COMMON_DLL size_t intersect_count(const uint64_t* words_one, const uint64_t* words_two, const size_t& num_words);
+PVS_COMMON_DLL void union_with(uint64_t* destination_words, const uint64_t* source_words, const size_t& num_words);
+
+}
+
+}
+
+}
+}
+
+#endif
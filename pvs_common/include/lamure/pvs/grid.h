@@ -35,6 +35,8 @@ public:
 
 	virtual void set_cell_visibility(const size_t& cell_index, const model_t& model_id, const node_t& node_id, const bool& visibility) = 0;
 	virtual void set_cell_visibility(const scm::math::vec3d& position, const model_t& model_id, const node_t& node_id, const bool& visibility) = 0;
+	// Sets the nodes of all bits set in the words visible, node n is bit n % 64 of word n / 64.
+	virtual void union_cell_visibility(const size_t& cell_index, const model_t& model_id, const uint64_t* words, const node_t& num_nodes) = 0;
 
 	virtual void save_grid_to_file(const std::string& file_path) const = 0;
 	virtual void save_visibility_to_file(const std::string& file_path) const = 0;
@@ -44,6 +44,7 @@ public:
 
 	virtual void set_cell_visibility(const size_t& cell_index, const model_t& model_id, const node_t& node_id, const bool& visibility);
 	virtual void set_cell_visibility(const scm::math::vec3d& position, const model_t& model_id, const node_t& node_id, const bool& visibility);
+	virtual void union_cell_visibility(const size_t& cell_index, const model_t& model_id, const uint64_t* words, const node_t& num_nodes);
 
 	virtual void save_grid_to_file(const std::string& file_path) const;
 	virtual void save_visibility_to_file(const std::string& file_path) const;
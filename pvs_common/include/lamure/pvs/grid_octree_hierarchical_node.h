@@ -44,6 +44,11 @@ public:
 protected:
 	const grid_octree_hierarchical_node* get_parent_node();
 
+	virtual bool has_inherited_visibility() const;
+
+	// Own visibility word of a model, 0 beyond the stored words.
+	uint64_t get_visibility_word(const model_t& object_id, const size_t& word_index) const;
+
 private:
 	grid_octree_hierarchical_node* parent_;
 
@@ -0,0 +1,54 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group 
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#ifndef LAMURE_PVS_GRID_OCTREE_INDEXED_H
+#define LAMURE_PVS_GRID_OCTREE_INDEXED_H
+
+#include <memory>
+
+#include <lamure/pvs/pvs.h>
+#include "lamure/pvs/grid_octree.h"
+#include "lamure/pvs/visibility_block_file.h"
+
+namespace lamure
+{
+namespace pvs
+{
+
+// Octree grid storing the visibility of its leaf cells as a visibility_block_file.
+class PVS_COMMON_DLL grid_octree_indexed : public grid_octree
+{
+public:
+	grid_octree_indexed();
+	grid_octree_indexed(const size_t& octree_depth, const double& size, const scm::math::vec3d& position_center, const std::vector<node_t>& ids);
+	virtual ~grid_octree_indexed();
+
+	virtual std::string get_grid_type() const;
+	static std::string get_grid_identifier();
+
+	virtual void save_grid_to_file(const std::string& file_path) const;
+	virtual void save_visibility_to_file(const std::string& file_path) const;
+
+	virtual bool load_grid_from_file(const std::string& file_path);
+	virtual bool load_visibility_from_file(const std::string& file_path);
+
+	virtual bool load_cell_visibility_from_file(const std::string& file_path, const size_t& cell_index);
+
+	// Codec and coding used by save_visibility_to_file(), and the threads used to encode and decode all cells.
+	void set_block_settings(const visibility_block_settings& settings);
+	const visibility_block_settings& get_block_settings() const;
+
+protected:
+	visibility_block_settings block_settings_;
+	// Shared with the loads decoding from it, replaced as a whole when another file is mapped.
+	mutable std::shared_ptr<visibility_block_file> block_file_;
+};
+
+}
+}
+
+#endif
@@ -10,7 +10,9 @@
 
 #include <vector>
 #include <map>
+#include <memory>
 #include <utility>
+#include <cstdint>
 
 #include <lamure/pvs/pvs.h>
 #include <lamure/types.h>
@@ -20,19 +22,53 @@ namespace lamure
 namespace pvs
 {
 
+class grid;
+
+// Counts the pixels per node of an ID buffer. Counters are dense arrays per model, so the histogram should be
+// created once with the number of nodes of each model (e.g. from grid::get_num_nodes()) and reused for every image.
+// Larger images are split among several threads whose partial histograms are merged by a parallel reduction.
+// The threads are started with the first large image and wait for the following images until the histogram is destroyed.
 class PVS_COMMON_DLL id_histogram
 {
 public:
 	id_histogram();
+	id_histogram(const std::vector<node_t>& numNodes, const unsigned int& numThreads = 0);
+	id_histogram(id_histogram&& other);
 	~id_histogram();
 
+	id_histogram& operator=(id_histogram&& other);
+
 	void create(const void* pixelData, const size_t& numPixels);
-	
+
 	std::map<model_t, std::vector<node_t>> get_visible_nodes(const size_t& numPixels, const float& visibilityThreshold) const;
 	std::map<model_t, std::map<node_t, size_t>> get_histogram() const;
 
+	// Sets the nodes passing the threshold visible in the given grid cell, writing whole bitset words instead of single nodes.
+	void set_cell_visibility(grid* visibilityGrid, const size_t& cellIndex, const size_t& numPixels, const float& visibilityThreshold);
+
 private:
-	std::map<model_t, std::map<node_t, size_t>> histogram_;			// first key is model ID, second key is node ID, final value is amount of visible pixels
+	class worker_pool;
+
+	void count_pixels(const unsigned int* pixelDataInt, const size_t& firstPixel, const size_t& lastPixel, const unsigned int& threadIndex);
+	void merge_counts(const unsigned int& targetIndex, const unsigned int& sourceIndex);
+	void clear_counts(const unsigned int& threadIndex);
+	uint32_t* get_counts_for_write(const unsigned int& threadIndex, const model_t& modelID, const node_t& nodeID);
+
+	size_t get_min_visible_count(const size_t& numPixels, const float& visibilityThreshold) const;
+
+	std::vector<node_t> num_nodes_;
+	unsigned int num_threads_;
+
+	// Threads helping the calling thread of create(), only started if an image is large enough to be split.
+	std::unique_ptr<worker_pool> workers_;
+
+	// Pixel counts per thread, model and node. The first thread holds the merged histogram once create() is done.
+	std::vector<std::vector<std::vector<uint32_t>>> counts_;
+	// IDs of the non-zero counters per thread (model ID in the upper 8 bits, node ID in the lower 24 bits like in the ID buffer).
+	std::vector<std::vector<uint32_t>> counted_ids_;
+
+	// Visible nodes per model as bitset words, only used during set_cell_visibility().
+	std::vector<std::vector<uint64_t>> visible_words_;
 };
 
 }
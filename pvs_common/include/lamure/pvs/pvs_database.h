@@ -8,12 +8,16 @@
 #ifndef LAMURE_PVS_PVS_DATABASE_H
 #define LAMURE_PVS_PVS_DATABASE_H
 
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <list>
+#include <map>
 #include <set>
 #include <string>
 #include <thread>
 #include <vector>
 #include <mutex>
-#include <queue>
 
 #include <lamure/pvs/pvs.h>
 #include "lamure/pvs/grid.h"
@@ -49,15 +53,47 @@ public:
 	const grid* get_bounding_grid() const;
 	void clear_visibility_grid();
 
+	struct prefetch_statistics
+	{
+		// Cells the viewer entered. Each one was either loaded already (hit), requested but not loaded yet (late prefetch) or not requested at all (cold miss).
+		size_t num_cell_switches;
+		size_t num_hits;
+		size_t num_late_prefetches;
+		size_t num_cold_misses;
+
+		// Time from entering a cell until its visibility is available, hits count as zero.
+		double average_switch_latency_ms;
+		double max_switch_latency_ms;
+
+		size_t num_loaded_cells;
+		size_t num_evicted_cells;
+		size_t num_cached_cells;
+	};
+
+	// If visibility is not preloaded, at most max_cached_cells view cells keep their visibility data, the least recently used ones are released first.
+	// Besides the neighbourhood of the viewer cell, num_prefetched_cells cells along the viewer's movement are loaded ahead.
+	void set_prefetching(const size_t& max_cached_cells, const size_t& num_prefetched_cells);
+	prefetch_statistics get_prefetch_statistics() const;
+	void reset_prefetch_statistics();
+
 protected:
 	pvs_database();
+	pvs_database(const unsigned int& num_loading_threads);
 
 	static pvs_database* instance_;
 
 private:
 	void loading_thread_loop();
-	void load_visibility_data_async(uint64_t cell_index);
-	std::queue<uint64_t> loading_queue_;
+	void request_cells_around_viewer(const size_t& cell_index);
+	void request_cell(const size_t& cell_index);
+	void touch_cached_cell(const size_t& cell_index);
+	void evict_cached_cells();
+	void reset_cache();
+
+	// Cells waiting for one of the loading threads, in order of importance.
+	std::deque<size_t> loading_queue_;
+	std::set<size_t> queued_cell_indices_;
+	std::set<size_t> cells_in_loading_;
 	semaphore semaphore_;
 
 	// Grid storing the major visibility data of the scene.
@@ -80,9 +116,27 @@ private:
 	std::string pvs_file_path_;
 
 	scm::math::vec3d smallest_cell_size_;
-	std::set<size_t> previously_loaded_cell_indices_;
 
-	std::thread visibility_data_loading_thread_;
+	// Loaded cells, most recently used first, and the cells around the viewer which must not be released.
+	std::list<size_t> cached_cell_indices_;
+	std::map<size_t, std::list<size_t>::iterator> cached_cell_positions_;
+	std::set<size_t> protected_cell_indices_;
+	size_t max_cached_cells_;
+	size_t num_prefetched_cells_;
+
+	// Viewer cell within the visibility grid and whether its visibility may be used already.
+	size_t viewer_cell_index_;
+	std::atomic<bool> viewer_cell_loaded_;
+	std::chrono::steady_clock::time_point viewer_cell_enter_time_;
+
+	scm::math::vec3d viewer_velocity_;
+	std::chrono::steady_clock::time_point viewer_position_time_;
+
+	prefetch_statistics statistics_;
+	double total_switch_latency_ms_;
+	size_t num_measured_switches_;
+
+	std::vector<std::thread> visibility_data_loading_threads_;
 
 	// Used to achieve thread safety.
 	mutable std::mutex mutex_;
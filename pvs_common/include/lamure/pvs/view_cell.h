@@ -11,6 +11,7 @@
 #include <map>
 #include <vector>
 #include <string>
+#include <cstdint>
 
 #include <scm/core/math.h>
 
@@ -38,6 +39,23 @@ public:
 	virtual bool contains_visibility_data() const = 0;
 	virtual std::map<model_t, std::vector<node_t>> get_visible_indices() const = 0;
 	virtual void clear_visibility_data() = 0;
+
+	// Bulk visibility operations over all models. The defaults work on the visible indices,
+	// view_cell_regular overrides them with word operations on its bitsets.
+
+	// Sets every node visible in the other cell as visible in this cell.
+	virtual void union_with(const view_cell* other);
+	// Sets the nodes of all bits set in the words visible, node n is bit n % 64 of word n / 64.
+	virtual void union_with_words(const model_t& object_id, const uint64_t* words, const node_t& num_nodes);
+	// Writes the visibility of the first num_nodes nodes into (num_nodes + 63) / 64 words, node n is bit n % 64 of word n / 64.
+	virtual void copy_visibility_words(const model_t& object_id, const node_t& num_nodes, uint64_t* words) const;
+	// Number of nodes visible in both cells.
+	virtual size_t intersect_count(const view_cell* other) const;
+	// Number of visible nodes.
+	virtual size_t popcount() const;
+
+	// Visible nodes of both cells divided by the nodes visible in either cell, 1.0 if both are empty.
+	float similarity(const view_cell* other) const;
 };
 
 }
@@ -10,6 +10,7 @@
 
 #include <vector>
 #include <map>
+#include <cstdint>
 
 #include <scm/core/math.h>
 #include <lamure/types.h>
@@ -47,11 +48,29 @@ public:
 	virtual boost::dynamic_bitset<> get_bitset(const model_t& object_id) const;
 	virtual void set_bitset(const model_t& object_id, const boost::dynamic_bitset<>& bitset);
 
+	virtual void union_with(const view_cell* other);
+	virtual void union_with_words(const model_t& object_id, const uint64_t* words, const node_t& num_nodes);
+	virtual void copy_visibility_words(const model_t& object_id, const node_t& num_nodes, uint64_t* words) const;
+	virtual size_t intersect_count(const view_cell* other) const;
+	virtual size_t popcount() const;
+
+	// Visibility of a model as 64-bit words, node n is bit n % 64 of word n / 64.
+	const uint64_t* get_visibility_words(const model_t& object_id, size_t& num_words) const;
+
+protected:
+	// True if get_visibility() also reports nodes which are not stored in this cell's own bitsets.
+	virtual bool has_inherited_visibility() const;
+
+	// Words of a model, grown to hold at least the given number of nodes.
+	uint64_t* get_visibility_words_for_write(const model_t& object_id, const node_t& num_nodes);
+
 private:
 	double cell_size_;
 	scm::math::vec3d position_center_;
 
-	std::vector<boost::dynamic_bitset<>> visibility_;
+	// Node visibility per model, each one with the number of bits it holds.
+	std::vector<std::vector<uint64_t>> visibility_;
+	std::vector<node_t> visibility_sizes_;
 };
 
 }
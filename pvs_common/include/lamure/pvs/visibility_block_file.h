@@ -0,0 +1,103 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group 
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#ifndef LAMURE_PVS_VISIBILITY_BLOCK_FILE_H
+#define LAMURE_PVS_VISIBILITY_BLOCK_FILE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <lamure/pvs/pvs.h>
+#include <lamure/types.h>
+#include "lamure/pvs/view_cell.h"
+
+#include <boost/iostreams/device/mapped_file.hpp>
+
+namespace lamure
+{
+namespace pvs
+{
+
+// Compression of the cell blocks.
+enum class visibility_block_codec : uint32_t
+{
+	none = 0,
+	deflate = 1
+};
+
+// Coding of the node bitsets of a cell before compression.
+enum class visibility_block_coding : uint32_t
+{
+	// Bitset words as stored in the view cells.
+	bitset = 0,
+	// Alternating lengths of invisible and visible node runs as variable length integers.
+	run_length = 1
+};
+
+struct visibility_block_settings
+{
+	visibility_block_codec codec = visibility_block_codec::deflate;
+	// Deflate level from 1 (fastest) to 9 (smallest).
+	int compression_level = 1;
+	visibility_block_coding coding = visibility_block_coding::run_length;
+	// Threads used to encode and decode blocks, 0 uses all hardware threads.
+	unsigned int num_threads = 0;
+};
+
+// Visibility file storing one independently coded block per view cell. The header is followed by a table of the
+// block offsets, so once the file is memory-mapped the block of any cell is found and decoded in place without
+// reading the others. Cells without visible nodes have empty blocks.
+class PVS_COMMON_DLL visibility_block_file
+{
+public:
+	visibility_block_file();
+	~visibility_block_file();
+
+	// Encodes the blocks of the cells in parallel and writes them in cell order. The file is written under a temporary
+	// name and then replaces the given one, so existing mappings of the previous file stay readable.
+	// Throws std::invalid_argument if the file can not be written and std::runtime_error if a block can not be encoded.
+	static void save(const std::string& file_path, const std::vector<const view_cell*>& cells, const std::vector<node_t>& ids, const visibility_block_settings& settings);
+
+	// Maps the file. Fails if it is no block file or does not match the given number of cells and nodes.
+	bool open(const std::string& file_path, const size_t& num_cells, const std::vector<node_t>& ids);
+	void close();
+
+	bool is_open() const;
+	const std::string& get_file_path() const;
+
+	// Codec and coding of the opened file.
+	visibility_block_settings get_settings() const;
+	size_t get_block_size(const size_t& cell_index) const;
+
+	// Decodes the block of a cell and sets its nodes visible in the given view cell. The bitsets of all models are
+	// allocated, so cells without visible nodes count as loaded as well.
+	// Blocks may be loaded concurrently as long as the file is not opened or closed meanwhile, the grids keep a
+	// shared_ptr to the file for every running load.
+	bool load_cell(const size_t& cell_index, view_cell* cell) const;
+	// Loads the blocks of all cells, distributed among the given number of threads (0 uses all hardware threads).
+	bool load_cells(const std::vector<view_cell*>& cells, const unsigned int& num_threads) const;
+
+private:
+	boost::iostreams::mapped_file_source file_;
+	std::string file_path_;
+
+	visibility_block_codec codec_;
+	visibility_block_coding coding_;
+	std::vector<node_t> ids_;
+	size_t num_cells_;
+	// Upper bound of the uncompressed size of a block, larger sizes stored in deflated blocks are rejected.
+	uint64_t max_cell_data_size_;
+
+	// Points into the mapped file, num_cells_ + 1 offsets of the blocks.
+	const char* block_offsets_;
+};
+
+}
+}
+
+#endif
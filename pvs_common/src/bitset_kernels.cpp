@@ -0,0 +1,179 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#include "lamure/pvs/bitset_kernels.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace lamure
+{
+namespace pvs
+{
+namespace bitset_kernels
+{
+
+namespace
+{
+
+inline size_t popcount_word(const uint64_t& word)
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+	return (size_t)__popcnt64(word);
+#elif defined(__GNUC__)
+	return (size_t)__builtin_popcountll(word);
+#else
+	uint64_t bits = word - ((word >> 1) & 0x5555555555555555ull);
+	bits = (bits & 0x3333333333333333ull) + ((bits >> 2) & 0x3333333333333333ull);
+	bits = (bits + (bits >> 4)) & 0x0f0f0f0f0f0f0f0full;
+	return (size_t)((bits * 0x0101010101010101ull) >> 56);
+#endif
+}
+
+#if defined(__AVX2__)
+
+// Bit counts of the 32 bytes, looked up per nibble.
+inline __m256i popcount_bytes(const __m256i& bytes)
+{
+	const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+											0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+	const __m256i low_mask = _mm256_set1_epi8(0x0f);
+
+	__m256i low = _mm256_and_si256(bytes, low_mask);
+	__m256i high = _mm256_and_si256(_mm256_srli_epi16(bytes, 4), low_mask);
+
+	return _mm256_add_epi8(_mm256_shuffle_epi8(lookup, low), _mm256_shuffle_epi8(lookup, high));
+}
+
+inline size_t horizontal_sum(const __m256i& sums)
+{
+	__m128i sum = _mm_add_epi64(_mm256_castsi256_si128(sums), _mm256_extracti128_si256(sums, 1));
+	return (size_t)(_mm_cvtsi128_si64(sum) + _mm_extract_epi64(sum, 1));
+}
+
+#endif
+
+}
+
+namespace scalar
+{
+
+size_t popcount(const uint64_t* words, const size_t& num_words)
+{
+	size_t count = 0;
+
+	for(size_t word_index = 0; word_index < num_words; ++word_index)
+	{
+		count += popcount_word(words[word_index]);
+	}
+
+	return count;
+}
+
+size_t intersect_count(const uint64_t* words_one, const uint64_t* words_two, const size_t& num_words)
+{
+	size_t count = 0;
+
+	for(size_t word_index = 0; word_index < num_words; ++word_index)
+	{
+		count += popcount_word(words_one[word_index] & words_two[word_index]);
+	}
+
+	return count;
+}
+
+void union_with(uint64_t* destination_words, const uint64_t* source_words, const size_t& num_words)
+{
+	for(size_t word_index = 0; word_index < num_words; ++word_index)
+	{
+		destination_words[word_index] |= source_words[word_index];
+	}
+}
+
+}
+
+#if defined(__AVX2__)
+
+const char* instruction_set_name()
+{
+	return "avx2";
+}
+
+size_t popcount(const uint64_t* words, const size_t& num_words)
+{
+	__m256i sums = _mm256_setzero_si256();
+	size_t word_index = 0;
+
+	for(; word_index + 4 <= num_words; word_index += 4)
+	{
+		__m256i bytes = _mm256_loadu_si256((const __m256i*)&words[word_index]);
+		sums = _mm256_add_epi64(sums, _mm256_sad_epu8(popcount_bytes(bytes), _mm256_setzero_si256()));
+	}
+
+	return horizontal_sum(sums) + scalar::popcount(&words[word_index], num_words - word_index);
+}
+
+size_t intersect_count(const uint64_t* words_one, const uint64_t* words_two, const size_t& num_words)
+{
+	__m256i sums = _mm256_setzero_si256();
+	size_t word_index = 0;
+
+	for(; word_index + 4 <= num_words; word_index += 4)
+	{
+		__m256i bytes = _mm256_and_si256(_mm256_loadu_si256((const __m256i*)&words_one[word_index]), _mm256_loadu_si256((const __m256i*)&words_two[word_index]));
+		sums = _mm256_add_epi64(sums, _mm256_sad_epu8(popcount_bytes(bytes), _mm256_setzero_si256()));
+	}
+
+	return horizontal_sum(sums) + scalar::intersect_count(&words_one[word_index], &words_two[word_index], num_words - word_index);
+}
+
+void union_with(uint64_t* destination_words, const uint64_t* source_words, const size_t& num_words)
+{
+	size_t word_index = 0;
+
+	for(; word_index + 4 <= num_words; word_index += 4)
+	{
+		__m256i destination = _mm256_loadu_si256((const __m256i*)&destination_words[word_index]);
+		__m256i source = _mm256_loadu_si256((const __m256i*)&source_words[word_index]);
+		_mm256_storeu_si256((__m256i*)&destination_words[word_index], _mm256_or_si256(destination, source));
+	}
+
+	scalar::union_with(&destination_words[word_index], &source_words[word_index], num_words - word_index);
+}
+
+#else
+
+const char* instruction_set_name()
+{
+	return "scalar";
+}
+
+size_t popcount(const uint64_t* words, const size_t& num_words)
+{
+	return scalar::popcount(words, num_words);
+}
+
+size_t intersect_count(const uint64_t* words_one, const uint64_t* words_two, const size_t& num_words)
+{
+	return scalar::intersect_count(words_one, words_two, num_words);
+}
+
+void union_with(uint64_t* destination_words, const uint64_t* source_words, const size_t& num_words)
+{
+	scalar::union_with(destination_words, source_words, num_words);
+}
+
+#endif
+
+}
+}
+}
@@ -163,6 +163,13 @@ set_cell_visibility(const scm::math::vec3d& position, const model_t& model_id, c
 	}
 }
 
+void grid_irregular::
+union_cell_visibility(const size_t& cell_index, const model_t& model_id, const uint64_t* words, const node_t& num_nodes)
+{
+	view_cell* current_visibility_cell = cells_by_indices_[cell_index];
+	current_visibility_cell->union_with_words(model_id, words, num_nodes);
+}
+
 void grid_irregular::
 save_grid_to_file(const std::string& file_path) const
 {
@@ -602,20 +609,18 @@ join_cells(const size_t& index_one, const size_t& index_two, const float& error,
 			new_managing_cell.add_cell(view_cell_two);
 		
 			// Copy visibility data.
-			view_cell_regular* view_cell_regular_one = (view_cell_regular*)view_cell_one;
-			view_cell_regular* view_cell_regular_two = (view_cell_regular*)view_cell_two;
-
 			for(model_t model_index = 0; model_index < ids_.size(); ++model_index)
 			{
-				boost::dynamic_bitset<> bitset_one = boost::dynamic_bitset<>(view_cell_regular_one->get_bitset(model_index));
-				bitset_one.resize(this->get_num_nodes(model_index));
-				boost::dynamic_bitset<> bitset_two = boost::dynamic_bitset<>(view_cell_regular_two->get_bitset(model_index));
-				bitset_two.resize(this->get_num_nodes(model_index));
-
-				boost::dynamic_bitset<> combined_visibility = bitset_one | bitset_two;
-				new_managing_cell.set_bitset(model_index, combined_visibility);
+				// Allocates the bitset of every model at once.
+				if(this->get_num_nodes(model_index) > 0)
+				{
+					new_managing_cell.set_visibility(model_index, this->get_num_nodes(model_index) - 1, false);
+				}
 			}
 
+			new_managing_cell.union_with(view_cell_one);
+			new_managing_cell.union_with(view_cell_two);
+
 			new_managing_cell.set_error(error);
 			managing_cells_.push_back(new_managing_cell);
 
@@ -644,19 +649,7 @@ join_cells(const size_t& index_one, const size_t& index_two, const float& error,
 		if((1.0 - error) - cell_managing->get_error() >= equality_threshold)
 		{
 			// Copy visibility data.
-			view_cell_regular* view_cell_regular_one = (view_cell_regular*)view_cell_one;
-			view_cell_regular* view_cell_regular_two = (view_cell_regular*)view_cell_two;
-
-			for(model_t model_index = 0; model_index < ids_.size(); ++model_index)
-			{
-				boost::dynamic_bitset<> bitset_one = boost::dynamic_bitset<>(view_cell_regular_one->get_bitset(model_index));
-				bitset_one.resize(this->get_num_nodes(model_index));
-				boost::dynamic_bitset<> bitset_two = boost::dynamic_bitset<>(view_cell_regular_two->get_bitset(model_index));
-				bitset_two.resize(this->get_num_nodes(model_index));
-
-				boost::dynamic_bitset<> combined_visibility = bitset_one | bitset_two;
-				view_cell_regular_two->set_bitset(model_index, combined_visibility);
-			}
+			view_cell_two->union_with(view_cell_one);
 
 			// Original view cells don't need to manage visibility data anymore.
 			view_cell_one->clear_visibility_data();
@@ -682,19 +675,7 @@ join_cells(const size_t& index_one, const size_t& index_two, const float& error,
 		if((1.0 - error) - cell_managing->get_error() >= equality_threshold)
 		{
 			// Copy visibility data.
-			view_cell_regular* view_cell_regular_one = (view_cell_regular*)view_cell_one;
-			view_cell_regular* view_cell_regular_two = (view_cell_regular*)view_cell_two;
-
-			for(model_t model_index = 0; model_index < ids_.size(); ++model_index)
-			{
-				boost::dynamic_bitset<> bitset_one = boost::dynamic_bitset<>(view_cell_regular_one->get_bitset(model_index));
-				bitset_one.resize(this->get_num_nodes(model_index));
-				boost::dynamic_bitset<> bitset_two = boost::dynamic_bitset<>(view_cell_regular_two->get_bitset(model_index));
-				bitset_two.resize(this->get_num_nodes(model_index));
-
-				boost::dynamic_bitset<> combined_visibility = bitset_one | bitset_two;
-				view_cell_regular_one->set_bitset(model_index, combined_visibility);
-			}
+			view_cell_one->union_with(view_cell_two);
 
 			// Original view cells don't need to manage visibility data anymore.
 			view_cell_two->clear_visibility_data();
@@ -720,19 +701,7 @@ join_cells(const size_t& index_one, const size_t& index_two, const float& error,
 		if((1.0 - error) - combined_error >= equality_threshold)
 		{
 			// Copy visibility data.
-			view_cell_regular* view_cell_regular_one = (view_cell_regular*)view_cell_one;
-			view_cell_regular* view_cell_regular_two = (view_cell_regular*)view_cell_two;
-
-			for(model_t model_index = 0; model_index < ids_.size(); ++model_index)
-			{
-				boost::dynamic_bitset<> bitset_one = boost::dynamic_bitset<>(view_cell_regular_one->get_bitset(model_index));
-				bitset_one.resize(this->get_num_nodes(model_index));
-				boost::dynamic_bitset<> bitset_two = boost::dynamic_bitset<>(view_cell_regular_two->get_bitset(model_index));
-				bitset_two.resize(this->get_num_nodes(model_index));
-
-				boost::dynamic_bitset<> combined_visibility = bitset_one | bitset_two;
-				view_cell_regular_one->set_bitset(model_index, combined_visibility);
-			}
+			view_cell_one->union_with(view_cell_two);
 
 			// Rewrite mapping and move managed view cells.
 			for(std::map<size_t, size_t>::const_iterator iter = original_index_to_cell_mapping_.begin(); iter != original_index_to_cell_mapping_.end(); ++iter)
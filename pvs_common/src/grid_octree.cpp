@@ -285,6 +285,13 @@ set_cell_visibility(const scm::math::vec3d& position, const model_t& model_id, c
 }
 
 
+void grid_octree::
+union_cell_visibility(const size_t& cell_index, const model_t& model_id, const uint64_t* words, const node_t& num_nodes)
+{
+	view_cell* view_node = cells_by_indices_[cell_index];
+	view_node->union_with_words(model_id, words, num_nodes);
+}
+
 void grid_octree::
 save_grid_to_file(const std::string& file_path) const
 {
@@ -613,7 +620,7 @@ load_cell_visibility_from_file(const std::string& file_path, const size_t& cell_
 void grid_octree::
 clear_cell_visibility(const size_t& cell_index)
 {
-	if(this->get_num_models() <= cell_index)
+	if(this->get_cell_count() <= cell_index)
 	{
 		return;
 	}
@@ -157,7 +157,7 @@ load_visibility_from_file(const std::string& file_path)
 	// Read access points to data blocks.
 	visibility_block_sizes_.clear();
 
-	for(size_t current_block_index = 0; current_block_index < this->get_cell_count(); ++current_block_index)
+	for(size_t current_block_index = 0; current_block_index < cells_by_indices_.size(); ++current_block_index)
 	{
 		uint64_t block_size;
 		file_in.read(reinterpret_cast<char*>(&block_size), sizeof(block_size));
@@ -167,7 +167,7 @@ load_visibility_from_file(const std::string& file_path)
 	// Read compressed data blocks.
 	std::vector<std::string> compressed_data_blocks;
 
-	for(size_t current_block_index = 0; current_block_index < this->get_cell_count(); ++current_block_index)
+	for(size_t current_block_index = 0; current_block_index < cells_by_indices_.size(); ++current_block_index)
 	{
 		size_t block_size = visibility_block_sizes_[current_block_index];
     std::vector<char> current_block_data(block_size);
@@ -223,47 +223,57 @@ load_visibility_from_file(const std::string& file_path)
 bool grid_octree_compressed::
 load_cell_visibility_from_file(const std::string& file_path, const size_t& cell_index)
 {
-	std::lock_guard<std::mutex> lock(mutex_);
+	// The file header is read under lock, the data block of the cell is read, decompressed and applied without it,
+	// so loads of different cells may run concurrently.
+	view_cell* current_cell = nullptr;
+	size_t block_size = 0;
+	size_t file_position = 0;
 
-	view_cell* current_cell = cells_by_indices_[cell_index];
+	std::fstream file_in;
 
-	// First check if visibility data is already loaded.
-	if(current_cell->contains_visibility_data())
 	{
-		return true;
-	}
+		std::lock_guard<std::mutex> lock(mutex_);
 
-	// If no visibility data exists, open the file and load them.
-	std::fstream file_in;
-	file_in.open(file_path, std::ios::in | std::ios::binary);
+		current_cell = cells_by_indices_[cell_index];
 
-	if(!file_in.is_open())
-	{
-		return false;
-	}
+		// First check if visibility data is already loaded.
+		if(current_cell->contains_visibility_data())
+		{
+			return true;
+		}
 
-	if(visibility_block_sizes_.size() == 0)
-	{
-		// Read access points to data blocks.
-		for(size_t current_block_index = 0; current_block_index < this->get_cell_count(); ++current_block_index)
+		// If no visibility data exists, open the file and load them.
+		file_in.open(file_path, std::ios::in | std::ios::binary);
+
+		if(!file_in.is_open())
 		{
-			uint64_t block_size;
-			file_in.read(reinterpret_cast<char*>(&block_size), sizeof(block_size));
-			visibility_block_sizes_.push_back(block_size);
+			return false;
+		}
+
+		if(visibility_block_sizes_.size() == 0)
+		{
+			// Read access points to data blocks.
+			for(size_t current_block_index = 0; current_block_index < cells_by_indices_.size(); ++current_block_index)
+			{
+				uint64_t block_size;
+				file_in.read(reinterpret_cast<char*>(&block_size), sizeof(block_size));
+				visibility_block_sizes_.push_back(block_size);
+			}
+		}
+
+		block_size = visibility_block_sizes_[cell_index];
+
+		// Find proper position in file. First data is compresses block sizes (one 64 bit integer per view cell).
+		file_position = visibility_block_sizes_.size() * sizeof(uint64_t);
+		for(size_t visibility_cell_index = 0; visibility_cell_index < cell_index; ++visibility_cell_index)
+		{
+			file_position += visibility_block_sizes_[visibility_cell_index];
 		}
 	}
 
 	// Read compressed data block.
-	size_t block_size = visibility_block_sizes_[cell_index];
   std::vector<char> current_block_data(block_size);
 
-	// Find proper position in file. First data is compresses block sizes (one 64 bit integer per view cell).
-	size_t file_position = visibility_block_sizes_.size() * sizeof(uint64_t);
-	for(size_t visibility_cell_index = 0; visibility_cell_index < cell_index; ++visibility_cell_index)
-	{
-		file_position += visibility_block_sizes_[visibility_cell_index];
-	}
-
 	file_in.seekg(file_position);
 	file_in.read(&current_block_data[0], block_size);
 	std::string compressed_data_block(&current_block_data[0], block_size);
@@ -277,7 +287,7 @@ load_cell_visibility_from_file(const std::string& file_path, const size_t& cell_
 	inbuf.push(stream_compressed);
 	boost::iostreams::copy(inbuf, stream_uncompressed);
 
-	// Apply visibility data.
+	// Apply visibility data. Bytes hold the nodes in ascending bit order, so they are packed into words and set at once.
 	for(model_t model_index = 0; model_index < ids_.size(); ++model_index)
 	{
 		node_t num_nodes = ids_.at(model_index);
@@ -286,19 +296,21 @@ load_cell_visibility_from_file(const std::string& file_path, const size_t& cell_
 
 		stream_uncompressed.read(&current_line_data[0], line_length);
 
-		// Used to avoid continuing resize within visibility data.
-		current_cell->set_visibility(model_index, num_nodes - 1, false);
+		std::vector<uint64_t> words((num_nodes + 63) / 64, 0);
 
 		for(node_t character_index = 0; character_index < line_length; ++character_index)
 		{
-			char current_byte = current_line_data[character_index];
-			
-			for(unsigned short bit_index = 0; bit_index < CHAR_BIT; ++bit_index)
-			{
-				bool visible = ((current_byte >> bit_index) & 1) == 0x01;
-				current_cell->set_visibility(model_index, (character_index * CHAR_BIT) + bit_index, visible);
-			}
+			uint64_t current_byte = (unsigned char)current_line_data[character_index];
+			words[character_index / 8] |= current_byte << ((character_index % 8) * CHAR_BIT);
 		}
+
+		// Padding bits of the last byte are no nodes.
+		if(num_nodes % 64 != 0)
+		{
+			words.back() &= ((uint64_t)1 << (num_nodes % 64)) - 1;
+		}
+
+		current_cell->union_with_words(model_index, words.data(), num_nodes);
 	}
 
 	file_in.close();
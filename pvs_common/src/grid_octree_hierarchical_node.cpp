@@ -134,39 +134,102 @@ combine_visibility(const std::vector<node_t>& ids, const unsigned short& num_all
 			current_child_node->combine_visibility(ids, num_allowed_unequal_elements);
 		}
 
+		// Children see the visibility of all hierarchical parents.
+		std::vector<const grid_octree_hierarchical_node*> visibility_sources;
+
+		for(const grid_octree_hierarchical_node* node = this; node != nullptr; node = node->hierarchical_storage_ ? node->parent_ : nullptr)
+		{
+			visibility_sources.push_back(node);
+		}
+
+		// An element is moved to the parent if at least this many children see it.
+		unsigned short num_required_elements = num_allowed_unequal_elements < 8 ? 8 - num_allowed_unequal_elements : 0;
+
 		for(model_t model_index = 0; model_index < ids.size(); ++model_index)
 		{
-			for(node_t node_index = 0; node_index < ids[model_index]; ++node_index)
+			size_t num_words = (ids[model_index] + 63) / 64;
+			std::vector<uint64_t> moved_words(num_words, 0);
+			node_t num_moved_nodes = 0;
+
+			for(size_t word_index = 0; word_index < num_words; ++word_index)
 			{
-				unsigned short non_appearance_counter = 0;
+				uint64_t inherited_word = 0;
+
+				for(const grid_octree_hierarchical_node* source : visibility_sources)
+				{
+					inherited_word |= source->get_visibility_word(model_index, word_index);
+				}
+
+				// Bit-sliced counters of how many children see each element.
+				uint64_t count_bits[4] = {0, 0, 0, 0};
 
-				// Count how often the index doesn't appear (allows faster skip of the current ID).
 				for(size_t child_index = 0; child_index < 8; ++child_index)
 				{
-					grid_octree_node* current_child_node = this->get_child_at_index(child_index);
+					const grid_octree_hierarchical_node* child_node = (const grid_octree_hierarchical_node*)this->get_child_at_index(child_index);
+					uint64_t carry = child_node->get_visibility_word(model_index, word_index) | inherited_word;
 
-					if(!current_child_node->get_visibility(model_index, node_index))
+					for(size_t bit = 0; bit < 4; ++bit)
 					{
-						non_appearance_counter++;
-
-						if(non_appearance_counter > num_allowed_unequal_elements)
-						{
-							break;
-						}
+						uint64_t sum = count_bits[bit] ^ carry;
+						carry &= count_bits[bit];
+						count_bits[bit] = sum;
 					}
 				}
 
-				// If an element is common among all children (or a given threshold of children) it is moved to the parent.
-				if(non_appearance_counter <= num_allowed_unequal_elements)
+				// Compare the counters to the required number of children.
+				uint64_t greater = 0;
+				uint64_t equal = ~(uint64_t)0;
+
+				for(size_t bit = 4; bit-- > 0;)
+				{
+					uint64_t required = ((num_required_elements >> bit) & 1) ? ~(uint64_t)0 : 0;
+					greater |= equal & count_bits[bit] & ~required;
+					equal &= ~(count_bits[bit] ^ required);
+				}
+
+				uint64_t moved_word = greater | equal;
+
+				if(word_index == num_words - 1 && ids[model_index] % 64 != 0)
 				{
-					this->set_visibility(model_index, node_index, true);
+					moved_word &= ((uint64_t)1 << (ids[model_index] % 64)) - 1;
+				}
+
+				if(moved_word != 0)
+				{
+					moved_words[word_index] = moved_word;
+					num_moved_nodes = word_index * 64 + 64;
 
-					for(size_t child_index = 0; child_index < 8; ++child_index)
+					while(((moved_word >> ((num_moved_nodes - 1) % 64)) & 1) == 0)
 					{
-						this->get_child_at_index(child_index)->set_visibility(model_index, node_index, false);
+						--num_moved_nodes;
 					}
 				}
 			}
+
+			if(num_moved_nodes == 0)
+			{
+				continue;
+			}
+
+			// If an element is common among all children (or a given threshold of children) it is moved to the parent.
+			size_t num_moved_words = (num_moved_nodes + 63) / 64;
+			uint64_t* words = this->get_visibility_words_for_write(model_index, num_moved_nodes);
+
+			for(size_t word_index = 0; word_index < num_moved_words; ++word_index)
+			{
+				words[word_index] |= moved_words[word_index];
+			}
+
+			for(size_t child_index = 0; child_index < 8; ++child_index)
+			{
+				grid_octree_hierarchical_node* child_node = (grid_octree_hierarchical_node*)this->get_child_at_index(child_index);
+				uint64_t* child_words = child_node->get_visibility_words_for_write(model_index, num_moved_nodes);
+
+				for(size_t word_index = 0; word_index < num_moved_words; ++word_index)
+				{
+					child_words[word_index] &= ~moved_words[word_index];
+				}
+			}
 		}
 	}
 }
@@ -195,5 +258,20 @@ get_parent_node()
 	return parent_;
 }
 
+bool grid_octree_hierarchical_node::
+has_inherited_visibility() const
+{
+	return hierarchical_storage_ && parent_ != nullptr;
+}
+
+uint64_t grid_octree_hierarchical_node::
+get_visibility_word(const model_t& object_id, const size_t& word_index) const
+{
+	size_t num_words = 0;
+	const uint64_t* words = this->get_visibility_words(object_id, num_words);
+
+	return word_index < num_words ? words[word_index] : 0;
+}
+
 }
 }
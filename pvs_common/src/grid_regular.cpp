@@ -147,6 +147,13 @@ set_cell_visibility(const scm::math::vec3d& position, const model_t& model_id, c
 	}
 }
 
+void grid_regular::
+union_cell_visibility(const size_t& cell_index, const model_t& model_id, const uint64_t* words, const node_t& num_nodes)
+{
+	view_cell* current_visibility_cell = cells_[cell_index];
+	current_visibility_cell->union_with_words(model_id, words, num_nodes);
+}
+
 void grid_regular::
 save_grid_to_file(const std::string& file_path) const
 {
@@ -354,7 +361,7 @@ load_visibility_from_file(const std::string& file_path)
 void grid_regular::
 clear_cell_visibility(const size_t& cell_index)
 {
-	if(this->get_num_models() <= cell_index)
+	if(this->get_cell_count() <= cell_index)
 	{
 		return;
 	}
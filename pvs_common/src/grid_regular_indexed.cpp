@@ -0,0 +1,137 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group 
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#include "lamure/pvs/grid_regular_indexed.h"
+
+namespace lamure
+{
+namespace pvs
+{
+
+grid_regular_indexed::
+grid_regular_indexed() : grid_regular_indexed(1, 1.0, scm::math::vec3d(0.0, 0.0, 0.0), std::vector<node_t>())
+{
+}
+
+grid_regular_indexed::
+grid_regular_indexed(const size_t& number_cells, const double& cell_size, const scm::math::vec3d& position_center, const std::vector<node_t>& ids) : grid_regular(number_cells, cell_size, position_center, ids)
+{
+}
+
+grid_regular_indexed::
+~grid_regular_indexed()
+{
+}
+
+std::string grid_regular_indexed::
+get_grid_type() const
+{
+	return get_grid_identifier();
+}
+
+std::string grid_regular_indexed::
+get_grid_identifier()
+{
+	return "regular_indexed";
+}
+
+void grid_regular_indexed::
+save_grid_to_file(const std::string& file_path) const
+{
+	save_regular_grid(file_path, get_grid_identifier());
+}
+
+void grid_regular_indexed::
+save_visibility_to_file(const std::string& file_path) const
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	// The new file replaces the mapped one, loads running meanwhile keep their mapping and the next load maps the new file.
+	if(block_file_ != nullptr && block_file_->get_file_path() == file_path)
+	{
+		block_file_.reset();
+	}
+
+	std::vector<const view_cell*> cells(cells_.begin(), cells_.end());
+	visibility_block_file::save(file_path, cells, ids_, block_settings_);
+}
+
+bool grid_regular_indexed::
+load_grid_from_file(const std::string& file_path)
+{
+	return load_regular_grid(file_path, get_grid_identifier());
+}
+
+bool grid_regular_indexed::
+load_visibility_from_file(const std::string& file_path)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	std::shared_ptr<visibility_block_file> block_file = std::make_shared<visibility_block_file>();
+
+	if(!block_file->open(file_path, cells_.size(), ids_))
+	{
+		return false;
+	}
+
+	block_file_ = block_file;
+
+	std::vector<view_cell*> cells(cells_.begin(), cells_.end());
+	return block_file->load_cells(cells, block_settings_.num_threads);
+}
+
+bool grid_regular_indexed::
+load_cell_visibility_from_file(const std::string& file_path, const size_t& cell_index)
+{
+	// Only mapping the file needs the lock, blocks of different cells are decoded concurrently. Each load holds on to
+	// the mapping it decodes from, so mapping another file meanwhile does not unmap it.
+	view_cell* current_cell = nullptr;
+	std::shared_ptr<const visibility_block_file> block_file;
+
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		current_cell = cells_[cell_index];
+
+		// First check if visibility data is already loaded.
+		if(current_cell->contains_visibility_data())
+		{
+			return true;
+		}
+
+		if(block_file_ == nullptr || block_file_->get_file_path() != file_path)
+		{
+			std::shared_ptr<visibility_block_file> opened_file = std::make_shared<visibility_block_file>();
+
+			if(!opened_file->open(file_path, cells_.size(), ids_))
+			{
+				return false;
+			}
+
+			block_file_ = opened_file;
+		}
+
+		block_file = block_file_;
+	}
+
+	return block_file->load_cell(cell_index, current_cell);
+}
+
+void grid_regular_indexed::
+set_block_settings(const visibility_block_settings& settings)
+{
+	block_settings_ = settings;
+}
+
+const visibility_block_settings& grid_regular_indexed::
+get_block_settings() const
+{
+	return block_settings_;
+}
+
+}
+}
@@ -6,67 +6,464 @@
 // http://www.uni-weimar.de/medien/vr
 
 #include "lamure/pvs/id_histogram.h"
-#include <iostream>
-#include <fstream>
-#include <bitset>
+#include "lamure/pvs/grid.h"
+
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
 
 namespace lamure
 {
 namespace pvs
 {
 
+namespace
+{
+
+// Images smaller than this are not worth starting threads for.
+const size_t MIN_PIXELS_PER_THREAD = 1 << 18;
+
+// Blocks until all threads of the reduction have arrived.
+class thread_barrier
+{
+public:
+	thread_barrier(const unsigned int& num_threads)
+	{
+		num_threads_ = num_threads;
+		num_waiting_ = 0;
+		generation_ = 0;
+	}
+
+	void wait()
+	{
+		std::unique_lock<std::mutex> lock(mutex_);
+		size_t generation = generation_;
+
+		if(++num_waiting_ == num_threads_)
+		{
+			num_waiting_ = 0;
+			++generation_;
+			condition_.notify_all();
+		}
+		else
+		{
+			condition_.wait(lock, [&]{ return generation != generation_; });
+		}
+	}
+
+private:
+	std::mutex mutex_;
+	std::condition_variable condition_;
+	unsigned int num_threads_;
+	unsigned int num_waiting_;
+	size_t generation_;
+};
+
+}
+
+// Threads which run the same task for every image, each with its own thread index.
+class id_histogram::worker_pool
+{
+public:
+	worker_pool(const unsigned int& num_workers)
+	{
+		task_ = nullptr;
+		num_task_threads_ = 0;
+		num_running_ = 0;
+		generation_ = 0;
+		shutdown_ = false;
+
+		for(unsigned int worker_index = 0; worker_index < num_workers; ++worker_index)
+		{
+			threads_.push_back(std::thread(&worker_pool::worker_loop, this, worker_index + 1));
+		}
+	}
+
+	~worker_pool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			shutdown_ = true;
+		}
+
+		start_condition_.notify_all();
+
+		for(std::thread& thread : threads_)
+		{
+			thread.join();
+		}
+	}
+
+	// Runs the task with thread indices below num_threads, index 0 on the calling thread, and returns once all are done.
+	void run(const unsigned int& num_threads, const std::function<void(unsigned int)>& task)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			task_ = &task;
+			num_task_threads_ = num_threads;
+			num_running_ = num_threads - 1;
+			++generation_;
+		}
+
+		start_condition_.notify_all();
+		task(0);
+
+		std::unique_lock<std::mutex> lock(mutex_);
+		done_condition_.wait(lock, [&]{ return num_running_ == 0; });
+		task_ = nullptr;
+	}
+
+private:
+	void worker_loop(const unsigned int& thread_index)
+	{
+		size_t generation = 0;
+
+		while(true)
+		{
+			const std::function<void(unsigned int)>* task = nullptr;
+
+			{
+				std::unique_lock<std::mutex> lock(mutex_);
+				start_condition_.wait(lock, [&]{ return shutdown_ || generation != generation_; });
+
+				if(shutdown_)
+				{
+					return;
+				}
+
+				generation = generation_;
+
+				// Smaller images do not need all threads.
+				if(thread_index >= num_task_threads_)
+				{
+					continue;
+				}
+
+				task = task_;
+			}
+
+			(*task)(thread_index);
+
+			std::lock_guard<std::mutex> lock(mutex_);
+
+			if(--num_running_ == 0)
+			{
+				done_condition_.notify_one();
+			}
+		}
+	}
+
+	std::vector<std::thread> threads_;
+	std::mutex mutex_;
+	std::condition_variable start_condition_;
+	std::condition_variable done_condition_;
+
+	const std::function<void(unsigned int)>* task_;
+	unsigned int num_task_threads_;
+	unsigned int num_running_;
+	size_t generation_;
+	bool shutdown_;
+};
+
 id_histogram::id_histogram()
+	: id_histogram(std::vector<node_t>())
 {
 }
 
+id_histogram::id_histogram(const std::vector<node_t>& numNodes, const unsigned int& numThreads)
+{
+	num_nodes_ = numNodes;
+	num_threads_ = numThreads > 0 ? numThreads : std::max(1u, std::thread::hardware_concurrency());
+
+	counts_.resize(num_threads_);
+	counted_ids_.resize(num_threads_);
+}
+
+id_histogram::id_histogram(id_histogram&& other) = default;
+
 id_histogram::~id_histogram()
 {
 }
 
+id_histogram& id_histogram::
+operator=(id_histogram&& other) = default;
+
 void id_histogram::
 create(const void* pixelData, const size_t& numPixels)
 {
-	histogram_.clear();
 	const unsigned int* pixelDataInt = (unsigned int*)pixelData;
 
-	for(size_t index = 0; index < numPixels; ++index)
+	for(unsigned int threadIndex = 0; threadIndex < num_threads_; ++threadIndex)
 	{
-		unsigned int pixelValue = pixelDataInt[index];
-		model_t modelID = (pixelValue >> 24) & 0xFF;					// RGBA-value is written in order AGBR, so skip 24 bits to get to model ID within alpha channel.
+		clear_counts(threadIndex);
+	}
 
-		modelID = 255 - modelID;										// Debug thingie. Helps to create a more visible object by starting at higher alpha values.
+	unsigned int numThreads = (unsigned int)std::min((size_t)num_threads_, std::max((size_t)1, numPixels / MIN_PIXELS_PER_THREAD));
 
-		if(modelID != 255)
+	if(numThreads == 1)
+	{
+		count_pixels(pixelDataInt, 0, numPixels, 0);
+		return;
+	}
+
+	// Every thread counts a contiguous part of the image, then the partial histograms are merged pairwise
+	// until the first thread holds all counts.
+	thread_barrier barrier(numThreads);
+
+	auto worker = [&](unsigned int threadIndex)
+	{
+		size_t firstPixel = (numPixels * threadIndex) / numThreads;
+		size_t lastPixel = (numPixels * (threadIndex + 1)) / numThreads;
+		count_pixels(pixelDataInt, firstPixel, lastPixel, threadIndex);
+
+		for(unsigned int stride = 1; stride < numThreads; stride *= 2)
 		{
-			node_t nodeID = pixelValue & 0xFFFFFF;						// RGBA-value is written in order AGBR, so first 24 bits are node ID.
-			histogram_[modelID][nodeID]++;
+			barrier.wait();
+
+			if(threadIndex % (2 * stride) == 0 && threadIndex + stride < numThreads)
+			{
+				merge_counts(threadIndex, threadIndex + stride);
+			}
 		}
+	};
+
+	if(workers_ == nullptr)
+	{
+		workers_.reset(new worker_pool(num_threads_ - 1));
 	}
+
+	workers_->run(numThreads, worker);
 }
 
 std::map<model_t, std::vector<node_t>> id_histogram::
 get_visible_nodes(const size_t& numPixels, const float& visibilityThreshold) const
 {
 	std::map<model_t, std::vector<node_t>> visibleNodes;
+	size_t minCount = get_min_visible_count(numPixels, visibilityThreshold);
 
-	for(std::map<model_t, std::map<node_t, size_t>>::const_iterator modelIter = histogram_.begin(); modelIter != histogram_.end(); ++modelIter)
+	for(const uint32_t& id : counted_ids_[0])
 	{
-		for(std::map<node_t, size_t>::const_iterator nodeIter = modelIter->second.begin(); nodeIter != modelIter->second.end(); ++nodeIter)
+		model_t modelID = id >> 24;
+		node_t nodeID = id & 0xFFFFFF;
+
+		if(counts_[0][modelID][nodeID] >= minCount)
 		{
-			if(((float)nodeIter->second / (float)numPixels) * 100.0f >= visibilityThreshold)
-			{
-				visibleNodes[modelIter->first].push_back(nodeIter->first);
-			}
+			visibleNodes[modelID].push_back(nodeID);
 		}
 	}
 
+	for(std::map<model_t, std::vector<node_t>>::iterator modelIter = visibleNodes.begin(); modelIter != visibleNodes.end(); ++modelIter)
+	{
+		std::sort(modelIter->second.begin(), modelIter->second.end());
+	}
+
 	return visibleNodes;
 }
 
 std::map<model_t, std::map<node_t, size_t>> id_histogram::
 get_histogram() const
 {
-	return histogram_;
+	std::map<model_t, std::map<node_t, size_t>> histogram;
+
+	for(const uint32_t& id : counted_ids_[0])
+	{
+		model_t modelID = id >> 24;
+		node_t nodeID = id & 0xFFFFFF;
+		histogram[modelID][nodeID] = counts_[0][modelID][nodeID];
+	}
+
+	return histogram;
+}
+
+void id_histogram::
+set_cell_visibility(grid* visibilityGrid, const size_t& cellIndex, const size_t& numPixels, const float& visibilityThreshold)
+{
+	size_t minCount = get_min_visible_count(numPixels, visibilityThreshold);
+	std::vector<node_t> numVisibleWordNodes(visible_words_.size(), 0);
+
+	for(const uint32_t& id : counted_ids_[0])
+	{
+		model_t modelID = id >> 24;
+		node_t nodeID = id & 0xFFFFFF;
+
+		if(counts_[0][modelID][nodeID] < minCount)
+		{
+			continue;
+		}
+
+		if(visible_words_.size() <= modelID)
+		{
+			visible_words_.resize(modelID + 1);
+			numVisibleWordNodes.resize(modelID + 1, 0);
+		}
+
+		std::vector<uint64_t>& words = visible_words_[modelID];
+
+		if(words.size() <= nodeID / 64)
+		{
+			words.resize(std::max((size_t)(nodeID / 64 + 1), (size_t)(modelID < num_nodes_.size() ? (num_nodes_[modelID] + 63) / 64 : 0)), 0);
+		}
+
+		words[nodeID / 64] |= (uint64_t)1 << (nodeID % 64);
+		numVisibleWordNodes[modelID] = std::max(numVisibleWordNodes[modelID], nodeID + 1);
+	}
+
+	for(model_t modelID = 0; modelID < numVisibleWordNodes.size(); ++modelID)
+	{
+		if(numVisibleWordNodes[modelID] == 0)
+		{
+			continue;
+		}
+
+		std::vector<uint64_t>& words = visible_words_[modelID];
+		visibilityGrid->union_cell_visibility(cellIndex, modelID, words.data(), numVisibleWordNodes[modelID]);
+
+		// Only the words up to the last visible node were touched.
+		std::fill(words.begin(), words.begin() + (numVisibleWordNodes[modelID] + 63) / 64, 0);
+	}
+}
+
+void id_histogram::
+count_pixels(const unsigned int* pixelDataInt, const size_t& firstPixel, const size_t& lastPixel, const unsigned int& threadIndex)
+{
+	std::vector<uint32_t>& countedIDs = counted_ids_[threadIndex];
+
+	// Counters of the model seen last, most pixels in a row belong to the same model.
+	model_t currentModelID = 255;
+	uint32_t* modelCounts = nullptr;
+	size_t numModelCounts = 0;
+
+	// Neighbouring pixels mostly show the same node, so equal pixel values are counted as runs.
+	size_t index = firstPixel;
+
+	while(index < lastPixel)
+	{
+		unsigned int pixelValue = pixelDataInt[index];
+		size_t runEnd = index + 1;
+
+		while(runEnd < lastPixel && pixelDataInt[runEnd] == pixelValue)
+		{
+			++runEnd;
+		}
+
+		model_t modelID = (pixelValue >> 24) & 0xFF;					// RGBA-value is written in order AGBR, so skip 24 bits to get to model ID within alpha channel.
+
+		modelID = 255 - modelID;										// Debug thingie. Helps to create a more visible object by starting at higher alpha values.
+
+		if(modelID != 255)
+		{
+			node_t nodeID = pixelValue & 0xFFFFFF;						// RGBA-value is written in order AGBR, so first 24 bits are node ID.
+
+			if(modelID != currentModelID || nodeID >= numModelCounts)
+			{
+				get_counts_for_write(threadIndex, modelID, nodeID);
+
+				currentModelID = modelID;
+				modelCounts = counts_[threadIndex][modelID].data();
+				numModelCounts = counts_[threadIndex][modelID].size();
+			}
+
+			uint32_t& count = modelCounts[nodeID];
+
+			if(count == 0)
+			{
+				countedIDs.push_back((uint32_t)((modelID << 24) | nodeID));
+			}
+
+			count += (uint32_t)(runEnd - index);
+		}
+
+		index = runEnd;
+	}
+}
+
+void id_histogram::
+merge_counts(const unsigned int& targetIndex, const unsigned int& sourceIndex)
+{
+	for(const uint32_t& id : counted_ids_[sourceIndex])
+	{
+		model_t modelID = id >> 24;
+		node_t nodeID = id & 0xFFFFFF;
+
+		uint32_t& sourceCount = counts_[sourceIndex][modelID][nodeID];
+		uint32_t* targetCount = get_counts_for_write(targetIndex, modelID, nodeID);
+
+		if(*targetCount == 0)
+		{
+			counted_ids_[targetIndex].push_back(id);
+		}
+
+		*targetCount += sourceCount;
+		sourceCount = 0;
+	}
+
+	counted_ids_[sourceIndex].clear();
+}
+
+void id_histogram::
+clear_counts(const unsigned int& threadIndex)
+{
+	// Only the counted nodes are reset, so the cost does not depend on the number of nodes.
+	for(const uint32_t& id : counted_ids_[threadIndex])
+	{
+		counts_[threadIndex][id >> 24][id & 0xFFFFFF] = 0;
+	}
+
+	counted_ids_[threadIndex].clear();
+}
+
+uint32_t* id_histogram::
+get_counts_for_write(const unsigned int& threadIndex, const model_t& modelID, const node_t& nodeID)
+{
+	std::vector<std::vector<uint32_t>>& modelCounts = counts_[threadIndex];
+
+	if(modelCounts.size() <= modelID)
+	{
+		modelCounts.resize(std::max((size_t)(modelID + 1), num_nodes_.size()));
+
+		for(model_t modelIndex = 0; modelIndex < num_nodes_.size(); ++modelIndex)
+		{
+			modelCounts[modelIndex].resize(num_nodes_[modelIndex], 0);
+		}
+	}
+
+	std::vector<uint32_t>& nodeCounts = modelCounts[modelID];
+
+	// IDs beyond the expected number of nodes are counted as well, their counters are grown on demand.
+	if(nodeCounts.size() <= nodeID)
+	{
+		nodeCounts.resize(nodeID + 1, 0);
+	}
+
+	return &nodeCounts[nodeID];
+}
+
+size_t id_histogram::
+get_min_visible_count(const size_t& numPixels, const float& visibilityThreshold) const
+{
+	// Smallest count passing the percentage test of the former map based histogram, which compared in float.
+	auto is_visible = [&](const size_t& count)
+	{
+		return ((float)count / (float)numPixels) * 100.0f >= visibilityThreshold;
+	};
+
+	size_t minCount = (size_t)std::max(0.0, std::ceil((double)visibilityThreshold * 0.01 * (double)numPixels));
+
+	while(minCount > 1 && is_visible(minCount - 1))
+	{
+		--minCount;
+	}
+
+	while(minCount <= numPixels && !is_visible(minCount))
+	{
+		++minCount;
+	}
+
+	// Only nodes which were seen at all are listed.
+	return std::max((size_t)1, minCount);
 }
 
 }
@@ -11,26 +11,45 @@
 #include "lamure/pvs/pvs_database.h"
 #include "lamure/pvs/grid_regular.h"
 #include "lamure/pvs/grid_regular_compressed.h"
+#include "lamure/pvs/grid_regular_indexed.h"
 #include "lamure/pvs/grid_octree.h"
 #include "lamure/pvs/grid_octree_compressed.h"
+#include "lamure/pvs/grid_octree_indexed.h"
 #include "lamure/pvs/grid_octree_hierarchical.h"
 #include "lamure/pvs/grid_octree_hierarchical_v2.h"
 #include "lamure/pvs/grid_octree_hierarchical_v3.h"
 #include "lamure/pvs/grid_irregular.h"
 #include "lamure/pvs/grid_irregular_compressed.h"
+#include "lamure/pvs/grid_irregular_indexed.h"
 #include "lamure/pvs/grid_bounding.h"
 
+#include <algorithm>
 #include <iostream>
+#include <limits>
 
 namespace lamure
 {
 namespace pvs
 {
 
+namespace
+{
+
+const size_t NO_CELL = std::numeric_limits<size_t>::max();
+
+}
+
 pvs_database* pvs_database::instance_ = nullptr;
 
+// Decompressing a cell takes longer than reading it, so several cells are loaded at once.
 pvs_database::
 pvs_database()
+	: pvs_database(std::max(1u, std::min(4u, std::thread::hardware_concurrency() / 2)))
+{
+}
+
+pvs_database::
+pvs_database(const unsigned int& num_loading_threads)
 {
 	visibility_grid_ = nullptr;
 	bounding_grid_ = nullptr;
@@ -38,13 +57,23 @@ pvs_database()
 	activated_ = true;
 	do_preload_ = false;
 	shutdown_ = false;
+
+	max_cached_cells_ = 64;
+	num_prefetched_cells_ = 3;
+	viewer_cell_index_ = NO_CELL;
+	viewer_cell_loaded_ = false;
+	viewer_velocity_ = scm::math::vec3d(0.0, 0.0, 0.0);
+	viewer_position_time_ = std::chrono::steady_clock::now();
+	reset_prefetch_statistics();
 	
 	//configure semaphore
   semaphore_.set_min_signal_count(1);
   semaphore_.set_max_signal_count(std::numeric_limits<size_t>::max());
-	
-	visibility_data_loading_thread_ = std::thread(&pvs_database::loading_thread_loop, this);
-	
+
+	for(unsigned int thread_index = 0; thread_index < num_loading_threads; ++thread_index)
+	{
+		visibility_data_loading_threads_.push_back(std::thread(&pvs_database::loading_thread_loop, this));
+	}
 }
 
 pvs_database::
@@ -53,9 +82,12 @@ pvs_database::
   shutdown_ = true;
   semaphore_.shutdown();
 
-	if(visibility_data_loading_thread_.joinable())
+	for(std::thread& loading_thread : visibility_data_loading_threads_)
 	{
-		visibility_data_loading_thread_.join();
+		if(loading_thread.joinable())
+		{
+			loading_thread.join();
+		}
 	}
 	
 	if(visibility_grid_ != nullptr)
@@ -81,6 +113,7 @@ load_pvs_from_file(const std::string& grid_file_path, const std::string& pvs_fil
 	std::lock_guard<std::mutex> lock(mutex_);
 
 	do_preload_ = do_preload;
+	reset_cache();
 	visibility_grid_ = load_grid_from_file(grid_file_path);
 
 	if(visibility_grid_ == nullptr)
@@ -220,6 +253,10 @@ create_grid_by_type(const std::string& grid_type) const
     {
         output_grid = new grid_regular_compressed();
     }
+    else if(grid_type == grid_regular_indexed::get_grid_identifier())
+    {
+        output_grid = new grid_regular_indexed();
+    }
     else if(grid_type == grid_octree::get_grid_identifier())
     {   
         output_grid = new grid_octree();
@@ -228,6 +265,10 @@ create_grid_by_type(const std::string& grid_type) const
     {
     	output_grid = new grid_octree_compressed();
     }
+    else if(grid_type == grid_octree_indexed::get_grid_identifier())
+    {
+        output_grid = new grid_octree_indexed();
+    }
     else if(grid_type == grid_octree_hierarchical::get_grid_identifier())
     {
         output_grid = new grid_octree_hierarchical();
@@ -248,6 +289,10 @@ create_grid_by_type(const std::string& grid_type) const
     {
         output_grid = new grid_irregular_compressed();
     }
+    else if(grid_type == grid_irregular_indexed::get_grid_identifier())
+    {
+        output_grid = new grid_irregular_indexed();
+    }
 
     return output_grid;
 }
@@ -267,6 +312,10 @@ create_grid_by_type(const std::string& grid_type, const size_t& num_cells_x, con
     {
         output_grid = new grid_regular_compressed(max_num_cells, bounds_size, position_center, ids);
     }
+    else if(grid_type == grid_regular_indexed::get_grid_identifier())
+    {
+        output_grid = new grid_regular_indexed(max_num_cells, bounds_size, position_center, ids);
+    }
     else if(grid_type == grid_octree::get_grid_identifier())
     {   
         output_grid = new grid_octree(max_num_cells, bounds_size, position_center, ids);
@@ -275,6 +324,10 @@ create_grid_by_type(const std::string& grid_type, const size_t& num_cells_x, con
     {   
         output_grid = new grid_octree_compressed(max_num_cells, bounds_size, position_center, ids);
     }
+    else if(grid_type == grid_octree_indexed::get_grid_identifier())
+    {
+        output_grid = new grid_octree_indexed(max_num_cells, bounds_size, position_center, ids);
+    }
     else if(grid_type == grid_octree_hierarchical::get_grid_identifier())
     {
         output_grid = new grid_octree_hierarchical(max_num_cells, bounds_size, position_center, ids);
@@ -295,6 +348,10 @@ create_grid_by_type(const std::string& grid_type, const size_t& num_cells_x, con
     {
     	output_grid = new grid_irregular_compressed(num_cells_x, num_cells_y, num_cells_z, bounds_size, position_center, ids);
     }
+    else if(grid_type == grid_irregular_indexed::get_grid_identifier())
+    {
+    	output_grid = new grid_irregular_indexed(num_cells_x, num_cells_y, num_cells_z, bounds_size, position_center, ids);
+    }
 
     return output_grid;
 }
@@ -310,18 +367,40 @@ loading_thread_loop() {
       break;
     }
     
-    int64_t cell_index = -1;
-    if (loading_queue_.size() > 0) {
-      loading_mutex_.lock();
+    size_t cell_index = NO_CELL;
+    {
+      std::lock_guard<std::mutex> lock(loading_mutex_);
       if (loading_queue_.size() > 0) {
         cell_index = loading_queue_.front();
-        loading_queue_.pop();
+        loading_queue_.pop_front();
+        queued_cell_indices_.erase(cell_index);
+        cells_in_loading_.insert(cell_index);
       }
-      loading_mutex_.unlock();
     }
     
-    if (cell_index >= 0) {
-      load_visibility_data_async(cell_index);
+    if (cell_index == NO_CELL) {
+      continue;
+    }
+
+    bool loaded = visibility_grid_->load_cell_visibility_from_file(pvs_file_path_, cell_index);
+
+    std::lock_guard<std::mutex> lock(loading_mutex_);
+    cells_in_loading_.erase(cell_index);
+
+    if (loaded) {
+      ++statistics_.num_loaded_cells;
+      touch_cached_cell(cell_index);
+
+      // The viewer waited for this cell.
+      if (cell_index == viewer_cell_index_ && !viewer_cell_loaded_) {
+        double latency_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - viewer_cell_enter_time_).count();
+        total_switch_latency_ms_ += latency_ms;
+        ++num_measured_switches_;
+        statistics_.max_switch_latency_ms = std::max(statistics_.max_switch_latency_ms, latency_ms);
+        viewer_cell_loaded_ = true;
+      }
+
+      evict_cached_cells();
     }
   }
 
@@ -336,6 +415,16 @@ set_viewer_position(const scm::math::vec3d& position)
 	{
 		if(position != position_viewer_)
 		{
+			// Smoothed viewer velocity, its direction decides which cells are loaded ahead.
+			std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+			double elapsed_seconds = std::chrono::duration<double>(now - viewer_position_time_).count();
+
+			if(viewer_cell_ != nullptr && elapsed_seconds > 0.0)
+			{
+				viewer_velocity_ = viewer_velocity_ * 0.5 + ((position - position_viewer_) / elapsed_seconds) * 0.5;
+			}
+
+			viewer_position_time_ = now;
 			position_viewer_ = position;
 			size_t cell_index = 0;
 			const view_cell* view_cell_at_position = visibility_grid_->get_cell_at_position(position, &cell_index);
@@ -346,18 +435,39 @@ set_viewer_position(const scm::math::vec3d& position)
 				// Only set viewer cell if it changed.
 				if(view_cell_at_position != viewer_cell_)
 				{
-					viewer_cell_ = view_cell_at_position;
-
 					// If the view cell changed and the visibility data is not preloaded, it should be loaded now.
 					if(!do_preload_)
 					{
-					
-            loading_mutex_.lock();
-            loading_queue_.push(cell_index);
-            //std::cout << "add cell " << cell_index << std::endl;
-						loading_mutex_.unlock();
-						semaphore_.signal(1);
-						
+						std::lock_guard<std::mutex> lock(loading_mutex_);
+
+						viewer_cell_loaded_ = false;
+						viewer_cell_ = view_cell_at_position;
+						viewer_cell_index_ = cell_index;
+						viewer_cell_enter_time_ = now;
+						++statistics_.num_cell_switches;
+
+						if(cached_cell_positions_.find(cell_index) != cached_cell_positions_.end())
+						{
+							++statistics_.num_hits;
+							++num_measured_switches_;
+							viewer_cell_loaded_ = true;
+						}
+						else if(queued_cell_indices_.find(cell_index) != queued_cell_indices_.end() || cells_in_loading_.find(cell_index) != cells_in_loading_.end())
+						{
+							++statistics_.num_late_prefetches;
+						}
+						else
+						{
+							++statistics_.num_cold_misses;
+						}
+
+						request_cells_around_viewer(cell_index);
+					}
+					else
+					{
+						viewer_cell_ = view_cell_at_position;
+						viewer_cell_index_ = cell_index;
+						viewer_cell_loaded_ = true;
 					}
 				}
 			}
@@ -370,7 +480,11 @@ set_viewer_position(const scm::math::vec3d& position)
 					// Only set viewer cell if it changed.
 					if(view_cell_at_position != viewer_cell_)
 					{
+						std::lock_guard<std::mutex> lock(loading_mutex_);
+
 						viewer_cell_ = view_cell_at_position;
+						viewer_cell_index_ = NO_CELL;
+						viewer_cell_loaded_ = true;
 					}
 				}
 			}
@@ -379,19 +493,19 @@ set_viewer_position(const scm::math::vec3d& position)
 }
 
 void pvs_database::
-load_visibility_data_async(uint64_t cell_index)
+request_cells_around_viewer(const size_t& cell_index)
 {
-  const view_cell* cell = visibility_grid_->get_cell_at_index(cell_index);
-  //
-  if (cell != viewer_cell_) {
-    return;
-  }
-  
-  //std::cout << "loading cell " << cell_index << std::endl;
-  
+	// Requests of the previous viewer cell which are still waiting are outdated.
+	loading_queue_.clear();
+	queued_cell_indices_.clear();
+	protected_cell_indices_.clear();
+
+	const view_cell* cell = visibility_grid_->get_cell_at_index(cell_index);
 	scm::math::vec3d center = cell->get_position_center();
 
-	std::set<size_t> cell_indices_to_load;
+	// Viewer cell first, then its direct neighbours, so the viewer has visibility data as soon as possible.
+	request_cell(cell_index);
+	protected_cell_indices_.insert(cell_index);
 
 	for(double z = -1.0; z < 1.5; z += 1.0)
 	{
@@ -405,39 +519,109 @@ load_visibility_data_async(uint64_t cell_index)
 
 				if(local_view_cell_at_position != nullptr)
 				{
-					cell_indices_to_load.insert(local_cell_index);
+					request_cell(local_cell_index);
+					protected_cell_indices_.insert(local_cell_index);
 				}
 			}
 		}
 	}
-  
-  std::lock_guard<std::mutex> lock(mutex_);
 
-	// Load required visibility data which is not yet loaded.
-	for (std::set<size_t>::iterator iter = cell_indices_to_load.begin(); iter != cell_indices_to_load.end(); ++iter)
+	// Cells further along the viewer's movement.
+	double speed = scm::math::length(viewer_velocity_);
+
+	if(speed > 0.0)
 	{
-		if(previously_loaded_cell_indices_.find(*iter) == previously_loaded_cell_indices_.end())
+		scm::math::vec3d direction = viewer_velocity_ / speed;
+
+		for(size_t step = 2; step < num_prefetched_cells_ + 2; ++step)
 		{
-			visibility_grid_->load_cell_visibility_from_file(pvs_file_path_, *iter);
+			size_t local_cell_index = 0;
+			scm::math::vec3d offset = smallest_cell_size_ * direction * (double)step;
+
+			if(visibility_grid_->get_cell_at_position(center + offset, &local_cell_index) != nullptr)
+			{
+				request_cell(local_cell_index);
+			}
 		}
 	}
+}
+
+void pvs_database::
+request_cell(const size_t& cell_index)
+{
+	// Loaded cells are only marked as recently used.
+	if(cached_cell_positions_.find(cell_index) != cached_cell_positions_.end())
+	{
+		touch_cached_cell(cell_index);
+		return;
+	}
+
+	if(queued_cell_indices_.find(cell_index) != queued_cell_indices_.end() || cells_in_loading_.find(cell_index) != cells_in_loading_.end())
+	{
+		return;
+	}
+
+	loading_queue_.push_back(cell_index);
+	queued_cell_indices_.insert(cell_index);
+	semaphore_.signal(1);
+}
+
+void pvs_database::
+touch_cached_cell(const size_t& cell_index)
+{
+	std::map<size_t, std::list<size_t>::iterator>::iterator position_iter = cached_cell_positions_.find(cell_index);
+
+	if(position_iter != cached_cell_positions_.end())
+	{
+		cached_cell_indices_.erase(position_iter->second);
+	}
+
+	cached_cell_indices_.push_front(cell_index);
+	cached_cell_positions_[cell_index] = cached_cell_indices_.begin();
+}
+
+void pvs_database::
+evict_cached_cells()
+{
+	std::list<size_t>::iterator iter = cached_cell_indices_.end();
 
-	// Release visibility data not within current neighbourhood.
-	for (std::set<size_t>::iterator iter = previously_loaded_cell_indices_.begin(); iter != previously_loaded_cell_indices_.end(); ++iter)
+	while(cached_cell_indices_.size() > max_cached_cells_ && iter != cached_cell_indices_.begin())
 	{
-		if(cell_indices_to_load.find(*iter) == cell_indices_to_load.end())
+		--iter;
+
+		// Cells around the viewer stay, even if the cache is too small to hold them.
+		if(protected_cell_indices_.find(*iter) != protected_cell_indices_.end())
 		{
-			visibility_grid_->clear_cell_visibility(*iter);
+			continue;
 		}
+
+		visibility_grid_->clear_cell_visibility(*iter);
+		cached_cell_positions_.erase(*iter);
+		iter = cached_cell_indices_.erase(iter);
+		++statistics_.num_evicted_cells;
 	}
+}
 
-	previously_loaded_cell_indices_ = std::set<size_t>(cell_indices_to_load);
+void pvs_database::
+reset_cache()
+{
+	std::lock_guard<std::mutex> lock(loading_mutex_);
+
+	loading_queue_.clear();
+	queued_cell_indices_.clear();
+	cached_cell_indices_.clear();
+	cached_cell_positions_.clear();
+	protected_cell_indices_.clear();
+
+	viewer_cell_ = nullptr;
+	viewer_cell_index_ = NO_CELL;
+	viewer_cell_loaded_ = false;
 }
 
 bool pvs_database::
 get_viewer_visibility(const model_t& model_id, const node_t node_id) const
 {
-	if(!activated_ || viewer_cell_ == nullptr || !viewer_cell_->contains_visibility_data())
+	if(!activated_ || viewer_cell_ == nullptr || !viewer_cell_loaded_ || !viewer_cell_->contains_visibility_data())
 	{
 		return true;
 	}
@@ -478,11 +662,42 @@ clear_visibility_grid()
 {
 	std::lock_guard<std::mutex> lock(mutex_);
 
-	viewer_cell_ = nullptr;
+	reset_cache();
 
 	delete visibility_grid_;
 	visibility_grid_ = nullptr;
 }
 
+void pvs_database::
+set_prefetching(const size_t& max_cached_cells, const size_t& num_prefetched_cells)
+{
+	std::lock_guard<std::mutex> lock(loading_mutex_);
+
+	max_cached_cells_ = std::max((size_t)1, max_cached_cells);
+	num_prefetched_cells_ = num_prefetched_cells;
+}
+
+pvs_database::prefetch_statistics pvs_database::
+get_prefetch_statistics() const
+{
+	std::lock_guard<std::mutex> lock(loading_mutex_);
+
+	prefetch_statistics statistics = statistics_;
+	statistics.average_switch_latency_ms = num_measured_switches_ > 0 ? total_switch_latency_ms_ / (double)num_measured_switches_ : 0.0;
+	statistics.num_cached_cells = cached_cell_indices_.size();
+
+	return statistics;
+}
+
+void pvs_database::
+reset_prefetch_statistics()
+{
+	std::lock_guard<std::mutex> lock(loading_mutex_);
+
+	statistics_ = prefetch_statistics();
+	total_switch_latency_ms_ = 0.0;
+	num_measured_switches_ = 0;
+}
+
 }
 }
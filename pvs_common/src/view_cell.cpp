@@ -0,0 +1,106 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group 
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#include "lamure/pvs/view_cell.h"
+
+#include <algorithm>
+
+namespace lamure
+{
+namespace pvs
+{
+
+void view_cell::
+union_with(const view_cell* other)
+{
+	std::map<model_t, std::vector<node_t>> other_visibility = other->get_visible_indices();
+
+	for(std::map<model_t, std::vector<node_t>>::const_iterator iter = other_visibility.begin(); iter != other_visibility.end(); ++iter)
+	{
+		for(const node_t& node_index : iter->second)
+		{
+			this->set_visibility(iter->first, node_index, true);
+		}
+	}
+}
+
+void view_cell::
+union_with_words(const model_t& object_id, const uint64_t* words, const node_t& num_nodes)
+{
+	for(node_t node_index = 0; node_index < num_nodes; ++node_index)
+	{
+		if((words[node_index / 64] >> (node_index % 64)) & 1)
+		{
+			this->set_visibility(object_id, node_index, true);
+		}
+	}
+}
+
+void view_cell::
+copy_visibility_words(const model_t& object_id, const node_t& num_nodes, uint64_t* words) const
+{
+	std::fill(words, words + (num_nodes + 63) / 64, 0);
+
+	for(node_t node_index = 0; node_index < num_nodes; ++node_index)
+	{
+		if(this->get_visibility(object_id, node_index))
+		{
+			words[node_index / 64] |= (uint64_t)1 << (node_index % 64);
+		}
+	}
+}
+
+size_t view_cell::
+intersect_count(const view_cell* other) const
+{
+	std::map<model_t, std::vector<node_t>> visibility = this->get_visible_indices();
+	size_t count = 0;
+
+	for(std::map<model_t, std::vector<node_t>>::const_iterator iter = visibility.begin(); iter != visibility.end(); ++iter)
+	{
+		for(const node_t& node_index : iter->second)
+		{
+			if(other->get_visibility(iter->first, node_index))
+			{
+				++count;
+			}
+		}
+	}
+
+	return count;
+}
+
+size_t view_cell::
+popcount() const
+{
+	std::map<model_t, std::vector<node_t>> visibility = this->get_visible_indices();
+	size_t count = 0;
+
+	for(std::map<model_t, std::vector<node_t>>::const_iterator iter = visibility.begin(); iter != visibility.end(); ++iter)
+	{
+		count += iter->second.size();
+	}
+
+	return count;
+}
+
+float view_cell::
+similarity(const view_cell* other) const
+{
+	size_t num_common = this->intersect_count(other);
+	size_t num_combined = this->popcount() + other->popcount() - num_common;
+
+	if(num_combined == 0)
+	{
+		return 1.0f;
+	}
+
+	return (float)num_common / (float)num_combined;
+}
+
+}
+}
@@ -6,6 +6,10 @@
 // http://www.uni-weimar.de/medien/vr
 
 #include "lamure/pvs/view_cell_regular.h"
+#include "lamure/pvs/bitset_kernels.h"
+
+#include <algorithm>
+#include <iterator>
 
 namespace lamure
 {
@@ -58,19 +62,17 @@ get_position_center() const
 void view_cell_regular::
 set_visibility(const model_t& object_id, const node_t& node_id, const bool& visible)
 {
-	if(visibility_.size() <= object_id)
+	uint64_t* words = get_visibility_words_for_write(object_id, node_id + 1);
+	uint64_t bit = (uint64_t)1 << (node_id % 64);
+
+	if(visible)
 	{
-		visibility_.resize(object_id + 1);
+		words[node_id / 64] |= bit;
 	}
-
-	boost::dynamic_bitset<>& node_visibility = visibility_[object_id];
-
-	if(node_visibility.size() <= node_id)
+	else
 	{
-		node_visibility.resize(node_id + 1);
+		words[node_id / 64] &= ~bit;
 	}
-
-	node_visibility[node_id] = visible;
 }
 
 bool view_cell_regular::
@@ -81,14 +83,12 @@ get_visibility(const model_t& object_id, const node_t& node_id) const
 		return false;
 	}
 
-	const boost::dynamic_bitset<>& node_visibility = visibility_[object_id];
-
-	if(node_visibility.size() <= node_id)
+	if(visibility_sizes_[object_id] <= node_id)
 	{
 		return false;
 	}
 
-	return node_visibility[node_id];
+	return (visibility_[object_id][node_id / 64] >> (node_id % 64)) & 1;
 }
 
 bool view_cell_regular::
@@ -104,13 +104,18 @@ get_visible_indices() const
 
 	for(model_t model_index = 0; model_index < visibility_.size(); ++model_index)
 	{
-		const boost::dynamic_bitset<>& node_visibility = visibility_[model_index];
+		const std::vector<uint64_t>& words = visibility_[model_index];
 
-		for(node_t node_index = 0; node_index < node_visibility.size(); ++node_index)
+		for(size_t word_index = 0; word_index < words.size(); ++word_index)
 		{
-			if(node_visibility[node_index])
+			uint64_t word = words[word_index];
+
+			for(node_t bit_index = 0; word != 0; ++bit_index, word >>= 1)
 			{
-				indices[model_index].push_back(node_index);
+				if(word & 1)
+				{
+					indices[model_index].push_back(word_index * 64 + bit_index);
+				}
 			}
 		}
 	}
@@ -122,6 +127,7 @@ void view_cell_regular::
 clear_visibility_data()
 {
 	visibility_.clear();
+	visibility_sizes_.clear();
 }
 
 boost::dynamic_bitset<> view_cell_regular::
@@ -132,18 +138,188 @@ get_bitset(const model_t& object_id) const
 		return boost::dynamic_bitset<>();
 	}
 
-	return visibility_[object_id];
+	typedef boost::dynamic_bitset<>::block_type block_type;
+	const size_t bits_per_block = boost::dynamic_bitset<>::bits_per_block;
+
+	boost::dynamic_bitset<> bitset;
+
+	for(const uint64_t& word : visibility_[object_id])
+	{
+		for(size_t shift = 0; shift < 64; shift += bits_per_block)
+		{
+			bitset.append((block_type)(word >> shift));
+		}
+	}
+
+	bitset.resize(visibility_sizes_[object_id]);
+
+	return bitset;
 }
 
 void view_cell_regular::
 set_bitset(const model_t& object_id, const boost::dynamic_bitset<>& bitset)
+{
+	typedef boost::dynamic_bitset<>::block_type block_type;
+	const size_t bits_per_block = boost::dynamic_bitset<>::bits_per_block;
+
+	std::vector<block_type> blocks;
+	boost::to_block_range(bitset, std::back_inserter(blocks));
+
+	if(visibility_.size() <= object_id)
+	{
+		visibility_.resize(object_id + 1);
+		visibility_sizes_.resize(object_id + 1, 0);
+	}
+
+	std::vector<uint64_t>& words = visibility_[object_id];
+	words.assign((bitset.size() + 63) / 64, 0);
+	visibility_sizes_[object_id] = bitset.size();
+
+	for(size_t block_index = 0; block_index < blocks.size(); ++block_index)
+	{
+		size_t bit_index = block_index * bits_per_block;
+		words[bit_index / 64] |= (uint64_t)blocks[block_index] << (bit_index % 64);
+	}
+}
+
+void view_cell_regular::
+union_with(const view_cell* other)
+{
+	const view_cell_regular* other_regular = dynamic_cast<const view_cell_regular*>(other);
+
+	if(other_regular == nullptr || other_regular->has_inherited_visibility())
+	{
+		view_cell::union_with(other);
+		return;
+	}
+
+	for(model_t model_index = 0; model_index < other_regular->visibility_.size(); ++model_index)
+	{
+		const std::vector<uint64_t>& other_words = other_regular->visibility_[model_index];
+
+		if(other_regular->visibility_sizes_[model_index] == 0)
+		{
+			continue;
+		}
+
+		uint64_t* words = get_visibility_words_for_write(model_index, other_regular->visibility_sizes_[model_index]);
+		bitset_kernels::union_with(words, other_words.data(), other_words.size());
+	}
+}
+
+void view_cell_regular::
+union_with_words(const model_t& object_id, const uint64_t* words, const node_t& num_nodes)
+{
+	if(num_nodes == 0)
+	{
+		return;
+	}
+
+	uint64_t* own_words = get_visibility_words_for_write(object_id, num_nodes);
+	bitset_kernels::union_with(own_words, words, (num_nodes + 63) / 64);
+}
+
+void view_cell_regular::
+copy_visibility_words(const model_t& object_id, const node_t& num_nodes, uint64_t* words) const
+{
+	if(this->has_inherited_visibility())
+	{
+		view_cell::copy_visibility_words(object_id, num_nodes, words);
+		return;
+	}
+
+	size_t num_words = (num_nodes + 63) / 64;
+	size_t num_own_words = 0;
+	const uint64_t* own_words = get_visibility_words(object_id, num_own_words);
+
+	num_own_words = std::min(num_own_words, num_words);
+	std::copy(own_words, own_words + num_own_words, words);
+	std::fill(words + num_own_words, words + num_words, 0);
+
+	// Bits beyond the requested nodes are no part of the copy.
+	if(num_own_words == num_words && num_nodes % 64 != 0)
+	{
+		words[num_words - 1] &= ((uint64_t)1 << (num_nodes % 64)) - 1;
+	}
+}
+
+size_t view_cell_regular::
+intersect_count(const view_cell* other) const
+{
+	const view_cell_regular* other_regular = dynamic_cast<const view_cell_regular*>(other);
+
+	if(other_regular == nullptr || this->has_inherited_visibility() || other_regular->has_inherited_visibility())
+	{
+		return view_cell::intersect_count(other);
+	}
+
+	size_t count = 0;
+	model_t num_models = std::min(visibility_.size(), other_regular->visibility_.size());
+
+	for(model_t model_index = 0; model_index < num_models; ++model_index)
+	{
+		const std::vector<uint64_t>& words = visibility_[model_index];
+		const std::vector<uint64_t>& other_words = other_regular->visibility_[model_index];
+
+		count += bitset_kernels::intersect_count(words.data(), other_words.data(), std::min(words.size(), other_words.size()));
+	}
+
+	return count;
+}
+
+size_t view_cell_regular::
+popcount() const
+{
+	if(this->has_inherited_visibility())
+	{
+		return view_cell::popcount();
+	}
+
+	size_t count = 0;
+
+	for(const std::vector<uint64_t>& words : visibility_)
+	{
+		count += bitset_kernels::popcount(words.data(), words.size());
+	}
+
+	return count;
+}
+
+const uint64_t* view_cell_regular::
+get_visibility_words(const model_t& object_id, size_t& num_words) const
+{
+	if(visibility_.size() <= object_id)
+	{
+		num_words = 0;
+		return nullptr;
+	}
+
+	num_words = visibility_[object_id].size();
+	return visibility_[object_id].data();
+}
+
+bool view_cell_regular::
+has_inherited_visibility() const
+{
+	return false;
+}
+
+uint64_t* view_cell_regular::
+get_visibility_words_for_write(const model_t& object_id, const node_t& num_nodes)
 {
 	if(visibility_.size() <= object_id)
 	{
 		visibility_.resize(object_id + 1);
+		visibility_sizes_.resize(object_id + 1, 0);
+	}
+
+	if(visibility_sizes_[object_id] < num_nodes)
+	{
+		visibility_[object_id].resize((num_nodes + 63) / 64, 0);
+		visibility_sizes_[object_id] = num_nodes;
 	}
 
-	visibility_[object_id] = boost::dynamic_bitset<>(bitset);
+	return visibility_[object_id].data();
 }
 
 }
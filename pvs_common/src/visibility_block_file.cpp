@@ -0,0 +1,656 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group 
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#include "lamure/pvs/visibility_block_file.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+#include <zlib.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace lamure
+{
+namespace pvs
+{
+
+namespace
+{
+
+const char BLOCK_FILE_MAGIC[8] = {'L', 'M', 'R', 'P', 'V', 'S', 'B', 'F'};
+const uint32_t BLOCK_FILE_VERSION = 1;
+
+// Magic, version, codec, coding, number of models and number of cells, followed by the number of nodes per model.
+const size_t BLOCK_FILE_HEADER_SIZE = sizeof(BLOCK_FILE_MAGIC) + 4 * sizeof(uint32_t) + sizeof(uint64_t);
+
+unsigned int get_num_threads(const unsigned int& num_threads, const size_t& num_cells)
+{
+	unsigned int max_threads = num_threads > 0 ? num_threads : std::max(1u, std::thread::hardware_concurrency());
+	return (unsigned int)std::max((size_t)1, std::min((size_t)max_threads, num_cells));
+}
+
+template<typename value_type>
+void append_value(std::string& data, const value_type& value)
+{
+	data.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template<typename value_type>
+value_type read_value(const char* data)
+{
+	value_type value;
+	std::memcpy(&value, data, sizeof(value));
+	return value;
+}
+
+void append_varint(std::string& data, uint64_t value)
+{
+	while(value >= 0x80)
+	{
+		data.push_back((char)((value & 0x7F) | 0x80));
+		value >>= 7;
+	}
+
+	data.push_back((char)value);
+}
+
+bool read_varint(const char*& data, const char* data_end, uint64_t& value)
+{
+	value = 0;
+
+	for(unsigned int shift = 0; shift < 64 && data < data_end; shift += 7)
+	{
+		uint8_t current_byte = (uint8_t)*data++;
+		value |= (uint64_t)(current_byte & 0x7F) << shift;
+
+		if((current_byte & 0x80) == 0)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+size_t count_trailing_zeros(const uint64_t& word)
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+	unsigned long index;
+	_BitScanForward64(&index, word);
+	return (size_t)index;
+#else
+	return (size_t)__builtin_ctzll(word);
+#endif
+}
+
+// First node at or after the given one whose visibility is the given value, num_nodes if there is none.
+size_t find_next_node(const uint64_t* words, const size_t& num_nodes, const size_t& first_node, const bool& visible)
+{
+	size_t num_words = (num_nodes + 63) / 64;
+	size_t word_index = first_node / 64;
+
+	if(word_index >= num_words)
+	{
+		return num_nodes;
+	}
+
+	uint64_t word = visible ? words[word_index] : ~words[word_index];
+	word &= ~(uint64_t)0 << (first_node % 64);
+
+	while(word == 0)
+	{
+		if(++word_index == num_words)
+		{
+			return num_nodes;
+		}
+
+		word = visible ? words[word_index] : ~words[word_index];
+	}
+
+	return std::min(num_nodes, word_index * 64 + count_trailing_zeros(word));
+}
+
+void set_node_range(uint64_t* words, const size_t& first_node, const size_t& last_node)
+{
+	size_t node_index = first_node;
+
+	while(node_index < last_node)
+	{
+		size_t bit_index = node_index % 64;
+		size_t num_bits = std::min((size_t)64 - bit_index, last_node - node_index);
+		uint64_t mask = num_bits == 64 ? ~(uint64_t)0 : (((uint64_t)1 << num_bits) - 1) << bit_index;
+
+		words[node_index / 64] |= mask;
+		node_index += num_bits;
+	}
+}
+
+size_t get_varint_size(uint64_t value)
+{
+	size_t size = 1;
+
+	while(value >= 0x80)
+	{
+		value >>= 7;
+		++size;
+	}
+
+	return size;
+}
+
+// Largest coded size of a cell before compression. Run-length coding has at most one run more than nodes per model.
+uint64_t get_max_cell_data_size(const std::vector<node_t>& ids, const visibility_block_coding& coding)
+{
+	uint64_t max_size = 0;
+
+	for(const node_t& num_nodes : ids)
+	{
+		if(coding == visibility_block_coding::bitset)
+		{
+			max_size += ((uint64_t)num_nodes + 63) / 64 * sizeof(uint64_t);
+		}
+		else
+		{
+			max_size += ((uint64_t)num_nodes + 1) * get_varint_size(num_nodes);
+		}
+	}
+
+	return max_size;
+}
+
+std::string encode_cell(const view_cell* cell, const std::vector<node_t>& ids, const visibility_block_settings& settings)
+{
+	std::string cell_data;
+	std::vector<uint64_t> words;
+	bool contains_visible_nodes = false;
+
+	for(model_t model_index = 0; model_index < ids.size(); ++model_index)
+	{
+		size_t num_nodes = ids[model_index];
+		words.assign((num_nodes + 63) / 64, 0);
+		cell->copy_visibility_words(model_index, ids[model_index], words.data());
+
+		if(settings.coding == visibility_block_coding::bitset)
+		{
+			cell_data.append(reinterpret_cast<const char*>(words.data()), words.size() * sizeof(uint64_t));
+
+			contains_visible_nodes = contains_visible_nodes || std::any_of(words.begin(), words.end(), [](const uint64_t& word){ return word != 0; });
+			continue;
+		}
+
+		// Runs alternate between invisible and visible nodes, starting with an invisible (possibly empty) one.
+		size_t node_index = 0;
+		bool visible = false;
+
+		while(node_index < num_nodes)
+		{
+			size_t run_end = find_next_node(words.data(), num_nodes, node_index, !visible);
+			append_varint(cell_data, run_end - node_index);
+
+			contains_visible_nodes = contains_visible_nodes || (visible && run_end > node_index);
+			node_index = run_end;
+			visible = !visible;
+		}
+	}
+
+	if(!contains_visible_nodes)
+	{
+		return std::string();
+	}
+
+	if(settings.codec == visibility_block_codec::none)
+	{
+		return cell_data;
+	}
+
+	// Raw deflate stream behind the uncompressed size, the block size already limits the data.
+	z_stream stream;
+	std::memset(&stream, 0, sizeof(stream));
+
+	if(deflateInit2(&stream, std::max(1, std::min(9, settings.compression_level)), Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+	{
+		throw std::runtime_error("failed to initialize deflate");
+	}
+
+	std::string block;
+	append_value(block, (uint64_t)cell_data.size());
+	block.resize(sizeof(uint64_t) + deflateBound(&stream, cell_data.size()));
+
+	stream.next_in = reinterpret_cast<Bytef*>(&cell_data[0]);
+	stream.avail_in = (uInt)cell_data.size();
+	stream.next_out = reinterpret_cast<Bytef*>(&block[sizeof(uint64_t)]);
+	stream.avail_out = (uInt)(block.size() - sizeof(uint64_t));
+
+	int result = deflate(&stream, Z_FINISH);
+	block.resize(sizeof(uint64_t) + stream.total_out);
+	deflateEnd(&stream);
+
+	if(result != Z_STREAM_END)
+	{
+		throw std::runtime_error("failed to deflate visibility block");
+	}
+
+	return block;
+}
+
+}
+
+visibility_block_file::
+visibility_block_file()
+{
+	codec_ = visibility_block_codec::none;
+	coding_ = visibility_block_coding::bitset;
+	num_cells_ = 0;
+	max_cell_data_size_ = 0;
+	block_offsets_ = nullptr;
+}
+
+visibility_block_file::
+~visibility_block_file()
+{
+	close();
+}
+
+void visibility_block_file::
+save(const std::string& file_path, const std::vector<const view_cell*>& cells, const std::vector<node_t>& ids, const visibility_block_settings& settings)
+{
+	// Written next to the target and renamed over it, so mappings of the previous file stay valid.
+	std::string temporary_file_path = file_path + ".tmp";
+
+	std::fstream file_out;
+	file_out.open(temporary_file_path, std::ios::out | std::ios::binary);
+
+	if(!file_out.is_open())
+	{
+		throw std::invalid_argument("invalid file path: " + file_path);
+	}
+
+	// Cells are coded independently, so threads take the next uncoded cell until all are done.
+	std::vector<std::string> blocks(cells.size());
+	std::atomic<size_t> next_cell_index(0);
+
+	// The first error of a thread stops the others and is rethrown once all are joined.
+	std::mutex error_mutex;
+	std::exception_ptr error;
+
+	auto encode_blocks = [&]()
+	{
+		try
+		{
+			for(size_t cell_index = next_cell_index++; cell_index < cells.size(); cell_index = next_cell_index++)
+			{
+				blocks[cell_index] = encode_cell(cells[cell_index], ids, settings);
+			}
+		}
+		catch(...)
+		{
+			std::lock_guard<std::mutex> lock(error_mutex);
+
+			if(error == nullptr)
+			{
+				error = std::current_exception();
+			}
+
+			next_cell_index = cells.size();
+		}
+	};
+
+	std::vector<std::thread> threads;
+	unsigned int num_threads = get_num_threads(settings.num_threads, cells.size());
+
+	for(unsigned int thread_index = 1; thread_index < num_threads; ++thread_index)
+	{
+		threads.push_back(std::thread(encode_blocks));
+	}
+
+	encode_blocks();
+
+	for(std::thread& thread : threads)
+	{
+		thread.join();
+	}
+
+	if(error != nullptr)
+	{
+		file_out.close();
+		std::remove(temporary_file_path.c_str());
+		std::rethrow_exception(error);
+	}
+
+	// Header.
+	std::string header(BLOCK_FILE_MAGIC, sizeof(BLOCK_FILE_MAGIC));
+	append_value(header, BLOCK_FILE_VERSION);
+	append_value(header, (uint32_t)settings.codec);
+	append_value(header, (uint32_t)settings.coding);
+	append_value(header, (uint32_t)ids.size());
+	append_value(header, (uint64_t)cells.size());
+
+	for(const node_t& num_nodes : ids)
+	{
+		append_value(header, (uint64_t)num_nodes);
+	}
+
+	// Block offsets from the beginning of the file, the last one marks the end of the last block.
+	uint64_t block_offset = header.size() + (cells.size() + 1) * sizeof(uint64_t);
+
+	for(const std::string& block : blocks)
+	{
+		append_value(header, block_offset);
+		block_offset += block.size();
+	}
+
+	append_value(header, block_offset);
+
+	file_out.write(header.c_str(), header.size());
+
+	for(const std::string& block : blocks)
+	{
+		file_out.write(block.c_str(), block.size());
+	}
+
+	file_out.close();
+
+	if(std::rename(temporary_file_path.c_str(), file_path.c_str()) != 0)
+	{
+		// Not every platform replaces an existing file by renaming.
+		std::remove(file_path.c_str());
+
+		if(std::rename(temporary_file_path.c_str(), file_path.c_str()) != 0)
+		{
+			std::remove(temporary_file_path.c_str());
+			throw std::invalid_argument("invalid file path: " + file_path);
+		}
+	}
+}
+
+bool visibility_block_file::
+open(const std::string& file_path, const size_t& num_cells, const std::vector<node_t>& ids)
+{
+	close();
+
+	try
+	{
+		file_.open(file_path);
+	}
+	catch(const std::exception&)
+	{
+		return false;
+	}
+
+	if(!file_.is_open() || file_.size() < BLOCK_FILE_HEADER_SIZE || std::memcmp(file_.data(), BLOCK_FILE_MAGIC, sizeof(BLOCK_FILE_MAGIC)) != 0)
+	{
+		close();
+		return false;
+	}
+
+	const char* data = file_.data() + sizeof(BLOCK_FILE_MAGIC);
+	uint32_t version = read_value<uint32_t>(data);
+	uint32_t codec = read_value<uint32_t>(data + 4);
+	uint32_t coding = read_value<uint32_t>(data + 8);
+	uint32_t num_models = read_value<uint32_t>(data + 12);
+	uint64_t num_file_cells = read_value<uint64_t>(data + 16);
+
+	size_t table_offset = BLOCK_FILE_HEADER_SIZE + num_models * sizeof(uint64_t);
+
+	if(version != BLOCK_FILE_VERSION || codec > (uint32_t)visibility_block_codec::deflate || coding > (uint32_t)visibility_block_coding::run_length ||
+		num_models != ids.size() || num_file_cells != num_cells || file_.size() < table_offset + (num_cells + 1) * sizeof(uint64_t))
+	{
+		close();
+		return false;
+	}
+
+	for(model_t model_index = 0; model_index < num_models; ++model_index)
+	{
+		if(read_value<uint64_t>(file_.data() + BLOCK_FILE_HEADER_SIZE + model_index * sizeof(uint64_t)) != ids[model_index])
+		{
+			close();
+			return false;
+		}
+	}
+
+	codec_ = (visibility_block_codec)codec;
+	coding_ = (visibility_block_coding)coding;
+	ids_ = ids;
+	max_cell_data_size_ = get_max_cell_data_size(ids, coding_);
+	num_cells_ = num_cells;
+	block_offsets_ = file_.data() + table_offset;
+	file_path_ = file_path;
+
+	if(read_value<uint64_t>(block_offsets_ + num_cells_ * sizeof(uint64_t)) != file_.size())
+	{
+		close();
+		return false;
+	}
+
+	return true;
+}
+
+void visibility_block_file::
+close()
+{
+	if(file_.is_open())
+	{
+		file_.close();
+	}
+
+	file_path_.clear();
+	ids_.clear();
+	num_cells_ = 0;
+	max_cell_data_size_ = 0;
+	block_offsets_ = nullptr;
+}
+
+bool visibility_block_file::
+is_open() const
+{
+	return block_offsets_ != nullptr;
+}
+
+const std::string& visibility_block_file::
+get_file_path() const
+{
+	return file_path_;
+}
+
+visibility_block_settings visibility_block_file::
+get_settings() const
+{
+	visibility_block_settings settings;
+	settings.codec = codec_;
+	settings.coding = coding_;
+
+	return settings;
+}
+
+size_t visibility_block_file::
+get_block_size(const size_t& cell_index) const
+{
+	uint64_t block_begin = read_value<uint64_t>(block_offsets_ + cell_index * sizeof(uint64_t));
+	uint64_t block_end = read_value<uint64_t>(block_offsets_ + (cell_index + 1) * sizeof(uint64_t));
+
+	return block_end - block_begin;
+}
+
+bool visibility_block_file::
+load_cell(const size_t& cell_index, view_cell* cell) const
+{
+	if(!is_open() || cell_index >= num_cells_)
+	{
+		return false;
+	}
+
+	uint64_t block_begin = read_value<uint64_t>(block_offsets_ + cell_index * sizeof(uint64_t));
+	uint64_t block_end = read_value<uint64_t>(block_offsets_ + (cell_index + 1) * sizeof(uint64_t));
+
+	if(block_begin > block_end || block_end > file_.size())
+	{
+		return false;
+	}
+
+	std::vector<uint64_t> words;
+
+	if(block_begin == block_end)
+	{
+		// No visible nodes. The bitsets are still allocated, so the cell counts as loaded and culls all nodes.
+		for(model_t model_index = 0; model_index < ids_.size(); ++model_index)
+		{
+			words.assign((ids_[model_index] + 63) / 64, 0);
+			cell->union_with_words(model_index, words.data(), ids_[model_index]);
+		}
+
+		return true;
+	}
+
+	const char* cell_data = file_.data() + block_begin;
+	const char* cell_data_end = file_.data() + block_end;
+	std::vector<char> uncompressed_data;
+
+	if(codec_ == visibility_block_codec::deflate)
+	{
+		if(block_end - block_begin < sizeof(uint64_t))
+		{
+			return false;
+		}
+
+		// A corrupt size must not cause a huge allocation.
+		uint64_t uncompressed_size = read_value<uint64_t>(cell_data);
+
+		if(uncompressed_size > max_cell_data_size_)
+		{
+			return false;
+		}
+
+		uncompressed_data.resize(uncompressed_size);
+
+		z_stream stream;
+		std::memset(&stream, 0, sizeof(stream));
+
+		if(inflateInit2(&stream, -15) != Z_OK)
+		{
+			return false;
+		}
+
+		// Inflated straight from the mapped file.
+		stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(cell_data + sizeof(uint64_t)));
+		stream.avail_in = (uInt)(block_end - block_begin - sizeof(uint64_t));
+		stream.next_out = reinterpret_cast<Bytef*>(uncompressed_data.data());
+		stream.avail_out = (uInt)uncompressed_data.size();
+
+		int result = inflate(&stream, Z_FINISH);
+		inflateEnd(&stream);
+
+		if(result != Z_STREAM_END || stream.total_out != uncompressed_data.size())
+		{
+			return false;
+		}
+
+		cell_data = uncompressed_data.data();
+		cell_data_end = cell_data + uncompressed_data.size();
+	}
+
+	// Every model's bitset is set, also the ones without visible nodes.
+	for(model_t model_index = 0; model_index < ids_.size(); ++model_index)
+	{
+		size_t num_nodes = ids_[model_index];
+		size_t num_words = (num_nodes + 63) / 64;
+
+		if(coding_ == visibility_block_coding::bitset)
+		{
+			if((size_t)(cell_data_end - cell_data) < num_words * sizeof(uint64_t))
+			{
+				return false;
+			}
+
+			words.resize(num_words);
+			std::memcpy(words.data(), cell_data, num_words * sizeof(uint64_t));
+			cell_data += num_words * sizeof(uint64_t);
+
+			cell->union_with_words(model_index, words.data(), (node_t)num_nodes);
+			continue;
+		}
+
+		words.assign(num_words, 0);
+
+		size_t node_index = 0;
+		bool visible = false;
+
+		while(node_index < num_nodes)
+		{
+			uint64_t run_length = 0;
+
+			if(!read_varint(cell_data, cell_data_end, run_length) || run_length > num_nodes - node_index)
+			{
+				return false;
+			}
+
+			if(visible && run_length > 0)
+			{
+				set_node_range(words.data(), node_index, node_index + run_length);
+			}
+
+			node_index += run_length;
+			visible = !visible;
+		}
+
+		cell->union_with_words(model_index, words.data(), (node_t)num_nodes);
+	}
+
+	return true;
+}
+
+bool visibility_block_file::
+load_cells(const std::vector<view_cell*>& cells, const unsigned int& num_threads) const
+{
+	if(cells.size() != num_cells_)
+	{
+		return false;
+	}
+
+	std::atomic<size_t> next_cell_index(0);
+	std::atomic<bool> success(true);
+
+	auto decode_blocks = [&]()
+	{
+		for(size_t cell_index = next_cell_index++; cell_index < cells.size(); cell_index = next_cell_index++)
+		{
+			if(!load_cell(cell_index, cells[cell_index]))
+			{
+				success = false;
+			}
+		}
+	};
+
+	std::vector<std::thread> threads;
+	unsigned int num_used_threads = get_num_threads(num_threads, cells.size());
+
+	for(unsigned int thread_index = 1; thread_index < num_used_threads; ++thread_index)
+	{
+		threads.push_back(std::thread(decode_blocks));
+	}
+
+	decode_blocks();
+
+	for(std::thread& thread : threads)
+	{
+		thread.join();
+	}
+
+	return success;
+}
+
+}
+}
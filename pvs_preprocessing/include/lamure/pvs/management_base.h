@@ -101,6 +101,7 @@ protected:
     bool                first_frame_;
 
     grid*               visibility_grid_;
+    id_histogram        node_id_histogram_;
     size_t              current_grid_index_;
     unsigned short      direction_counter_;
 
@@ -208,6 +208,8 @@ public:
     void toggle_display_info();
 
     lamure::pvs::id_histogram create_node_id_histogram(const bool& save_screenshot, const int& image_index) const;
+    // Fills the given histogram, which keeps its counters allocated between images.
+    void create_node_id_histogram(lamure::pvs::id_histogram& hist, const bool& save_screenshot, const int& image_index) const;
     void compare_histogram_to_cut(const lamure::pvs::id_histogram& hist, const float& visibility_threshold);
 
     int get_rendered_node_count() const;
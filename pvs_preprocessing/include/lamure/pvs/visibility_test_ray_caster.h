@@ -0,0 +1,102 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#ifndef LAMURE_PVS_VISIBILITY_TEST_RAY_CASTER_H
+#define LAMURE_PVS_VISIBILITY_TEST_RAY_CASTER_H
+
+#include <lamure/pvs/pvs_preprocessing.h>
+#include "lamure/pvs/visibility_test.h"
+#include "lamure/pvs/grid.h"
+
+#include <lamure/types.h>
+
+#include <scm/core/math.h>
+#include <scm/gl_core/primitives/box.h>
+
+#include <string>
+#include <vector>
+
+namespace lamure
+{
+namespace pvs
+{
+
+// Visibility test which runs on the CPU only, so PVS can be generated on machines without OpenGL context.
+// Like the histogram renderer it looks from the center of each view cell into the six axis directions,
+// but instead of rendering ID buffers it casts packets of rays against the LOD bvh node bounding boxes
+// and the surfel splats of a single cut depth. Visible nodes are then treated like the rendered ones of
+// the histogram renderer (nodes inside the cell are added and visibility is propagated along the LOD-trees).
+class PVS_PREPROCESSING_DLL visibility_test_ray_caster : public visibility_test
+{
+public:
+	visibility_test_ray_caster();
+	virtual ~visibility_test_ray_caster();
+
+	virtual int initialize(int& argc, char** argv);
+	virtual void test_visibility(grid* visibility_grid);
+	virtual void shutdown();
+
+	virtual bounding_box get_scene_bounds() const;
+
+	// Performance of the last visibility test.
+	double get_rays_per_second() const;
+	double get_cells_per_minute() const;
+
+	// Splats as used by the ray caster, already transformed into world space.
+	struct splat
+	{
+		float x, y, z;
+		float nx, ny, nz;
+		float radius_squared;
+	};
+
+	struct model_scene
+	{
+		model_t model_id;
+		uint32_t fan_factor;
+		uint32_t cut_depth;
+
+		node_t first_cut_node;
+		node_t num_cut_nodes;
+
+		// World space boxes of all nodes from the root to the cut depth.
+		std::vector<scm::gl::boxf> node_bounds;
+
+		// Splats of the cut nodes, splats of cut node i are in [splat_offsets[i], splat_offsets[i + 1]).
+		std::vector<splat> splats;
+		std::vector<size_t> splat_offsets;
+	};
+
+private:
+	void load_models(const std::vector<scm::math::mat4f>& model_transformations, const std::vector<bool>& use_model);
+	uint32_t choose_cut_depth() const;
+
+	void test_cell(grid* visibility_grid, const size_t& cell_index, std::vector<std::vector<bool>>& visible_nodes, std::vector<std::vector<uint32_t>>& hit_counts, size_t& num_rays) const;
+	void propagate_visibility(const model_t& model_index, std::vector<bool>& visible_nodes) const;
+
+	unsigned int resolution_;
+	unsigned int num_threads_;
+	int cut_depth_;
+	unsigned int main_memory_budget_;
+	float visibility_threshold_;
+	float radius_scale_;
+
+	std::string pvs_file_path_;
+
+	std::vector<model_scene> models_;
+	bounding_box scene_bounds_;
+
+	double rays_per_second_;
+	double cells_per_minute_;
+
+	bool initialized_;
+};
+
+}
+}
+
+#endif
@@ -22,6 +22,13 @@ optimize_grid(grid* input_grid, const float& equality_threshold)
 {
 	grid_irregular* irr_grid = (grid_irregular*)input_grid;
 
+	size_t total_nodes = 0;
+
+	for(model_t model_index = 0; model_index < irr_grid->get_num_models(); ++model_index)
+	{
+		total_nodes += input_grid->get_num_nodes(model_index);
+	}
+
 	for(long current_cell_index = 0; current_cell_index < irr_grid->get_cell_count(); ++current_cell_index)
 	{
 		bool is_original_cell = irr_grid->is_cell_at_index_original(current_cell_index);
@@ -39,24 +46,7 @@ optimize_grid(grid* input_grid, const float& equality_threshold)
 			const view_cell* compare_cell = irr_grid->get_cell_at_index(compare_cell_index);
 
 			// Check equality.
-			size_t equality_counter = 0;
-			size_t total_nodes = 0;
-
-			view_cell_regular* current_view_cell_regular = (view_cell_regular*)current_cell;
-			view_cell_regular* compare_view_cell_regular = (view_cell_regular*)compare_cell;
-
-			for(model_t model_index = 0; model_index < irr_grid->get_num_models(); ++model_index)
-			{
-				boost::dynamic_bitset<> bitset_one = boost::dynamic_bitset<>(current_view_cell_regular->get_bitset(model_index));
-				bitset_one.resize(input_grid->get_num_nodes(model_index));
-				boost::dynamic_bitset<> bitset_two = boost::dynamic_bitset<>(compare_view_cell_regular->get_bitset(model_index));
-				bitset_two.resize(input_grid->get_num_nodes(model_index));
-
-				boost::dynamic_bitset<> common_bits = bitset_one & bitset_two;
-
-				equality_counter += common_bits.count();
-				total_nodes += common_bits.size();
-			}
+			size_t equality_counter = current_cell->intersect_count(compare_cell);
 
 			float equality = (float)equality_counter / (float)total_nodes;
 			float error = 1.0f - equality;
@@ -89,42 +89,18 @@ try_collapse_node(grid_octree_node* node, grid* input_grid, const float& equalit
 		// Collect visibility data of all child nodes.
 		for(int child_index = 0; child_index < 8; ++child_index)
 		{
-			grid_octree_node* child_node = node->get_child_at_index(child_index);
-
-			for(model_t model_index = 0; model_index < input_grid->get_num_models(); ++model_index)
-			{
-				for(node_t node_index = 0; node_index < input_grid->get_num_nodes(model_index); ++node_index)
-				{
-					if(child_node->get_visibility(model_index, node_index))
-					{
-						tmp_node.set_visibility(model_index, node_index, true);
-					}
-				}
-			}
+			tmp_node.union_with(node->get_child_at_index(child_index));
 		}
 
 		// Count entries of collected visibility.
-		std::map<model_t, std::vector<node_t>> tmp_visibility = tmp_node.get_visible_indices();
-		size_t num_visible_nodes = 0;
-
-		for(model_t model_index = 0; model_index < input_grid->get_num_models(); ++model_index)
-		{
-			num_visible_nodes += tmp_visibility[model_index].size();
-		}
+		size_t num_visible_nodes = tmp_node.popcount();
 
 		bool collapse = true;
 
 		// Compare to each of the children.
 		for(int child_index = 0; child_index < 8; ++child_index)
 		{
-			grid_octree_node* child_node = node->get_child_at_index(child_index);
-			std::map<model_t, std::vector<node_t>> child_visibility = child_node->get_visible_indices();
-
-			size_t num_visible_nodes_child = 0;
-			for(model_t model_index = 0; model_index < input_grid->get_num_models(); ++model_index)
-			{
-				num_visible_nodes_child += child_visibility[model_index].size();
-			}
+			size_t num_visible_nodes_child = node->get_child_at_index(child_index)->popcount();
 
 			// Check if difference of visible nodes is within threshold.
 			if((float)num_visible_nodes_child / (float)num_visible_nodes < equality_threshold)
@@ -139,17 +115,16 @@ try_collapse_node(grid_octree_node* node, grid* input_grid, const float& equalit
 			node->collapse();
 
 			// Propagate visibility of child nodes to parent.
+			node->clear_visibility_data();
+
 			for(model_t model_index = 0; model_index < input_grid->get_num_models(); ++model_index)
 			{
 				// Performance improving hack. Instantly allocates memory.
 				node->set_visibility(model_index, input_grid->get_num_nodes(model_index)-1, false);
-
-				for(node_t node_index = 0; node_index < input_grid->get_num_nodes(model_index); ++node_index)
-				{
-					node->set_visibility(model_index, node_index, tmp_node.get_visibility(model_index, node_index));
-				}
 			}
 
+			node->union_with(&tmp_node);
+
 			return true;
 		}
 	}
@@ -360,6 +360,16 @@ set_grid(grid* visibility_grid)
     // Set size of containers used to collect data on rendered node depth.
     if(visibility_grid_ != nullptr)
     {
+        // Histogram counters are sized once for all images rendered for this grid.
+        std::vector<node_t> num_nodes;
+
+        for(model_t model_index = 0; model_index < visibility_grid_->get_num_models(); ++model_index)
+        {
+            num_nodes.push_back(visibility_grid_->get_num_nodes(model_index));
+        }
+
+        node_id_histogram_ = id_histogram(num_nodes);
+
         total_depth_rendered_nodes_.clear();
         total_num_rendered_nodes_.clear();
 
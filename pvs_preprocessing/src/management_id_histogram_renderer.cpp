@@ -249,18 +249,8 @@ MainLoop()
             start_time = std::chrono::system_clock::now();
         #endif
 
-            id_histogram hist = renderer_->create_node_id_histogram(false, (direction_counter_ * visibility_grid_->get_cell_count()) + current_grid_index_);
-            std::map<model_t, std::vector<node_t>> visible_ids = hist.get_visible_nodes(width_ * height_, visibility_threshold_);
-
-            for(std::map<model_t, std::vector<node_t>>::iterator iter = visible_ids.begin(); iter != visible_ids.end(); ++iter)
-            {
-                model_t model_id = iter->first;
-
-                for(node_t node_id : iter->second)
-                {
-                    visibility_grid_->set_cell_visibility(current_grid_index_, model_id, node_id, true);
-                }
-            }
+            renderer_->create_node_id_histogram(node_id_histogram_, false, (direction_counter_ * visibility_grid_->get_cell_count()) + current_grid_index_);
+            node_id_histogram_.set_cell_visibility(visibility_grid_, current_grid_index_, width_ * height_, visibility_threshold_);
 
         #ifdef LAMURE_PVS_MEASURE_PERFORMANCE
             end_time = std::chrono::system_clock::now();
@@ -334,18 +334,8 @@ MainLoop()
             start_time = std::chrono::system_clock::now();
         #endif
 
-            id_histogram hist = renderer_->create_node_id_histogram(false, (direction_counter_ * visibility_grid_->get_cell_count()) + current_grid_index_);
-            std::map<model_t, std::vector<node_t>> visible_ids = hist.get_visible_nodes(width_ * height_, visibility_threshold_);
-
-            for(std::map<model_t, std::vector<node_t>>::iterator iter = visible_ids.begin(); iter != visible_ids.end(); ++iter)
-            {
-                model_t model_id = iter->first;
-
-                for(node_t node_id : iter->second)
-                {
-                    visibility_grid_->set_cell_visibility(current_grid_index_, model_id, node_id, true);
-                }
-            }
+            renderer_->create_node_id_histogram(node_id_histogram_, false, (direction_counter_ * visibility_grid_->get_cell_count()) + current_grid_index_);
+            node_id_histogram_.set_cell_visibility(visibility_grid_, current_grid_index_, width_ * height_, visibility_threshold_);
 
         #ifdef LAMURE_PVS_MEASURE_PERFORMANCE
             end_time = std::chrono::system_clock::now();
@@ -407,25 +397,21 @@ MainLoop()
             start_time = std::chrono::system_clock::now();
         #endif
 
-            id_histogram hist = renderer_->create_node_id_histogram(false, (direction_counter_ * visibility_grid_->get_cell_count()) + current_grid_index_);
-            std::map<model_t, std::vector<node_t>> visible_ids = hist.get_visible_nodes(width_ * height_, visibility_threshold_);
+            renderer_->create_node_id_histogram(node_id_histogram_, false, (direction_counter_ * visibility_grid_->get_cell_count()) + current_grid_index_);
 
-            for(std::map<model_t, std::vector<node_t>>::iterator iter = visible_ids.begin(); iter != visible_ids.end(); ++iter)
+            // Visibility is to be set in up to 8 view cells surrounding the corner that was rendered.
+            for(double z_dir = -1.0; z_dir < 2.0; z_dir += 2.0)
             {
-                model_t model_id = iter->first;
-
-                for(node_t node_id : iter->second)
+                for(double y_dir = -1.0; y_dir < 2.0; y_dir += 2.0)
                 {
-                    // Visibility is to be set in up to 8 view cells surrounding the corner that was rendered.
-                    for(double z_dir = -1.0; z_dir < 2.0; z_dir += 2.0)
+                    for(double x_dir = -1.0; x_dir < 2.0; x_dir += 2.0)
                     {
-                        for(double y_dir = -1.0; y_dir < 2.0; y_dir += 2.0)
+                        scm::math::vec3d potentially_cell_pos = current_corner_pos + (smallest_cell_size_ * scm::math::vec3d(x_dir, y_dir, z_dir) * 0.1);
+                        size_t cell_index = 0;
+
+                        if(visibility_grid_->get_cell_at_position(potentially_cell_pos, &cell_index) != nullptr)
                         {
-                            for(double x_dir = -1.0; x_dir < 2.0; x_dir += 2.0)
-                            {
-                                scm::math::vec3d potentially_cell_pos = current_corner_pos + (smallest_cell_size_ * scm::math::vec3d(x_dir, y_dir, z_dir) * 0.1);
-                                visibility_grid_->set_cell_visibility(potentially_cell_pos, model_id, node_id, true);
-                            }
+                            node_id_histogram_.set_cell_visibility(visibility_grid_, cell_index, width_ * height_, visibility_threshold_);
                         }
                     }
                 }
@@ -699,6 +699,15 @@ switch_render_mode(RenderMode const& render_mode)
 
 lamure::pvs::id_histogram Renderer::
 create_node_id_histogram(const bool& save_screenshot, const int& image_index) const
+{
+    lamure::pvs::id_histogram hist;
+    create_node_id_histogram(hist, save_screenshot, image_index);
+
+    return hist;
+}
+
+void Renderer::
+create_node_id_histogram(lamure::pvs::id_histogram& hist, const bool& save_screenshot, const int& image_index) const
 {
     // Make the BYTE array, factor of 4 because it's RGBA.
     GLubyte* pixels = new GLubyte[4 * win_x_ * win_y_];
@@ -706,7 +715,6 @@ create_node_id_histogram(const bool& save_screenshot, const int& image_index) co
     device_->opengl_api().glBindTexture(GL_TEXTURE_2D, visible_node_id_texture_->object_id());
     device_->opengl_api().glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA_INTEGER, GL_UNSIGNED_BYTE, pixels);
 
-    lamure::pvs::id_histogram hist;
     hist.create(pixels, win_x_ * win_y_);
 
     if(save_screenshot)
@@ -737,8 +745,6 @@ create_node_id_histogram(const bool& save_screenshot, const int& image_index) co
     }
 
     delete [] pixels;
-
-    return hist;
 }
 
 // Debug stuff to output rendered nodes as histogram and check if histogram is valid within current cut.
@@ -0,0 +1,877 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#include "lamure/pvs/visibility_test_ray_caster.h"
+#include "lamure/pvs/utils.h"
+#include "lamure/pvs/pvs_database.h"
+
+#include "lamure/ren/model_database.h"
+#include "lamure/ren/controller.h"
+#include "lamure/ren/dataset.h"
+#include "lamure/ren/lod_stream.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <mutex>
+#include <set>
+#include <thread>
+
+#include <boost/program_options.hpp>
+#include <boost/filesystem.hpp>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace lamure
+{
+namespace pvs
+{
+
+namespace
+{
+
+// Rays of a packet share their origin, which is the center of the view cell.
+const size_t ray_packet_size = 8;
+
+struct ray_packet
+{
+	float origin_x, origin_y, origin_z;
+
+	float direction_x[ray_packet_size];
+	float direction_y[ray_packet_size];
+	float direction_z[ray_packet_size];
+
+	float inverse_direction_x[ray_packet_size];
+	float inverse_direction_y[ray_packet_size];
+	float inverse_direction_z[ray_packet_size];
+
+	float t_near[ray_packet_size];
+	float t_hit[ray_packet_size];
+
+	int32_t hit_model[ray_packet_size];
+	node_t hit_node[ray_packet_size];
+};
+
+// Returns a bit per ray which enters the box between its near plane and its closest hit so far.
+#if defined(__AVX2__)
+
+uint32_t intersect_box(const ray_packet& packet, const scm::gl::boxf& box)
+{
+	__m256 min_x = _mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(box.min_vertex().x), _mm256_set1_ps(packet.origin_x)), _mm256_loadu_ps(packet.inverse_direction_x));
+	__m256 max_x = _mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(box.max_vertex().x), _mm256_set1_ps(packet.origin_x)), _mm256_loadu_ps(packet.inverse_direction_x));
+	__m256 min_y = _mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(box.min_vertex().y), _mm256_set1_ps(packet.origin_y)), _mm256_loadu_ps(packet.inverse_direction_y));
+	__m256 max_y = _mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(box.max_vertex().y), _mm256_set1_ps(packet.origin_y)), _mm256_loadu_ps(packet.inverse_direction_y));
+	__m256 min_z = _mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(box.min_vertex().z), _mm256_set1_ps(packet.origin_z)), _mm256_loadu_ps(packet.inverse_direction_z));
+	__m256 max_z = _mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(box.max_vertex().z), _mm256_set1_ps(packet.origin_z)), _mm256_loadu_ps(packet.inverse_direction_z));
+
+	__m256 t_enter = _mm256_max_ps(_mm256_max_ps(_mm256_min_ps(min_x, max_x), _mm256_min_ps(min_y, max_y)), _mm256_min_ps(min_z, max_z));
+	__m256 t_exit = _mm256_min_ps(_mm256_min_ps(_mm256_max_ps(min_x, max_x), _mm256_max_ps(min_y, max_y)), _mm256_max_ps(min_z, max_z));
+
+	__m256 hit = _mm256_cmp_ps(t_enter, t_exit, _CMP_LE_OQ);
+	hit = _mm256_and_ps(hit, _mm256_cmp_ps(t_exit, _mm256_loadu_ps(packet.t_near), _CMP_GE_OQ));
+	hit = _mm256_and_ps(hit, _mm256_cmp_ps(t_enter, _mm256_loadu_ps(packet.t_hit), _CMP_LT_OQ));
+
+	return (uint32_t)_mm256_movemask_ps(hit);
+}
+
+#else
+
+uint32_t intersect_box(const ray_packet& packet, const scm::gl::boxf& box)
+{
+	uint32_t hit_mask = 0;
+
+	for(size_t ray_index = 0; ray_index < ray_packet_size; ++ray_index)
+	{
+		float min_x = (box.min_vertex().x - packet.origin_x) * packet.inverse_direction_x[ray_index];
+		float max_x = (box.max_vertex().x - packet.origin_x) * packet.inverse_direction_x[ray_index];
+		float min_y = (box.min_vertex().y - packet.origin_y) * packet.inverse_direction_y[ray_index];
+		float max_y = (box.max_vertex().y - packet.origin_y) * packet.inverse_direction_y[ray_index];
+		float min_z = (box.min_vertex().z - packet.origin_z) * packet.inverse_direction_z[ray_index];
+		float max_z = (box.max_vertex().z - packet.origin_z) * packet.inverse_direction_z[ray_index];
+
+		float t_enter = std::max(std::max(std::min(min_x, max_x), std::min(min_y, max_y)), std::min(min_z, max_z));
+		float t_exit = std::min(std::min(std::max(min_x, max_x), std::max(min_y, max_y)), std::max(min_z, max_z));
+
+		if(t_enter <= t_exit && t_exit >= packet.t_near[ray_index] && t_enter < packet.t_hit[ray_index])
+		{
+			hit_mask |= 1u << ray_index;
+		}
+	}
+
+	return hit_mask;
+}
+
+#endif
+
+// Intersects the rays with the splat discs, closer hits replace the current ones.
+// Returns a bit per ray whose closest hit changed.
+#if defined(__AVX2__)
+
+uint32_t intersect_splats(ray_packet& packet, const visibility_test_ray_caster::splat* splats, const size_t& num_splats)
+{
+	__m256 direction_x = _mm256_loadu_ps(packet.direction_x);
+	__m256 direction_y = _mm256_loadu_ps(packet.direction_y);
+	__m256 direction_z = _mm256_loadu_ps(packet.direction_z);
+	__m256 t_near = _mm256_loadu_ps(packet.t_near);
+	__m256 t_hit = _mm256_loadu_ps(packet.t_hit);
+	__m256 changed = _mm256_setzero_ps();
+
+	for(size_t splat_index = 0; splat_index < num_splats; ++splat_index)
+	{
+		const visibility_test_ray_caster::splat& current_splat = splats[splat_index];
+
+		// Splat center relative to the common ray origin.
+		float center_x = current_splat.x - packet.origin_x;
+		float center_y = current_splat.y - packet.origin_y;
+		float center_z = current_splat.z - packet.origin_z;
+		float center_distance = center_x * current_splat.nx + center_y * current_splat.ny + center_z * current_splat.nz;
+
+		__m256 denominator = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(direction_x, _mm256_set1_ps(current_splat.nx)),
+										   _mm256_mul_ps(direction_y, _mm256_set1_ps(current_splat.ny))),
+										   _mm256_mul_ps(direction_z, _mm256_set1_ps(current_splat.nz)));
+		__m256 t = _mm256_div_ps(_mm256_set1_ps(center_distance), denominator);
+
+		__m256 offset_x = _mm256_sub_ps(_mm256_mul_ps(direction_x, t), _mm256_set1_ps(center_x));
+		__m256 offset_y = _mm256_sub_ps(_mm256_mul_ps(direction_y, t), _mm256_set1_ps(center_y));
+		__m256 offset_z = _mm256_sub_ps(_mm256_mul_ps(direction_z, t), _mm256_set1_ps(center_z));
+		__m256 offset_squared = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(offset_x, offset_x), _mm256_mul_ps(offset_y, offset_y)), _mm256_mul_ps(offset_z, offset_z));
+
+		__m256 hit = _mm256_cmp_ps(t, t_near, _CMP_GE_OQ);
+		hit = _mm256_and_ps(hit, _mm256_cmp_ps(t, t_hit, _CMP_LT_OQ));
+		hit = _mm256_and_ps(hit, _mm256_cmp_ps(offset_squared, _mm256_set1_ps(current_splat.radius_squared), _CMP_LE_OQ));
+
+		t_hit = _mm256_blendv_ps(t_hit, t, hit);
+		changed = _mm256_or_ps(changed, hit);
+	}
+
+	_mm256_storeu_ps(packet.t_hit, t_hit);
+
+	return (uint32_t)_mm256_movemask_ps(changed);
+}
+
+#else
+
+uint32_t intersect_splats(ray_packet& packet, const visibility_test_ray_caster::splat* splats, const size_t& num_splats)
+{
+	uint32_t changed_mask = 0;
+
+	for(size_t splat_index = 0; splat_index < num_splats; ++splat_index)
+	{
+		const visibility_test_ray_caster::splat& current_splat = splats[splat_index];
+
+		float center_x = current_splat.x - packet.origin_x;
+		float center_y = current_splat.y - packet.origin_y;
+		float center_z = current_splat.z - packet.origin_z;
+		float center_distance = center_x * current_splat.nx + center_y * current_splat.ny + center_z * current_splat.nz;
+
+		for(size_t ray_index = 0; ray_index < ray_packet_size; ++ray_index)
+		{
+			float denominator = packet.direction_x[ray_index] * current_splat.nx + packet.direction_y[ray_index] * current_splat.ny + packet.direction_z[ray_index] * current_splat.nz;
+			float t = center_distance / denominator;
+
+			float offset_x = packet.direction_x[ray_index] * t - center_x;
+			float offset_y = packet.direction_y[ray_index] * t - center_y;
+			float offset_z = packet.direction_z[ray_index] * t - center_z;
+
+			if(t >= packet.t_near[ray_index] && t < packet.t_hit[ray_index] &&
+				offset_x * offset_x + offset_y * offset_y + offset_z * offset_z <= current_splat.radius_squared)
+			{
+				packet.t_hit[ray_index] = t;
+				changed_mask |= 1u << ray_index;
+			}
+		}
+	}
+
+	return changed_mask;
+}
+
+#endif
+
+// Walks the LOD bvh of a model down to the cut depth, nearer children first, and intersects the splats of the reached cut nodes.
+void cast_packet(ray_packet& packet, const visibility_test_ray_caster::model_scene& model, const int32_t& model_index, std::vector<std::pair<node_t, uint32_t>>& stack)
+{
+	stack.clear();
+	stack.push_back(std::make_pair((node_t)0, (uint32_t)0));
+
+	std::pair<float, node_t> children[64];
+
+	while(!stack.empty())
+	{
+		node_t node_id = stack.back().first;
+		uint32_t node_depth = stack.back().second;
+		stack.pop_back();
+
+		if(intersect_box(packet, model.node_bounds[node_id]) == 0)
+		{
+			continue;
+		}
+
+		if(node_depth == model.cut_depth)
+		{
+			node_t cut_node_index = node_id - model.first_cut_node;
+			size_t splat_begin = model.splat_offsets[cut_node_index];
+			size_t splat_end = model.splat_offsets[cut_node_index + 1];
+
+			uint32_t changed_mask = intersect_splats(packet, &model.splats[splat_begin], splat_end - splat_begin);
+
+			for(size_t ray_index = 0; ray_index < ray_packet_size; ++ray_index)
+			{
+				if(changed_mask & (1u << ray_index))
+				{
+					packet.hit_model[ray_index] = model_index;
+					packet.hit_node[ray_index] = node_id;
+				}
+			}
+
+			continue;
+		}
+
+		// Push farther children first so the nearer ones are popped first and shorten the rays early.
+		uint32_t num_children = 0;
+
+		for(uint32_t child_index = 0; child_index < model.fan_factor && child_index < 64; ++child_index)
+		{
+			node_t child_id = node_id * model.fan_factor + 1 + child_index;
+
+			if(child_id >= model.node_bounds.size())
+			{
+				break;
+			}
+
+			const scm::gl::boxf& child_bounds = model.node_bounds[child_id];
+			float center_x = (child_bounds.min_vertex().x + child_bounds.max_vertex().x) * 0.5f - packet.origin_x;
+			float center_y = (child_bounds.min_vertex().y + child_bounds.max_vertex().y) * 0.5f - packet.origin_y;
+			float center_z = (child_bounds.min_vertex().z + child_bounds.max_vertex().z) * 0.5f - packet.origin_z;
+
+			children[num_children++] = std::make_pair(center_x * center_x + center_y * center_y + center_z * center_z, child_id);
+		}
+
+		std::sort(children, children + num_children);
+
+		for(uint32_t child_index = num_children; child_index > 0; --child_index)
+		{
+			stack.push_back(std::make_pair(children[child_index - 1].second, node_depth + 1));
+		}
+	}
+}
+
+}
+
+visibility_test_ray_caster::
+visibility_test_ray_caster()
+{
+	resolution_ = 256;
+	num_threads_ = std::max(1u, std::thread::hardware_concurrency());
+	cut_depth_ = -1;
+	main_memory_budget_ = 4096;
+	visibility_threshold_ = 0.0001f;
+	radius_scale_ = 1.0f;
+
+	rays_per_second_ = 0.0;
+	cells_per_minute_ = 0.0;
+
+	initialized_ = false;
+}
+
+visibility_test_ray_caster::
+~visibility_test_ray_caster()
+{
+	shutdown();
+}
+
+int visibility_test_ray_caster::
+initialize(int& argc, char** argv)
+{
+	namespace po = boost::program_options;
+	namespace fs = boost::filesystem;
+
+	const std::string exec_name = (argc > 0) ? fs::basename(argv[0]) : "";
+
+	std::string resource_file_path = "";
+
+	// These value are read, but not used. Yet ignoring them in the terminal parameters would lead to misinterpretation.
+	std::string visibility_test_type = "";
+	std::string grid_type = "";
+	unsigned int grid_size = 1;
+	unsigned int num_steps = 11;
+	double oversize_factor = 1.5;
+	float optimization_threshold = 1.0f;
+
+	po::options_description desc("Usage: " + exec_name + " [OPTION]... INPUT\n\n"
+							   "Allowed Options");
+	desc.add_options()
+	  ("help", "print help message")
+	  ("resource-file,f", po::value<std::string>(&resource_file_path), "specify resource input-file")
+	  ("mem,m", po::value<unsigned>(&main_memory_budget_)->default_value(4096), "specify main memory budget in MB for the splats of the cut (default=4096)")
+	  ("rayres", po::value<unsigned>(&resolution_)->default_value(256), "specify the number of rays per axis of each of the six view directions per view cell (default=256)")
+	  ("raythreads", po::value<unsigned>(&num_threads_)->default_value(num_threads_), "specify the number of threads casting rays, each thread works on its own view cells")
+	  ("raydepth", po::value<int>(&cut_depth_)->default_value(-1), "specify the LOD-tree depth of the splats the rays are cast against. Default is -1, which selects the deepest depth fitting into the main memory budget.")
+	  ("raythresh", po::value<float>(&visibility_threshold_)->default_value(0.0001f), "specify the percentage of rays of a view direction which must hit a node to make it visible (default=0.0001, like the histogram renderer)")
+	  ("rayradius", po::value<float>(&radius_scale_)->default_value(1.0f), "specify the factor the splat radii are scaled by, larger values trade accuracy for fewer missed nodes (default=1.0)")
+	// The following parameters are used by the main app only, yet must be identified nonetheless since otherwise they are dealt with as file paths.
+	  ("pvs-file,p", po::value<std::string>(&pvs_file_path_), "specify output file of calculated pvs data")
+	  ("vistest", po::value<std::string>(&visibility_test_type)->default_value("rc"), "specify type of visibility test to be used.")
+	  ("gridtype", po::value<std::string>(&grid_type)->default_value("octree"), "specify type of grid to store visibility data")
+	  ("gridsize", po::value<unsigned int>(&grid_size)->default_value(1), "specify size/depth of the grid used for the visibility test (depends on chosen grid type)")
+	  ("oversize", po::value<double>(&oversize_factor)->default_value(1.5), "factor the grid bounds will be scaled by, default is 1.5 (grid bounds will exceed scene bounds by factor of 1.5)")
+	  ("optithresh", po::value<float>(&optimization_threshold)->default_value(1.0f), "specify the threshold at which common data are converged. Default is 1.0, which means data must be 100 percent equal.")
+	  ("numsteps,n", po::value<unsigned int>(&num_steps)->default_value(11), "specify the number of intervals the occlusion values will be split into (visibility analysis only)");
+	  ;
+
+	po::variables_map vm;
+
+	try
+	{
+		auto parsed_options = po::command_line_parser(argc, argv).options(desc).allow_unregistered().run();
+		po::store(parsed_options, vm);
+		po::notify(vm);
+
+		std::vector<std::string> to_pass_further = po::collect_unrecognized(parsed_options.options, po::include_positional);
+		bool no_input = !vm.count("input") && to_pass_further.empty();
+
+		if (resource_file_path == "")
+		{
+			if (vm.count("help") || no_input)
+			{
+				std::cout << desc;
+				return 0;
+			}
+		}
+
+		// no explicit input -> use unknown options
+		if (!vm.count("input") && resource_file_path == "")
+		{
+			resource_file_path = "auto_generated.rsc";
+			std::fstream ofstr(resource_file_path, std::ios::out);
+			if (ofstr.good())
+			{
+				for (auto argument : to_pass_further)
+				{
+					ofstr << argument << std::endl;
+				}
+			}
+			else
+			{
+				throw std::runtime_error("Cannot open file");
+			}
+			ofstr.close();
+		}
+	}
+	catch (std::exception& e)
+	{
+		std::cout << "Warning: No input file specified. \n" << desc;
+		return 0;
+	}
+
+	resolution_ = std::max(1u, resolution_);
+	num_threads_ = std::max(1u, num_threads_);
+
+	std::pair< std::vector<std::string>, std::vector<scm::math::mat4f> > model_attributes;
+	std::set<lamure::model_t> visible_set;
+	std::set<lamure::model_t> invisible_set;
+	model_attributes = read_model_string(resource_file_path, &visible_set, &invisible_set);
+
+	std::vector<scm::math::mat4f> & model_transformations = model_attributes.second;
+	std::vector<std::string> const& model_filenames = model_attributes.first;
+
+	lamure::ren::model_database* database = lamure::ren::model_database::get_instance();
+	std::vector<bool> use_model;
+	initialized_ = true;
+
+	for(size_t model_index = 0; model_index < model_filenames.size(); ++model_index)
+	{
+		database->add_model(model_filenames[model_index], std::to_string(model_index));
+
+		// Same selection as the renderer of the histogram visibility tests, models of the invisible set are skipped.
+		use_model.push_back(invisible_set.find(model_index) == invisible_set.end() || visible_set.find(model_index) != visible_set.end());
+	}
+
+	// Calculate bounding box of whole scene.
+	for(lamure::model_t model_id = 0; model_id < database->num_models(); ++model_id)
+	{
+		// Cast required from boxf to bounding_box.
+		const scm::gl::boxf& box_model_root = database->get_model(model_id)->get_bvh()->get_bounding_boxes()[0];
+		vec3r min_vertex(box_model_root.min_vertex() + database->get_model(model_id)->get_bvh()->get_translation());
+		vec3r max_vertex(box_model_root.max_vertex() + database->get_model(model_id)->get_bvh()->get_translation());
+		bounding_box model_root_box(min_vertex, max_vertex);
+
+		if(model_id == 0)
+		{
+			scene_bounds_ = bounding_box(model_root_box);
+		}
+		else
+		{
+			scene_bounds_.expand(model_root_box);
+		}
+	}
+
+	load_models(model_transformations, use_model);
+
+	return 0;
+}
+
+uint32_t visibility_test_ray_caster::
+choose_cut_depth() const
+{
+	lamure::ren::model_database* database = lamure::ren::model_database::get_instance();
+
+	uint32_t max_depth = 0;
+	for(lamure::model_t model_id = 0; model_id < database->num_models(); ++model_id)
+	{
+		max_depth = std::max(max_depth, database->get_model(model_id)->get_bvh()->get_depth());
+	}
+
+	if(cut_depth_ >= 0)
+	{
+		return std::min((uint32_t)cut_depth_, max_depth);
+	}
+
+	// Deepest depth whose splats fit into the main memory budget.
+	size_t memory_budget = (size_t)main_memory_budget_ * 1024 * 1024;
+	uint32_t chosen_depth = 0;
+
+	for(uint32_t depth = 0; depth <= max_depth; ++depth)
+	{
+		size_t required_memory = 0;
+
+		for(lamure::model_t model_id = 0; model_id < database->num_models(); ++model_id)
+		{
+			const lamure::ren::bvh* bvh = database->get_model(model_id)->get_bvh();
+			uint32_t model_depth = std::min(depth, bvh->get_depth());
+
+			required_memory += (size_t)bvh->get_length_of_depth(model_depth) * bvh->get_primitives_per_node() * sizeof(splat);
+		}
+
+		if(required_memory > memory_budget && depth > 0)
+		{
+			break;
+		}
+
+		chosen_depth = depth;
+	}
+
+	return chosen_depth;
+}
+
+void visibility_test_ray_caster::
+load_models(const std::vector<scm::math::mat4f>& model_transformations, const std::vector<bool>& use_model)
+{
+	lamure::ren::model_database* database = lamure::ren::model_database::get_instance();
+	uint32_t cut_depth = choose_cut_depth();
+
+	std::cout << "ray casting against LOD depth " << cut_depth << std::endl;
+
+	models_.clear();
+
+	for(lamure::model_t model_id = 0; model_id < database->num_models(); ++model_id)
+	{
+		if(!use_model[model_id])
+		{
+			continue;
+		}
+
+		const lamure::ren::bvh* bvh = database->get_model(model_id)->get_bvh();
+
+		if(bvh->get_primitive() != lamure::ren::bvh::primitive_type::POINTCLOUD)
+		{
+			std::cout << "Model " << model_id << " is skipped, the ray caster supports uncompressed point clouds only." << std::endl;
+			continue;
+		}
+
+		model_scene model;
+		model.model_id = model_id;
+		model.fan_factor = bvh->get_fan_factor();
+		model.cut_depth = std::min(cut_depth, bvh->get_depth());
+		model.first_cut_node = bvh->get_first_node_id_of_depth(model.cut_depth);
+		model.num_cut_nodes = bvh->get_length_of_depth(model.cut_depth);
+
+		// Surfels are stored relative to the translation of the bvh, like in the renderer.
+		scm::math::mat4f transform = model_transformations[model_id] * scm::math::make_translation(bvh->get_translation());
+		scm::math::mat4f normal_transform = scm::math::transpose(scm::math::inverse(transform));
+		float radius_scale = scm::math::length(scm::math::vec3f(transform * scm::math::vec4f(1.0f, 0.0f, 0.0f, 0.0f))) * radius_scale_;
+
+		// Boxes of all nodes down to the cut depth, transformed into world space.
+		node_t num_traversed_nodes = model.first_cut_node + model.num_cut_nodes;
+		model.node_bounds.resize(num_traversed_nodes);
+
+		for(node_t node_id = 0; node_id < num_traversed_nodes; ++node_id)
+		{
+			const scm::gl::boxf& local_bounds = bvh->get_bounding_boxes()[node_id];
+			scm::math::vec3f min_vertex(std::numeric_limits<float>::max());
+			scm::math::vec3f max_vertex(std::numeric_limits<float>::lowest());
+
+			for(unsigned int corner_index = 0; corner_index < 8; ++corner_index)
+			{
+				scm::math::vec4f corner((corner_index & 1) ? local_bounds.max_vertex().x : local_bounds.min_vertex().x,
+										(corner_index & 2) ? local_bounds.max_vertex().y : local_bounds.min_vertex().y,
+										(corner_index & 4) ? local_bounds.max_vertex().z : local_bounds.min_vertex().z,
+										1.0f);
+				scm::math::vec4f world_corner = transform * corner;
+
+				for(unsigned int axis = 0; axis < 3; ++axis)
+				{
+					min_vertex[axis] = std::min(min_vertex[axis], world_corner[axis]);
+					max_vertex[axis] = std::max(max_vertex[axis], world_corner[axis]);
+				}
+			}
+
+			model.node_bounds[node_id] = scm::gl::boxf(min_vertex, max_vertex);
+		}
+
+		// Read the splats of the cut nodes, the nodes of a depth are stored consecutively in the LOD file.
+		std::string bvh_filename = bvh->get_filename();
+		std::string base_name = bvh_filename.substr(0, bvh_filename.find_last_of(".") + 1);
+		std::string file_extension = bvh_filename.substr(base_name.size());
+		std::string lod_file_name = base_name + "lod" + file_extension.substr(3);
+
+		lamure::ren::lod_stream lod_file;
+		lod_file.open(lod_file_name);
+
+		size_t surfels_per_node = bvh->get_primitives_per_node();
+		size_t node_size = database->get_node_size(model_id);
+		std::vector<lamure::ren::dataset::serialized_surfel> surfels(surfels_per_node);
+
+		model.splat_offsets.reserve(model.num_cut_nodes + 1);
+		model.splat_offsets.push_back(0);
+
+		for(node_t cut_node_index = 0; cut_node_index < model.num_cut_nodes; ++cut_node_index)
+		{
+			node_t node_id = model.first_cut_node + cut_node_index;
+
+			if(bvh->get_visibility(node_id) != lamure::ren::bvh::node_visibility::NODE_INVISIBLE)
+			{
+				lod_file.read((char*)surfels.data(), (size_t)node_id * node_size, node_size);
+
+				for(const lamure::ren::dataset::serialized_surfel& surfel : surfels)
+				{
+					if(surfel.size <= std::numeric_limits<float>::min())
+					{
+						continue;
+					}
+
+					scm::math::vec4f position = transform * scm::math::vec4f(surfel.x, surfel.y, surfel.z, 1.0f);
+					scm::math::vec3f normal = scm::math::normalize(scm::math::vec3f(normal_transform * scm::math::vec4f(surfel.nx, surfel.ny, surfel.nz, 0.0f)));
+					float radius = surfel.size * radius_scale;
+
+					splat current_splat = {position.x, position.y, position.z, normal.x, normal.y, normal.z, radius * radius};
+					model.splats.push_back(current_splat);
+				}
+			}
+
+			model.splat_offsets.push_back(model.splats.size());
+		}
+
+		lod_file.close();
+
+		std::cout << "model " << model_id << ": " << model.num_cut_nodes << " nodes, " << model.splats.size() << " splats" << std::endl;
+
+		models_.push_back(std::move(model));
+	}
+}
+
+void visibility_test_ray_caster::
+test_visibility(grid* visibility_grid)
+{
+	std::atomic<size_t> next_cell_index(0);
+	std::atomic<size_t> total_num_rays(0);
+	std::mutex grid_mutex;
+	size_t num_cells = visibility_grid->get_cell_count();
+	size_t num_cells_done = 0;
+
+	auto start_time = std::chrono::system_clock::now();
+
+	auto worker = [&]()
+	{
+		// Per thread buffers, reused for all cells of the thread.
+		std::vector<std::vector<bool>> visible_nodes(visibility_grid->get_num_models());
+		std::vector<std::vector<uint32_t>> hit_counts(models_.size());
+
+		for(model_t model_index = 0; model_index < visible_nodes.size(); ++model_index)
+		{
+			visible_nodes[model_index].resize(visibility_grid->get_num_nodes(model_index));
+		}
+
+		for(size_t model_index = 0; model_index < models_.size(); ++model_index)
+		{
+			hit_counts[model_index].resize(models_[model_index].num_cut_nodes);
+		}
+
+		size_t cell_index;
+		while((cell_index = next_cell_index++) < num_cells)
+		{
+			size_t num_rays = 0;
+			test_cell(visibility_grid, cell_index, visible_nodes, hit_counts, num_rays);
+			total_num_rays += num_rays;
+
+			std::lock_guard<std::mutex> lock(grid_mutex);
+
+			for(model_t model_index = 0; model_index < visible_nodes.size(); ++model_index)
+			{
+				for(node_t node_id = 0; node_id < visible_nodes[model_index].size(); ++node_id)
+				{
+					if(visible_nodes[model_index][node_id])
+					{
+						visibility_grid->set_cell_visibility(cell_index, model_index, node_id, true);
+					}
+				}
+			}
+
+			// Calculate current ray casting state so user gets visual feedback on the preprocessing progress.
+			++num_cells_done;
+			float current_percentage_done = ((float)num_cells_done / (float)num_cells) * 100.0f;
+			std::cout << "\rray casting in progress [" << current_percentage_done << "]       " << std::flush;
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for(unsigned int thread_index = 0; thread_index < num_threads_; ++thread_index)
+	{
+		threads.push_back(std::thread(worker));
+	}
+
+	for(std::thread& thread : threads)
+	{
+		thread.join();
+	}
+
+	std::cout << std::endl;
+
+	std::chrono::duration<double> elapsed_seconds = std::chrono::system_clock::now() - start_time;
+	rays_per_second_ = (double)total_num_rays / elapsed_seconds.count();
+	cells_per_minute_ = (double)num_cells / (elapsed_seconds.count() / 60.0);
+
+	std::cout << "ray casting: " << num_cells << " cells in " << elapsed_seconds.count() << " s, "
+			  << rays_per_second_ / 1000000.0 << " Mrays/s, " << cells_per_minute_ << " cells/min" << std::endl;
+
+	if(pvs_file_path_.size() > 4)
+	{
+		std::string performance_file_path = pvs_file_path_;
+		performance_file_path.resize(performance_file_path.size() - 4);
+		performance_file_path += "_performance.txt";
+
+		std::ofstream file_out;
+		file_out.open(performance_file_path);
+
+		file_out << "---------- ray casting performance ----------" << std::endl;
+		file_out << "threads: " << num_threads_ << std::endl;
+		file_out << "rays: " << total_num_rays << std::endl;
+		file_out << "rays per second: " << rays_per_second_ << std::endl;
+		file_out << "cells per minute: " << cells_per_minute_ << std::endl;
+		file_out << "visibility test: " << elapsed_seconds.count() << std::endl;
+		file_out << std::endl;
+
+		file_out.close();
+	}
+}
+
+void visibility_test_ray_caster::
+test_cell(grid* visibility_grid, const size_t& cell_index, std::vector<std::vector<bool>>& visible_nodes, std::vector<std::vector<uint32_t>>& hit_counts, size_t& num_rays) const
+{
+	const view_cell* current_cell = visibility_grid->get_cell_at_index(cell_index);
+	scm::math::vec3d cell_center = current_cell->get_position_center();
+	scm::math::vec3d cell_size = current_cell->get_size();
+
+	for(std::vector<bool>& model_visible_nodes : visible_nodes)
+	{
+		std::fill(model_visible_nodes.begin(), model_visible_nodes.end(), false);
+	}
+
+	ray_packet packet;
+	packet.origin_x = (float)cell_center.x;
+	packet.origin_y = (float)cell_center.y;
+	packet.origin_z = (float)cell_center.z;
+
+	std::vector<std::pair<node_t, uint32_t>> stack;
+	size_t num_rays_per_direction = (size_t)resolution_ * resolution_;
+
+	// Same six directions and near planes as the histogram renderer, each direction covers 90 degrees.
+	for(unsigned int direction_index = 0; direction_index < 6; ++direction_index)
+	{
+		unsigned int axis = direction_index / 2;
+		float axis_sign = (direction_index % 2 == 0) ? 1.0f : -1.0f;
+		unsigned int axis_u = (axis + 1) % 3;
+		unsigned int axis_v = (axis + 2) % 3;
+
+		float t_near = (float)cell_size[axis] * 0.5f;
+
+		for(std::vector<uint32_t>& model_hit_counts : hit_counts)
+		{
+			std::fill(model_hit_counts.begin(), model_hit_counts.end(), 0);
+		}
+
+		for(size_t first_ray_index = 0; first_ray_index < num_rays_per_direction; first_ray_index += ray_packet_size)
+		{
+			size_t num_packet_rays = std::min(ray_packet_size, num_rays_per_direction - first_ray_index);
+
+			for(size_t ray_index = 0; ray_index < ray_packet_size; ++ray_index)
+			{
+				// Lanes beyond the last ray repeat it, their hits are not counted.
+				size_t pixel_index = first_ray_index + std::min(ray_index, num_packet_rays - 1);
+				float direction[3];
+
+				direction[axis] = axis_sign;
+				direction[axis_u] = ((float)(pixel_index % resolution_) + 0.5f) / (float)resolution_ * 2.0f - 1.0f;
+				direction[axis_v] = ((float)(pixel_index / resolution_) + 0.5f) / (float)resolution_ * 2.0f - 1.0f;
+
+				// Directions are not normalized, so t is the distance along the view direction like the depth of the renderer.
+				packet.direction_x[ray_index] = direction[0];
+				packet.direction_y[ray_index] = direction[1];
+				packet.direction_z[ray_index] = direction[2];
+				packet.inverse_direction_x[ray_index] = 1.0f / direction[0];
+				packet.inverse_direction_y[ray_index] = 1.0f / direction[1];
+				packet.inverse_direction_z[ray_index] = 1.0f / direction[2];
+
+				packet.t_near[ray_index] = t_near;
+				packet.t_hit[ray_index] = std::numeric_limits<float>::max();
+				packet.hit_model[ray_index] = -1;
+			}
+
+			for(size_t model_index = 0; model_index < models_.size(); ++model_index)
+			{
+				cast_packet(packet, models_[model_index], (int32_t)model_index, stack);
+			}
+
+			for(size_t ray_index = 0; ray_index < num_packet_rays; ++ray_index)
+			{
+				if(packet.hit_model[ray_index] >= 0)
+				{
+					const model_scene& model = models_[packet.hit_model[ray_index]];
+					++hit_counts[packet.hit_model[ray_index]][packet.hit_node[ray_index] - model.first_cut_node];
+				}
+			}
+
+			num_rays += num_packet_rays;
+		}
+
+		// Like the histogram, a node is visible if it covers the given percentage of the rays of one direction.
+		for(size_t model_index = 0; model_index < models_.size(); ++model_index)
+		{
+			const model_scene& model = models_[model_index];
+
+			for(node_t cut_node_index = 0; cut_node_index < model.num_cut_nodes; ++cut_node_index)
+			{
+				if(hit_counts[model_index][cut_node_index] > 0 &&
+					((float)hit_counts[model_index][cut_node_index] / (float)num_rays_per_direction) * 100.0f >= visibility_threshold_)
+				{
+					visible_nodes[model.model_id][model.first_cut_node + cut_node_index] = true;
+				}
+			}
+		}
+	}
+
+	// Nodes inside the view cell are not covered by the rays since they start at the near plane.
+	scm::gl::boxf cell_bounds(scm::math::vec3f(cell_center - cell_size * 0.5), scm::math::vec3f(cell_center + cell_size * 0.5));
+
+	for(const model_scene& model : models_)
+	{
+		for(node_t cut_node_index = 0; cut_node_index < model.num_cut_nodes; ++cut_node_index)
+		{
+			const scm::gl::boxf& node_bounds = model.node_bounds[model.first_cut_node + cut_node_index];
+
+			if(!(node_bounds.max_vertex().x < cell_bounds.min_vertex().x || node_bounds.max_vertex().y < cell_bounds.min_vertex().y || node_bounds.max_vertex().z < cell_bounds.min_vertex().z ||
+				node_bounds.min_vertex().x > cell_bounds.max_vertex().x || node_bounds.min_vertex().y > cell_bounds.max_vertex().y || node_bounds.min_vertex().z > cell_bounds.max_vertex().z))
+			{
+				visible_nodes[model.model_id][model.first_cut_node + cut_node_index] = true;
+			}
+		}
+	}
+
+	// Hardcoded heresy. This grid type applies visibility propagation at runtime.
+	if(visibility_grid->get_grid_type() != "octree_hierarchical_v3")
+	{
+		for(const model_scene& model : models_)
+		{
+			propagate_visibility(model.model_id, visible_nodes[model.model_id]);
+		}
+	}
+}
+
+void visibility_test_ray_caster::
+propagate_visibility(const model_t& model_index, std::vector<bool>& visible_nodes) const
+{
+	// Since only a single LOD-level was tested, parents and children of visible nodes are visible, too.
+	const lamure::ren::bvh* bvh = lamure::ren::model_database::get_instance()->get_model(model_index)->get_bvh();
+	uint32_t fan_factor = bvh->get_fan_factor();
+	node_t num_nodes = std::min((node_t)visible_nodes.size(), (node_t)bvh->get_num_nodes());
+
+	// Children first, they are visited after their parents, so a single pass reaches all descendants of the tested nodes.
+	for(node_t node_id = 0; node_id < num_nodes; ++node_id)
+	{
+		if(!visible_nodes[node_id])
+		{
+			continue;
+		}
+
+		for(uint32_t child_index = 0; child_index < fan_factor; ++child_index)
+		{
+			node_t child_id = bvh->get_child_id(node_id, child_index);
+
+			if(child_id < num_nodes)
+			{
+				visible_nodes[child_id] = true;
+			}
+		}
+	}
+
+	// Parents only up to the first visible one, so the siblings of visible nodes stay invisible.
+	for(node_t node_id = 0; node_id < num_nodes; ++node_id)
+	{
+		if(!visible_nodes[node_id])
+		{
+			continue;
+		}
+
+		node_t parent_id = bvh->get_parent_id(node_id);
+		while(parent_id != lamure::invalid_node_t && !visible_nodes[parent_id])
+		{
+			visible_nodes[parent_id] = true;
+			parent_id = bvh->get_parent_id(parent_id);
+		}
+	}
+}
+
+void visibility_test_ray_caster::
+shutdown()
+{
+	if(initialized_)
+	{
+		models_.clear();
+		initialized_ = false;
+
+		delete lamure::pvs::pvs_database::get_instance();
+
+		delete lamure::ren::controller::get_instance();
+		delete lamure::ren::model_database::get_instance();
+	}
+}
+
+bounding_box visibility_test_ray_caster::
+get_scene_bounds() const
+{
+	return scene_bounds_;
+}
+
+double visibility_test_ray_caster::
+get_rays_per_second() const
+{
+	return rays_per_second_;
+}
+
+double visibility_test_ray_caster::
+get_cells_per_minute() const
+{
+	return cells_per_minute_;
+}
+
+}
+}
@@ -23,6 +23,7 @@
 #include <lamure/types.h>
 #include <lamure/ren/platform.h>
 #include <lamure/ren/cache_index.h>
+#include <lamure/ren/clock_cache_index.h>
 
 namespace lamure {
 namespace ren {
@@ -13,6 +13,7 @@
 #include <lamure/ren/config.h>
 #include <lamure/ren/platform.h>
 
+#include <functional>
 #include <vector>
 #include <set>
 #include <map>
@@ -32,23 +33,40 @@ public:
 
     const slot_t        num_slots() const { return num_slots_; };
 
-    const slot_t        num_free_slots();
-    const slot_t        reserve_slot();
-    void                apply_slot(const slot_t slot_id, const model_t model_id, const node_t node_id);
-    void                unreserve_slot(const slot_t slot_id);
+    virtual const slot_t num_free_slots();
+    virtual const slot_t reserve_slot();
+    virtual void        apply_slot(const slot_t slot_id, const model_t model_id, const node_t node_id);
+    virtual void        unreserve_slot(const slot_t slot_id);
 
-    const slot_t        get_slot(const model_t model_id, const node_t node_id);
-    const bool          is_node_indexed(const model_t model_id, const node_t node_id);
-    const bool          is_node_aquired(const model_t model_id, const node_t node_id);
+    virtual const slot_t get_slot(const model_t model_id, const node_t node_id);
+    virtual const bool  is_node_indexed(const model_t model_id, const node_t node_id);
+    virtual const bool  is_node_aquired(const model_t model_id, const node_t node_id);
 
-    void                aquire_slot(const view_t view_id, const model_t model_id, const node_t node_id);
-    void                release_slot(const view_t view_id, const model_t model_id, const node_t node_id);
-    const bool          release_slot_invalidate(const view_t view_id, const model_t model_id, const node_t node_id);
+    virtual void        aquire_slot(const view_t view_id, const model_t model_id, const node_t node_id);
+    //aquires the slot if the node is indexed, lookup and aquire are one step
+    virtual const bool  try_aquire_slot(const view_t view_id, const model_t model_id, const node_t node_id);
+    virtual void        release_slot(const view_t view_id, const model_t model_id, const node_t node_id);
+    virtual const bool  release_slot_invalidate(const view_t view_id, const model_t model_id, const node_t node_id);
 
-private:
+    //called whenever a node drops out of the index, e.g. to issue residency hints
+    typedef std::function<void(const model_t, const node_t)> eviction_hint;
+    void                set_eviction_hint(const eviction_hint& hint) { eviction_hint_ = hint; };
+
+protected:
+    //for derived indices that keep their own slot bookkeeping, skips the lru list
+                        cache_index(const model_t num_models, const slot_t num_slots, const bool lru_list);
+
+    void                evict(const model_t model_id, const node_t node_id);
 
     model_t             num_models_;
     slot_t              num_slots_;
+
+private:
+    //mutex_ has to be held
+    void                aquire(const view_t view_id, const slot_t slot_id);
+
+    eviction_hint       eviction_hint_;
+
     slot_t              num_free_slots_;
 
 
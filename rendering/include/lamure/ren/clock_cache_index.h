@@ -0,0 +1,113 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#ifndef REN_CLOCK_CACHE_INDEX_H_
+#define REN_CLOCK_CACHE_INDEX_H_
+
+#include <lamure/ren/cache_index.h>
+
+#include <atomic>
+#include <memory>
+
+
+namespace lamure {
+namespace ren {
+
+/**
+* Cache index with CLOCK (second chance) replacement instead of an lru list.
+*
+* Every slot keeps its state in one atomic word: a reference bit that is
+* set on every aquire, a pinned bit while views hold the slot and a
+* reserved bit between reserve_slot and apply_slot / unreserve_slot.
+* reserve_slot advances a shared clock hand and claims the first slot that
+* is neither pinned nor referenced, clearing reference bits as it passes.
+*
+* The (model, node) to slot mapping is split into shards with one mutex
+* each, so lookups, aquires and releases of different nodes do not contend
+* and reserve_slot takes no lock until it evicts a node.
+*/
+class RENDERING_DLL clock_cache_index : public cache_index
+{
+public:
+                        clock_cache_index(const model_t num_models, const slot_t num_slots);
+    virtual             ~clock_cache_index();
+
+    const slot_t        num_free_slots() override;
+    const slot_t        reserve_slot() override;
+    void                apply_slot(const slot_t slot_id, const model_t model_id, const node_t node_id) override;
+    void                unreserve_slot(const slot_t slot_id) override;
+
+    const slot_t        get_slot(const model_t model_id, const node_t node_id) override;
+    const bool          is_node_indexed(const model_t model_id, const node_t node_id) override;
+    const bool          is_node_aquired(const model_t model_id, const node_t node_id) override;
+
+    void                aquire_slot(const view_t view_id, const model_t model_id, const node_t node_id) override;
+    const bool          try_aquire_slot(const view_t view_id, const model_t model_id, const node_t node_id) override;
+    void                release_slot(const view_t view_id, const model_t model_id, const node_t node_id) override;
+    const bool          release_slot_invalidate(const view_t view_id, const model_t model_id, const node_t node_id) override;
+
+private:
+    enum slot_state : uint32_t
+    {
+        REFERENCED = 1,
+        PINNED = 2,
+        RESERVED = 4
+    };
+
+    struct clock_slot
+    {
+        clock_slot()
+            : state_(0),
+            model_id_(invalid_model_t),
+            node_id_(invalid_node_t) {};
+
+        std::atomic<uint32_t> state_;
+        model_t         model_id_;
+        node_t          node_id_;
+        //guarded by the shard of (model_id_, node_id_)
+        std::vector<view_t> views_;
+    };
+
+    struct shard
+    {
+        std::mutex      mutex_;
+        std::unordered_map<uint64_t, slot_t> slots_;
+    };
+
+    static const size_t num_shards_ = 64;
+
+    inline static const uint64_t key(const model_t model_id, const node_t node_id)
+    {
+        return (uint64_t(model_id) << 32) | uint64_t(node_id);
+    }
+
+    inline shard&       shard_of(const uint64_t key)
+    {
+        //top 6 bits of the hash, one of 64 shards
+        return shards_[(key * 0x9E3779B97F4A7C15ull) >> 58];
+    }
+
+    //slot of an indexed node that is not being replaced, invalid_slot_t otherwise,
+    //the shard of the node has to be locked
+    const slot_t        find_slot(shard& shard, const uint64_t key) const;
+    //pins the slot for the view, false if the slot is being replaced,
+    //the shard of the node of the slot has to be locked
+    const bool          aquire(const view_t view_id, const slot_t slot_id);
+
+    std::atomic<slot_t> num_free_slots_;
+    std::atomic<uint64_t> hand_;
+
+    std::unique_ptr<clock_slot[]> slots_;
+    std::unique_ptr<shard[]> shards_;
+};
+
+
+
+} } // namespace lamure
+
+
+#endif // REN_CLOCK_CACHE_INDEX_H_
@@ -39,6 +39,7 @@ namespace ren {
 
 //#define LAMURE_CUT_UPDATE_ENABLE_CUT_UPDATE_EXPERIMENTAL_MODE
 
+// 0 uses one thread per hardware thread
 #define LAMURE_CUT_UPDATE_NUM_CUT_UPDATE_THREADS 4
 
 //#define LAMURE_CUT_UPDATE_ENABLE_SHOW_OOC_CACHE_USAGE
@@ -62,9 +63,17 @@ namespace ren {
 #define LAMURE_MIN_THRESHOLD 0.1f
 #define LAMURE_MAX_THRESHOLD 10.f
 
-//#define LAMURE_CUT_UPDATE_ENABLE_PREFETCHING
-#define LAMURE_CUT_UPDATE_PREFETCH_FACTOR 5.f
+//speculative out-of-core requests for extrapolated camera poses,
+//frames to look ahead (0 disables) and requests per frame, see policy
+#define LAMURE_CUT_UPDATE_DEFAULT_PREFETCH_FRAMES 0
 #define LAMURE_CUT_UPDATE_PREFETCH_BUDGET 1024
+//levels below the cut that are requested for a predicted pose
+#define LAMURE_CUT_UPDATE_PREFETCH_MAX_LEVELS 3
+//speculative requests are queued below all demand requests
+#define LAMURE_CUT_UPDATE_PREFETCH_PRIORITY_BAND (1 << 24)
+//frames a speculative request waits for its demand before it counts as wasted
+#define LAMURE_CUT_UPDATE_PREFETCH_EXPIRY_FRAMES 120
+//#define LAMURE_CUT_UPDATE_ENABLE_SHOW_PREFETCH_STATS
 
 #define LAMURE_MIN_UPLOAD_BUDGET 16
 #define LAMURE_MIN_VIDEO_MEMORY_BUDGET 128
@@ -95,6 +104,12 @@ namespace ren {
 #define LAMURE_CUT_UPDATE_LOADING_QUEUE_MODE cache_queue::update_mode::UPDATE_ALWAYS
 //#define LAMURE_CUT_UPDATE_LOADING_QUEUE_MODE cache_queue::update_mode::UPDATE_INCREMENT_ONLY
 
+#define LAMURE_CUT_UPDATE_LOADER_MODE ooc_pool::loader_mode::LOADER_BLOCKING
+//#define LAMURE_CUT_UPDATE_LOADER_MODE ooc_pool::loader_mode::LOADER_BATCHED
+
+//max. number of jobs in flight for LOADER_BATCHED
+#define LAMURE_CUT_UPDATE_LOADING_QUEUE_DEPTH 64
+
 //------------------------------
 //for bvh_stream: 
 //------------------------------
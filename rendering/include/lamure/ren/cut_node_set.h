@@ -0,0 +1,103 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#ifndef REN_CUT_NODE_SET_H_
+#define REN_CUT_NODE_SET_H_
+
+#include <vector>
+#include <cstdint>
+
+#include <lamure/types.h>
+#include <lamure/ren/platform.h>
+
+namespace lamure {
+namespace ren {
+
+/**
+* The nodes of one cut front of a model. Membership is kept in a bitset
+* over all node ids of the model, iteration goes over a compact node list.
+*
+* Inserting and erasing only touch the bitset and append to the list; the
+* list is sorted and stale entries are dropped by compact(), which has to
+* be called before iterating. Iteration is in ascending node order, so
+* siblings are adjacent.
+*/
+class RENDERING_DLL cut_node_set
+{
+public:
+    typedef std::vector<node_t>::const_iterator const_iterator;
+
+                        cut_node_set();
+                        ~cut_node_set() {};
+
+    // sizes the bitset for node ids [0, num_nodes) up front
+    void                reserve(const node_t num_nodes);
+
+    inline const bool   contains(const node_t node_id) const
+    {
+        const size_t word = node_id >> 6;
+        return word < bits_.size() && ((bits_[word] >> (node_id & 63)) & 1);
+    }
+
+    inline void         insert(const node_t node_id)
+    {
+        // children lists of leaves contain invalid ids
+        if (node_id == invalid_node_t) {
+            return;
+        }
+        const size_t word = node_id >> 6;
+        if (word >= bits_.size()) {
+            bits_.resize(word + 1, 0);
+        }
+        const uint64_t mask = uint64_t(1) << (node_id & 63);
+        if (bits_[word] & mask) {
+            return;
+        }
+        bits_[word] |= mask;
+        if (!nodes_.empty() && nodes_.back() > node_id) {
+            dirty_ = true;
+        }
+        nodes_.push_back(node_id);
+        ++size_;
+    }
+
+    template <typename iterator_t>
+    void                insert(iterator_t first, iterator_t last)
+    {
+        for (; first != last; ++first) {
+            insert(*first);
+        }
+    }
+
+    void                erase(const node_t node_id);
+    void                clear();
+
+    // sorts the node list and removes erased and duplicate entries
+    void                compact();
+
+    inline const size_t size() const { return size_; };
+    inline const bool   empty() const { return size_ == 0; };
+
+    // only valid after compact()
+    inline const_iterator begin() const { return nodes_.begin(); };
+    inline const_iterator end() const { return nodes_.end(); };
+    inline const std::vector<node_t>& nodes() const { return nodes_; };
+
+private:
+
+    std::vector<uint64_t> bits_;
+    std::vector<node_t> nodes_;
+    size_t              size_;
+    bool                dirty_;
+
+};
+
+
+} } // namespace lamure
+
+
+#endif // REN_CUT_NODE_SET_H_
@@ -11,6 +11,7 @@
 #include <lamure/types.h>
 #include <lamure/utils.h>
 #include <lamure/ren/config.h>
+#include <lamure/ren/cut_node_set.h>
 #include <vector>
 #include <unordered_map>
 #include <unordered_set>
@@ -21,6 +22,7 @@
 #include <assert.h>
 #include <algorithm>
 #include <stack>
+#include <limits>
 
 #include <lamure/ren/model_database.h>
 
@@ -94,13 +96,14 @@ public:
     const size_t        num_actions(const queue_t queue);
 
     void                push_action(const action& action, bool sort);
+    void                push_actions(const std::vector<action>& actions, bool sort);
     const action        front_action(const queue_t queue);
     const action        back_action(const queue_t queue);
     void                pop_front_action(const queue_t queue);
     void                Popback_action(const queue_t queue);
 
-    const std::set<node_t>& get_current_cut(const view_t view_id, const model_t model_id);
-    const std::set<node_t>& get_previous_cut(const view_t view_id, const model_t model_id);
+    const cut_node_set& get_current_cut(const view_t view_id, const model_t model_id);
+    const cut_node_set& get_previous_cut(const view_t view_id, const model_t model_id);
     void                swap_cuts();
     void                reset_cut(const view_t view_id, const model_t model_id);
 
@@ -124,13 +127,89 @@ private:
         INVALID_FRONT = 2
     };
 
-    void                add_action(const action& action, bool sort);
+    /**
+    * Max-heap of actions ordered by error, 4-ary so sifting touches
+    * fewer cache lines. An open-addressing table maps (view, model, node)
+    * to the heap position, so removing or updating an action is
+    * O(log n). Pushing an action whose view, model and node are
+    * already queued replaces the queued one.
+    *
+    * Both arrays keep their capacity when emptied, so a running cut
+    * update does not allocate.
+    */
+    class action_queue
+    {
+    public:
+                            action_queue();
+
+        inline const size_t size() const { return heap_.size(); };
+        inline const bool   empty() const { return heap_.empty(); };
+
+        inline const action& front() const { return heap_.front().action_; };
+        // the last heap slot, a leaf with a low error
+        inline const action& back() const { return heap_.back().action_; };
+
+        void                push(const action& action);
+        // adds without restoring the heap order, call heapify() afterwards
+        void                append(const action& action);
+        void                heapify();
+
+        void                pop_front();
+        void                pop_back();
+        const bool          remove(const view_t view_id, const model_t model_id, const node_t node_id);
+        void                clear();
+
+    private:
+        struct heap_entry
+        {
+            action          action_;
+            uint32_t        table_slot_;
+        };
+
+        struct table_entry
+        {
+            view_t          view_id_;
+            model_t         model_id_;
+            node_t          node_id_;
+            uint32_t        position_;
+        };
+
+        static const uint32_t empty_position = std::numeric_limits<uint32_t>::max();
+
+        inline const size_t hash(const view_t view_id, const model_t model_id, const node_t node_id) const
+        {
+            uint64_t h = uint64_t(node_id) * 0x9E3779B97F4A7C15ull;
+            h ^= (uint64_t(model_id) + 1) * 0xC2B2AE3D27D4EB4Full;
+            h ^= (uint64_t(view_id) + 1) * 0x165667B19E3779F9ull;
+            h ^= h >> 29;
+            return size_t(h) & (table_.size() - 1);
+        }
+
+        const uint32_t      find(const view_t view_id, const model_t model_id, const node_t node_id) const;
+        const uint32_t      insert_key(const action& action, const uint32_t position);
+        void                erase_key(uint32_t table_slot);
+        void                grow();
+
+        // true if the action was merged into a queued one
+        const bool          add(const action& action);
+
+        inline void         place(const size_t position, const heap_entry& entry)
+        {
+            heap_[position] = entry;
+            table_[entry.table_slot_].position_ = uint32_t(position);
+        }
+
+        void                sift_up(size_t position);
+        void                sift_down(size_t position);
+        void                remove_at(const size_t position);
+
+        std::vector<heap_entry> heap_;
+        std::vector<table_entry> table_;
+    };
 
-    void                swap(const queue_t queue, const size_t slot_id_0, const size_t slot_id_1);
-    void                shuffle_up(const queue_t queue, const size_t slot_id);
-    void                shuffle_down(const queue_t queue, const size_t slot_id);
+    void                add_action(const action& action, bool sort);
+    void                reserve_cuts();
 
-    size_t              num_slots_[queue_t::NUM_QUEUES];
     view_t              num_views_;
     model_t             num_models_;
     std::mutex          mutex_;
@@ -139,16 +218,14 @@ private:
     std::vector<node_t> num_nodes_table_;
     std::set<view_t> view_ids_;
 
-    std::vector<action> slots_[queue_t::NUM_QUEUES];
-    std::stack<action> initial_queue_;
-
-    //mapping [queue] (model, node) to slot
-    std::vector<std::map<node_t, std::set<slot_t>>> slot_maps_[queue_t::NUM_QUEUES];
+    action_queue        queues_[queue_t::NUM_QUEUES];
+    // actions pushed without sorting, moved to the queues by sort()
+    std::vector<action> initial_queue_;
 
     cut_front            current_cut_front_;
     //[user][model][node]
-    std::map<view_t, std::vector<std::set<node_t>>> front_a_cuts_;
-    std::map<view_t, std::vector<std::set<node_t>>> front_b_cuts_;
+    std::map<view_t, std::vector<cut_node_set>> front_a_cuts_;
+    std::map<view_t, std::vector<cut_node_set>> front_b_cuts_;
 
 };
 
@@ -25,7 +25,9 @@
 #include <lamure/ren/cut_update_index.h>
 #include <lamure/ren/cut_update_queue.h>
 #include <lamure/ren/gpu_cache.h>
+#include <lamure/ren/node_kernels.h>
 #include <lamure/ren/ooc_cache.h>
+#include <lamure/ren/predictive_prefetcher.h>
 
 namespace lamure
 {
@@ -43,6 +45,11 @@ class cut_update_pool
 
     const bool is_running();
 
+    // decides the actions of one (view, model) pair from its previous cut and resets its current cut. The analysis
+    // jobs and apps/cut_update_benchmark, which replays camera sessions without a gpu context, both call this.
+    static void analyse_cut(cut_update_index &index, const bvh_soa &nodes, const node_view_params &params, const view_t view_id, const model_t model_id,
+                            const float threshold, const bool freshness_timeout, std::vector<cut_update_index::action> &actions);
+
   protected:
     void initialize();
     const bool prepare();
@@ -51,7 +58,7 @@ class cut_update_pool
     void collapse_node(const cut_update_index::action &item);
     void cut_update_split_again(const cut_update_index::action &split_action);
 
-    const bool is_all_nodes_in_cut(const model_t model_id, const std::vector<node_t> &node_ids, const std::set<node_t> &cut);
+    static const bool is_all_nodes_in_cut(const cut_update_index &index, const model_t model_id, const std::vector<node_t> &node_ids, const cut_node_set &cut);
     const bool is_node_in_frustum(const view_t view_id, const model_t model_id, const node_t node_id, const scm::gl::frustum &frustum);
     const bool is_no_node_in_frustum(const view_t view_id, const model_t model_id, const std::vector<node_t> &node_ids, const scm::gl::frustum &frustum);
 
@@ -65,9 +72,7 @@ class cut_update_pool
     void cut_update();
     void compile_transfer_list();
     void compile_render_list();
-#ifdef LAMURE_CUT_UPDATE_ENABLE_PREFETCHING
     void prefetch_routine();
-#endif
 
   private:
     bool is_shutdown();
@@ -88,6 +93,12 @@ class cut_update_pool
     gpu_cache *gpu_cache_;
     cut_update_index *index_;
 
+    // [model], read by the analysis jobs
+    std::vector<bvh_soa> node_data_;
+
+    // [view * num_models + model]
+    std::vector<std::vector<cut_update_index::action>> analysis_actions_;
+
     std::vector<cut_database_record::slot_update_desc> transfer_list_;
     std::vector<std::vector<std::vector<cut::node_slot_aggregate>>> render_list_;
 
@@ -118,9 +129,7 @@ class cut_update_pool
     std::map<model_t, size_t> model_freshness_;
 #endif
 
-#ifdef LAMURE_CUT_UPDATE_ENABLE_PREFETCHING
-    std::vector<cut_update_index::action> pending_prefetch_set_;
-#endif
+    predictive_prefetcher prefetcher_;
 
 #ifdef LAMURE_CUT_UPDATE_ENABLE_REPEAT_MODE
     boost::timer::cpu_timer master_timer_;
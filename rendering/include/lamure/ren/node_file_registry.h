@@ -0,0 +1,87 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#ifndef REN_NODE_FILE_REGISTRY_H_
+#define REN_NODE_FILE_REGISTRY_H_
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include <lamure/ren/platform.h>
+
+namespace lamure {
+namespace ren
+{
+
+// keeps one read-only handle per registered file open for the whole
+// lifetime of the registry. reads are positional (pread / overlapped
+// ReadFile), so any number of threads may read from the same handle
+// concurrently without seeking or locking.
+class RENDERING_DLL node_file_registry
+{
+public:
+    typedef uint32_t    file_t;
+    const static file_t invalid_file_t = 0xFFFFFFFF;
+
+                        node_file_registry();
+                        node_file_registry(const node_file_registry&) = delete;
+                        node_file_registry& operator=(const node_file_registry&) = delete;
+    virtual             ~node_file_registry();
+
+    const file_t        register_file(const std::string& file_name);
+    void                close();
+
+    const size_t        num_files() const { return handles_.size(); };
+    const uint64_t      file_size(const file_t file_id) const;
+    const std::string&  file_name(const file_t file_id) const;
+#ifndef _WIN32
+    const int           descriptor(const file_t file_id) const;
+#endif
+
+    // reads length_in_bytes at offset_in_bytes directly into data.
+    // bytes beyond the end of the file are zeroed.
+    void                read(const file_t file_id,
+                            char* const data,
+                            const size_t offset_in_bytes,
+                            const size_t length_in_bytes) const;
+
+    // maps the whole file read-only. padding_in_bytes of zeroes are
+    // readable past the end of the file, so fixed-size slot copies of the
+    // last node stay in bounds. returns nullptr if mapping is unsupported.
+    const char*         map(const file_t file_id, const size_t padding_in_bytes);
+    const char*         mapped_data(const file_t file_id) const;
+
+    // residency hints for mapped files (madvise WILLNEED / DONTNEED).
+    // prefetch also touches the range so it is resident on return.
+    void                prefetch(const file_t file_id,
+                            const size_t offset_in_bytes,
+                            const size_t length_in_bytes) const;
+    void                evict(const file_t file_id,
+                            const size_t offset_in_bytes,
+                            const size_t length_in_bytes) const;
+
+private:
+    struct handle
+    {
+#ifdef _WIN32
+        void*           native_;
+#else
+        int             native_;
+#endif
+        uint64_t        file_size_;
+        std::string     file_name_;
+        char*           mapped_;
+        size_t          mapped_length_;
+    };
+
+    std::vector<handle> handles_;
+};
+
+} } // namespace lamure
+
+#endif // REN_NODE_FILE_REGISTRY_H_
@@ -0,0 +1,125 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#ifndef REN_NODE_KERNELS_H_
+#define REN_NODE_KERNELS_H_
+
+#include <vector>
+#include <cstdint>
+
+#include <lamure/types.h>
+#include <lamure/ren/platform.h>
+#include <lamure/ren/bvh.h>
+
+namespace lamure {
+namespace ren {
+
+/**
+* Structure-of-arrays copy of the bvh data the cut update reads for every
+* node each frame: centroids, average primitive extents and bounding boxes.
+*/
+class RENDERING_DLL bvh_soa
+{
+public:
+                        bvh_soa();
+    explicit            bvh_soa(const bvh& bvh);
+
+    void                resize(const node_t num_nodes);
+    void                set_node(const node_t node_id, const scm::math::vec3f& centroid,
+                                 const float extent, const scm::gl::boxf& bounding_box);
+
+    // nodes below this id are not deeper than the minimum lod depth
+    void                set_first_refinable_node(const node_t node_id) { first_refinable_node_ = node_id; };
+
+    const node_t        num_nodes() const { return num_nodes_; };
+    const node_t        first_refinable_node() const { return first_refinable_node_; };
+
+    const float*        centroid_x() const { return centroid_x_.data(); };
+    const float*        centroid_y() const { return centroid_y_.data(); };
+    const float*        centroid_z() const { return centroid_z_.data(); };
+    const float*        extent() const { return extent_.data(); };
+    // min_corner(axis) / max_corner(axis), axis 0..2
+    const float*        min_corner(const int axis) const { return min_[axis].data(); };
+    const float*        max_corner(const int axis) const { return max_[axis].data(); };
+
+private:
+    node_t              num_nodes_;
+    node_t              first_refinable_node_;
+
+    std::vector<float>  centroid_x_;
+    std::vector<float>  centroid_y_;
+    std::vector<float>  centroid_z_;
+    std::vector<float>  extent_;
+    std::vector<float>  min_[3];
+    std::vector<float>  max_[3];
+};
+
+/**
+* Everything the node error and the frustum test need for one
+* (view, model) pair, computed once per cut analysis.
+*/
+struct RENDERING_DLL node_view_params
+{
+    // third row of view * model, gives the view space depth
+    float               depth_row_[4];
+    // lod scaling * 2 * radius scaling * near plane * height / (top - bottom)
+    float               error_scale_;
+    // planes of proj * view * model, normals point inside
+    float               planes_[6][4];
+
+    static node_view_params make(const scm::math::mat4f& model_matrix,
+                                 const scm::math::mat4f& view_matrix,
+                                 const scm::math::mat4f& projection_matrix,
+                                 const float near_plane,
+                                 const float height_divided_by_top_minus_bottom,
+                                 const float lod_viewport_scaling);
+};
+
+/**
+* Computes the screen space error of nodes and whether their bounding
+* boxes touch the view frustum, several nodes per instruction. The
+* instruction set follows LAMURE_ENABLE_AVX512 / LAMURE_ENABLE_AVX2 as for
+* the preprocessing surfel kernels; the scalar versions are the reference.
+*
+* The error matches cut_update_pool::calculate_node_error, nodes not deeper
+* than the minimum lod depth get an error of 100. in_frustum may be null.
+*/
+namespace node_kernels
+{
+
+RENDERING_DLL const char* instruction_set_name();
+
+// nodes given by id
+RENDERING_DLL void evaluate(const bvh_soa& nodes, const node_view_params& params,
+                            const node_t* node_ids, const size_t count,
+                            float* errors, uint8_t* in_frustum);
+
+// the consecutive nodes [first_node_id, first_node_id + count), e.g. siblings
+RENDERING_DLL void evaluate_range(const bvh_soa& nodes, const node_view_params& params,
+                                  const node_t first_node_id, const size_t count,
+                                  float* errors, uint8_t* in_frustum);
+
+namespace scalar
+{
+
+RENDERING_DLL void evaluate(const bvh_soa& nodes, const node_view_params& params,
+                            const node_t* node_ids, const size_t count,
+                            float* errors, uint8_t* in_frustum);
+
+RENDERING_DLL void evaluate_range(const bvh_soa& nodes, const node_view_params& params,
+                                  const node_t first_node_id, const size_t count,
+                                  float* errors, uint8_t* in_frustum);
+
+}
+
+}
+
+
+} } // namespace lamure
+
+
+#endif // REN_NODE_KERNELS_H_
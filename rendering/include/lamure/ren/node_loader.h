@@ -0,0 +1,117 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#ifndef REN_NODE_LOADER_H_
+#define REN_NODE_LOADER_H_
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <lamure/ren/node_file_registry.h>
+#include <lamure/ren/platform.h>
+
+#ifdef LAMURE_ENABLE_IO_URING
+struct io_uring;
+#endif
+
+namespace lamure {
+namespace ren
+{
+
+// asynchronous backend for batched node reads. requests are submitted
+// in batches and complete in any order; the caller keeps the number of
+// requests in flight at or below queue_depth().
+class RENDERING_DLL node_loader
+{
+public:
+    struct request
+    {
+        node_file_registry::file_t file_id_;
+        char*           data_;
+        size_t          offset_in_bytes_;
+        size_t          length_in_bytes_;
+        uint64_t        tag_;
+    };
+
+                        node_loader(const node_file_registry* files, const uint32_t queue_depth);
+                        node_loader(const node_loader&) = delete;
+                        node_loader& operator=(const node_loader&) = delete;
+    virtual             ~node_loader();
+
+    const uint32_t      queue_depth() const { return queue_depth_; };
+    virtual const char* name() const = 0;
+
+    virtual void        submit(const std::vector<request>& requests) = 0;
+
+    // blocks until at least one request has completed and appends
+    // the tags of all completed requests
+    virtual void        wait(std::vector<uint64_t>& completed_tags) = 0;
+
+    // io_uring if it was enabled at build time and the kernel supports it,
+    // a pool of blocking reader threads otherwise
+    static node_loader* create(const node_file_registry* files, const uint32_t queue_depth);
+
+protected:
+    const node_file_registry* files_;
+    uint32_t            queue_depth_;
+};
+
+class RENDERING_DLL node_loader_threaded : public node_loader
+{
+public:
+                        node_loader_threaded(const node_file_registry* files, const uint32_t queue_depth);
+    virtual             ~node_loader_threaded();
+
+    virtual const char* name() const { return "threaded"; };
+
+    virtual void        submit(const std::vector<request>& requests);
+    virtual void        wait(std::vector<uint64_t>& completed_tags);
+
+protected:
+    void                run();
+
+private:
+    std::mutex          mutex_;
+    std::condition_variable request_signal_;
+    std::condition_variable completion_signal_;
+    bool                shutdown_;
+
+    std::deque<request> requests_;
+    std::vector<uint64_t> completed_;
+
+    std::vector<std::thread> threads_;
+};
+
+#ifdef LAMURE_ENABLE_IO_URING
+class RENDERING_DLL node_loader_uring : public node_loader
+{
+public:
+                        node_loader_uring(const node_file_registry* files, const uint32_t queue_depth);
+    virtual             ~node_loader_uring();
+
+    virtual const char* name() const { return "io_uring"; };
+
+    virtual void        submit(const std::vector<request>& requests);
+    virtual void        wait(std::vector<uint64_t>& completed_tags);
+
+private:
+    void                prepare(const size_t entry_id);
+
+    struct io_uring*    ring_;
+
+    //in-flight requests, indexed by the user data of the submission
+    std::vector<request> entries_;
+    std::vector<size_t> free_entries_;
+};
+#endif
+
+} } // namespace lamure
+
+#endif // REN_NODE_LOADER_H_
@@ -14,9 +14,14 @@
 #include <lamure/ren/config.h>
 #include <lamure/ren/lod_stream.h>
 #include <lamure/ren/model_database.h>
+#include <lamure/ren/node_file_registry.h>
+#include <lamure/ren/node_loader.h>
 #include <lamure/ren/provenance_stream.h>
 #include <lamure/types.h>
 #include <lamure/utils.h>
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <map>
 #include <mutex>
 #include <set>
@@ -38,7 +43,29 @@ namespace ren {
 class ooc_pool
 {
   public:
-    ooc_pool(const uint32_t num_loader_threads, const size_t size_of_slot_in_bytes, const size_t slot_size_provenance);
+    enum loader_mode
+    {
+        //every loader thread serves one job at a time with blocking reads
+        LOADER_BLOCKING,
+        //one thread keeps up to LAMURE_CUT_UPDATE_LOADING_QUEUE_DEPTH jobs
+        //in flight on an asynchronous node_loader (io_uring or thread pool)
+        LOADER_BATCHED
+    };
+
+    struct loader_statistics
+    {
+        //latency buckets are powers of two in microseconds
+        const static size_t num_latency_buckets = 24;
+
+        size_t num_jobs_;
+        size_t bytes_loaded_;
+        size_t queue_depth_sum_;
+        size_t max_queue_depth_;
+        std::array<size_t, num_latency_buckets> latency_histogram_;
+    };
+
+    ooc_pool(const uint32_t num_loader_threads, const size_t size_of_slot_in_bytes, const size_t slot_size_provenance,
+             const loader_mode mode = LAMURE_CUT_UPDATE_LOADER_MODE, const bool map_files = false);
     /*virtual*/ ~ooc_pool();
 
     const uint32_t num_threads() const { return num_threads_; };
@@ -57,9 +84,26 @@ class ooc_pool
     void begin_measure();
     void end_measure();
 
+    const loader_statistics statistics();
+
+    //zero-copy residency: node data lives in the mapped .lod/.prov files
+    //and loading a node only makes its pages resident
+    const bool is_mapped() const { return mapped_; };
+    char *mapped_node_data(const model_t model_id, const node_t node_id) const;
+    char *mapped_node_data_provenance(const model_t model_id, const node_t node_id) const;
+    void evict_node(const model_t model_id, const node_t node_id) const;
+
   protected:
     void run();
+    void run_batched();
     bool is_shutdown();
+    void register_files();
+    bool map_files();
+
+    void collect_reads(const cache_queue::job &job, std::vector<char> &scratch, std::vector<node_loader::request> &reads, const uint64_t tag);
+    void finish_job(const cache_queue::job &job, const std::vector<char> &scratch);
+    void record_jobs(const std::vector<cache_queue::job> &jobs, const std::vector<std::chrono::high_resolution_clock::time_point> &start_times,
+                     const size_t bytes_loaded, const size_t queue_depth);
 
   private:
     bool locked_;
@@ -70,13 +114,26 @@ class ooc_pool
 
     uint32_t num_threads_;
     std::vector<std::thread> threads_;
+    loader_mode mode_;
+    bool mapped_;
+    std::atomic<size_t> num_busy_threads_;
 
     bool shutdown_;
 
     size_t bytes_loaded_;
+    loader_statistics statistics_;
+    std::chrono::high_resolution_clock::time_point measure_start_;
 
     std::vector<cache_queue::job> history_;
 
+    //one handle per model, opened once and shared by all loader threads
+    node_file_registry files_;
+    std::vector<node_file_registry::file_t> lod_files_;
+    std::vector<node_file_registry::file_t> provenance_files_;
+    std::vector<size_t> provenance_sizes_;
+    //mapped mode: provenance of models without .prov file
+    std::vector<char> empty_provenance_;
+
     cache_queue priority_queue_;
 };
 }
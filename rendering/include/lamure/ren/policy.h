@@ -32,11 +32,22 @@ public:
     void                set_max_upload_budget_in_mb(const size_t max_upload_budget) { max_upload_budget_in_mb_ = max_upload_budget; };
     void                set_render_budget_in_mb(const size_t render_budget) { render_budget_in_mb_ = render_budget; };
     void                set_out_of_core_budget_in_mb(const size_t out_of_core_budget) { out_of_core_budget_in_mb_ = out_of_core_budget; };
+    void                set_out_of_core_mapping(const bool out_of_core_mapping) { out_of_core_mapping_ = out_of_core_mapping; };
+    void                set_clock_cache_replacement(const bool clock_cache_replacement) { clock_cache_replacement_ = clock_cache_replacement; };
+    void                set_prefetch_frames(const uint32_t prefetch_frames) { prefetch_frames_ = prefetch_frames; };
+    void                set_prefetch_budget_in_nodes(const size_t prefetch_budget) { prefetch_budget_in_nodes_ = prefetch_budget; };
     
     const bool          reset_system() const { return reset_system_; };
     const size_t        max_upload_budget_in_mb() const { return max_upload_budget_in_mb_; };
     const size_t        render_budget_in_mb() const { return render_budget_in_mb_; };
     const size_t        out_of_core_budget_in_mb() const { return out_of_core_budget_in_mb_; };
+    //map read-only datasets that fit into main memory instead of copying nodes into slots
+    const bool          out_of_core_mapping() const { return out_of_core_mapping_; };
+    //replace cache slots with CLOCK and a sharded node index instead of a locked lru list
+    const bool          clock_cache_replacement() const { return clock_cache_replacement_; };
+    //request nodes for the camera pose extrapolated this many frames ahead, 0 disables
+    const uint32_t      prefetch_frames() const { return prefetch_frames_; };
+    const size_t        prefetch_budget_in_nodes() const { return prefetch_budget_in_nodes_; };
 
     const int32_t       window_width() const { return window_width_; };
     const int32_t       window_height() const { return window_height_; };
@@ -59,6 +70,10 @@ private:
     size_t              max_upload_budget_in_mb_;
     size_t              render_budget_in_mb_;
     size_t              out_of_core_budget_in_mb_;
+    bool                out_of_core_mapping_;
+    bool                clock_cache_replacement_;
+    uint32_t            prefetch_frames_;
+    size_t              prefetch_budget_in_nodes_;
 
     int32_t             window_width_;
     int32_t             window_height_;
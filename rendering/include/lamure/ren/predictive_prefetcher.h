@@ -0,0 +1,89 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#ifndef REN_PREDICTIVE_PREFETCHER_H_
+#define REN_PREDICTIVE_PREFETCHER_H_
+
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+#include <lamure/types.h>
+#include <lamure/ren/platform.h>
+#include <lamure/ren/camera.h>
+
+namespace lamure {
+namespace ren {
+
+/**
+* Bookkeeping for speculative out-of-core requests of the cut update.
+*
+* Keeps the last two view matrices of every view and extrapolates the
+* camera motion, assuming the per-frame motion between them continues.
+* Nodes requested for a predicted pose are remembered until the cut
+* update demands them (a hit) or until they expire (wasted).
+*/
+class RENDERING_DLL predictive_prefetcher
+{
+public:
+
+    struct frame_stats
+    {
+        size_t          num_requested_;
+        size_t          num_hits_;
+        // demanded while still being loaded
+        size_t          num_late_;
+        size_t          num_wasted_;
+        size_t          wasted_bytes_;
+    };
+
+                        predictive_prefetcher();
+                        ~predictive_prefetcher() {};
+
+    // starts a new frame, expires requests older than expiry_frames
+    void                begin_frame(const std::map<view_t, camera>& cameras, const uint32_t expiry_frames, const size_t node_size_in_bytes);
+
+    // view matrix after frames_ahead frames, false if the view did not move
+    // or has no history yet
+    const bool          predict_view_matrix(const view_t view_id, const uint32_t frames_ahead, scm::math::mat4f& predicted_view_matrix) const;
+
+    void                note_request(const model_t model_id, const node_t node_id);
+    void                note_demand(const model_t model_id, const node_t node_id, const bool resident);
+
+    const frame_stats&  stats() const { return stats_; };
+    const frame_stats&  total_stats() const { return total_stats_; };
+
+private:
+
+    static inline const uint64_t key(const model_t model_id, const node_t node_id)
+    {
+        return (uint64_t(model_id) << 32) | uint64_t(node_id);
+    }
+
+    struct view_history
+    {
+        scm::math::mat4f previous_;
+        scm::math::mat4f current_;
+        size_t          frame_;
+        bool            valid_;
+    };
+
+    size_t              frame_;
+    std::map<view_t, view_history> views_;
+
+    // (model, node) to the frame the node was requested in
+    std::unordered_map<uint64_t, size_t> requests_;
+
+    frame_stats         stats_;
+    frame_stats         total_stats_;
+};
+
+
+} } // namespace lamure
+
+
+#endif // REN_PREDICTIVE_PREFETCHER_H_
@@ -20,7 +20,12 @@ cache(const slot_t num_slots)
     model_database* database = model_database::get_instance();
 
     slot_size_ = database->get_slot_size();
-    index_ = new cache_index(database->num_models(), num_slots_);
+    if (policy::get_instance()->clock_cache_replacement()) {
+        index_ = new clock_cache_index(database->num_models(), num_slots_);
+    }
+    else {
+        index_ = new cache_index(database->num_models(), num_slots_);
+    }
 }
 
 cache::
@@ -48,10 +53,8 @@ slot_id(const model_t model_id, const node_t node_id) {
 
 void cache::
 aquire_node(const context_t context_id, const view_t view_id, const model_t model_id, const node_t node_id) {
-    if (index_->is_node_indexed(model_id, node_id)) {
-        uint32_t hash_id = ((((uint32_t)context_id) & 0xFFFF) << 16) | (((uint32_t)view_id) & 0xFFFF);
-        index_->aquire_slot(hash_id, model_id, node_id);
-    }
+    uint32_t hash_id = ((((uint32_t)context_id) & 0xFFFF) << 16) | (((uint32_t)view_id) & 0xFFFF);
+    index_->try_aquire_slot(hash_id, model_id, node_id);
 }
 
 void cache::
@@ -16,9 +16,19 @@ namespace ren
 
 cache_index::
 cache_index(const model_t num_models, const slot_t num_slots)
+    : cache_index(num_models, num_slots, true) {
+
+}
+
+cache_index::
+cache_index(const model_t num_models, const slot_t num_slots, const bool lru_list)
     : num_models_(num_models), num_slots_(num_slots), num_free_slots_(num_slots) {
     assert(num_slots > 0);
 
+    if (!lru_list) {
+        return;
+    }
+
     try {
       for (slot_t i = 0; i < num_slots_ + 2; ++i) {
         slots_.push_back(cache_index_node(invalid_model_t, invalid_node_t, i - 1, i + 1));
@@ -73,6 +83,7 @@ reserve_slot() {
 
     if (node.node_id_ != invalid_node_t) {
         maps_[node.model_id_].erase(node.node_id_);
+        evict(node.model_id_, node.node_id_);
     }
 
     node.node_id_ = invalid_node_t;
@@ -155,6 +166,13 @@ unreserve_slot(const slot_t slot_id) {
     }
 }
 
+void cache_index::
+evict(const model_t model_id, const node_t node_id) {
+    if (eviction_hint_) {
+        eviction_hint_(model_id, node_id);
+    }
+}
+
 const slot_t cache_index::
 get_slot(const model_t model_id, const node_t node_id) {
     std::lock_guard<std::mutex> lock(mutex_);
@@ -211,7 +229,27 @@ aquire_slot(const view_t view_id, const model_t model_id, const node_t node_id)
     //this raises when node was not applied
     assert(it != maps_[model_id].end());
 
-    slot_t slot_id = it->second;
+    aquire(view_id, it->second);
+
+}
+
+const bool cache_index::
+try_aquire_slot(const view_t view_id, const model_t model_id, const node_t node_id) {
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    const auto it = maps_[model_id].find(node_id);
+    if (it == maps_[model_id].end()) {
+        return false;
+    }
+
+    aquire(view_id, it->second);
+
+    return true;
+}
+
+void cache_index::
+aquire(const view_t view_id, const slot_t slot_id) {
     cache_index_node& node = slots_[slot_id];
 
     if (node.views_.find(view_id) == node.views_.end()) {
@@ -236,7 +274,6 @@ aquire_slot(const view_t view_id, const model_t model_id, const node_t node_id)
         }
     }
 
-
 }
 
 void cache_index::
@@ -312,6 +349,7 @@ release_slot_invalidate(const view_t view_id, const model_t model_id, const node
                 //invalidate slot
                 if (node.node_id_ != invalid_node_t) {
                     maps_[node.model_id_].erase(node.node_id_);
+                    evict(node.model_id_, node.node_id_);
                 }
 
                 node.node_id_ = invalid_node_t;
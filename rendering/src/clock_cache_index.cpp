@@ -0,0 +1,319 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#include <lamure/ren/clock_cache_index.h>
+
+#include <algorithm>
+#include <thread>
+
+
+namespace lamure
+{
+
+namespace ren
+{
+
+clock_cache_index::
+clock_cache_index(const model_t num_models, const slot_t num_slots)
+    : cache_index(num_models, num_slots, false),
+    num_free_slots_(num_slots),
+    hand_(0),
+    slots_(new clock_slot[num_slots]),
+    shards_(new shard[num_shards_]) {
+
+}
+
+clock_cache_index::
+~clock_cache_index() {
+
+}
+
+const slot_t clock_cache_index::
+find_slot(shard& shard, const uint64_t key) const {
+    const auto it = shard.slots_.find(key);
+    if (it == shard.slots_.end()) {
+        return invalid_slot_t;
+    }
+
+    //the slot is about to be handed to another node
+    if (slots_[it->second].state_.load(std::memory_order_acquire) & RESERVED) {
+        return invalid_slot_t;
+    }
+
+    return it->second;
+}
+
+const slot_t clock_cache_index::
+num_free_slots() {
+    return num_free_slots_.load(std::memory_order_relaxed);
+}
+
+const slot_t clock_cache_index::
+reserve_slot() {
+    assert(num_free_slots_ > 0);
+
+    slot_t slot_id = invalid_slot_t;
+    uint64_t steps = 0;
+
+    while (slot_id == invalid_slot_t) {
+        const slot_t candidate = slot_t(hand_.fetch_add(1, std::memory_order_relaxed) % num_slots_);
+        clock_slot& slot = slots_[candidate];
+
+        uint32_t state = slot.state_.load(std::memory_order_relaxed);
+        while (!(state & (PINNED | RESERVED))) {
+            if (state & REFERENCED) {
+                //second chance, the hand clears the bit on its way
+                if (slot.state_.compare_exchange_weak(state, state & ~REFERENCED, std::memory_order_relaxed)) {
+                    break;
+                }
+            }
+            else if (slot.state_.compare_exchange_weak(state, RESERVED, std::memory_order_acquire)) {
+                slot_id = candidate;
+                break;
+            }
+        }
+
+        //every slot is pinned or reserved by other threads
+        if (++steps % (2 * uint64_t(num_slots_)) == 0) {
+            std::this_thread::yield();
+        }
+    }
+
+    --num_free_slots_;
+
+    clock_slot& slot = slots_[slot_id];
+
+    //no view holds the slot, so nobody else touches the node of the slot
+    if (slot.node_id_ != invalid_node_t) {
+        const uint64_t node_key = key(slot.model_id_, slot.node_id_);
+        {
+            shard& shard = shard_of(node_key);
+            std::lock_guard<std::mutex> lock(shard.mutex_);
+            //the node may have been applied to another slot already
+            const auto it = shard.slots_.find(node_key);
+            if (it != shard.slots_.end() && it->second == slot_id) {
+                shard.slots_.erase(it);
+            }
+        }
+        evict(slot.model_id_, slot.node_id_);
+    }
+
+    assert(slot.views_.empty());
+
+    slot.node_id_ = invalid_node_t;
+    slot.model_id_ = invalid_model_t;
+
+    return slot_id;
+}
+
+void clock_cache_index::
+apply_slot(const slot_t slot_id, const model_t model_id, const node_t node_id) {
+    clock_slot& slot = slots_[slot_id];
+
+    //these raise when slot was not reserved
+    assert(slot.state_ == RESERVED);
+    assert(slot.node_id_ == invalid_node_t);
+    assert(slot.model_id_ == invalid_model_t);
+    assert(slot.views_.empty());
+
+    slot.node_id_ = node_id;
+    slot.model_id_ = model_id;
+
+    const uint64_t node_key = key(model_id, node_id);
+    shard& shard = shard_of(node_key);
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex_);
+        //a slot that is being replaced may still be mapped to the node
+        assert(find_slot(shard, node_key) == invalid_slot_t);
+        shard.slots_[node_key] = slot_id;
+
+        slot.state_.store(0, std::memory_order_release);
+    }
+
+    ++num_free_slots_;
+}
+
+void clock_cache_index::
+unreserve_slot(const slot_t slot_id) {
+    clock_slot& slot = slots_[slot_id];
+
+    //assert slot was reserved and was not applied
+    assert(slot.state_ == RESERVED);
+    assert(slot.node_id_ == invalid_node_t);
+    assert(slot.views_.empty());
+
+    slot.state_.store(0, std::memory_order_release);
+
+    ++num_free_slots_;
+}
+
+const slot_t clock_cache_index::
+get_slot(const model_t model_id, const node_t node_id) {
+    const uint64_t node_key = key(model_id, node_id);
+    shard& shard = shard_of(node_key);
+    std::lock_guard<std::mutex> lock(shard.mutex_);
+
+    const slot_t slot_id = find_slot(shard, node_key);
+
+    //this raises when slot was not applied
+    assert(slot_id != invalid_slot_t);
+
+    //this raises if attempting to access a slot that was not aquired
+    //and, thus, is in danger of being overriden very soon
+    assert(!slots_[slot_id].views_.empty());
+
+    return slot_id;
+}
+
+const bool clock_cache_index::
+is_node_indexed(const model_t model_id, const node_t node_id) {
+    const uint64_t node_key = key(model_id, node_id);
+    shard& shard = shard_of(node_key);
+    std::lock_guard<std::mutex> lock(shard.mutex_);
+
+    return find_slot(shard, node_key) != invalid_slot_t;
+}
+
+const bool clock_cache_index::
+is_node_aquired(const model_t model_id, const node_t node_id) {
+    const uint64_t node_key = key(model_id, node_id);
+    shard& shard = shard_of(node_key);
+    std::lock_guard<std::mutex> lock(shard.mutex_);
+
+    const slot_t slot_id = find_slot(shard, node_key);
+    if (slot_id == invalid_slot_t) {
+        return false;
+    }
+
+    return !slots_[slot_id].views_.empty();
+}
+
+void clock_cache_index::
+aquire_slot(const view_t view_id, const model_t model_id, const node_t node_id) {
+    const uint64_t node_key = key(model_id, node_id);
+    shard& shard = shard_of(node_key);
+    std::lock_guard<std::mutex> lock(shard.mutex_);
+
+    const auto it = shard.slots_.find(node_key);
+
+    //this raises when node was not applied
+    assert(it != shard.slots_.end());
+
+    aquire(view_id, it->second);
+}
+
+const bool clock_cache_index::
+try_aquire_slot(const view_t view_id, const model_t model_id, const node_t node_id) {
+    const uint64_t node_key = key(model_id, node_id);
+    shard& shard = shard_of(node_key);
+    std::lock_guard<std::mutex> lock(shard.mutex_);
+
+    const auto it = shard.slots_.find(node_key);
+    if (it == shard.slots_.end()) {
+        return false;
+    }
+
+    return aquire(view_id, it->second);
+}
+
+const bool clock_cache_index::
+aquire(const view_t view_id, const slot_t slot_id) {
+    clock_slot& slot = slots_[slot_id];
+
+    //pin the slot unless the clock hand claimed it in the meantime
+    uint32_t state = slot.state_.load(std::memory_order_relaxed);
+    do {
+        if (state & RESERVED) {
+            return false;
+        }
+    } while (!slot.state_.compare_exchange_weak(state, state | PINNED | REFERENCED, std::memory_order_acquire));
+
+    if (!(state & PINNED)) {
+        --num_free_slots_;
+    }
+
+    if (std::find(slot.views_.begin(), slot.views_.end(), view_id) == slot.views_.end()) {
+        slot.views_.push_back(view_id);
+    }
+
+    return true;
+}
+
+void clock_cache_index::
+release_slot(const view_t view_id, const model_t model_id, const node_t node_id) {
+    const uint64_t node_key = key(model_id, node_id);
+    shard& shard = shard_of(node_key);
+    std::lock_guard<std::mutex> lock(shard.mutex_);
+
+    const auto it = shard.slots_.find(node_key);
+
+    //this raises when node was not applied
+    assert(it != shard.slots_.end());
+
+    clock_slot& slot = slots_[it->second];
+
+    const auto view_it = std::find(slot.views_.begin(), slot.views_.end(), view_id);
+    if (view_it == slot.views_.end()) {
+        return;
+    }
+
+    slot.views_.erase(view_it);
+
+    if (slot.views_.empty()) {
+        slot.state_.fetch_and(~uint32_t(PINNED), std::memory_order_release);
+        ++num_free_slots_;
+    }
+}
+
+const bool clock_cache_index::
+release_slot_invalidate(const view_t view_id, const model_t model_id, const node_t node_id) {
+    //purpose: unregister view from node,
+    //if no views remain, invalidate node (remove from index)
+    //and leave the slot unreferenced for the clock hand
+    //return true if and only if the slot was invalidated
+    //during current function call
+
+    const uint64_t node_key = key(model_id, node_id);
+    shard& shard = shard_of(node_key);
+    std::unique_lock<std::mutex> lock(shard.mutex_);
+
+    const auto it = shard.slots_.find(node_key);
+
+    //this raises when node was not applied
+    assert(it != shard.slots_.end());
+
+    clock_slot& slot = slots_[it->second];
+
+    const auto view_it = std::find(slot.views_.begin(), slot.views_.end(), view_id);
+    if (view_it == slot.views_.end()) {
+        return false;
+    }
+
+    slot.views_.erase(view_it);
+
+    if (!slot.views_.empty()) {
+        return false;
+    }
+
+    shard.slots_.erase(it);
+    slot.node_id_ = invalid_node_t;
+    slot.model_id_ = invalid_model_t;
+
+    slot.state_.store(0, std::memory_order_release);
+    ++num_free_slots_;
+
+    lock.unlock();
+
+    evict(model_id, node_id);
+
+    return true;
+}
+
+
+} // namespace ren
+
+} // namespace lamure
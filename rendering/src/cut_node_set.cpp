@@ -0,0 +1,73 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#include <lamure/ren/cut_node_set.h>
+
+#include <algorithm>
+
+namespace lamure
+{
+
+namespace ren
+{
+
+cut_node_set::
+cut_node_set()
+: size_(0),
+  dirty_(false) {
+
+}
+
+void cut_node_set::
+reserve(const node_t num_nodes) {
+    const size_t num_words = (size_t(num_nodes) + 63) / 64;
+    if (bits_.size() < num_words) {
+        bits_.resize(num_words, 0);
+    }
+}
+
+void cut_node_set::
+erase(const node_t node_id) {
+    if (!contains(node_id)) {
+        return;
+    }
+    bits_[node_id >> 6] &= ~(uint64_t(1) << (node_id & 63));
+    --size_;
+
+    // the list entry stays until the next compact()
+    dirty_ = true;
+}
+
+void cut_node_set::
+clear() {
+    // cuts are small compared to the tree, so clear bit by bit
+    for (const auto node_id : nodes_) {
+        bits_[node_id >> 6] = 0;
+    }
+    nodes_.clear();
+    size_ = 0;
+    dirty_ = false;
+}
+
+void cut_node_set::
+compact() {
+    if (!dirty_) {
+        return;
+    }
+
+    std::sort(nodes_.begin(), nodes_.end());
+    nodes_.erase(std::unique(nodes_.begin(), nodes_.end()), nodes_.end());
+    nodes_.erase(std::remove_if(nodes_.begin(), nodes_.end(),
+                                [this](const node_t node_id) { return !contains(node_id); }),
+                 nodes_.end());
+    dirty_ = false;
+}
+
+
+} // namespace ren
+
+} // namespace lamure
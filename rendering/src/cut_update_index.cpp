@@ -24,11 +24,6 @@ cut_update_index()
 
     num_models_ = database->num_models();
 
-    for (int32_t queue_id = 0; queue_id < queue_t::NUM_QUEUES; ++queue_id) {
-        num_slots_[queue_id] = 0;
-        slot_maps_[queue_id].resize(num_models_);
-    }
-
     for (const auto& view_id : view_ids_) {
         front_a_cuts_[view_id].resize(num_models_);
         front_b_cuts_[view_id].resize(num_models_);
@@ -39,6 +34,7 @@ cut_update_index()
         num_nodes_table_.push_back(database->get_model(model_id)->get_bvh()->get_num_nodes());
     }
 
+    reserve_cuts();
 }
 
 cut_update_index::
@@ -66,9 +62,7 @@ update_policy(const view_t num_views) {
         num_models_ = database->num_models();
 
         for (int32_t queue_id = 0; queue_id < queue_t::NUM_QUEUES; ++queue_id) {
-            num_slots_[queue_id] = 0;
-            slot_maps_[queue_id].clear();
-            slot_maps_[queue_id].resize(num_models_);
+            queues_[queue_id].clear();
         }
 
         for (const auto& view_id : view_ids_) {
@@ -86,17 +80,30 @@ update_policy(const view_t num_views) {
             num_nodes_table_.push_back(database->get_model(model_id)->get_bvh()->get_num_nodes());
         }
 
+        reserve_cuts();
     }
     else if (num_views_ > prev_num_views) {
         for (const auto& view_id : view_ids_) {
             front_a_cuts_[view_id].resize(num_models_);
             front_b_cuts_[view_id].resize(num_models_);
         }
+
+        reserve_cuts();
     }
 
 
 }
 
+void cut_update_index::
+reserve_cuts() {
+    for (const auto& view_id : view_ids_) {
+        for (model_t model_id = 0; model_id < num_models_; ++model_id) {
+            front_a_cuts_[view_id][model_id].reserve(num_nodes_table_[model_id]);
+            front_b_cuts_[view_id][model_id].reserve(num_nodes_table_[model_id]);
+        }
+    }
+}
+
 const node_t cut_update_index::
 num_nodes(const model_t model_id) const {
     assert(model_id < num_models_);
@@ -117,53 +124,37 @@ num_actions(const queue_t queue) {
 
     assert(queue < queue_t::NUM_QUEUES);
 
-    return num_slots_[queue];
+    return queues_[queue].size();
 }
 
-const std::set<node_t>& cut_update_index::
+const cut_node_set& cut_update_index::
 get_current_cut(const view_t view_id, const model_t model_id) {
     std::lock_guard<std::mutex> lock(mutex_);
 
     assert(view_ids_.find(view_id) != view_ids_.end());
     assert(model_id < num_models_);
 
-    switch (current_cut_front_) {
-        case cut_front::FRONT_A:
-            return front_a_cuts_[view_id][model_id];
-            break;
-
-        case cut_front::FRONT_B:
-            return front_b_cuts_[view_id][model_id];
-            break;
-
-        default: break;
+    cut_node_set& cut = current_cut_front_ == cut_front::FRONT_B
+        ? front_b_cuts_[view_id][model_id]
+        : front_a_cuts_[view_id][model_id];
 
-    }
-
-    return front_a_cuts_[view_id][model_id];
+    cut.compact();
+    return cut;
 }
 
-const std::set<node_t>& cut_update_index::
+const cut_node_set& cut_update_index::
 get_previous_cut(const view_t view_id, const model_t model_id) {
     std::lock_guard<std::mutex> lock(mutex_);
 
     assert(view_ids_.find(view_id) != view_ids_.end());
     assert(model_id < num_models_);
 
-    switch (current_cut_front_) {
-        case cut_front::FRONT_A:
-            return front_b_cuts_[view_id][model_id];
-            break;
+    cut_node_set& cut = current_cut_front_ == cut_front::FRONT_B
+        ? front_a_cuts_[view_id][model_id]
+        : front_b_cuts_[view_id][model_id];
 
-        case cut_front::FRONT_B:
-            return front_a_cuts_[view_id][model_id];
-            break;
-
-        default: break;
-
-    }
-
-    return front_b_cuts_[view_id][model_id];
+    cut.compact();
+    return cut;
 }
 
 void cut_update_index::
@@ -212,6 +203,19 @@ push_action(const action& action, bool sort) {
     add_action(action, sort);
 }
 
+void cut_update_index::
+push_actions(const std::vector<action>& actions, bool sort) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    for (const auto& action : actions) {
+        assert(action.model_id_ < num_models_);
+        assert(action.node_id_ < num_nodes_table_[action.model_id_]);
+        assert(action.queue_ < queue_t::NUM_QUEUES);
+
+        add_action(action, sort);
+    }
+}
+
 const cut_update_index::action cut_update_index::
 front_action(const queue_t queue) {
     std::lock_guard<std::mutex> lock(mutex_);
@@ -220,8 +224,8 @@ front_action(const queue_t queue) {
 
     action action;
 
-    if (num_slots_[queue] > 0) {
-        action = slots_[queue].front();
+    if (!queues_[queue].empty()) {
+        action = queues_[queue].front();
     }
 
     return action;
@@ -235,8 +239,8 @@ back_action(const queue_t queue) {
 
     action action;
 
-    if (num_slots_[queue] > 0) {
-        action = slots_[queue].back();
+    if (!queues_[queue].empty()) {
+        action = queues_[queue].back();
     }
 
     return action;
@@ -247,27 +251,10 @@ pop_front_action(const queue_t queue) {
     std::lock_guard<std::mutex> lock(mutex_);
 
     assert(queue < queue_t::NUM_QUEUES);
-    assert(!slots_[queue].empty());
-
-    action action = slots_[queue].front();
-    assert(action.queue_ == queue);
-
-    swap(queue, 0, num_slots_[queue]-1);
-
-
-    assert(slot_maps_[queue][action.model_id_][action.node_id_].find(num_slots_[queue]-1) != slot_maps_[queue][action.model_id_][action.node_id_].end());
-
-    slots_[queue].pop_back();
-    slot_maps_[queue][action.model_id_][action.node_id_].erase(num_slots_[queue]-1);
-
-    --num_slots_[queue];
-
-    shuffle_down(queue, 0);
-
-    if (slot_maps_[queue][action.model_id_][action.node_id_].empty()) {
-        slot_maps_[queue][action.model_id_].erase(action.node_id_);
-    }
+    assert(!queues_[queue].empty());
+    assert(queues_[queue].front().queue_ == queue);
 
+    queues_[queue].pop_front();
 }
 
 void cut_update_index::
@@ -275,23 +262,10 @@ Popback_action(const queue_t queue) {
     std::lock_guard<std::mutex> lock(mutex_);
 
     assert(queue < queue_t::NUM_QUEUES);
-    assert(!slots_[queue].empty());
-
-    action action = slots_[queue].back();
-    assert(action.queue_ == queue);
-
-    assert(slot_maps_[queue][action.model_id_][action.node_id_].find(num_slots_[queue]-1) != slot_maps_[queue][action.model_id_][action.node_id_].end());
-
-
-    slots_[queue].pop_back();
-    slot_maps_[queue][action.model_id_][action.node_id_].erase(num_slots_[queue]-1);
-
-    --num_slots_[queue];
-
-    if (slot_maps_[queue][action.model_id_][action.node_id_].empty()) {
-        slot_maps_[queue][action.model_id_].erase(action.node_id_);
-    }
+    assert(!queues_[queue].empty());
+    assert(queues_[queue].back().queue_ == queue);
 
+    queues_[queue].pop_back();
 }
 
 void cut_update_index::
@@ -492,16 +466,10 @@ add_action(const action& action, bool sort) {
     assert(action.queue_ < queue_t::NUM_QUEUES);
 
     if (sort) {
-        slots_[action.queue_].push_back(action);
-        ++num_slots_[action.queue_];
-
-        slot_maps_[action.queue_][action.model_id_][action.node_id_].insert(num_slots_[action.queue_]-1);
-
-        shuffle_up(action.queue_, num_slots_[action.queue_]-1);
-
+        queues_[action.queue_].push(action);
     }
     else {
-        initial_queue_.push(action);
+        initial_queue_.push_back(action);
     }
 
 }
@@ -516,15 +484,11 @@ cancel_action(const view_t view_id, const model_t model_id, const node_t node_id
 
     switch (current_cut_front_) {
         case cut_front::FRONT_A:
-            if (front_a_cuts_[view_id][model_id].find(node_id) != front_a_cuts_[view_id][model_id].end()) {
-                front_a_cuts_[view_id][model_id].erase(node_id);
-            }
+            front_a_cuts_[view_id][model_id].erase(node_id);
             break;
 
         case cut_front::FRONT_B:
-            if (front_b_cuts_[view_id][model_id].find(node_id) != front_b_cuts_[view_id][model_id].end()) {
-                front_b_cuts_[view_id][model_id].erase(node_id);
-            }
+            front_b_cuts_[view_id][model_id].erase(node_id);
             break;
 
         default: break;
@@ -534,154 +498,228 @@ cancel_action(const view_t view_id, const model_t model_id, const node_t node_id
     //secondly, cancel all pending actions (remove actions from queues)
 
     for (uint32_t queue = 0; queue < queue_t::NUM_QUEUES; ++queue) {
-        const auto slot_it = slot_maps_[queue][model_id].find(node_id);
-
-        if (slot_it == slot_maps_[queue][model_id].end()) {
-            continue;
-        }
-
-        assert(slot_it != slot_maps_[queue][model_id].end());
-
-        std::set<slot_t> slot_ids = slot_it->second; //copy
-
-        std::set<slot_t>::iterator it = std::prev(slot_ids.end());
-
-        while (true) {
-            std::set<slot_t>::iterator current_it = it--;
-
-            slot_t slot_id = *(current_it);
-
-            if (slots_[queue][slot_id].view_id_ == view_id) {
-
-                action current_item = slots_[queue][slot_id];
-                action last_item = slots_[queue][num_slots_[queue]-1];
-
-                assert(slot_maps_[queue][current_item.model_id_][current_item.node_id_].find(slot_id) != slot_maps_[queue][current_item.model_id_][current_item.node_id_].end());
-                assert(slot_maps_[queue][last_item.model_id_][last_item.node_id_].find(num_slots_[queue]-1) != slot_maps_[queue][last_item.model_id_][last_item.node_id_].end());
-
-                assert(current_item.queue_ == queue);
-                assert(current_item.model_id_ == model_id);
-                assert(current_item.node_id_ == node_id);
-                assert(last_item.queue_ == queue);
-
-                slot_maps_[queue][current_item.model_id_][current_item.node_id_].erase(slot_id);
-                slot_maps_[queue][last_item.model_id_][last_item.node_id_].erase(num_slots_[queue]-1);
-
-                slot_maps_[queue][current_item.model_id_][current_item.node_id_].insert(num_slots_[queue]-1);
-                slot_maps_[queue][last_item.model_id_][last_item.node_id_].insert(slot_id);
-
-                std::swap(slots_[queue][slot_id], slots_[queue][num_slots_[queue]-1]);
-
-                slot_maps_[queue][current_item.model_id_][current_item.node_id_].erase(num_slots_[queue]-1);
-
-                slots_[queue].pop_back();
-
-                --num_slots_[queue];
-
-                shuffle_down((queue_t)queue, slot_id);
-
-            }
-
-            if (current_it == slot_ids.begin()) {
-                break;
-            }
-        }
-
-        if (slot_maps_[queue][model_id][node_id].empty()) {
-            slot_maps_[queue][model_id].erase(node_id);
-        }
+        queues_[queue].remove(view_id, model_id, node_id);
     }
 
 }
 
 void cut_update_index::
 sort() {
-    while(!initial_queue_.empty()) {
-        action action = initial_queue_.top();
-        initial_queue_.pop();
-
-        slots_[action.queue_].push_back(action);
-        ++num_slots_[action.queue_];
-
-        slot_maps_[action.queue_][action.model_id_][action.node_id_].insert(num_slots_[action.queue_]-1);
+    if (initial_queue_.empty()) {
+        return;
+    }
 
-        shuffle_up(action.queue_, num_slots_[action.queue_]-1);
+    for (const auto& action : initial_queue_) {
+        queues_[action.queue_].append(action);
+    }
+    initial_queue_.clear();
 
+    // building the heaps bottom-up is linear in the number of actions
+    for (int32_t queue_id = 0; queue_id < queue_t::NUM_QUEUES; ++queue_id) {
+        queues_[queue_id].heapify();
     }
 
 }
 
-void cut_update_index::
-swap(const queue_t queue, const size_t slot_id_0, const size_t slot_id_1) {
-    if (slot_id_0 == slot_id_1) {
-        return;
+cut_update_index::action_queue::
+action_queue()
+: table_(64) {
+    for (auto& entry : table_) {
+        entry.position_ = empty_position;
     }
+}
 
-    action& item0 = slots_[queue][slot_id_0];
-    action& item1 = slots_[queue][slot_id_1];
+const uint32_t cut_update_index::action_queue::
+find(const view_t view_id, const model_t model_id, const node_t node_id) const {
+    const size_t mask = table_.size() - 1;
+    for (size_t slot = hash(view_id, model_id, node_id); ; slot = (slot + 1) & mask) {
+        const table_entry& entry = table_[slot];
+        if (entry.position_ == empty_position) {
+            return empty_position;
+        }
+        if (entry.node_id_ == node_id && entry.model_id_ == model_id && entry.view_id_ == view_id) {
+            return uint32_t(slot);
+        }
+    }
+}
 
+const uint32_t cut_update_index::action_queue::
+insert_key(const action& action, const uint32_t position) {
+    const size_t mask = table_.size() - 1;
+    size_t slot = hash(action.view_id_, action.model_id_, action.node_id_);
+    while (table_[slot].position_ != empty_position) {
+        slot = (slot + 1) & mask;
+    }
+    table_[slot].view_id_ = action.view_id_;
+    table_[slot].model_id_ = action.model_id_;
+    table_[slot].node_id_ = action.node_id_;
+    table_[slot].position_ = position;
+    return uint32_t(slot);
+}
 
-    assert(slot_maps_[queue][item0.model_id_][item0.node_id_].find(slot_id_0) != slot_maps_[queue][item0.model_id_][item0.node_id_].end());
-    assert(slot_maps_[queue][item1.model_id_][item1.node_id_].find(slot_id_1) != slot_maps_[queue][item1.model_id_][item1.node_id_].end());
+void cut_update_index::action_queue::
+erase_key(uint32_t table_slot) {
+    // backward shift deletion keeps the probe sequences intact without tombstones
+    const size_t mask = table_.size() - 1;
+    size_t hole = table_slot;
+    size_t slot = table_slot;
+    while (true) {
+        slot = (slot + 1) & mask;
+        const table_entry& entry = table_[slot];
+        if (entry.position_ == empty_position) {
+            break;
+        }
+        const size_t ideal = hash(entry.view_id_, entry.model_id_, entry.node_id_);
+        const bool movable = (slot > hole) ? (ideal <= hole || ideal > slot)
+                                           : (ideal <= hole && ideal > slot);
+        if (movable) {
+            table_[hole] = entry;
+            heap_[entry.position_].table_slot_ = uint32_t(hole);
+            hole = slot;
+        }
+    }
+    table_[hole].position_ = empty_position;
+}
 
+void cut_update_index::action_queue::
+grow() {
+    table_.assign(table_.size() * 2, table_entry());
+    for (auto& entry : table_) {
+        entry.position_ = empty_position;
+    }
+    for (size_t position = 0; position < heap_.size(); ++position) {
+        heap_[position].table_slot_ = insert_key(heap_[position].action_, uint32_t(position));
+    }
+}
 
-    slot_maps_[queue][item0.model_id_][item0.node_id_].erase(slot_id_0);
-    slot_maps_[queue][item1.model_id_][item1.node_id_].erase(slot_id_1);
+const bool cut_update_index::action_queue::
+add(const action& action) {
+    const uint32_t table_slot = find(action.view_id_, action.model_id_, action.node_id_);
+    if (table_slot != empty_position) {
+        heap_[table_[table_slot].position_].action_ = action;
+        return true;
+    }
 
-    slot_maps_[queue][item0.model_id_][item0.node_id_].insert(slot_id_1);
-    slot_maps_[queue][item1.model_id_][item1.node_id_].insert(slot_id_0);
+    // keep the load factor at or below one half
+    if ((heap_.size() + 1) * 2 > table_.size()) {
+        grow();
+    }
 
-    std::swap(slots_[queue][slot_id_0], slots_[queue][slot_id_1]);
+    heap_entry entry;
+    entry.action_ = action;
+    entry.table_slot_ = insert_key(action, uint32_t(heap_.size()));
+    heap_.push_back(entry);
+    return false;
 }
 
-void cut_update_index::
-shuffle_up(const queue_t queue, const size_t slot_id) {
-    if (slot_id == 0) {
-        return;
+void cut_update_index::action_queue::
+push(const action& action) {
+    if (add(action)) {
+        // the table slot of an entry does not move while sifting
+        const uint32_t table_slot = find(action.view_id_, action.model_id_, action.node_id_);
+        sift_up(table_[table_slot].position_);
+        sift_down(table_[table_slot].position_);
     }
+    else {
+        sift_up(heap_.size() - 1);
+    }
+}
 
-    size_t parent_slot_id = (size_t)std::floor((slot_id-1)/2);
+void cut_update_index::action_queue::
+append(const action& action) {
+    add(action);
+}
 
-    if (slots_[queue][slot_id].error_ < slots_[queue][parent_slot_id].error_) {
+void cut_update_index::action_queue::
+heapify() {
+    if (heap_.size() < 2) {
         return;
     }
+    for (size_t position = (heap_.size() - 2) / 4 + 1; position-- > 0; ) {
+        sift_down(position);
+    }
+}
 
-    swap(queue, slot_id, parent_slot_id);
-
-    shuffle_up(queue, parent_slot_id);
+void cut_update_index::action_queue::
+pop_front() {
+    remove_at(0);
 }
 
-void cut_update_index::
-shuffle_down(const queue_t queue, const size_t slot_id) {
-    size_t left_child_id = slot_id*2 + 1;
-    size_t right_child_id = slot_id*2 + 2;
+void cut_update_index::action_queue::
+pop_back() {
+    remove_at(heap_.size() - 1);
+}
 
-    size_t replace_id = slot_id;
+const bool cut_update_index::action_queue::
+remove(const view_t view_id, const model_t model_id, const node_t node_id) {
+    const uint32_t table_slot = find(view_id, model_id, node_id);
+    if (table_slot == empty_position) {
+        return false;
+    }
+    remove_at(table_[table_slot].position_);
+    return true;
+}
 
-    if (slot_id == num_slots_[queue]-1) {
-        return;
+void cut_update_index::action_queue::
+clear() {
+    for (const auto& entry : heap_) {
+        table_[entry.table_slot_].position_ = empty_position;
     }
+    heap_.clear();
+}
 
-    if (right_child_id < num_slots_[queue]) {
-        bool left_greater = slots_[queue][right_child_id].error_ < slots_[queue][left_child_id].error_;
+void cut_update_index::action_queue::
+sift_up(size_t position) {
+    const heap_entry entry = heap_[position];
+    while (position > 0) {
+        const size_t parent = (position - 1) / 4;
+        if (entry.action_.error_ < heap_[parent].action_.error_) {
+            break;
+        }
+        place(position, heap_[parent]);
+        position = parent;
+    }
+    place(position, entry);
+}
 
-        if (left_greater && slots_[queue][slot_id].error_ < slots_[queue][left_child_id].error_) {
-            replace_id = left_child_id;
+void cut_update_index::action_queue::
+sift_down(size_t position) {
+    const size_t size = heap_.size();
+    const heap_entry entry = heap_[position];
+    while (true) {
+        const size_t first_child = position * 4 + 1;
+        if (first_child >= size) {
+            break;
         }
-        else if (!left_greater && slots_[queue][slot_id].error_ < slots_[queue][right_child_id].error_) {
-            replace_id = right_child_id;
+        const size_t last_child = std::min(first_child + 4, size);
+        size_t max_child = first_child;
+        for (size_t child = first_child + 1; child < last_child; ++child) {
+            if (heap_[max_child].action_.error_ < heap_[child].action_.error_) {
+                max_child = child;
+            }
         }
-
-    }
-    else if (left_child_id < num_slots_[queue]) {
-        if (slots_[queue][slot_id].error_ < slots_[queue][left_child_id].error_) {
-            replace_id = left_child_id;
+        if (!(entry.action_.error_ < heap_[max_child].action_.error_)) {
+            break;
         }
+        place(position, heap_[max_child]);
+        position = max_child;
     }
+    place(position, entry);
+}
+
+void cut_update_index::action_queue::
+remove_at(const size_t position) {
+    assert(position < heap_.size());
+
+    erase_key(heap_[position].table_slot_);
+
+    const heap_entry last = heap_.back();
+    heap_.pop_back();
 
-    if (replace_id != slot_id) {
-        swap(queue, slot_id, replace_id);
-        shuffle_down(queue, replace_id);
+    if (position < heap_.size()) {
+        place(position, last);
+        sift_down(position);
+        sift_up(table_[last.table_slot_].position_);
     }
 }
 
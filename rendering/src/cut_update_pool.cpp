@@ -8,6 +8,7 @@
 #include <lamure/ren/cut_update_pool.h>
 #include <lamure/pvs/pvs_database.h>
 
+#include <algorithm>
 #include <iostream>
 
 namespace lamure
@@ -15,7 +16,7 @@ namespace lamure
 namespace ren
 {
 cut_update_pool::cut_update_pool(const context_t context_id, const node_t upload_budget_in_nodes, const node_t render_budget_in_nodes)
-    : context_id_(context_id), locked_(false), num_threads_(LAMURE_CUT_UPDATE_NUM_CUT_UPDATE_THREADS), shutdown_(false), current_gpu_storage_A_(nullptr), current_gpu_storage_B_(nullptr),
+    : context_id_(context_id), locked_(false), num_threads_(LAMURE_CUT_UPDATE_NUM_CUT_UPDATE_THREADS > 0 ? LAMURE_CUT_UPDATE_NUM_CUT_UPDATE_THREADS : std::max(1u, std::thread::hardware_concurrency())), shutdown_(false), current_gpu_storage_A_(nullptr), current_gpu_storage_B_(nullptr),
       current_gpu_storage_(nullptr), current_gpu_storage_A_provenance_(nullptr), current_gpu_storage_B_provenance_(nullptr), current_gpu_storage_provenance_(nullptr),
       current_gpu_buffer_(cut_database_record::temporary_buffer::BUFFER_A), upload_budget_in_nodes_(upload_budget_in_nodes), render_budget_in_nodes_(render_budget_in_nodes),
 #ifdef LAMURE_CUT_UPDATE_ENABLE_MODEL_TIMEOUT
@@ -187,6 +188,8 @@ const bool cut_update_pool::prepare()
     cut_database->receive_thresholds(context_id_, model_thresholds_);
     cut_database->receive_lod_viewport_scalings(context_id_, model_lod_viewport_scalings_);
 
+    prefetcher_.begin_frame(user_cameras_, LAMURE_CUT_UPDATE_PREFETCH_EXPIRY_FRAMES, model_database::get_instance()->get_slot_size());
+
     transfer_list_.clear();
     render_list_.clear();
 
@@ -196,6 +199,17 @@ const bool cut_update_pool::prepare()
 
     index_->update_policy(user_cameras_.size());
 
+    if(node_data_.size() != index_->num_models())
+    {
+        model_database *database = model_database::get_instance();
+
+        node_data_.clear();
+        for(model_t model_id = 0; model_id < index_->num_models(); ++model_id)
+        {
+            node_data_.emplace_back(*database->get_model(model_id)->get_bvh());
+        }
+    }
+
     // clamp threshold
     for(auto &threshold_it : model_thresholds_)
     {
@@ -306,6 +320,16 @@ void cut_update_pool::cut_master()
     std::cout << "lamure: free slots cpu: " << ooc_cache_->num_free_slots() << "\t\t( " << ooc_cache_->num_slots() - ooc_cache_->num_free_slots() << " occupied)" << std::endl << std::endl;
 #endif
 
+#ifdef LAMURE_CUT_UPDATE_ENABLE_SHOW_PREFETCH_STATS
+    {
+        const predictive_prefetcher::frame_stats &stats = prefetcher_.stats();
+        const predictive_prefetcher::frame_stats &total = prefetcher_.total_stats();
+        const size_t demanded = total.num_hits_ + total.num_late_;
+        std::cout << "lamure: prefetch requested: " << stats.num_requested_ << ", hits: " << stats.num_hits_ << ", late: " << stats.num_late_
+                  << ", wasted: " << stats.wasted_bytes_ / 1024 << " KB\t\t( hit rate " << (demanded > 0 ? 100.0 * total.num_hits_ / demanded : 0.0) << " %)" << std::endl;
+    }
+#endif
+
     // swap and use temporary buffer
     if(current_gpu_buffer_ == cut_database_record::temporary_buffer::BUFFER_A)
     {
@@ -361,6 +385,8 @@ void cut_update_pool::cut_master()
         semaphore_.set_min_signal_count(1);
         semaphore_.unlock();
 
+        analysis_actions_.resize(index_->num_models() * index_->num_views());
+
         // launch slaves
         for(view_t view_id = 0; view_id < index_->num_views(); ++view_id)
         {
@@ -379,6 +405,12 @@ void cut_update_pool::cut_master()
         assert(semaphore_.num_signals() == 0);
         assert(master_semaphore_.num_signals() == 0);
 
+        // merge independent of the order in which the analysis jobs finished
+        for(const auto &actions : analysis_actions_)
+        {
+            index_->push_actions(actions, false);
+        }
+
         index_->sort();
 
         // re-configure semaphores
@@ -440,8 +472,6 @@ void cut_update_pool::cut_master()
 void cut_update_pool::
 cut_analysis(view_t view_id, model_t model_id) {
 
-    lamure::pvs::pvs_database* pvs = lamure::pvs::pvs_database::get_instance();
-
     assert(view_id != invalid_view_t);
     assert(model_id != invalid_model_t);
     assert(view_id < index_->num_views());
@@ -451,7 +481,7 @@ cut_analysis(view_t view_id, model_t model_id) {
 #ifdef LAMURE_CUT_UPDATE_ENABLE_MODEL_TIMEOUT
     size_t freshness;
 #endif
-    scm::gl::frustum frustum;
+    node_view_params params;
 
     {
         std::lock_guard<std::mutex> lock(mutex_);
@@ -459,29 +489,81 @@ cut_analysis(view_t view_id, model_t model_id) {
 #ifdef LAMURE_CUT_UPDATE_ENABLE_MODEL_TIMEOUT
         freshness = model_freshness_[model_id];
 #endif
-        frustum = user_cameras_[view_id].get_frustum_by_model(model_matrix);
+        const camera &camera = user_cameras_[view_id];
+        params = node_view_params::make(model_matrix, camera.get_view_matrix(), camera.get_projection_matrix(), camera.near_plane_value(),
+                                        height_divided_by_top_minus_bottoms_[view_id], model_lod_viewport_scalings_[view_id]);
     }
 
-    // perform cut analysis
-    std::set<node_t> old_cut = index_->get_previous_cut(view_id, model_id);
-
-    index_->reset_cut(view_id, model_id);
-
-    uint32_t fan_factor = index_->fan_factor(model_id);
-
     bool freshness_timeout = false;
 #ifdef LAMURE_CUT_UPDATE_ENABLE_MODEL_TIMEOUT
     freshness_timeout = cut_update_counter_ - freshness > LAMURE_CUT_UPDATE_MAX_MODEL_TIMEOUT;
 #endif
 
-    float min_error_threshold = model_thresholds_[model_id] - 0.1f;
-    float max_error_threshold = model_thresholds_[model_id] + 0.1f;
+    // actions go to a list owned by this (view, model) pair and are merged
+    // into the index by the master in a fixed order
+    analyse_cut(*index_, node_data_[model_id], params, view_id, model_id, model_thresholds_[model_id], freshness_timeout,
+                analysis_actions_[view_id * index_->num_models() + model_id]);
+
+    master_semaphore_.signal(1);
+}
+
+void cut_update_pool::
+analyse_cut(cut_update_index &index, const bvh_soa &nodes, const node_view_params &params, const view_t view_id, const model_t model_id,
+            const float threshold, const bool freshness_timeout, std::vector<cut_update_index::action> &actions) {
+
+    lamure::pvs::pvs_database* pvs = lamure::pvs::pvs_database::get_instance();
+
+    actions.clear();
+
+    // perform cut analysis
+    // the previous front is not touched until the next swap, so no copy is needed
+    const cut_node_set &old_cut = index.get_previous_cut(view_id, model_id);
+
+    index.reset_cut(view_id, model_id);
+
+    uint32_t fan_factor = index.fan_factor(model_id);
+
+    float min_error_threshold = threshold - 0.1f;
+    float max_error_threshold = threshold + 0.1f;
+
+    // errors and frustum flags of the whole previous cut in one pass
+    std::vector<float> cut_errors(old_cut.size());
+    std::vector<uint8_t> cut_in_frustum(old_cut.size());
+    node_kernels::evaluate(nodes, params, old_cut.nodes().data(), old_cut.size(), cut_errors.data(), cut_in_frustum.data());
+
+    std::vector<float> sibling_errors(fan_factor);
+    std::vector<uint8_t> sibling_frustum_flags(fan_factor);
+    std::vector<float> child_errors(fan_factor);
+
+    // only split if the predicted error of children does not require collapsing
+    auto children_allow_split = [&](const node_t node_id)
+    {
+        std::vector<node_t> children;
+        index.get_all_children(model_id, node_id, children);
+
+        // children are consecutive, the last one is invalid if any is
+        if(children.back() == invalid_node_t)
+        {
+            return false;
+        }
+
+        node_kernels::evaluate_range(nodes, params, children.front(), fan_factor, child_errors.data(), nullptr);
+        for(uint32_t j = 0; j < fan_factor; ++j)
+        {
+            if(child_errors[j] < min_error_threshold)
+            {
+                return false;
+            }
+        }
+        return true;
+    };
 
     // cut analysis
-    std::set<node_t>::iterator cut_it;
+    cut_node_set::const_iterator cut_it;
     for(cut_it = old_cut.begin(); cut_it != old_cut.end(); ++cut_it)
     {
         node_t node_id = *cut_it;
+        const size_t cut_index = cut_it - old_cut.begin();
 
         bool all_siblings_in_cut = false;
         bool no_sibling_in_frustum = true;
@@ -492,18 +574,20 @@ cut_analysis(view_t view_id, model_t model_id) {
         std::vector<node_t> siblings;
 
         assert(node_id != invalid_node_t);
-        assert(node_id < index_->num_nodes(model_id));
+        assert(node_id < index.num_nodes(model_id));
 
 
-        if (node_id > 0 && node_id < index_->num_nodes(model_id))
+        if (node_id > 0 && node_id < index.num_nodes(model_id))
         {
-            parent_id = index_->get_parent_id(model_id, node_id);
-            parent_error = calculate_node_error(view_id, model_id, parent_id);
+            parent_id = index.get_parent_id(model_id, node_id);
 
-            index_->get_all_siblings(model_id, node_id, siblings);
+            uint8_t parent_in_frustum;
+            node_kernels::evaluate_range(nodes, params, parent_id, 1, &parent_error, &parent_in_frustum);
 
-            all_siblings_in_cut = is_all_nodes_in_cut(model_id, siblings, old_cut);
-            no_sibling_in_frustum = !is_node_in_frustum(view_id, model_id, parent_id, frustum);
+            index.get_all_siblings(model_id, node_id, siblings);
+
+            all_siblings_in_cut = is_all_nodes_in_cut(index, model_id, siblings, old_cut);
+            no_sibling_in_frustum = !parent_in_frustum;
 
             // Check if no sibling is visible via PVS.
             for(node_t sibling_id : siblings)
@@ -518,43 +602,25 @@ cut_analysis(view_t view_id, model_t model_id) {
 
         if (!all_siblings_in_cut)
         {
-            float node_error = calculate_node_error(view_id, model_id, node_id);
-            bool node_in_frustum = is_node_in_frustum(view_id, model_id, node_id, frustum);
+            float node_error = cut_errors[cut_index];
+            bool node_in_frustum = cut_in_frustum[cut_index] != 0;
 
             if (node_in_frustum && node_error > max_error_threshold && pvs->get_viewer_visibility(model_id, node_id))
             {
-                //only split if the predicted error of children does not require collapsing
-                bool split = true;
-                std::vector<node_t> children;
-                index_->get_all_children(model_id, node_id, children);
-                for (const auto& child_id : children)
-                {
-                    if (child_id == invalid_node_t)
-                    {
-                        split = false;
-                        break;
-                    }
-
-                    float child_error = calculate_node_error(view_id, model_id, child_id);
-                    if(child_error < min_error_threshold)
-                    {
-                        split = false;
-                        break;
-                    }
-                }
+                bool split = children_allow_split(node_id);
 
                 if (!split || freshness_timeout)
                 {
-                    index_->push_action(cut_update_index::action(cut_update_index::queue_t::KEEP, view_id, model_id, node_id, parent_error), false);
+                    actions.push_back(cut_update_index::action(cut_update_index::queue_t::KEEP, view_id, model_id, node_id, parent_error));
                 }
                 else
                 {
-                    index_->push_action(cut_update_index::action(cut_update_index::queue_t::MUST_SPLIT,view_id, model_id, node_id, node_error), false);
+                    actions.push_back(cut_update_index::action(cut_update_index::queue_t::MUST_SPLIT,view_id, model_id, node_id, node_error));
                 }
             }
             else
             {
-                index_->push_action(cut_update_index::action(cut_update_index::queue_t::KEEP, view_id, model_id, node_id, parent_error), false);
+                actions.push_back(cut_update_index::action(cut_update_index::queue_t::KEEP, view_id, model_id, node_id, parent_error));
             }
         }
         else
@@ -563,15 +629,15 @@ cut_analysis(view_t view_id, model_t model_id) {
             if (no_sibling_in_frustum)
             {
 #ifdef LAMURE_CUT_UPDATE_MUST_COLLAPSE_OUTSIDE_FRUSTUM
-                index_->push_action(cut_update_index::action(cut_update_index::queue_t::MUST_COLLAPSE, view_id, model_id, parent_id, parent_error), false);
+                actions.push_back(cut_update_index::action(cut_update_index::queue_t::MUST_COLLAPSE, view_id, model_id, parent_id, parent_error));
 #else
-                index_->push_action(cut_update_index::action(cut_update_index::queue_t::COLLAPSE_ON_NEED, view_id, model_id, parent_id, parent_error), false);
+                actions.push_back(cut_update_index::action(cut_update_index::queue_t::COLLAPSE_ON_NEED, view_id, model_id, parent_id, parent_error));
 #endif
             }
             else if(no_sibling_visible_in_pvs)
             {
                 // Parent is invisible from current view point per PVS.
-                index_->push_action(cut_update_index::action(cut_update_index::queue_t::MUST_COLLAPSE, view_id, model_id, parent_id, parent_error), false);
+                actions.push_back(cut_update_index::action(cut_update_index::queue_t::MUST_COLLAPSE, view_id, model_id, parent_id, parent_error));
             }
             else
             {
@@ -579,7 +645,7 @@ cut_analysis(view_t view_id, model_t model_id) {
 
                 if (freshness_timeout)
                 {
-                    index_->push_action(cut_update_index::action(cut_update_index::queue_t::COLLAPSE_ON_NEED, view_id, model_id, parent_id, parent_error), false);
+                    actions.push_back(cut_update_index::action(cut_update_index::queue_t::COLLAPSE_ON_NEED, view_id, model_id, parent_id, parent_error));
 
                     // skip to next group of siblings
                     std::advance(cut_it, fan_factor - 1);
@@ -592,33 +658,17 @@ cut_analysis(view_t view_id, model_t model_id) {
 
                 std::vector<bool> keep_sibling;
 
-                for (const auto& sibling_id : siblings)
+                node_kernels::evaluate_range(nodes, params, siblings.front(), fan_factor, sibling_errors.data(), sibling_frustum_flags.data());
+
+                for (uint32_t j = 0; j < fan_factor; ++j)
                 {
-                    float sibling_error = calculate_node_error(view_id, model_id, sibling_id);
-                    bool sibling_in_frustum = is_node_in_frustum(view_id, model_id, sibling_id, frustum);
+                    const node_t sibling_id = siblings[j];
+                    float sibling_error = sibling_errors[j];
+                    bool sibling_in_frustum = sibling_frustum_flags[j] != 0;
 
                     if (sibling_error > max_error_threshold && sibling_in_frustum && pvs->get_viewer_visibility(model_id, sibling_id))
                     {
-                        //only split if the predicted error of children does not require collapsing
-                        bool split = true;
-                        std::vector<node_t> children;
-                        index_->get_all_children(model_id, sibling_id, children);
-                        for (const auto& child_id : children)
-                        {
-                            if (child_id == invalid_node_t)
-                            {
-                                split = false;
-                                break;
-                            }
-
-                            float child_error = calculate_node_error(view_id, model_id, child_id);
-
-                            if (child_error < min_error_threshold)
-                            {
-                                split = false;
-                                break;
-                            }
-                        }
+                        bool split = children_allow_split(sibling_id);
 
                         if (!split)
                         {
@@ -626,7 +676,7 @@ cut_analysis(view_t view_id, model_t model_id) {
                         }
                         else
                         {
-                            index_->push_action(cut_update_index::action(cut_update_index::queue_t::MUST_SPLIT, view_id, model_id, sibling_id, sibling_error), false);
+                            actions.push_back(cut_update_index::action(cut_update_index::queue_t::MUST_SPLIT, view_id, model_id, sibling_id, sibling_error));
 
                             keep_all_siblings = false;
                             keep_sibling.push_back(false);
@@ -646,11 +696,11 @@ cut_analysis(view_t view_id, model_t model_id) {
 
                 if (keep_all_siblings && all_sibling_errors_below_min_error_threshold)
                 {
-                    index_->push_action(cut_update_index::action(cut_update_index::queue_t::MUST_COLLAPSE, view_id, model_id, parent_id, parent_error), false);
+                    actions.push_back(cut_update_index::action(cut_update_index::queue_t::MUST_COLLAPSE, view_id, model_id, parent_id, parent_error));
                 }
                 else if (keep_all_siblings)
                 {
-                    index_->push_action(cut_update_index::action(cut_update_index::queue_t::MAYBE_COLLAPSE, view_id, model_id, parent_id, parent_error), false);
+                    actions.push_back(cut_update_index::action(cut_update_index::queue_t::MAYBE_COLLAPSE, view_id, model_id, parent_id, parent_error));
                 }
                 else
                 {
@@ -659,7 +709,7 @@ cut_analysis(view_t view_id, model_t model_id) {
                     {
                         if (keep_sibling[j])
                         {
-                            index_->push_action(cut_update_index::action(cut_update_index::queue_t::KEEP, view_id, model_id, siblings[j], parent_error), false);
+                            actions.push_back(cut_update_index::action(cut_update_index::queue_t::KEEP, view_id, model_id, siblings[j], parent_error));
                         }
                     }
                 }
@@ -669,8 +719,6 @@ cut_analysis(view_t view_id, model_t model_id) {
             std::advance(cut_it, fan_factor - 1);
         }
     }
-
-    master_semaphore_.signal(1);
 }
 
 void cut_update_pool::cut_update_split_again(const cut_update_index::action &split_action)
@@ -772,6 +820,7 @@ void cut_update_pool::cut_update()
 
                 for(const auto &child_id : child_ids)
                 {
+                    prefetcher_.note_demand(must_split_action.model_id_, child_id, true);
                     gpu_cache_->aquire_node(context_id_, must_split_action.view_id_, must_split_action.model_id_, child_id);
                     ooc_cache->aquire_node(context_id_, must_split_action.view_id_, must_split_action.model_id_, child_id);
                 }
@@ -846,7 +895,7 @@ void cut_update_pool::cut_update()
                     std::vector<node_t> siblings;
                     index_->get_all_siblings(keep_action.model_id_, keep_action.node_id_, siblings);
 
-                    if(is_all_nodes_in_cut(keep_action.model_id_, siblings, index_->get_previous_cut(keep_action.view_id_, keep_action.model_id_)))
+                    if(is_all_nodes_in_cut(*index_, keep_action.model_id_, siblings, index_->get_previous_cut(keep_action.view_id_, keep_action.model_id_)))
                     {
                         bool singularity = false;
 
@@ -943,7 +992,7 @@ void cut_update_pool::cut_update()
                     std::vector<node_t> siblings;
                     index_->get_all_siblings(split_action.model_id_, split_action.node_id_, siblings);
 
-                    if(is_all_nodes_in_cut(split_action.model_id_, siblings, index_->get_previous_cut(split_action.view_id_, split_action.model_id_)))
+                    if(is_all_nodes_in_cut(*index_, split_action.model_id_, siblings, index_->get_previous_cut(split_action.view_id_, split_action.model_id_)))
                     {
                         bool singularity = split_action.node_id_ == must_split_action.node_id_;
 
@@ -1000,9 +1049,7 @@ void cut_update_pool::cut_update()
         collapse_node(collapse_action);
     }
 
-#ifdef LAMURE_CUT_UPDATE_ENABLE_PREFETCHING
     prefetch_routine();
-#endif
     gpu_cache_->unlock();
     ooc_cache->unlock();
 
@@ -1056,7 +1103,7 @@ void cut_update_pool::compile_render_list()
         {
             std::vector<cut::node_slot_aggregate> model_render_lists;
 
-            const std::set<node_t> &current_cut = index_->get_current_cut(view_id, model_id);
+            const cut_node_set &current_cut = index_->get_current_cut(view_id, model_id);
 
             for(const auto &node_id : current_cut)
             {
@@ -1069,93 +1116,94 @@ void cut_update_pool::compile_render_list()
     }
 }
 
-#ifdef LAMURE_CUT_UPDATE_ENABLE_PREFETCHING
 void cut_update_pool::prefetch_routine()
 {
+    policy *policy = policy::get_instance();
+    const uint32_t frames_ahead = policy->prefetch_frames();
+    size_t budget = policy->prefetch_budget_in_nodes();
+
+    if(frames_ahead == 0 || budget == 0)
+    {
+        return;
+    }
+
     ooc_cache *ooc_cache = ooc_cache::get_instance();
 
-#if 0
-   uint32_t num_prefetched = 0;
-#endif
+    std::vector<node_t> candidates;
+    std::vector<node_t> next_candidates;
+    std::vector<node_t> child_ids;
+    std::vector<float> errors;
+    std::vector<uint8_t> in_frustum;
 
-    std::queue<std::pair<model_t, node_t>> node_id_queue;
-    for(const auto &action : pending_prefetch_set_)
+    for(view_t view_id = 0; view_id < index_->num_views() && budget > 0; ++view_id)
     {
-        if(action.node_id_ == invalid_node_t)
+        scm::math::mat4f predicted_view_matrix;
+        if(!prefetcher_.predict_view_matrix(view_id, frames_ahead, predicted_view_matrix))
         {
             continue;
         }
 
-        float max_error_threshold = model_thresholds_[model_id] + 0.1f;
+        const camera &camera = user_cameras_[view_id];
 
-        if(action.error_ > max_error_threshold * LAMURE_CUT_UPDATE_PREFETCH_FACTOR)
+        for(model_t model_id = 0; model_id < index_->num_models() && budget > 0; ++model_id)
         {
-            std::vector<node_t> child_ids;
-            index_->get_all_children(action.model_id_, action.node_id_, child_ids);
-            for(const auto &child_id : child_ids)
+            const node_view_params params = node_view_params::make(model_transforms_[model_id], predicted_view_matrix, camera.get_projection_matrix(), camera.near_plane_value(),
+                                                                   height_divided_by_top_minus_bottoms_[view_id], model_lod_viewport_scalings_[view_id]);
+            const float max_error_threshold = model_thresholds_[model_id] + 0.1f;
+
+            // descend from the complete cut of the last frame as far as the predicted pose would split
+            const cut_node_set &cut = index_->get_previous_cut(view_id, model_id);
+            candidates.assign(cut.begin(), cut.end());
+
+            for(uint32_t level = 0; level < LAMURE_CUT_UPDATE_PREFETCH_MAX_LEVELS && !candidates.empty() && budget > 0; ++level)
             {
-                node_id_queue.push(std::make_pair(action.model_id_, child_id));
-            }
-        }
-    }
+                errors.resize(candidates.size());
+                in_frustum.resize(candidates.size());
+                node_kernels::evaluate(node_data_[model_id], params, candidates.data(), candidates.size(), errors.data(), in_frustum.data());
 
-    uint32_t current_prefetch_depth = 0;
+                next_candidates.clear();
 
-    while(!node_id_queue.empty())
-    {
-        std::pair<model_t, node_t> model_node = node_id_queue.front();
-        node_t node_id = model_node.second;
-        model_t model_id = model_node.first;
-        node_id_queue.pop();
+                for(size_t i = 0; i < candidates.size() && budget > 0; ++i)
+                {
+                    if(!in_frustum[i] || errors[i] <= max_error_threshold)
+                    {
+                        continue;
+                    }
 
-        std::vector<node_t> child_ids;
-        index_->get_all_children(model_id, node_id, child_ids);
+                    // speculative requests must not displace the working set
+                    if(ooc_cache->num_free_slots() <= ooc_cache->num_slots() / 4)
+                    {
+                        return;
+                    }
 
-        uint32_t fan_factor = index_->fan_factor(model_id);
-        if(++current_prefetch_depth < LAMURE_CUT_UPDATE_PREFETCH_BUDGET)
-        {
-            if(ooc_cache->num_free_slots() > ooc_cache->num_slots() / 4 && gpu_cache_->num_free_slots() > gpu_cache_->num_slots() / 4)
-            {
-                bool all_children_fit_in_ooc_cache = ooc_cache->num_free_slots() >= fan_factor;
-                bool all_children_fit_in_gpu_cache = gpu_cache_->num_free_slots() >= fan_factor;
+                    index_->get_all_children(model_id, candidates[i], child_ids);
+
+                    // below every demand request, which are queued by their error
+                    const int32_t priority = (int32_t)std::min(errors[i], (float)(LAMURE_CUT_UPDATE_PREFETCH_PRIORITY_BAND - 1)) - LAMURE_CUT_UPDATE_PREFETCH_PRIORITY_BAND;
 
-                if(all_children_fit_in_ooc_cache && all_children_fit_in_gpu_cache)
-                {
                     for(const auto &child_id : child_ids)
                     {
                         if(child_id == invalid_node_t)
+                        {
                             continue;
+                        }
+
+                        next_candidates.push_back(child_id);
 
-                        if(!ooc_cache->is_node_resident(model_id, child_id))
+                        if(!ooc_cache->is_node_resident(model_id, child_id) && budget > 0)
                         {
-                            // load child from harddisk
-                            if(ooc_cache->num_free_slots() > 0)
-                            {
-                                ooc_cache->register_node(model_id, child_id, (int32_t)(-current_prefetch_depth));
-                            }
+                            ooc_cache->register_node(model_id, child_id, priority);
+                            prefetcher_.note_request(model_id, child_id);
+                            --budget;
                         }
-
-                        node_id_queue.push(std::make_pair(model_id, child_id));
-#if 0
-                ++num_prefetched;
-#endif
                     }
                 }
-                else
-                {
-                    break;
-                }
+
+                candidates.swap(next_candidates);
             }
         }
     }
-
-    pending_prefetch_set_.clear();
-
-#if 0
-   std::cout << "lamure: num prefetched: " << num_prefetched << std::endl;
-#endif
 }
-#endif
 
 void cut_update_pool::compile_transfer_list()
 {
@@ -1221,7 +1269,10 @@ void cut_update_pool::split_node(const cut_update_index::action &action)
     // try to obtain children
     for(const auto &child_id : child_ids)
     {
-        if(!ooc_cache->is_node_resident(action.model_id_, child_id))
+        const bool resident = ooc_cache->is_node_resident(action.model_id_, child_id);
+        prefetcher_.note_demand(action.model_id_, child_id, resident);
+
+        if(!resident)
         {
             if(all_children_fit_in_ooc_cache)
             {
@@ -1246,12 +1297,7 @@ void cut_update_pool::split_node(const cut_update_index::action &action)
                     // transfer child to gpu
                     if(gpu_cache_->transfer_budget() > 0 && gpu_cache_->num_free_slots() > 0)
                     {
-                        if(gpu_cache_->register_node(action.model_id_, child_id))
-                        {
-#ifdef LAMURE_CUT_UPDATE_ENABLE_PREFETCHING
-                            pending_prefetch_set_.push_back(action);
-#endif
-                        }
+                        gpu_cache_->register_node(action.model_id_, child_id);
                     }
                     else
                     {
@@ -1323,19 +1369,19 @@ void cut_update_pool::collapse_node(const cut_update_index::action &action)
     index_->approve_action(action);
 }
 
-const bool cut_update_pool::is_all_nodes_in_cut(const model_t model_id, const std::vector<node_t> &node_ids, const std::set<node_t> &cut)
+const bool cut_update_pool::is_all_nodes_in_cut(const cut_update_index &index, const model_t model_id, const std::vector<node_t> &node_ids, const cut_node_set &cut)
 {
     for(node_t i = 0; i < node_ids.size(); ++i)
     {
         node_t node_id = node_ids[i];
 
-        if(node_id >= (node_t)index_->num_nodes(model_id))
+        if(node_id >= (node_t)index.num_nodes(model_id))
             return false;
 
         if(node_id == invalid_node_t)
             return false;
 
-        if(cut.find(node_id) == cut.end())
+        if(!cut.contains(node_id))
             return false;
     }
 
@@ -0,0 +1,273 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#include <lamure/ren/node_file_registry.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+namespace lamure
+{
+namespace ren
+{
+
+node_file_registry::node_file_registry() {}
+
+node_file_registry::~node_file_registry()
+{
+    try
+    {
+        close();
+    }
+    catch(...)
+    {
+    }
+}
+
+const node_file_registry::file_t node_file_registry::register_file(const std::string &file_name)
+{
+    handle h;
+    h.file_name_ = file_name;
+    h.mapped_ = nullptr;
+    h.mapped_length_ = 0;
+
+#ifdef _WIN32
+    HANDLE native = CreateFileA(file_name.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, NULL);
+    if(native == INVALID_HANDLE_VALUE)
+    {
+        throw std::runtime_error("lamure: node_file_registry::Unable to open file: " + file_name);
+    }
+    LARGE_INTEGER size;
+    GetFileSizeEx(native, &size);
+    h.native_ = native;
+    h.file_size_ = size.QuadPart;
+#else
+    int native = ::open(file_name.c_str(), O_RDONLY);
+    if(native < 0)
+    {
+        throw std::runtime_error("lamure: node_file_registry::Unable to open file: " + file_name);
+    }
+    struct stat info;
+    fstat(native, &info);
+#ifdef POSIX_FADV_RANDOM
+    posix_fadvise(native, 0, 0, POSIX_FADV_RANDOM);
+#endif
+    h.native_ = native;
+    h.file_size_ = info.st_size;
+#endif
+
+    handles_.push_back(h);
+    return (file_t)(handles_.size() - 1);
+}
+
+void node_file_registry::close()
+{
+    for(auto &h : handles_)
+    {
+#ifndef _WIN32
+        if(h.mapped_ != nullptr)
+        {
+            munmap(h.mapped_, h.mapped_length_);
+        }
+#endif
+#ifdef _WIN32
+        CloseHandle((HANDLE)h.native_);
+#else
+        ::close(h.native_);
+#endif
+    }
+    handles_.clear();
+}
+
+const uint64_t node_file_registry::file_size(const file_t file_id) const
+{
+    assert(file_id < handles_.size());
+    return handles_[file_id].file_size_;
+}
+
+const std::string &node_file_registry::file_name(const file_t file_id) const
+{
+    assert(file_id < handles_.size());
+    return handles_[file_id].file_name_;
+}
+
+#ifndef _WIN32
+const int node_file_registry::descriptor(const file_t file_id) const
+{
+    assert(file_id < handles_.size());
+    return handles_[file_id].native_;
+}
+#endif
+
+void node_file_registry::read(const file_t file_id, char *const data, const size_t offset_in_bytes, const size_t length_in_bytes) const
+{
+    assert(length_in_bytes > 0);
+    assert(file_id < handles_.size());
+    assert(data != nullptr);
+
+    const handle &h = handles_[file_id];
+
+    size_t length_in_file = 0;
+    if(offset_in_bytes < h.file_size_)
+    {
+        length_in_file = std::min<uint64_t>(length_in_bytes, h.file_size_ - offset_in_bytes);
+    }
+
+    size_t bytes_read = 0;
+    while(bytes_read < length_in_file)
+    {
+#ifdef _WIN32
+        OVERLAPPED overlapped;
+        memset(&overlapped, 0, sizeof(OVERLAPPED));
+        uint64_t offset = offset_in_bytes + bytes_read;
+        overlapped.Offset = (DWORD)(offset & 0xFFFFFFFF);
+        overlapped.OffsetHigh = (DWORD)(offset >> 32);
+
+        DWORD chunk = (DWORD)std::min<size_t>(length_in_file - bytes_read, 0x40000000);
+        DWORD result = 0;
+        if(!ReadFile((HANDLE)h.native_, data + bytes_read, chunk, &result, &overlapped) || result == 0)
+        {
+            throw std::runtime_error("lamure: node_file_registry::Unable to read from file: " + h.file_name_);
+        }
+#else
+        ssize_t result = ::pread(h.native_, data + bytes_read, length_in_file - bytes_read, offset_in_bytes + bytes_read);
+        if(result < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if(result <= 0)
+        {
+            throw std::runtime_error("lamure: node_file_registry::Unable to read from file: " + h.file_name_);
+        }
+#endif
+        bytes_read += result;
+    }
+
+    if(length_in_file < length_in_bytes)
+    {
+        memset(data + length_in_file, 0, length_in_bytes - length_in_file);
+    }
+}
+
+const char *node_file_registry::map(const file_t file_id, const size_t padding_in_bytes)
+{
+    assert(file_id < handles_.size());
+
+    handle &h = handles_[file_id];
+
+    if(h.mapped_ != nullptr)
+    {
+        return h.mapped_;
+    }
+
+#ifdef _WIN32
+    return nullptr;
+#else
+    size_t length = h.file_size_ + padding_in_bytes;
+    if(length == 0)
+    {
+        return nullptr;
+    }
+
+    //reserve the padded range with zero pages, then place the file on top of it
+    void *reserved = mmap(nullptr, length, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(reserved == MAP_FAILED)
+    {
+        return nullptr;
+    }
+
+    if(h.file_size_ > 0)
+    {
+        void *mapped = mmap(reserved, h.file_size_, PROT_READ, MAP_SHARED | MAP_FIXED, h.native_, 0);
+        if(mapped == MAP_FAILED)
+        {
+            munmap(reserved, length);
+            return nullptr;
+        }
+        madvise(mapped, h.file_size_, MADV_RANDOM);
+    }
+
+    h.mapped_ = (char *)reserved;
+    h.mapped_length_ = length;
+    return h.mapped_;
+#endif
+}
+
+const char *node_file_registry::mapped_data(const file_t file_id) const
+{
+    assert(file_id < handles_.size());
+    return handles_[file_id].mapped_;
+}
+
+void node_file_registry::prefetch(const file_t file_id, const size_t offset_in_bytes, const size_t length_in_bytes) const
+{
+    assert(file_id < handles_.size());
+
+    const handle &h = handles_[file_id];
+    assert(h.mapped_ != nullptr);
+
+#ifndef _WIN32
+    const size_t page_size = (size_t)sysconf(_SC_PAGESIZE);
+
+    //widen to whole pages
+    size_t begin = (offset_in_bytes / page_size) * page_size;
+    size_t end = std::min<size_t>(offset_in_bytes + length_in_bytes, h.file_size_);
+    if(end <= begin)
+    {
+        return;
+    }
+
+    madvise(h.mapped_ + begin, end - begin, MADV_WILLNEED);
+
+    //fault the pages in here instead of on the render thread
+    volatile char sink = 0;
+    for(size_t offset = begin; offset < end; offset += page_size)
+    {
+        sink += h.mapped_[offset];
+    }
+    (void)sink;
+#endif
+}
+
+void node_file_registry::evict(const file_t file_id, const size_t offset_in_bytes, const size_t length_in_bytes) const
+{
+    assert(file_id < handles_.size());
+
+    const handle &h = handles_[file_id];
+    if(h.mapped_ == nullptr)
+    {
+        return;
+    }
+
+#ifndef _WIN32
+    const size_t page_size = (size_t)sysconf(_SC_PAGESIZE);
+
+    //shrink to whole pages so neighbouring nodes keep their pages
+    size_t begin = ((offset_in_bytes + page_size - 1) / page_size) * page_size;
+    size_t end = (std::min<size_t>(offset_in_bytes + length_in_bytes, h.file_size_) / page_size) * page_size;
+    if(end <= begin)
+    {
+        return;
+    }
+
+    madvise(h.mapped_ + begin, end - begin, MADV_DONTNEED);
+#endif
+}
+}
+} // namespace lamure
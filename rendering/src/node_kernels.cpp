@@ -0,0 +1,351 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#include <lamure/ren/node_kernels.h>
+
+#include <cmath>
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace lamure
+{
+
+namespace ren
+{
+
+bvh_soa::
+bvh_soa()
+: num_nodes_(0),
+  first_refinable_node_(0) {
+
+}
+
+bvh_soa::
+bvh_soa(const bvh& bvh)
+: num_nodes_(0),
+  first_refinable_node_(0) {
+
+    resize(bvh.get_num_nodes());
+
+    const auto& centroids = bvh.get_centroids();
+    const auto& bounding_boxes = bvh.get_bounding_boxes();
+
+    for (node_t node_id = 0; node_id < num_nodes_; ++node_id) {
+        set_node(node_id, centroids[node_id], bvh.get_avg_primitive_extent(node_id), bounding_boxes[node_id]);
+    }
+
+    // same depth computation as the per node error, depth grows with the id
+    node_t first_refinable_node = 0;
+    while (first_refinable_node < num_nodes_ &&
+           bvh.get_depth_of_node(first_refinable_node) <= bvh.get_min_lod_depth()) {
+        ++first_refinable_node;
+    }
+    first_refinable_node_ = first_refinable_node;
+}
+
+void bvh_soa::
+resize(const node_t num_nodes) {
+    num_nodes_ = num_nodes;
+    centroid_x_.resize(num_nodes);
+    centroid_y_.resize(num_nodes);
+    centroid_z_.resize(num_nodes);
+    extent_.resize(num_nodes);
+    for (int axis = 0; axis < 3; ++axis) {
+        min_[axis].resize(num_nodes);
+        max_[axis].resize(num_nodes);
+    }
+}
+
+void bvh_soa::
+set_node(const node_t node_id, const scm::math::vec3f& centroid,
+         const float extent, const scm::gl::boxf& bounding_box) {
+    centroid_x_[node_id] = centroid.x;
+    centroid_y_[node_id] = centroid.y;
+    centroid_z_[node_id] = centroid.z;
+    extent_[node_id] = extent;
+    for (int axis = 0; axis < 3; ++axis) {
+        min_[axis][node_id] = bounding_box.min_vertex()[axis];
+        max_[axis][node_id] = bounding_box.max_vertex()[axis];
+    }
+}
+
+node_view_params node_view_params::
+make(const scm::math::mat4f& model_matrix,
+     const scm::math::mat4f& view_matrix,
+     const scm::math::mat4f& projection_matrix,
+     const float near_plane,
+     const float height_divided_by_top_minus_bottom,
+     const float lod_viewport_scaling) {
+
+    node_view_params params;
+
+    const scm::math::mat4f model_view = view_matrix * model_matrix;
+    for (int column = 0; column < 4; ++column) {
+        params.depth_row_[column] = model_view[column * 4 + 2];
+    }
+
+    const float radius_scaling = std::sqrt(model_matrix[0] * model_matrix[0] +
+                                           model_matrix[1] * model_matrix[1] +
+                                           model_matrix[2] * model_matrix[2]);
+
+    //hotfix, for people who did not set lod_viewport_scaling
+    const float lod_scaling = lod_viewport_scaling == 0.f ? 1.f : lod_viewport_scaling;
+
+    params.error_scale_ = lod_scaling * std::abs(2.f * radius_scaling * near_plane * height_divided_by_top_minus_bottom);
+
+    // left, right, bottom, top, near, far
+    const scm::math::mat4f clip = projection_matrix * model_view;
+    for (int plane = 0; plane < 6; ++plane) {
+        const int row = plane / 2;
+        const float sign = (plane % 2 == 0) ? 1.f : -1.f;
+        for (int column = 0; column < 4; ++column) {
+            params.planes_[plane][column] = clip[column * 4 + 3] + sign * clip[column * 4 + row];
+        }
+    }
+
+    return params;
+}
+
+namespace node_kernels
+{
+
+namespace {
+
+inline void evaluate_node(const bvh_soa& nodes, const node_view_params& params, const node_t node_id,
+                          float& error, uint8_t* in_frustum) {
+    const float* r = params.depth_row_;
+    const float depth = r[0] * nodes.centroid_x()[node_id] + r[1] * nodes.centroid_y()[node_id]
+                      + r[2] * nodes.centroid_z()[node_id] + r[3];
+
+    error = node_id < nodes.first_refinable_node()
+          ? 100.f
+          : std::abs(params.error_scale_ * nodes.extent()[node_id] / depth);
+
+    if (in_frustum != nullptr) {
+        bool outside = false;
+        for (int plane = 0; plane < 6 && !outside; ++plane) {
+            const float* p = params.planes_[plane];
+            // the box corner furthest along the plane normal
+            float distance = p[3];
+            for (int axis = 0; axis < 3; ++axis) {
+                distance += p[axis] * (p[axis] >= 0.f ? nodes.max_corner(axis)[node_id]
+                                                      : nodes.min_corner(axis)[node_id]);
+            }
+            outside = distance < 0.f;
+        }
+        *in_frustum = outside ? 0 : 1;
+    }
+}
+
+#if defined(__AVX512F__)
+
+typedef __m512 lane_float;
+typedef __m512i lane_int;
+const size_t lane_width = 16;
+
+inline lane_float load(const float* base, const node_t first) { return _mm512_loadu_ps(base + first); }
+inline lane_float gather(const float* base, const lane_int ids) { return _mm512_i32gather_ps(ids, base, 4); }
+
+inline void evaluate_lanes(const bvh_soa& nodes, const node_view_params& params, const lane_int ids,
+                           const lane_float cx, const lane_float cy, const lane_float cz, const lane_float extent,
+                           const lane_float* min, const lane_float* max,
+                           float* errors, uint8_t* in_frustum) {
+    const float* r = params.depth_row_;
+    lane_float depth = _mm512_fmadd_ps(_mm512_set1_ps(r[0]), cx,
+                       _mm512_fmadd_ps(_mm512_set1_ps(r[1]), cy,
+                       _mm512_fmadd_ps(_mm512_set1_ps(r[2]), cz, _mm512_set1_ps(r[3]))));
+    lane_float error = _mm512_abs_ps(_mm512_div_ps(_mm512_mul_ps(_mm512_set1_ps(params.error_scale_), extent), depth));
+
+    const __mmask16 coarse = _mm512_cmplt_epu32_mask(ids, _mm512_set1_epi32((int32_t)nodes.first_refinable_node()));
+    error = _mm512_mask_blend_ps(coarse, error, _mm512_set1_ps(100.f));
+    _mm512_storeu_ps(errors, error);
+
+    if (in_frustum != nullptr) {
+        __mmask16 outside = 0;
+        for (int plane = 0; plane < 6; ++plane) {
+            const float* p = params.planes_[plane];
+            lane_float distance = _mm512_set1_ps(p[3]);
+            for (int axis = 0; axis < 3; ++axis) {
+                distance = _mm512_fmadd_ps(_mm512_set1_ps(p[axis]), p[axis] >= 0.f ? max[axis] : min[axis], distance);
+            }
+            outside |= _mm512_cmp_ps_mask(distance, _mm512_setzero_ps(), _CMP_LT_OQ);
+        }
+        for (size_t lane = 0; lane < lane_width; ++lane) {
+            in_frustum[lane] = ((outside >> lane) & 1) ? 0 : 1;
+        }
+    }
+}
+
+inline lane_int range_ids(const node_t first) {
+    return _mm512_add_epi32(_mm512_set1_epi32((int32_t)first),
+                            _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+}
+
+inline lane_int load_ids(const node_t* node_ids) {
+    return _mm512_loadu_si512(reinterpret_cast<const void*>(node_ids));
+}
+
+#elif defined(__AVX2__)
+
+typedef __m256 lane_float;
+typedef __m256i lane_int;
+const size_t lane_width = 8;
+
+inline lane_float load(const float* base, const node_t first) { return _mm256_loadu_ps(base + first); }
+inline lane_float gather(const float* base, const lane_int ids) { return _mm256_i32gather_ps(base, ids, 4); }
+
+inline void evaluate_lanes(const bvh_soa& nodes, const node_view_params& params, const lane_int ids,
+                           const lane_float cx, const lane_float cy, const lane_float cz, const lane_float extent,
+                           const lane_float* min, const lane_float* max,
+                           float* errors, uint8_t* in_frustum) {
+    const float* r = params.depth_row_;
+    lane_float depth = _mm256_fmadd_ps(_mm256_set1_ps(r[0]), cx,
+                       _mm256_fmadd_ps(_mm256_set1_ps(r[1]), cy,
+                       _mm256_fmadd_ps(_mm256_set1_ps(r[2]), cz, _mm256_set1_ps(r[3]))));
+    const lane_float sign_mask = _mm256_set1_ps(-0.f);
+    lane_float error = _mm256_andnot_ps(sign_mask,
+        _mm256_div_ps(_mm256_mul_ps(_mm256_set1_ps(params.error_scale_), extent), depth));
+
+    // node ids stay below 2^31, so the signed compare is fine
+    const lane_int coarse = _mm256_cmpgt_epi32(_mm256_set1_epi32((int32_t)nodes.first_refinable_node()), ids);
+    error = _mm256_blendv_ps(error, _mm256_set1_ps(100.f), _mm256_castsi256_ps(coarse));
+    _mm256_storeu_ps(errors, error);
+
+    if (in_frustum != nullptr) {
+        lane_float outside = _mm256_setzero_ps();
+        for (int plane = 0; plane < 6; ++plane) {
+            const float* p = params.planes_[plane];
+            lane_float distance = _mm256_set1_ps(p[3]);
+            for (int axis = 0; axis < 3; ++axis) {
+                distance = _mm256_fmadd_ps(_mm256_set1_ps(p[axis]), p[axis] >= 0.f ? max[axis] : min[axis], distance);
+            }
+            outside = _mm256_or_ps(outside, _mm256_cmp_ps(distance, _mm256_setzero_ps(), _CMP_LT_OQ));
+        }
+        const int outside_bits = _mm256_movemask_ps(outside);
+        for (size_t lane = 0; lane < lane_width; ++lane) {
+            in_frustum[lane] = ((outside_bits >> lane) & 1) ? 0 : 1;
+        }
+    }
+}
+
+inline lane_int range_ids(const node_t first) {
+    return _mm256_add_epi32(_mm256_set1_epi32((int32_t)first), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+}
+
+inline lane_int load_ids(const node_t* node_ids) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(node_ids));
+}
+
+#endif
+
+}
+
+namespace scalar
+{
+
+void
+evaluate(const bvh_soa& nodes, const node_view_params& params,
+         const node_t* node_ids, const size_t count,
+         float* errors, uint8_t* in_frustum) {
+    for (size_t i = 0; i < count; ++i) {
+        evaluate_node(nodes, params, node_ids[i], errors[i], in_frustum != nullptr ? in_frustum + i : nullptr);
+    }
+}
+
+void
+evaluate_range(const bvh_soa& nodes, const node_view_params& params,
+               const node_t first_node_id, const size_t count,
+               float* errors, uint8_t* in_frustum) {
+    for (size_t i = 0; i < count; ++i) {
+        evaluate_node(nodes, params, first_node_id + node_t(i), errors[i], in_frustum != nullptr ? in_frustum + i : nullptr);
+    }
+}
+
+}
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+
+const char*
+instruction_set_name() {
+#if defined(__AVX512F__)
+    return "avx512";
+#else
+    return "avx2";
+#endif
+}
+
+void
+evaluate(const bvh_soa& nodes, const node_view_params& params,
+         const node_t* node_ids, const size_t count,
+         float* errors, uint8_t* in_frustum) {
+    size_t i = 0;
+    for (; i + lane_width <= count; i += lane_width) {
+        const lane_int ids = load_ids(node_ids + i);
+        lane_float min[3], max[3];
+        for (int axis = 0; axis < 3; ++axis) {
+            min[axis] = gather(nodes.min_corner(axis), ids);
+            max[axis] = gather(nodes.max_corner(axis), ids);
+        }
+        evaluate_lanes(nodes, params, ids,
+                       gather(nodes.centroid_x(), ids), gather(nodes.centroid_y(), ids),
+                       gather(nodes.centroid_z(), ids), gather(nodes.extent(), ids),
+                       min, max, errors + i, in_frustum != nullptr ? in_frustum + i : nullptr);
+    }
+    scalar::evaluate(nodes, params, node_ids + i, count - i, errors + i, in_frustum != nullptr ? in_frustum + i : nullptr);
+}
+
+void
+evaluate_range(const bvh_soa& nodes, const node_view_params& params,
+               const node_t first_node_id, const size_t count,
+               float* errors, uint8_t* in_frustum) {
+    size_t i = 0;
+    for (; i + lane_width <= count; i += lane_width) {
+        const node_t first = first_node_id + node_t(i);
+        lane_float min[3], max[3];
+        for (int axis = 0; axis < 3; ++axis) {
+            min[axis] = load(nodes.min_corner(axis), first);
+            max[axis] = load(nodes.max_corner(axis), first);
+        }
+        evaluate_lanes(nodes, params, range_ids(first),
+                       load(nodes.centroid_x(), first), load(nodes.centroid_y(), first),
+                       load(nodes.centroid_z(), first), load(nodes.extent(), first),
+                       min, max, errors + i, in_frustum != nullptr ? in_frustum + i : nullptr);
+    }
+    scalar::evaluate_range(nodes, params, first_node_id + node_t(i), count - i, errors + i, in_frustum != nullptr ? in_frustum + i : nullptr);
+}
+
+#else
+
+const char*
+instruction_set_name() {
+    return "scalar";
+}
+
+void
+evaluate(const bvh_soa& nodes, const node_view_params& params,
+         const node_t* node_ids, const size_t count,
+         float* errors, uint8_t* in_frustum) {
+    scalar::evaluate(nodes, params, node_ids, count, errors, in_frustum);
+}
+
+void
+evaluate_range(const bvh_soa& nodes, const node_view_params& params,
+               const node_t first_node_id, const size_t count,
+               float* errors, uint8_t* in_frustum) {
+    scalar::evaluate_range(nodes, params, first_node_id, count, errors, in_frustum);
+}
+
+#endif
+
+}
+
+
+} // namespace ren
+
+} // namespace lamure
@@ -0,0 +1,278 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#include <lamure/ren/node_loader.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+#ifdef LAMURE_ENABLE_IO_URING
+#include <liburing.h>
+#endif
+
+namespace lamure
+{
+namespace ren
+{
+
+node_loader::node_loader(const node_file_registry *files, const uint32_t queue_depth)
+    : files_(files), queue_depth_(std::max(queue_depth, 1u))
+{
+    assert(files_ != nullptr);
+}
+
+node_loader::~node_loader() {}
+
+node_loader *node_loader::create(const node_file_registry *files, const uint32_t queue_depth)
+{
+#ifdef LAMURE_ENABLE_IO_URING
+    try
+    {
+        return new node_loader_uring(files, queue_depth);
+    }
+    catch(const std::runtime_error &e)
+    {
+        std::cout << e.what() << ", falling back to threaded node loader" << std::endl;
+    }
+#endif
+    return new node_loader_threaded(files, queue_depth);
+}
+
+//------------------------------------------------------------------------
+
+node_loader_threaded::node_loader_threaded(const node_file_registry *files, const uint32_t queue_depth)
+    : node_loader(files, queue_depth), shutdown_(false)
+{
+    for(uint32_t i = 0; i < queue_depth_; ++i)
+    {
+        threads_.push_back(std::thread(&node_loader_threaded::run, this));
+    }
+}
+
+node_loader_threaded::~node_loader_threaded()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        shutdown_ = true;
+    }
+    request_signal_.notify_all();
+
+    for(auto &thread : threads_)
+    {
+        if(thread.joinable())
+        {
+            thread.join();
+        }
+    }
+    threads_.clear();
+}
+
+void node_loader_threaded::submit(const std::vector<request> &requests)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        requests_.insert(requests_.end(), requests.begin(), requests.end());
+    }
+    request_signal_.notify_all();
+}
+
+void node_loader_threaded::wait(std::vector<uint64_t> &completed_tags)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    completion_signal_.wait(lock, [&] { return !completed_.empty(); });
+
+    completed_tags.insert(completed_tags.end(), completed_.begin(), completed_.end());
+    completed_.clear();
+}
+
+void node_loader_threaded::run()
+{
+    while(true)
+    {
+        request req;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            request_signal_.wait(lock, [&] { return shutdown_ || !requests_.empty(); });
+
+            if(shutdown_)
+            {
+                break;
+            }
+
+            req = requests_.front();
+            requests_.pop_front();
+        }
+
+        files_->read(req.file_id_, req.data_, req.offset_in_bytes_, req.length_in_bytes_);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            completed_.push_back(req.tag_);
+        }
+        completion_signal_.notify_one();
+    }
+}
+
+//------------------------------------------------------------------------
+
+#ifdef LAMURE_ENABLE_IO_URING
+
+node_loader_uring::node_loader_uring(const node_file_registry *files, const uint32_t queue_depth)
+    : node_loader(files, queue_depth), ring_(new struct io_uring)
+{
+    int result = io_uring_queue_init(queue_depth_, ring_, 0);
+    if(result < 0)
+    {
+        delete ring_;
+        throw std::runtime_error("lamure: node_loader_uring::Unable to create io_uring: " + std::string(strerror(-result)));
+    }
+
+    entries_.resize(queue_depth_);
+    for(size_t i = 0; i < queue_depth_; ++i)
+    {
+        free_entries_.push_back(queue_depth_ - 1 - i);
+    }
+}
+
+node_loader_uring::~node_loader_uring()
+{
+    //drain whatever is still in flight before the buffers go away
+    while(free_entries_.size() < queue_depth_)
+    {
+        std::vector<uint64_t> completed_tags;
+        wait(completed_tags);
+    }
+
+    io_uring_queue_exit(ring_);
+    delete ring_;
+}
+
+void node_loader_uring::prepare(const size_t entry_id)
+{
+    const request &req = entries_[entry_id];
+
+    struct io_uring_sqe *sqe = io_uring_get_sqe(ring_);
+    assert(sqe != nullptr);
+
+    io_uring_prep_read(sqe, files_->descriptor(req.file_id_), req.data_, (unsigned)req.length_in_bytes_, req.offset_in_bytes_);
+    io_uring_sqe_set_data(sqe, (void *)(uintptr_t)entry_id);
+}
+
+void node_loader_uring::submit(const std::vector<request> &requests)
+{
+    assert(requests.size() <= free_entries_.size());
+
+    for(const auto &req : requests)
+    {
+        //the part beyond the end of the file is zeroed right away, as node_file_registry::read does
+        uint64_t file_size = files_->file_size(req.file_id_);
+        size_t length_in_file = 0;
+        if(req.offset_in_bytes_ < file_size)
+        {
+            length_in_file = std::min<uint64_t>(req.length_in_bytes_, file_size - req.offset_in_bytes_);
+        }
+        if(length_in_file < req.length_in_bytes_)
+        {
+            memset(req.data_ + length_in_file, 0, req.length_in_bytes_ - length_in_file);
+        }
+
+        size_t entry_id = free_entries_.back();
+        free_entries_.pop_back();
+
+        entries_[entry_id] = req;
+        entries_[entry_id].length_in_bytes_ = length_in_file;
+
+        if(length_in_file == 0)
+        {
+            //nothing to read, complete through a no-op so wait() stays uniform
+            struct io_uring_sqe *sqe = io_uring_get_sqe(ring_);
+            io_uring_prep_nop(sqe);
+            io_uring_sqe_set_data(sqe, (void *)(uintptr_t)entry_id);
+            continue;
+        }
+
+        prepare(entry_id);
+    }
+
+    io_uring_submit(ring_);
+}
+
+void node_loader_uring::wait(std::vector<uint64_t> &completed_tags)
+{
+    assert(free_entries_.size() < queue_depth_);
+
+    //short reads are resubmitted, so keep going until something actually finished
+    const size_t num_completed = completed_tags.size();
+    while(completed_tags.size() == num_completed)
+    {
+        struct io_uring_cqe *cqe = nullptr;
+        int result = io_uring_wait_cqe(ring_, &cqe);
+        while(result == -EINTR)
+        {
+            result = io_uring_wait_cqe(ring_, &cqe);
+        }
+        if(result < 0)
+        {
+            throw std::runtime_error("lamure: node_loader_uring::Unable to wait for completion: " + std::string(strerror(-result)));
+        }
+
+        bool resubmit = false;
+
+        while(cqe != nullptr)
+        {
+            size_t entry_id = (size_t)(uintptr_t)io_uring_cqe_get_data(cqe);
+            int bytes = cqe->res;
+            io_uring_cqe_seen(ring_, cqe);
+
+            request &req = entries_[entry_id];
+
+            if(bytes == -EAGAIN || bytes == -EINTR)
+            {
+                prepare(entry_id);
+                resubmit = true;
+            }
+            else if(bytes < 0 || (bytes == 0 && req.length_in_bytes_ > 0))
+            {
+                throw std::runtime_error("lamure: node_loader_uring::Unable to read from file: " + files_->file_name(req.file_id_));
+            }
+            else if((size_t)bytes < req.length_in_bytes_)
+            {
+                //short read, continue where the kernel stopped
+                req.data_ += bytes;
+                req.offset_in_bytes_ += bytes;
+                req.length_in_bytes_ -= bytes;
+                prepare(entry_id);
+                resubmit = true;
+            }
+            else
+            {
+                completed_tags.push_back(req.tag_);
+                free_entries_.push_back(entry_id);
+            }
+
+            cqe = nullptr;
+            if(io_uring_peek_cqe(ring_, &cqe) != 0)
+            {
+                cqe = nullptr;
+            }
+        }
+
+        if(resubmit)
+        {
+            io_uring_submit(ring_);
+        }
+    }
+}
+
+#endif
+
+}
+} // namespace lamure
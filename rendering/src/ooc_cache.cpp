@@ -15,12 +15,26 @@ std::mutex ooc_cache::mutex_;
 bool ooc_cache::is_instanced_ = false;
 ooc_cache *ooc_cache::single_ = nullptr;
 
-ooc_cache::ooc_cache(const slot_t num_slots) : cache(num_slots), maintenance_counter_(0)
+ooc_cache::ooc_cache(const slot_t num_slots) : cache(num_slots), cache_data_(nullptr), cache_data_provenance_(nullptr), maintenance_counter_(0)
 {
     model_database *database = model_database::get_instance();
+    policy *policy = policy::get_instance();
 
     size_t slot_size_provenance = database->get_primitives_per_node() * lamure::ren::data_provenance::get_instance()->get_size_in_bytes();
 
+    pool_ = new ooc_pool(LAMURE_CUT_UPDATE_NUM_LOADING_THREADS, database->get_slot_size(), slot_size_provenance,
+                         LAMURE_CUT_UPDATE_LOADER_MODE, policy->out_of_core_mapping());
+
+    if (pool_->is_mapped()) {
+      //slots only count resident nodes, evicted ones give their pages back
+      ooc_pool *pool = pool_;
+      index_->set_eviction_hint([pool](const model_t model_id, const node_t node_id) { pool->evict_node(model_id, node_id); });
+#ifdef LAMURE_ENABLE_INFO
+      std::cout << "lamure: ooc-cache init (MAPPED)" << std::endl;
+#endif
+      return;
+    }
+
     cache_data_ = new char[num_slots * database->get_slot_size()];
 
     if (slot_size_provenance > 0) {
@@ -35,9 +49,6 @@ ooc_cache::ooc_cache(const slot_t num_slots) : cache(num_slots), maintenance_cou
 #endif
       
     }
-    pool_ = new ooc_pool(LAMURE_CUT_UPDATE_NUM_LOADING_THREADS, database->get_slot_size(), slot_size_provenance);
-
-
 }
 
 ooc_cache::~ooc_cache()
@@ -149,8 +160,17 @@ void ooc_cache::register_node(const model_t model_id, const node_t node_id, cons
         
         model_database *database = model_database::get_instance();
         slot_t slot_id = index_->reserve_slot();
-        cache_queue::job job(model_id, node_id, slot_id, priority, cache_data_ + slot_id * slot_size(),
-                             cache_data_provenance_ + slot_id * database->get_primitives_per_node() * lamure::ren::data_provenance::get_instance()->get_size_in_bytes());
+        char *slot_mem = nullptr;
+        char *slot_mem_provenance = nullptr;
+        if (pool_->is_mapped()) {
+            slot_mem = pool_->mapped_node_data(model_id, node_id);
+            slot_mem_provenance = pool_->mapped_node_data_provenance(model_id, node_id);
+        }
+        else {
+            slot_mem = cache_data_ + slot_id * slot_size();
+            slot_mem_provenance = cache_data_provenance_ + slot_id * database->get_primitives_per_node() * lamure::ren::data_provenance::get_instance()->get_size_in_bytes();
+        }
+        cache_queue::job job(model_id, node_id, slot_id, priority, slot_mem, slot_mem_provenance);
         if(!pool_->acknowledge_request(job))
         {
             index_->unreserve_slot(slot_id);
@@ -173,11 +193,19 @@ void ooc_cache::register_node(const model_t model_id, const node_t node_id, cons
 }
 
 char *ooc_cache::node_data(const model_t model_id, const node_t node_id) { 
+    if (pool_->is_mapped()) {
+        assert(index_->is_node_aquired(model_id, node_id));
+        return pool_->mapped_node_data(model_id, node_id);
+    }
     return cache_data_ + index_->get_slot(model_id, node_id) * slot_size(); 
 }
 
 char *ooc_cache::node_data_provenance(const model_t model_id, const node_t node_id)
 {
+    if (pool_->is_mapped()) {
+        assert(index_->is_node_aquired(model_id, node_id));
+        return pool_->mapped_node_data_provenance(model_id, node_id);
+    }
     model_database *database = model_database::get_instance();
     return cache_data_provenance_ + index_->get_slot(model_id, node_id) * database->get_primitives_per_node() * lamure::ren::data_provenance::get_instance()->get_size_in_bytes();
 }
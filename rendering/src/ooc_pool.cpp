@@ -7,13 +7,19 @@
 
 #include <lamure/ren/ooc_pool.h>
 
+#include <lamure/memory.h>
+
+#include <algorithm>
+#include <memory>
+
 namespace lamure
 {
 namespace ren
 {
 
-ooc_pool::ooc_pool(const uint32_t num_threads, const size_t size_of_slot_in_bytes, const size_t size_of_slot_provenance)
-    : locked_(false), size_of_slot_(size_of_slot_in_bytes), size_of_slot_provenance_(size_of_slot_provenance), num_threads_(num_threads), shutdown_(false), bytes_loaded_(0)
+ooc_pool::ooc_pool(const uint32_t num_threads, const size_t size_of_slot_in_bytes, const size_t size_of_slot_provenance, const loader_mode mode, const bool map_files)
+    : locked_(false), size_of_slot_(size_of_slot_in_bytes), size_of_slot_provenance_(size_of_slot_provenance), num_threads_(num_threads), mode_(mode), mapped_(false), num_busy_threads_(0),
+      shutdown_(false), bytes_loaded_(0)
 {
     assert(num_threads_ > 0);
 
@@ -24,9 +30,33 @@ ooc_pool::ooc_pool(const uint32_t num_threads, const size_t size_of_slot_in_byte
 
     priority_queue_.initialize(LAMURE_CUT_UPDATE_LOADING_QUEUE_MODE, database->num_models());
 
-    for(uint32_t i = 0; i < num_threads_; ++i)
+    register_files();
+
+    if(map_files)
+    {
+        mapped_ = this->map_files();
+
+        //pages are faulted in synchronously, there is nothing to batch
+        if(mapped_)
+        {
+            mode_ = loader_mode::LOADER_BLOCKING;
+        }
+    }
+
+    statistics_ = loader_statistics();
+    measure_start_ = std::chrono::high_resolution_clock::now();
+
+    if(mode_ == loader_mode::LOADER_BATCHED)
     {
-        threads_.push_back(std::thread(&ooc_pool::run, this));
+        num_threads_ = 1;
+        threads_.push_back(std::thread(&ooc_pool::run_batched, this));
+    }
+    else
+    {
+        for(uint32_t i = 0; i < num_threads_; ++i)
+        {
+            threads_.push_back(std::thread(&ooc_pool::run, this));
+        }
     }
 }
 
@@ -47,6 +77,8 @@ ooc_pool::~ooc_pool()
         }
     }
     threads_.clear();
+
+    files_.close();
 }
 
 bool ooc_pool::is_shutdown()
@@ -71,23 +103,71 @@ void ooc_pool::begin_measure()
 {
     std::lock_guard<std::mutex> lock(mutex_);
     bytes_loaded_ = 0;
+    statistics_ = loader_statistics();
+    measure_start_ = std::chrono::high_resolution_clock::now();
 }
 
 void ooc_pool::end_measure()
 {
     std::lock_guard<std::mutex> lock(mutex_);
+    double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - measure_start_).count();
+
     std::cout << "megabytes loaded: " << bytes_loaded_ / 1024 / 1024 << std::endl;
+    std::cout << "nodes loaded: " << statistics_.num_jobs_ << std::endl;
+    std::cout << "megabytes/s: " << (seconds > 0.0 ? statistics_.bytes_loaded_ / seconds / 1024.0 / 1024.0 : 0.0) << std::endl;
+    if(statistics_.num_jobs_ > 0)
+    {
+        std::cout << "avg. queue depth: " << (double)statistics_.queue_depth_sum_ / statistics_.num_jobs_ << " (max. " << statistics_.max_queue_depth_ << ")" << std::endl;
+        std::cout << "job latency histogram:" << std::endl;
+        for(size_t i = 0; i < loader_statistics::num_latency_buckets; ++i)
+        {
+            if(statistics_.latency_histogram_[i] > 0)
+            {
+                std::cout << "  < " << (1ull << (i + 1)) << " us: " << statistics_.latency_histogram_[i] << std::endl;
+            }
+        }
+    }
 }
 
-void ooc_pool::run()
+const ooc_pool::loader_statistics ooc_pool::statistics()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return statistics_;
+}
+
+void ooc_pool::record_jobs(const std::vector<cache_queue::job> &jobs, const std::vector<std::chrono::high_resolution_clock::time_point> &start_times,
+                           const size_t bytes_loaded, const size_t queue_depth)
+{
+    auto now = std::chrono::high_resolution_clock::now();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    history_.insert(history_.end(), jobs.begin(), jobs.end());
+    bytes_loaded_ += bytes_loaded;
+
+    statistics_.num_jobs_ += jobs.size();
+    statistics_.bytes_loaded_ += bytes_loaded;
+    statistics_.queue_depth_sum_ += queue_depth * jobs.size();
+    statistics_.max_queue_depth_ = std::max(statistics_.max_queue_depth_, queue_depth);
+
+    for(const auto &start_time : start_times)
+    {
+        uint64_t latency = std::chrono::duration_cast<std::chrono::microseconds>(now - start_time).count();
+        size_t bucket = 0;
+        while(latency > 1 && bucket < loader_statistics::num_latency_buckets - 1)
+        {
+            latency >>= 1;
+            ++bucket;
+        }
+        ++statistics_.latency_histogram_[bucket];
+    }
+}
+
+void ooc_pool::register_files()
 {
     model_database *database = model_database::get_instance();
     model_t num_models = database->num_models();
 
-    std::vector<std::string> lod_files;
-    std::vector<std::string> provenance_files;
-    std::vector<size_t> provenance_sizes;
-
     uint64_t data_provenance_size_in_bytes = lamure::ren::data_provenance::get_instance()->get_size_in_bytes();
 
     for (model_t model_id = 0; model_id < num_models; ++model_id) {
@@ -99,32 +179,205 @@ void ooc_pool::run()
         std::string lod_file_name = base_name + "lod" + bvh_suffix;
         std::string provenance_file_name = bvh_filename.substr(0, bvh_filename.size() - 3) + "prov";
 
+        lod_files_.push_back(files_.register_file(lod_file_name));
 
-        lod_files.push_back(lod_file_name);
-
+        node_file_registry::file_t provenance_file = node_file_registry::invalid_file_t;
         if (data_provenance_size_in_bytes > 0)
         {
             std::ifstream f(provenance_file_name.c_str());
             if (f.good()) {
               //check if corresponding .prov file exists
-              provenance_files.push_back(provenance_file_name);
               f.close();
+              provenance_file = files_.register_file(provenance_file_name);
             }
-            else {
-              provenance_files.push_back("");   
+        }
+        provenance_files_.push_back(provenance_file);
+
+        provenance_sizes_.push_back(database->get_model(model_id)->get_bvh()->get_size_of_provenance());
+    }
+}
+
+void ooc_pool::collect_reads(const cache_queue::job &job, std::vector<char> &scratch, std::vector<node_loader::request> &reads, const uint64_t tag)
+{
+    model_database *database = model_database::get_instance();
+
+    uint64_t data_provenance_size_in_bytes = lamure::ren::data_provenance::get_instance()->get_size_in_bytes();
+
+    //the slot is reserved for this job and not visible to anyone
+    //before resolve_cache_history, so we read straight into it
+    size_t stride_in_bytes = database->get_node_size(job.model_id_);
+    size_t offset_in_bytes = job.node_id_ * stride_in_bytes;
+
+    reads.push_back(node_loader::request{lod_files_[job.model_id_], job.slot_mem_, offset_in_bytes, stride_in_bytes, tag});
+
+    scratch.clear();
+
+    if(data_provenance_size_in_bytes > 0) { //check if provenance backend invoked
+        if (provenance_files_[job.model_id_] != node_file_registry::invalid_file_t) {
+            if (job.slot_mem_provenance_ == nullptr) {
+                std::cout << "prov slot mem not allocated" << std::endl;
+            }
+            size_t size_of_provenance = provenance_sizes_[job.model_id_];
+            if (size_of_provenance == 0) {
+                std::cout << "Warning!" << std::endl;
+                //WARNING! You invoked the provenance backend, but your provenance size for this model is zero.
+                //In this case, revert to the system-wide provenance size. 
+                //For .bvh files generated before bvh format revision 1.3, this should do the trick.
+                size_of_provenance = data_provenance_size_in_bytes;
+            }
+
+            size_t stride_in_bytes_provenance = database->get_primitives_per_node(job.model_id_) * size_of_provenance;
+
+            size_t offset_in_bytes_provenance = job.node_id_ * stride_in_bytes_provenance;
+
+            char *target = job.slot_mem_provenance_;
+            if (data_provenance_size_in_bytes != size_of_provenance) {
+                //layout on disk differs from the one in the cache, repacked in finish_job
+                scratch.resize(stride_in_bytes_provenance);
+                target = scratch.data();
+            }
+
+            reads.push_back(node_loader::request{provenance_files_[job.model_id_], target, offset_in_bytes_provenance, stride_in_bytes_provenance, tag});
+        }
+    }
+}
+
+void ooc_pool::finish_job(const cache_queue::job &job, const std::vector<char> &scratch)
+{
+    if (scratch.empty()) {
+        return;
+    }
+
+    model_database *database = model_database::get_instance();
+
+    uint64_t data_provenance_size_in_bytes = lamure::ren::data_provenance::get_instance()->get_size_in_bytes();
+    size_t num_primitives = database->get_primitives_per_node(job.model_id_);
+    size_t size_of_provenance = scratch.size() / num_primitives;
+
+    for (uint64_t surfel_id = 0; surfel_id < num_primitives; ++surfel_id) {
+        memcpy(job.slot_mem_provenance_+surfel_id*data_provenance_size_in_bytes, 
+            scratch.data()+surfel_id*size_of_provenance, size_of_provenance);
+    }
+}
+
+bool ooc_pool::map_files()
+{
+    model_database *database = model_database::get_instance();
+    uint64_t data_provenance_size_in_bytes = lamure::ren::data_provenance::get_instance()->get_size_in_bytes();
+
+    //only worth it if everything fits into the page cache
+    uint64_t total_size_in_bytes = 0;
+    for(model_t model_id = 0; model_id < database->num_models(); ++model_id)
+    {
+        total_size_in_bytes += files_.file_size(lod_files_[model_id]);
+
+        if(provenance_files_[model_id] != node_file_registry::invalid_file_t)
+        {
+            total_size_in_bytes += files_.file_size(provenance_files_[model_id]);
+
+            //the cache layout must match the file layout
+            size_t size_of_provenance = provenance_sizes_[model_id] == 0 ? data_provenance_size_in_bytes : provenance_sizes_[model_id];
+            if(size_of_provenance != data_provenance_size_in_bytes)
+            {
+#ifdef LAMURE_ENABLE_INFO
+                std::cout << "lamure: provenance layout differs from file, ooc-cache uses slot copies" << std::endl;
+#endif
+                return false;
+            }
+        }
+    }
+
+    float safety = 0.75;
+    if(total_size_in_bytes > get_total_memory() * safety)
+    {
+#ifdef LAMURE_ENABLE_INFO
+        std::cout << "lamure: dataset exceeds main memory, ooc-cache uses slot copies" << std::endl;
+#endif
+        return false;
+    }
+
+    for(model_t model_id = 0; model_id < database->num_models(); ++model_id)
+    {
+        if(files_.map(lod_files_[model_id], size_of_slot_) == nullptr)
+        {
+            return false;
+        }
+
+        if(provenance_files_[model_id] != node_file_registry::invalid_file_t)
+        {
+            if(files_.map(provenance_files_[model_id], size_of_slot_provenance_) == nullptr)
+            {
+                return false;
             }
         }
+        else if(data_provenance_size_in_bytes > 0)
+        {
+            //models without .prov file share one zero-filled node, the transfer copies provenance for every node
+            size_t stride_in_bytes_provenance = database->get_primitives_per_node(model_id) * data_provenance_size_in_bytes;
+            empty_provenance_.resize(std::max(empty_provenance_.size(), std::max(stride_in_bytes_provenance, size_of_slot_provenance_)), 0);
+        }
+    }
+
+#ifdef LAMURE_ENABLE_INFO
+    std::cout << "lamure: ooc-cache maps " << total_size_in_bytes / 1024 / 1024 << " MB of node data" << std::endl;
+#endif
+
+    return true;
+}
+
+char *ooc_pool::mapped_node_data(const model_t model_id, const node_t node_id) const
+{
+    assert(mapped_);
 
-        provenance_sizes.push_back(database->get_model(model_id)->get_bvh()->get_size_of_provenance());
+    model_database *database = model_database::get_instance();
+    size_t stride_in_bytes = database->get_node_size(model_id);
+
+    return const_cast<char *>(files_.mapped_data(lod_files_[model_id])) + node_id * stride_in_bytes;
+}
+
+char *ooc_pool::mapped_node_data_provenance(const model_t model_id, const node_t node_id) const
+{
+    assert(mapped_);
+
+    if(provenance_files_[model_id] == node_file_registry::invalid_file_t)
+    {
+        return empty_provenance_.empty() ? nullptr : const_cast<char *>(empty_provenance_.data());
     }
 
-    char *local_cache = new char[size_of_slot_];
-    
-    char *local_cache_provenance = nullptr;
-    if(data_provenance_size_in_bytes > 0) {
-      local_cache_provenance = new char[size_of_slot_provenance_];
+    model_database *database = model_database::get_instance();
+    uint64_t data_provenance_size_in_bytes = lamure::ren::data_provenance::get_instance()->get_size_in_bytes();
+    size_t stride_in_bytes_provenance = database->get_primitives_per_node(model_id) * data_provenance_size_in_bytes;
+
+    return const_cast<char *>(files_.mapped_data(provenance_files_[model_id])) + node_id * stride_in_bytes_provenance;
+}
+
+void ooc_pool::evict_node(const model_t model_id, const node_t node_id) const
+{
+    if(!mapped_)
+    {
+        return;
     }
 
+    model_database *database = model_database::get_instance();
+    size_t stride_in_bytes = database->get_node_size(model_id);
+    files_.evict(lod_files_[model_id], node_id * stride_in_bytes, stride_in_bytes);
+
+    if(provenance_files_[model_id] != node_file_registry::invalid_file_t)
+    {
+        uint64_t data_provenance_size_in_bytes = lamure::ren::data_provenance::get_instance()->get_size_in_bytes();
+        size_t stride_in_bytes_provenance = database->get_primitives_per_node(model_id) * data_provenance_size_in_bytes;
+        files_.evict(provenance_files_[model_id], node_id * stride_in_bytes_provenance, stride_in_bytes_provenance);
+    }
+}
+
+void ooc_pool::run()
+{
+    std::vector<char> scratch;
+    std::vector<node_loader::request> reads;
+
+    std::vector<cache_queue::job> jobs(1);
+    std::vector<std::chrono::high_resolution_clock::time_point> start_times(1);
+
     while(true)
     {
         semaphore_.wait();
@@ -132,80 +385,168 @@ void ooc_pool::run()
         if(is_shutdown())
             break;
 
+        auto start_time = std::chrono::high_resolution_clock::now();
         cache_queue::job job = priority_queue_.top_job();
 
         if(job.node_id_ != invalid_node_t)
         {
             assert(job.slot_mem_ != nullptr);
-            
-
-            size_t stride_in_bytes = database->get_node_size(job.model_id_);
-            size_t offset_in_bytes = job.node_id_ * stride_in_bytes;
 
-            lod_stream access;
-            access.open(lod_files[job.model_id_]);
-            access.read(local_cache, offset_in_bytes, stride_in_bytes);
-            access.close();
+            size_t queue_depth = ++num_busy_threads_;
 
-            std::lock_guard<std::mutex> lock(mutex_);
+            reads.clear();
+            collect_reads(job, scratch, reads, 0);
 
-            memcpy(job.slot_mem_, local_cache, stride_in_bytes);
-
-            history_.push_back(job);
-
-            if(data_provenance_size_in_bytes > 0) { //check if provenance backend invoked
-                if (job.slot_mem_provenance_ == nullptr) {
-                    std::cout << "prov slot mem not allocated" << std::endl;
+            size_t bytes_loaded = 0;
+            for(const auto &read : reads)
+            {
+                if(mapped_)
+                {
+                    files_.prefetch(read.file_id_, read.offset_in_bytes_, read.length_in_bytes_);
                 }
-                if (provenance_files[job.model_id_] != "") {
-                    provenance_stream access_provenance;
-                    access_provenance.open(provenance_files[job.model_id_]);
-                    
-                    size_t size_of_provenance = provenance_sizes[job.model_id_];
-                    if (size_of_provenance == 0) {
-                        std::cout << "Warning!" << std::endl;
-                        //WARNING! You invoked the provenance backend, but your provenance size for this model is zero.
-                        //In this case, revert to the system-wide provenance size. 
-                        //For .bvh files generated before bvh format revision 1.3, this should do the trick.
-                        size_of_provenance = data_provenance_size_in_bytes;
-                    }
-
-                    size_t stride_in_bytes_provenance = database->get_primitives_per_node(job.model_id_) * size_of_provenance;
-
-                    size_t offset_in_bytes_provenance = job.node_id_ * stride_in_bytes_provenance;
-                    access_provenance.read(local_cache_provenance, offset_in_bytes_provenance, stride_in_bytes_provenance);
-
-                    if (data_provenance_size_in_bytes == size_of_provenance) {
-                        memcpy(job.slot_mem_provenance_, local_cache_provenance, stride_in_bytes_provenance);
-                    }
-                    else {
-
-                      for (uint64_t surfel_id = 0; surfel_id < database->get_primitives_per_node(job.model_id_); ++surfel_id) {
-                        memcpy(job.slot_mem_provenance_+surfel_id*data_provenance_size_in_bytes, 
-                            local_cache_provenance+surfel_id*size_of_provenance, size_of_provenance);
-                      }
-                    }
-                    
-                    access_provenance.close();
+                else
+                {
+                    files_.read(read.file_id_, read.data_, read.offset_in_bytes_, read.length_in_bytes_);
                 }
+                bytes_loaded += read.length_in_bytes_;
             }
+
+            finish_job(job, scratch);
+
+            jobs[0] = job;
+            start_times[0] = start_time;
+            record_jobs(jobs, start_times, bytes_loaded, queue_depth);
+
+            --num_busy_threads_;
         }
     }
+}
 
-    
-    lod_files.clear();
-    provenance_files.clear();
+void ooc_pool::run_batched()
+{
+    const uint32_t max_jobs_in_flight = LAMURE_CUT_UPDATE_LOADING_QUEUE_DEPTH;
 
+    //every job issues up to two reads (.lod and .prov)
+    std::unique_ptr<node_loader> loader(node_loader::create(&files_, 2 * max_jobs_in_flight));
 
-    if(local_cache != nullptr)
+    struct in_flight_job
+    {
+        cache_queue::job job_;
+        uint32_t num_pending_reads_;
+        size_t bytes_;
+        std::vector<char> scratch_;
+        std::chrono::high_resolution_clock::time_point start_time_;
+    };
+
+    std::vector<in_flight_job> in_flight(max_jobs_in_flight);
+    std::vector<uint32_t> free_entries;
+    for(uint32_t i = 0; i < max_jobs_in_flight; ++i)
     {
-        delete[] local_cache;
-        local_cache = nullptr;
+        free_entries.push_back(max_jobs_in_flight - 1 - i);
     }
-    if(local_cache_provenance != nullptr)
+
+    std::vector<node_loader::request> batch;
+    std::vector<uint64_t> completed_tags;
+    std::vector<cache_queue::job> completed_jobs;
+    std::vector<std::chrono::high_resolution_clock::time_point> start_times;
+
+    while(true)
+    {
+        size_t num_in_flight = max_jobs_in_flight - free_entries.size();
+
+        if(num_in_flight == 0)
+        {
+            semaphore_.wait();
+        }
+
+        if(is_shutdown())
+            break;
+
+        //jobs stay in the queue (and abortable) until there is room for them.
+        //top_job always hands out the currently most important one
+        batch.clear();
+        while(!free_entries.empty())
+        {
+            auto start_time = std::chrono::high_resolution_clock::now();
+            cache_queue::job job = priority_queue_.top_job();
+            if(job.node_id_ == invalid_node_t)
+            {
+                break;
+            }
+
+            assert(job.slot_mem_ != nullptr);
+
+            uint32_t entry_id = free_entries.back();
+            free_entries.pop_back();
+
+            in_flight_job &entry = in_flight[entry_id];
+            entry.job_ = job;
+            entry.start_time_ = start_time;
+
+            size_t first_read = batch.size();
+            collect_reads(job, entry.scratch_, batch, entry_id);
+
+            entry.num_pending_reads_ = (uint32_t)(batch.size() - first_read);
+            entry.bytes_ = 0;
+            for(size_t i = first_read; i < batch.size(); ++i)
+            {
+                entry.bytes_ += batch[i].length_in_bytes_;
+            }
+        }
+
+        if(!batch.empty())
+        {
+            loader->submit(batch);
+        }
+
+        num_in_flight = max_jobs_in_flight - free_entries.size();
+        if(num_in_flight == 0)
+        {
+            continue;
+        }
+
+        completed_tags.clear();
+        loader->wait(completed_tags);
+
+        completed_jobs.clear();
+        start_times.clear();
+        size_t bytes_loaded = 0;
+
+        for(const auto tag : completed_tags)
+        {
+            in_flight_job &entry = in_flight[tag];
+            assert(entry.num_pending_reads_ > 0);
+
+            if(--entry.num_pending_reads_ == 0)
+            {
+                finish_job(entry.job_, entry.scratch_);
+
+                completed_jobs.push_back(entry.job_);
+                start_times.push_back(entry.start_time_);
+                bytes_loaded += entry.bytes_;
+
+                free_entries.push_back((uint32_t)tag);
+            }
+        }
+
+        if(!completed_jobs.empty())
+        {
+            record_jobs(completed_jobs, start_times, bytes_loaded, num_in_flight);
+        }
+    }
+
+    //the loader must not write into the slots after the cache is gone
+    while(free_entries.size() < max_jobs_in_flight)
     {
-        delete[] local_cache_provenance;
-        local_cache_provenance = nullptr;
+        completed_tags.clear();
+        loader->wait(completed_tags);
+        for(const auto tag : completed_tags)
+        {
+            if(--in_flight[tag].num_pending_reads_ == 0)
+            {
+                free_entries.push_back((uint32_t)tag);
+            }
+        }
     }
 }
 
@@ -25,6 +25,10 @@ policy()
   max_upload_budget_in_mb_(LAMURE_DEFAULT_UPLOAD_BUDGET),
   render_budget_in_mb_(LAMURE_DEFAULT_VIDEO_MEMORY_BUDGET),
   out_of_core_budget_in_mb_(LAMURE_DEFAULT_MAIN_MEMORY_BUDGET),
+  out_of_core_mapping_(false),
+  clock_cache_replacement_(false),
+  prefetch_frames_(LAMURE_CUT_UPDATE_DEFAULT_PREFETCH_FRAMES),
+  prefetch_budget_in_nodes_(LAMURE_CUT_UPDATE_PREFETCH_BUDGET),
   window_width_(800),
   window_height_(600) {
 
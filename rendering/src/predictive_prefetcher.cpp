@@ -0,0 +1,124 @@
+// Copyright (c) 2014-2018 Bauhaus-Universitaet Weimar
+// This Software is distributed under the Modified BSD License, see license.txt.
+//
+// Virtual Reality and Visualization Research Group
+// Faculty of Media, Bauhaus-Universitaet Weimar
+// http://www.uni-weimar.de/medien/vr
+
+#include <lamure/ren/predictive_prefetcher.h>
+
+#include <cmath>
+
+
+namespace lamure
+{
+
+namespace ren
+{
+
+predictive_prefetcher::
+predictive_prefetcher()
+: frame_(0) {
+    stats_ = frame_stats{0, 0, 0, 0, 0};
+    total_stats_ = stats_;
+}
+
+void predictive_prefetcher::
+begin_frame(const std::map<view_t, camera>& cameras, const uint32_t expiry_frames, const size_t node_size_in_bytes) {
+    ++frame_;
+
+    for (const auto& camera_it : cameras) {
+        const scm::math::mat4f view_matrix = camera_it.second.get_view_matrix();
+        auto history_it = views_.find(camera_it.first);
+        if (history_it == views_.end()) {
+            views_[camera_it.first] = view_history{view_matrix, view_matrix, frame_, false};
+            continue;
+        }
+        view_history& history = history_it->second;
+        // only consecutive frames give a per-frame motion
+        history.valid_ = history.frame_ + 1 == frame_;
+        history.previous_ = history.current_;
+        history.current_ = view_matrix;
+        history.frame_ = frame_;
+    }
+
+    stats_ = frame_stats{0, 0, 0, 0, 0};
+
+    for (auto it = requests_.begin(); it != requests_.end(); ) {
+        if (frame_ - it->second > expiry_frames) {
+            ++stats_.num_wasted_;
+            stats_.wasted_bytes_ += node_size_in_bytes;
+            it = requests_.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+
+    total_stats_.num_wasted_ += stats_.num_wasted_;
+    total_stats_.wasted_bytes_ += stats_.wasted_bytes_;
+}
+
+const bool predictive_prefetcher::
+predict_view_matrix(const view_t view_id, const uint32_t frames_ahead, scm::math::mat4f& predicted_view_matrix) const {
+    const auto history_it = views_.find(view_id);
+    if (history_it == views_.end() || !history_it->second.valid_ || frames_ahead == 0) {
+        return false;
+    }
+
+    const view_history& history = history_it->second;
+
+    // current = motion * previous, motion maps the previous view space to the current one
+    const scm::math::mat4f motion = history.current_ * scm::math::inverse(history.previous_);
+
+    float deviation = 0.f;
+    for (int i = 0; i < 16; ++i) {
+        deviation += std::abs(motion[i] - scm::math::mat4f::identity()[i]);
+    }
+    if (deviation < 1e-5f) {
+        return false;
+    }
+
+    predicted_view_matrix = history.current_;
+    for (uint32_t frame = 0; frame < frames_ahead; ++frame) {
+        predicted_view_matrix = motion * predicted_view_matrix;
+    }
+
+    return true;
+}
+
+void predictive_prefetcher::
+note_request(const model_t model_id, const node_t node_id) {
+    if (requests_.emplace(key(model_id, node_id), frame_).second) {
+        ++stats_.num_requested_;
+        ++total_stats_.num_requested_;
+    }
+}
+
+void predictive_prefetcher::
+note_demand(const model_t model_id, const node_t node_id, const bool resident) {
+    if (requests_.empty()) {
+        return;
+    }
+
+    const auto it = requests_.find(key(model_id, node_id));
+    if (it == requests_.end()) {
+        return;
+    }
+
+    requests_.erase(it);
+
+    if (resident) {
+        ++stats_.num_hits_;
+        ++total_stats_.num_hits_;
+    }
+    else {
+        ++stats_.num_late_;
+        ++total_stats_.num_late_;
+    }
+}
+
+
+} // namespace ren
+
+} // namespace lamure
@@ -8,120 +8,198 @@
 #ifndef VT_TILEREQUESTPRIORITYQUEUE_H
 #define VT_TILEREQUESTPRIORITYQUEUE_H
 
-#include <lamure/vt/AbstractQueue.h>
+#include <lamure/vt/common.h>
 #include <lamure/vt/ooc/TileRequest.h>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <vector>
 
 namespace vt
 {
+/*
+ * Binary max-heap of pending tile requests. Every request stores its
+ * position in the heap, so priority updates, removal and contains do not
+ * search the queue. Requests of equal priority are popped in the order
+ * they were pushed.
+ */
 template <typename priority_type>
-class TileRequestPriorityQueue;
-
-template <typename priority_type>
-class VT_DLL TileRequestPriorityQueueEntry : public AbstractQueueEntry<vt::ooc::TileRequest*>
+class VT_DLL TileRequestPriorityQueue
 {
   protected:
-    std::mutex _deleteLock;
+    struct Entry
+    {
+        priority_type priority;
+        uint64_t sequence;
+        ooc::TileRequest* request;
+    };
 
-  public:
-    explicit TileRequestPriorityQueueEntry(ooc::TileRequest* req, TileRequestPriorityQueue<priority_type>& queue);
+    alignas(64) std::condition_variable _newEntry;
 
-    ~TileRequestPriorityQueueEntry() {}
+    alignas(64) std::mutex _lock;
+    std::vector<Entry> _heap;
+    uint64_t _sequence;
 
-    virtual priority_type getPriority() { return this->_content.load()->getPriority(); }
-};
+    static bool _before(const Entry& a, const Entry& b) { return a.priority > b.priority || (a.priority == b.priority && a.sequence < b.sequence); }
 
-#ifdef _WIN32
-#if defined(LAMURE_VT_LIBRARY)
-template <typename priority_type>
-TileRequestPriorityQueueEntry<priority_type>::TileRequestPriorityQueueEntry(ooc::TileRequest* req, TileRequestPriorityQueue<priority_type>& queue) : AbstractQueueEntry<ooc::TileRequest*>(req, &queue)
-{
-}
-#endif
-#else
-template <typename priority_type>
-TileRequestPriorityQueueEntry<priority_type>::TileRequestPriorityQueueEntry(ooc::TileRequest* req, TileRequestPriorityQueue<priority_type>& queue) : AbstractQueueEntry<ooc::TileRequest*>(req, &queue)
-{
-}
-#endif
+    void _place(size_t pos, const Entry& entry)
+    {
+        _heap[pos] = entry;
+        entry.request->setQueuePosition(pos);
+    }
 
-template <typename priority_type>
-class VT_DLL TileRequestPriorityQueue : public AbstractQueue<ooc::TileRequest*>
-{
-  protected:
-    virtual void _insertUnsafe(TileRequestPriorityQueueEntry<priority_type>& entry)
+    void _siftUpUnsafe(size_t pos)
     {
-        auto next = (TileRequestPriorityQueueEntry<priority_type>*)this->_first.load();
-        TileRequestPriorityQueueEntry<priority_type>* prev = nullptr;
+        Entry entry = _heap[pos];
 
-        while(next != nullptr)
+        while(pos > 0)
         {
-            if(next->getPriority() >= entry.getPriority())
+            size_t parent = (pos - 1) / 2;
+
+            if(!_before(entry, _heap[parent]))
             {
                 break;
             }
 
-            prev = next;
-            next = (TileRequestPriorityQueueEntry<priority_type>*)next->getNext();
+            _place(pos, _heap[parent]);
+            pos = parent;
         }
 
-        entry.setPrev(prev);
-        entry.setNext(next);
+        _place(pos, entry);
+    }
 
-        if(prev == nullptr)
-        {
-            this->_first.store(&entry);
-        }
-        else
-        {
-            prev->setNext(&entry);
-        }
+    void _siftDownUnsafe(size_t pos)
+    {
+        Entry entry = _heap[pos];
+        size_t size = _heap.size();
 
-        if(next == nullptr)
+        while(true)
         {
-            this->_last.store(&entry);
+            size_t child = 2 * pos + 1;
+
+            if(child >= size)
+            {
+                break;
+            }
+
+            if(child + 1 < size && _before(_heap[child + 1], _heap[child]))
+            {
+                ++child;
+            }
+
+            if(!_before(_heap[child], entry))
+            {
+                break;
+            }
+
+            _place(pos, _heap[child]);
+            pos = child;
         }
-        else
+
+        _place(pos, entry);
+    }
+
+    bool _containsUnsafe(ooc::TileRequest* request)
+    {
+        size_t pos = request->getQueuePosition();
+        return pos < _heap.size() && _heap[pos].request == request;
+    }
+
+    ooc::TileRequest* _extractUnsafe(size_t pos)
+    {
+        auto request = _heap[pos].request;
+        request->setQueuePosition(ooc::TileRequest::NOT_QUEUED);
+
+        Entry last = _heap.back();
+        _heap.pop_back();
+
+        if(pos < _heap.size())
         {
-            next->setPrev(&entry);
+            _heap[pos] = last;
+
+            if(pos > 0 && _before(last, _heap[(pos - 1) / 2]))
+            {
+                _siftUpUnsafe(pos);
+            }
+            else
+            {
+                _siftDownUnsafe(pos);
+            }
         }
+
+        return request;
     }
 
   public:
-    virtual void reinsert(TileRequestPriorityQueueEntry<priority_type>& entry)
-    {
-        std::lock_guard<std::mutex> lock(this->_lock);
+    TileRequestPriorityQueue() { _sequence = 0; }
 
-        this->_extractUnsafe(entry);
-        this->_insertUnsafe(entry);
-    }
+    virtual ~TileRequestPriorityQueue() {}
 
     virtual void push(ooc::TileRequest*& content)
     {
-        auto entry = new TileRequestPriorityQueueEntry<priority_type>(content, *this);
+        {
+            std::lock_guard<std::mutex> lock(this->_lock);
+
+            _heap.push_back(Entry{content->getPriority(), _sequence++, content});
+            _siftUpUnsafe(_heap.size() - 1);
+        }
+
+        // wake one waiting loader instead of letting it run into its timeout
+        this->_newEntry.notify_one();
+    }
 
+    // sets the priority of the request and moves it if it is queued
+    virtual void setPriority(ooc::TileRequest* content, priority_type priority)
+    {
         std::lock_guard<std::mutex> lock(this->_lock);
 
-        this->_insertUnsafe(*entry);
+        content->setPriority(priority);
+
+        if(!_containsUnsafe(content))
+        {
+            return;
+        }
+
+        size_t pos = content->getQueuePosition();
+        priority_type previous = _heap[pos].priority;
+        _heap[pos].priority = priority;
+
+        if(priority > previous)
+        {
+            _siftUpUnsafe(pos);
+        }
+        else if(priority < previous)
+        {
+            _siftDownUnsafe(pos);
+        }
     }
 
-    virtual bool pop(ooc::TileRequest*& content, const std::chrono::milliseconds maxTime)
+    // takes the request out of the queue, false if it is not queued (anymore)
+    virtual bool remove(ooc::TileRequest* content)
     {
-        std::unique_lock<std::mutex> lock(this->_lock);
+        std::lock_guard<std::mutex> lock(this->_lock);
 
-        if(!this->_newEntry.wait_for(lock, maxTime, [this]() -> bool { return this->_first.load() != nullptr; }))
+        if(!_containsUnsafe(content))
         {
             return false;
         }
 
-        auto entry = (TileRequestPriorityQueueEntry<priority_type>*)this->_popBackUnsafe();
+        _extractUnsafe(content->getQueuePosition());
+
+        return true;
+    }
 
-        if(entry == nullptr)
+    virtual bool pop(ooc::TileRequest*& content, const std::chrono::milliseconds maxTime)
+    {
+        std::unique_lock<std::mutex> lock(this->_lock);
+
+        if(!this->_newEntry.wait_for(lock, maxTime, [this]() -> bool { return !this->_heap.empty(); }))
         {
             return false;
         }
 
-        content = entry->getContent();
-        delete entry;
+        content = _extractUnsafe(0);
 
         return true;
     }
@@ -130,20 +208,23 @@ class VT_DLL TileRequestPriorityQueue : public AbstractQueue<ooc::TileRequest*>
     {
         std::unique_lock<std::mutex> lock(this->_lock);
 
-        if(!this->_newEntry.wait_for(lock, maxTime, [this]() -> bool { return this->_last.load() != nullptr; }))
+        if(!this->_newEntry.wait_for(lock, maxTime, [this]() -> bool { return !this->_heap.empty(); }))
         {
             return false;
         }
 
-        auto entry = (TileRequestPriorityQueueEntry<priority_type>*)this->_popFrontUnsafe();
+        // the least request is one of the leaves
+        size_t least = _heap.size() / 2;
 
-        if(entry == nullptr)
+        for(size_t pos = least + 1; pos < _heap.size(); ++pos)
         {
-            return false;
+            if(_before(_heap[least], _heap[pos]))
+            {
+                least = pos;
+            }
         }
 
-        content = entry->getContent();
-        delete entry;
+        content = _extractUnsafe(least);
 
         return true;
     }
@@ -152,15 +233,14 @@ class VT_DLL TileRequestPriorityQueue : public AbstractQueue<ooc::TileRequest*>
     {
         std::lock_guard<std::mutex> lock(this->_lock);
 
-        for(auto entry = this->_first.load(); entry != nullptr; entry = entry->getNext())
-        {
-            if(entry->getContent() == content)
-            {
-                return true;
-            }
-        }
+        return _containsUnsafe(content);
+    }
+
+    size_t size()
+    {
+        std::lock_guard<std::mutex> lock(this->_lock);
 
-        return false;
+        return _heap.size();
     }
 };
 
@@ -66,6 +66,8 @@ class VT_DLL VTConfig
     uint32_t get_size_physical_update_throughput() const;
 
     uint32_t get_size_ram_cache() const;
+    /** Number of tile loader threads, 0 uses one per hardware thread. */
+    uint32_t get_num_loader_threads() const;
 
     FORMAT_TEXTURE get_format_texture() const;
     bool is_verbose() const;
@@ -79,6 +81,7 @@ class VT_DLL VTConfig
     void set_size_physical_texture(uint32_t sizePhysicalTexture);
     void set_size_physical_update_throughput(uint32_t sizePhysicalUpdateThroughput);
     void set_size_ram_cache(uint32_t sizeRamCache);
+    void set_num_loader_threads(uint32_t numLoaderThreads);
     void set_format_texture(FORMAT_TEXTURE formatTexture);
     void set_verbose(bool verbose);
 
@@ -96,6 +99,7 @@ private:
     static constexpr const char* PHYSICAL_SIZE_MB = "PHYSICAL_SIZE_MB";
     static constexpr const char* PHYSICAL_UPDATE_THROUGHPUT_MB = "PHYSICAL_UPDATE_THROUGHPUT_MB";
     static constexpr const char* RAM_CACHE_SIZE_MB = "RAM_CACHE_SIZE_MB";
+    static constexpr const char* LOADER_THREADS = "LOADER_THREADS";
 
     static constexpr const char* TEXTURE_FORMAT = "TEXTURE_FORMAT";
     static constexpr const char* TEXTURE_FORMAT_RGBA8 = "RGBA8";
@@ -115,6 +119,7 @@ private:
     uint32_t _size_physical_texture;
     uint32_t _size_physical_update_throughput;
     uint32_t _size_ram_cache;
+    uint32_t _num_loader_threads;
 
     VTConfig::FORMAT_TEXTURE _format_texture;
     bool _verbose;
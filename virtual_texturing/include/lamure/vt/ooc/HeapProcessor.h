@@ -15,6 +15,7 @@
 #include <lamure/vt/ooc/TileCache.h>
 #include <lamure/vt/ooc/TileRequest.h>
 #include <thread>
+#include <vector>
 
 namespace vt
 {
@@ -26,7 +27,8 @@ class VT_DLL HeapProcessor
     TileRequestPriorityQueue<float> _requests_prio_queue;
 
     std::atomic<bool> _running;
-    std::thread* _thread;
+    // workers share the request queue, each runs beforeStart, process and beforeStop
+    std::vector<std::thread> _threads;
 
     TileCache* _cache;
 
@@ -36,7 +38,13 @@ class VT_DLL HeapProcessor
 
     void request(TileRequest* request);
 
-    void start();
+    void setPriority(TileRequest* request, priority_type priority);
+
+    // drops a pending request from the queue and returns true, the caller erases it then. A request that is being
+    // processed is only marked as aborted. The caller has to keep the request alive, see TileRequestMap::processRequest.
+    bool abort(TileRequest* request);
+
+    void start(size_t threadCount = 1);
 
     void run();
 
@@ -51,6 +51,8 @@ class VT_DLL TileProvider
 
     TileCacheSlot* getTile(pre::AtlasFile* resource, id_type id, priority_type priority, uint16_t context_id);
     void ungetTile(pre::AtlasFile* resource, id_type id, uint16_t context_id);
+    // cancels a request of getTile that is not loaded yet
+    void abortTile(pre::AtlasFile* resource, id_type id);
 
     void stop();
 
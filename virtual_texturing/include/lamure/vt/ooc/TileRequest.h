@@ -8,6 +8,7 @@
 #ifndef VT_OOC_TILEREQUEST_H
 #define VT_OOC_TILEREQUEST_H
 
+#include <atomic>
 #include <lamure/vt/platform.h>
 #include <lamure/vt/pre/AtlasFile.h>
 #include <lamure/vt/Observable.h>
@@ -23,9 +24,14 @@ class VT_DLL TileRequest : public Observable
     pre::AtlasFile* _resource;
     uint64_t _id;
     priority_type _priority;
-    bool _aborted;
+    // set by the renderer while a loader may be processing the request
+    std::atomic<bool> _aborted;
+    // position in the request queue of the loader, maintained by the queue
+    size_t _queuePosition;
 
   public:
+    static const size_t NOT_QUEUED = SIZE_MAX;
+
     explicit TileRequest();
 
     void setResource(pre::AtlasFile* resource);
@@ -45,6 +51,10 @@ class VT_DLL TileRequest : public Observable
     void abort();
 
     bool isAborted();
+
+    void setQueuePosition(size_t position);
+
+    size_t getQueuePosition();
 };
 } // namespace ooc
 } // namespace vt
@@ -11,6 +11,7 @@
 #include <mutex>
 #include <condition_variable>
 #include <cstdint>
+#include <functional>
 #include <lamure/vt/platform.h>
 #include <lamure/vt/pre/AtlasFile.h>
 #include <lamure/vt/ooc/TileRequest.h>
@@ -37,6 +38,10 @@ class VT_DLL TileRequestMap : public Observer
 
     bool insertRequest(TileRequest* req);
 
+    // runs action on the request of the tile while holding the map lock, so no loader can erase the request meanwhile.
+    // A request for which action returns true is dropped from the map and deleted. False if the tile is not requested.
+    bool processRequest(pre::AtlasFile* resource, uint64_t id, const std::function<bool(TileRequest*)>& action);
+
     void inform(event_type event, Observable* observable);
 
     bool waitUntilEmpty(std::chrono::milliseconds maxTime = std::chrono::milliseconds::zero());
@@ -37,6 +37,14 @@ class VT_DLL AtlasFile
     const char* _fileName;
     std::ifstream _file;
 
+    // tiles are read at explicit offsets through a separate handle, so
+    // several loader threads can read from one atlas concurrently
+#ifdef _WIN32
+    void* _handle;
+#else
+    int _fd;
+#endif
+
     uint64_t _imageWidth;
     uint64_t _imageHeight;
     uint64_t _tileWidth;
@@ -71,6 +79,8 @@ class VT_DLL AtlasFile
 
     uint64_t _getOffset(uint64_t id);
 
+    bool _readAt(uint64_t offset, uint8_t* out, uint64_t byteSize);
+
   public:
     AtlasFile(const char* fileName);
     ~AtlasFile();
@@ -14,8 +14,15 @@
 #include <iostream>
 #endif
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <cstddef>
+#include <functional>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 #include <fstream>
 #include <chrono>
 #include <cstring>
@@ -85,6 +92,8 @@ class VT_DLL Preprocessor
     std::fstream _destPayloadFile;
     uint64_t _destPayloadOffset;
 
+    size_t _threadCount;
+
     bool _isPowerOfTwo(size_t val);
 
     size_t _loadTileById(uint64_t id, uint8_t* out);
@@ -95,6 +104,35 @@ class VT_DLL Preprocessor
     void _extract(size_t bufferTileWidth, size_t writeBufferTileSize);
     void _deflate(size_t tilesInWriteBuffer);
 
+    // threads started once per _extract or _deflate call and fed with one batch of tiles after the other
+    class WorkerPool
+    {
+      private:
+        std::vector<std::thread> _threads;
+        std::mutex _lock;
+        std::condition_variable _batchStarted;
+        std::condition_variable _batchDone;
+
+        const std::function<void(size_t)>* _job;
+        size_t _count;
+        std::atomic<size_t> _next;
+        uint64_t _batch;
+        size_t _busyThreads;
+        bool _running;
+        std::exception_ptr _error;
+
+        void _work();
+        void _runJobs();
+
+      public:
+        // starts threadCount - 1 threads, the thread calling parallelFor takes part in every batch
+        explicit WorkerPool(size_t threadCount);
+        ~WorkerPool();
+
+        // runs job(0) ... job(count - 1) on the pool, rethrows the first exception of a job
+        void parallelFor(size_t count, const std::function<void(size_t)>& job);
+    };
+
     void _putLE(uint64_t num, uint8_t* out);
     void _putPixelFormat(Bitmap::PIXEL_FORMAT pxFormat, uint8_t* out);
     void _putFileFormat(AtlasFile::LAYOUT fileFormat, uint8_t* out);
@@ -108,6 +146,9 @@ class VT_DLL Preprocessor
 
     void setOutput(const std::string& destFileName, Bitmap::PIXEL_FORMAT destPxFormat, AtlasFile::LAYOUT format, size_t tileWidth, size_t tileHeight, size_t padding, bool combine = true);
 
+    // threads cutting and deflating tiles, 0 uses one per hardware thread (default); the atlas does not depend on it
+    void setThreadCount(size_t threadCount);
+
     void run(size_t maxMemory);
 };
 } // namespace pre
@@ -81,6 +81,6 @@ void Observable::inform(event_type event)
         observers[i]->inform(event, this);
     }
 
-    delete observers;
+    delete[] observers;
 }
 } // namespace vt
\ No newline at end of file
@@ -34,6 +34,7 @@ void VTConfig::read_config(const char* path_config)
     _size_physical_texture = (uint32_t)atoi(ini_config->GetValue(VTConfig::TEXTURE_MANAGEMENT, VTConfig::PHYSICAL_SIZE_MB, VTConfig::UNDEF));
     _size_physical_update_throughput = (uint32_t)atoi(ini_config->GetValue(VTConfig::TEXTURE_MANAGEMENT, VTConfig::PHYSICAL_UPDATE_THROUGHPUT_MB, VTConfig::UNDEF));
     _size_ram_cache = (uint32_t)atoi(ini_config->GetValue(VTConfig::TEXTURE_MANAGEMENT, VTConfig::RAM_CACHE_SIZE_MB, VTConfig::UNDEF));
+    _num_loader_threads = (uint32_t)atoi(ini_config->GetValue(VTConfig::TEXTURE_MANAGEMENT, VTConfig::LOADER_THREADS, "0"));
     _format_texture = VTConfig::which_texture_format(ini_config->GetValue(VTConfig::TEXTURE_MANAGEMENT, VTConfig::TEXTURE_FORMAT, VTConfig::UNDEF));
     _verbose = atoi(ini_config->GetValue(VTConfig::DEBUG, VTConfig::VERBOSE, VTConfig::UNDEF)) == 1;
 }
@@ -97,6 +98,7 @@ const VTConfig::FORMAT_TEXTURE VTConfig::which_texture_format(const char* _textu
 }
 
 uint32_t VTConfig::get_size_ram_cache() const { return _size_ram_cache; }
+uint32_t VTConfig::get_num_loader_threads() const { return _num_loader_threads; }
 void VTConfig::set_defaults()
 {
     _size_tile = 256;
@@ -104,6 +106,7 @@ void VTConfig::set_defaults()
     _size_physical_texture = 4096;
     _size_physical_update_throughput = 4;
     _size_ram_cache = 16384;
+    _num_loader_threads = 0;
     _format_texture = FORMAT_TEXTURE::RGB8;
     _verbose = false;
 
@@ -114,6 +117,7 @@ void VTConfig::set_size_padding(uint16_t sizePadding) { _size_padding = sizePadd
 void VTConfig::set_size_physical_texture(uint32_t sizePhysicalTexture) { _size_physical_texture = sizePhysicalTexture; }
 void VTConfig::set_size_physical_update_throughput(uint32_t sizePhysicalUpdateThroughput) { _size_physical_update_throughput = sizePhysicalUpdateThroughput; }
 void VTConfig::set_size_ram_cache(uint32_t sizeRamCache) { _size_ram_cache = sizeRamCache; }
+void VTConfig::set_num_loader_threads(uint32_t numLoaderThreads) { _num_loader_threads = numLoaderThreads; }
 void VTConfig::set_format_texture(VTConfig::FORMAT_TEXTURE formatTexture) { _format_texture = formatTexture; }
 void VTConfig::set_verbose(bool verbose) { _verbose = verbose; }
 } // namespace vt
\ No newline at end of file
@@ -7,27 +7,39 @@
 
 #include <lamure/vt/ooc/HeapProcessor.h>
 
+#include <algorithm>
+
 namespace vt
 {
 namespace ooc
 {
 HeapProcessor::HeapProcessor()
 {
-    _thread = nullptr;
+    _running = false;
     _cache = nullptr;
 }
 
-HeapProcessor::~HeapProcessor()
-{
-    stop();
-    delete _thread;
-}
+HeapProcessor::~HeapProcessor() { stop(); }
 
 void HeapProcessor::request(TileRequest* request) { _requests_prio_queue.push(request); }
 
-void HeapProcessor::start()
+void HeapProcessor::setPriority(TileRequest* request, priority_type priority) { _requests_prio_queue.setPriority(request, priority); }
+
+bool HeapProcessor::abort(TileRequest* request)
 {
-    if(_thread != nullptr)
+    if(_requests_prio_queue.remove(request))
+    {
+        return true;
+    }
+
+    request->abort();
+
+    return false;
+}
+
+void HeapProcessor::start(size_t threadCount)
+{
+    if(!_threads.empty())
     {
         throw std::runtime_error("HeapProcessor is already started.");
     }
@@ -38,7 +50,11 @@ void HeapProcessor::start()
     }
 
     _running = true;
-    _thread = new std::thread(&HeapProcessor::run, this);
+
+    for(size_t i = 0; i < std::max<size_t>(threadCount, 1); ++i)
+    {
+        _threads.emplace_back(&HeapProcessor::run, this);
+    }
 }
 
 void HeapProcessor::run()
@@ -68,10 +84,16 @@ void HeapProcessor::writeTo(TileCache* cache) { _cache = cache; }
 void HeapProcessor::stop()
 {
     _running = false;
-    if(_thread->joinable())
+
+    for(auto& thread : _threads)
     {
-        _thread->join();
+        if(thread.joinable())
+        {
+            thread.join();
+        }
     }
+
+    _threads.clear();
 }
 
 } // namespace ooc
@@ -6,6 +6,7 @@
 // http://www.uni-weimar.de/medien/vr
 
 #include <lamure/vt/ooc/TileProvider.h>
+#include <lamure/vt/VTConfig.h>
 
 namespace vt
 {
@@ -43,7 +44,15 @@ void TileProvider::start(size_t maxMemSize)
 
     _cache = new TileCache(_tileByteSize, slotCount);
     _loader.writeTo(_cache);
-    _loader.start();
+
+    size_t loaderThreads = VTConfig::get_instance().get_num_loader_threads();
+
+    if(loaderThreads == 0)
+    {
+        loaderThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    _loader.start(loaderThreads);
 }
 
 pre::AtlasFile* TileProvider::loadResource(const char* fileName)
@@ -94,17 +103,19 @@ TileCacheSlot* TileProvider::getTile(pre::AtlasFile* resource, id_type tile_id,
         return slot;
     }
 
-    auto req = _requestsMap.getRequest(resource, tile_id);
+    // this updates priority of a tile in the loading queue if it is already present, under the lock of the request map
+    // like abortTile
+    bool requested = _requestsMap.processRequest(resource, tile_id, [&](TileRequest* req) {
+        _loader.setPriority(req, std::max(req->getPriority(), priority));
+        return false;
+    });
 
-    if(req != nullptr)
+    if(requested)
     {
-        // this updates priority of a tile in the loading queue if it is already present
-        req->setPriority(std::max(req->getPriority(), priority));
-
         return nullptr;
     }
 
-    req = new TileRequest();
+    auto req = new TileRequest();
 
     req->setResource(resource);
     req->setId(tile_id);
@@ -117,6 +128,14 @@ TileCacheSlot* TileProvider::getTile(pre::AtlasFile* resource, id_type tile_id,
     return nullptr;
 }
 
+void TileProvider::abortTile(pre::AtlasFile* resource, id_type tile_id)
+{
+    std::lock_guard<std::mutex> lock(_cacheLock);
+
+    // the lookup and the abort happen under the lock of the request map, so a loader can not erase the request in between
+    _requestsMap.processRequest(resource, tile_id, [this](TileRequest* req) { return _loader.abort(req); });
+}
+
 void TileProvider::stop() { _loader.stop(); }
 
 void TileProvider::print()
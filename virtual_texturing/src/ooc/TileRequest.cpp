@@ -15,6 +15,7 @@ TileRequest::TileRequest() : Observable()
 {
     _resource = nullptr;
     _aborted = false;
+    _queuePosition = NOT_QUEUED;
 }
 
 void TileRequest::setResource(pre::AtlasFile* resource) { _resource = resource; }
@@ -32,5 +33,7 @@ void TileRequest::abort() { _aborted = true; }
 bool TileRequest::isAborted() { return _aborted; }
 void TileRequest::setPriority(priority_type priority) { _priority = priority; }
 priority_type TileRequest::getPriority() { return _priority; }
+void TileRequest::setQueuePosition(size_t position) { _queuePosition = position; }
+size_t TileRequest::getQueuePosition() { return _queuePosition; }
 } // namespace ooc
 } // namespace vt
\ No newline at end of file
@@ -55,6 +55,39 @@ bool TileRequestMap::insertRequest(TileRequest* req)
     return false;
 }
 
+bool TileRequestMap::processRequest(pre::AtlasFile* resource, uint64_t id, const std::function<bool(TileRequest*)>& action)
+{
+    bool empty;
+
+    {
+        std::lock_guard<std::mutex> lock(_mapLock);
+
+        auto iter = _map.find(std::make_pair(resource, id));
+
+        if(iter == _map.end())
+        {
+            return false;
+        }
+
+        if(!action(iter->second))
+        {
+            return true;
+        }
+
+        delete iter->second;
+        _map.erase(iter);
+
+        empty = _map.empty();
+    }
+
+    if(empty)
+    {
+        _allRequestsProcessed.notify_all();
+    }
+
+    return true;
+}
+
 void TileRequestMap::inform(event_type event, Observable* observable)
 {
     bool empty;
@@ -8,6 +8,16 @@
 #include <lamure/vt/pre/AtlasFile.h>
 #include <lamure/vt/pre/OffsetIndex.h>
 
+#include <algorithm>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
 namespace vt
 {
 namespace pre
@@ -146,10 +156,35 @@ AtlasFile::AtlasFile(const char* fileName)
     _cielabIndex = new CielabIndex(_totalTileCount);
     _file.seekg(_cielabIndexOffset);
     _cielabIndex->readFromFile(_file);
+
+#ifdef _WIN32
+    _handle = CreateFileA(fileName, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+
+    if(_handle == INVALID_HANDLE_VALUE)
+    {
+        throw std::runtime_error("Could not open Atlas-File.");
+    }
+#else
+    _fd = open(fileName, O_RDONLY);
+
+    if(_fd < 0)
+    {
+        throw std::runtime_error("Could not open Atlas-File.");
+    }
+
+#ifdef POSIX_FADV_RANDOM
+    posix_fadvise(_fd, 0, 0, POSIX_FADV_RANDOM);
+#endif
+#endif
 }
 
 AtlasFile::~AtlasFile()
 {
+#ifdef _WIN32
+    CloseHandle(_handle);
+#else
+    close(_fd);
+#endif
     _file.close();
     delete _offsetIndex;
     delete _cielabIndex;
@@ -220,8 +255,49 @@ bool AtlasFile::getTile(uint64_t id, uint8_t* out)
         return false;
     }
 
-    _file.seekg(_payloadOffset + offset);
-    _file.read((char*)out, _tileByteSize);
+    if(!_readAt(_payloadOffset + offset, out, _tileByteSize))
+    {
+        std::memset((char*)out, 0x00, _tileByteSize);
+
+        return false;
+    }
+
+    return true;
+}
+
+bool AtlasFile::_readAt(uint64_t offset, uint8_t* out, uint64_t byteSize)
+{
+    while(byteSize > 0)
+    {
+#ifdef _WIN32
+        OVERLAPPED overlapped = {};
+        overlapped.Offset = (DWORD)(offset & 0xFFFFFFFF);
+        overlapped.OffsetHigh = (DWORD)(offset >> 32);
+
+        DWORD chunkSize = (DWORD)(std::min<uint64_t>)(byteSize, 1u << 30);
+        DWORD bytesRead = 0;
+
+        if(!ReadFile(_handle, out, chunkSize, &bytesRead, &overlapped) || bytesRead == 0)
+        {
+            return false;
+        }
+#else
+        ssize_t bytesRead = pread(_fd, out, (size_t)byteSize, (off_t)offset);
+
+        if(bytesRead < 0 && errno == EINTR)
+        {
+            continue;
+        }
+
+        if(bytesRead <= 0)
+        {
+            return false;
+        }
+#endif
+        out += bytesRead;
+        offset += bytesRead;
+        byteSize -= bytesRead;
+    }
 
     return true;
 }
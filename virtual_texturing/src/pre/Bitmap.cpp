@@ -7,6 +7,21 @@
 
 #include <lamure/vt/pre/Bitmap.h>
 #include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define LAMURE_VT_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(__SSSE3__) || defined(__AVX2__)
+#define LAMURE_VT_SSSE3
+#include <tmmintrin.h>
+#endif
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
 
 namespace vt
 {
@@ -40,6 +55,374 @@ inline double cielabNormaliseRGB(double rgb)
     return rgb * 100;
 }
 
+// Row kernels for the conversions between R8, RGB8 and RGBA8, specialised per pair of formats and chosen once per
+// rect. They compute the same values as _copyPixel and _deflatePixels. Conversions from or to LAB go through the
+// per pixel functions.
+namespace
+{
+typedef void (*CopyRowKernel)(const uint8_t* src, uint8_t* dest, size_t count);
+typedef void (*DeflateRowKernel)(const uint8_t* src0, const uint8_t* src1, uint8_t* dest, size_t destCount);
+
+constexpr size_t formatSize(Bitmap::PIXEL_FORMAT format) { return format == Bitmap::PIXEL_FORMAT::R8 ? 1 : (format == Bitmap::PIXEL_FORMAT::RGB8 ? 3 : 4); }
+
+inline bool isByteFormat(Bitmap::PIXEL_FORMAT format)
+{
+    return format == Bitmap::PIXEL_FORMAT::R8 || format == Bitmap::PIXEL_FORMAT::RGB8 || format == Bitmap::PIXEL_FORMAT::RGBA8;
+}
+
+template <Bitmap::PIXEL_FORMAT srcFormat, Bitmap::PIXEL_FORMAT destFormat>
+void copyRow(const uint8_t* src, uint8_t* dest, size_t count)
+{
+    constexpr size_t srcSize = formatSize(srcFormat);
+    constexpr size_t destSize = formatSize(destFormat);
+
+    if(srcFormat == destFormat)
+    {
+        std::memcpy(dest, src, count * srcSize);
+        return;
+    }
+
+    for(size_t i = 0; i < count; ++i, src += srcSize, dest += destSize)
+    {
+        if(srcFormat == Bitmap::PIXEL_FORMAT::R8)
+        {
+            dest[0] = src[0];
+
+            if(destSize > 1)
+            {
+                dest[1] = src[0];
+                dest[2] = src[0];
+            }
+        }
+        else if(destFormat == Bitmap::PIXEL_FORMAT::R8)
+        {
+            dest[0] = (uint8_t)(((uint16_t)src[0] + src[1] + src[2]) / 3);
+        }
+        else
+        {
+            dest[0] = src[0];
+            dest[1] = src[1];
+            dest[2] = src[2];
+        }
+
+        if(destSize == 4)
+        {
+            dest[3] = srcSize == 4 ? src[3] : 0xff;
+        }
+    }
+}
+
+template <Bitmap::PIXEL_FORMAT srcFormat, Bitmap::PIXEL_FORMAT destFormat>
+void deflateRowScalar(const uint8_t* src0, const uint8_t* src1, uint8_t* dest, size_t destCount)
+{
+    constexpr size_t srcSize = formatSize(srcFormat);
+    constexpr size_t destSize = formatSize(destFormat);
+
+    for(size_t i = 0; i < destCount; ++i, src0 += 2 * srcSize, src1 += 2 * srcSize, dest += destSize)
+    {
+        const uint8_t* px0 = src0;
+        const uint8_t* px1 = src0 + srcSize;
+        const uint8_t* px2 = src1;
+        const uint8_t* px3 = src1 + srcSize;
+
+        if(srcFormat == Bitmap::PIXEL_FORMAT::R8)
+        {
+            uint8_t avrg = (uint8_t)(((uint16_t)px0[0] + px1[0] + px2[0] + px3[0]) >> 2);
+
+            dest[0] = avrg;
+
+            if(destSize > 1)
+            {
+                dest[1] = avrg;
+                dest[2] = avrg;
+            }
+        }
+        else if(destFormat == Bitmap::PIXEL_FORMAT::R8)
+        {
+            dest[0] = (uint8_t)(((uint32_t)px0[0] + px0[1] + px0[2] + px1[0] + px1[1] + px1[2] + px2[0] + px2[1] + px2[2] + px3[0] + px3[1] + px3[2]) / 12);
+        }
+        else
+        {
+            dest[0] = (uint8_t)(((uint16_t)px0[0] + px1[0] + px2[0] + px3[0]) >> 2);
+            dest[1] = (uint8_t)(((uint16_t)px0[1] + px1[1] + px2[1] + px3[1]) >> 2);
+            dest[2] = (uint8_t)(((uint16_t)px0[2] + px1[2] + px2[2] + px3[2]) >> 2);
+        }
+
+        if(destSize == 4)
+        {
+            dest[3] = srcSize == 4 ? (uint8_t)(((uint16_t)px0[3] + px1[3] + px2[3] + px3[3]) >> 2) : 0xff;
+        }
+    }
+}
+
+template <Bitmap::PIXEL_FORMAT srcFormat, Bitmap::PIXEL_FORMAT destFormat>
+void deflateRow(const uint8_t* src0, const uint8_t* src1, uint8_t* dest, size_t destCount)
+{
+    deflateRowScalar<srcFormat, destFormat>(src0, src1, dest, destCount);
+}
+
+#if defined(LAMURE_VT_SSE2)
+// sums of the two rows in 16 bit lanes
+inline void sumRows(const uint8_t* src0, const uint8_t* src1, __m128i& lo, __m128i& hi)
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i a = _mm_loadu_si128((const __m128i*)src0);
+    __m128i b = _mm_loadu_si128((const __m128i*)src1);
+
+    lo = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+    hi = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+}
+
+// sums of neighbouring 4 channel pixels, 2 pixels in each of lo and hi
+inline __m128i sumPixelPairs(__m128i lo, __m128i hi) { return _mm_add_epi16(_mm_unpacklo_epi64(lo, hi), _mm_unpackhi_epi64(lo, hi)); }
+
+template <>
+void deflateRow<Bitmap::PIXEL_FORMAT::R8, Bitmap::PIXEL_FORMAT::R8>(const uint8_t* src0, const uint8_t* src1, uint8_t* dest, size_t destCount)
+{
+    size_t i = 0;
+
+#if defined(__AVX2__)
+    const __m256i ones256 = _mm256_set1_epi16(1);
+
+    for(; i + 16 <= destCount; i += 16)
+    {
+        __m256i a = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)&src0[2 * i]));
+        __m256i b = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)&src0[2 * i + 16]));
+        __m256i c = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)&src1[2 * i]));
+        __m256i d = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)&src1[2 * i + 16]));
+
+        __m256i sum0 = _mm256_srli_epi32(_mm256_madd_epi16(_mm256_add_epi16(a, c), ones256), 2);
+        __m256i sum1 = _mm256_srli_epi32(_mm256_madd_epi16(_mm256_add_epi16(b, d), ones256), 2);
+
+        // packs work per 128 bit lane, restore the order of the 16 results
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi32(sum0, sum1), 0xd8);
+        __m128i result = _mm_packus_epi16(_mm256_castsi256_si128(packed), _mm256_extracti128_si256(packed, 1));
+
+        _mm_storeu_si128((__m128i*)&dest[i], result);
+    }
+#endif
+
+    const __m128i ones = _mm_set1_epi16(1);
+
+    for(; i + 8 <= destCount; i += 8)
+    {
+        __m128i lo;
+        __m128i hi;
+
+        sumRows(&src0[2 * i], &src1[2 * i], lo, hi);
+
+        __m128i sum = _mm_packs_epi32(_mm_srli_epi32(_mm_madd_epi16(lo, ones), 2), _mm_srli_epi32(_mm_madd_epi16(hi, ones), 2));
+
+        _mm_storel_epi64((__m128i*)&dest[i], _mm_packus_epi16(sum, sum));
+    }
+
+    deflateRowScalar<Bitmap::PIXEL_FORMAT::R8, Bitmap::PIXEL_FORMAT::R8>(&src0[2 * i], &src1[2 * i], &dest[i], destCount - i);
+}
+
+template <>
+void deflateRow<Bitmap::PIXEL_FORMAT::RGBA8, Bitmap::PIXEL_FORMAT::RGBA8>(const uint8_t* src0, const uint8_t* src1, uint8_t* dest, size_t destCount)
+{
+    size_t i = 0;
+
+#if defined(__AVX2__)
+    for(; i + 8 <= destCount; i += 8)
+    {
+        __m256i a = _mm256_loadu_si256((const __m256i*)&src0[8 * i]);
+        __m256i b = _mm256_loadu_si256((const __m256i*)&src0[8 * i + 32]);
+        __m256i c = _mm256_loadu_si256((const __m256i*)&src1[8 * i]);
+        __m256i d = _mm256_loadu_si256((const __m256i*)&src1[8 * i + 32]);
+
+        const __m256i zero = _mm256_setzero_si256();
+
+        // per 128 bit lane: pixels 0, 1 in lo, pixels 2, 3 in hi
+        __m256i lo0 = _mm256_add_epi16(_mm256_unpacklo_epi8(a, zero), _mm256_unpacklo_epi8(c, zero));
+        __m256i hi0 = _mm256_add_epi16(_mm256_unpackhi_epi8(a, zero), _mm256_unpackhi_epi8(c, zero));
+        __m256i lo1 = _mm256_add_epi16(_mm256_unpacklo_epi8(b, zero), _mm256_unpacklo_epi8(d, zero));
+        __m256i hi1 = _mm256_add_epi16(_mm256_unpackhi_epi8(b, zero), _mm256_unpackhi_epi8(d, zero));
+
+        __m256i sum0 = _mm256_srli_epi16(_mm256_add_epi16(_mm256_unpacklo_epi64(lo0, hi0), _mm256_unpackhi_epi64(lo0, hi0)), 2);
+        __m256i sum1 = _mm256_srli_epi16(_mm256_add_epi16(_mm256_unpacklo_epi64(lo1, hi1), _mm256_unpackhi_epi64(lo1, hi1)), 2);
+
+        // packs work per 128 bit lane, restore the order of the 8 pixels
+        _mm256_storeu_si256((__m256i*)&dest[4 * i], _mm256_permute4x64_epi64(_mm256_packus_epi16(sum0, sum1), 0xd8));
+    }
+#endif
+
+    for(; i + 4 <= destCount; i += 4)
+    {
+        __m128i lo0;
+        __m128i hi0;
+        __m128i lo1;
+        __m128i hi1;
+
+        sumRows(&src0[8 * i], &src1[8 * i], lo0, hi0);
+        sumRows(&src0[8 * i + 16], &src1[8 * i + 16], lo1, hi1);
+
+        __m128i sum0 = _mm_srli_epi16(sumPixelPairs(lo0, hi0), 2);
+        __m128i sum1 = _mm_srli_epi16(sumPixelPairs(lo1, hi1), 2);
+
+        _mm_storeu_si128((__m128i*)&dest[4 * i], _mm_packus_epi16(sum0, sum1));
+    }
+
+    deflateRowScalar<Bitmap::PIXEL_FORMAT::RGBA8, Bitmap::PIXEL_FORMAT::RGBA8>(&src0[8 * i], &src1[8 * i], &dest[4 * i], destCount - i);
+}
+#endif
+
+#if defined(LAMURE_VT_SSSE3)
+template <>
+void deflateRow<Bitmap::PIXEL_FORMAT::RGB8, Bitmap::PIXEL_FORMAT::RGB8>(const uint8_t* src0, const uint8_t* src1, uint8_t* dest, size_t destCount)
+{
+    // spread 4 pixels of 3 channels to 4 channels, the 4th channel is 0
+    const __m128i spreadFirst = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    const __m128i spreadSecond = _mm_setr_epi8(4, 5, 6, -1, 7, 8, 9, -1, 10, 11, 12, -1, 13, 14, 15, -1);
+    const __m128i gather = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+    const __m128i zero = _mm_setzero_si128();
+
+    size_t i = 0;
+
+    // 8 source pixels of each row (24 bytes) to 4 pixels
+    for(; i + 4 <= destCount; i += 4)
+    {
+        const uint8_t* row0 = &src0[6 * i];
+        const uint8_t* row1 = &src1[6 * i];
+
+        __m128i a0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)row0), spreadFirst);
+        __m128i a1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)&row0[8]), spreadSecond);
+        __m128i b0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)row1), spreadFirst);
+        __m128i b1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)&row1[8]), spreadSecond);
+
+        __m128i lo0 = _mm_add_epi16(_mm_unpacklo_epi8(a0, zero), _mm_unpacklo_epi8(b0, zero));
+        __m128i hi0 = _mm_add_epi16(_mm_unpackhi_epi8(a0, zero), _mm_unpackhi_epi8(b0, zero));
+        __m128i lo1 = _mm_add_epi16(_mm_unpacklo_epi8(a1, zero), _mm_unpacklo_epi8(b1, zero));
+        __m128i hi1 = _mm_add_epi16(_mm_unpackhi_epi8(a1, zero), _mm_unpackhi_epi8(b1, zero));
+
+        __m128i sum0 = _mm_srli_epi16(sumPixelPairs(lo0, hi0), 2);
+        __m128i sum1 = _mm_srli_epi16(sumPixelPairs(lo1, hi1), 2);
+
+        __m128i result = _mm_shuffle_epi8(_mm_packus_epi16(sum0, sum1), gather);
+
+        _mm_storel_epi64((__m128i*)&dest[3 * i], result);
+        uint32_t last = (uint32_t)_mm_cvtsi128_si32(_mm_srli_si128(result, 8));
+        std::memcpy(&dest[3 * i + 8], &last, 4);
+    }
+
+    deflateRowScalar<Bitmap::PIXEL_FORMAT::RGB8, Bitmap::PIXEL_FORMAT::RGB8>(&src0[6 * i], &src1[6 * i], &dest[3 * i], destCount - i);
+}
+
+template <>
+void copyRow<Bitmap::PIXEL_FORMAT::RGB8, Bitmap::PIXEL_FORMAT::RGBA8>(const uint8_t* src, uint8_t* dest, size_t count)
+{
+    const __m128i spread = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    const __m128i alpha = _mm_set1_epi32((int)0xff000000);
+
+    size_t i = 0;
+
+    // the load reads 16 of the 18 bytes of 6 pixels
+    for(; i + 6 <= count; i += 4)
+    {
+        __m128i px = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)&src[3 * i]), spread);
+        _mm_storeu_si128((__m128i*)&dest[4 * i], _mm_or_si128(px, alpha));
+    }
+
+    for(; i < count; ++i)
+    {
+        dest[4 * i] = src[3 * i];
+        dest[4 * i + 1] = src[3 * i + 1];
+        dest[4 * i + 2] = src[3 * i + 2];
+        dest[4 * i + 3] = 0xff;
+    }
+}
+
+template <>
+void copyRow<Bitmap::PIXEL_FORMAT::RGBA8, Bitmap::PIXEL_FORMAT::RGB8>(const uint8_t* src, uint8_t* dest, size_t count)
+{
+    const __m128i gather = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+
+    size_t i = 0;
+
+    for(; i + 4 <= count; i += 4)
+    {
+        __m128i px = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)&src[4 * i]), gather);
+
+        _mm_storel_epi64((__m128i*)&dest[3 * i], px);
+        uint32_t last = (uint32_t)_mm_cvtsi128_si32(_mm_srli_si128(px, 8));
+        std::memcpy(&dest[3 * i + 8], &last, 4);
+    }
+
+    for(; i < count; ++i)
+    {
+        dest[3 * i] = src[4 * i];
+        dest[3 * i + 1] = src[4 * i + 1];
+        dest[3 * i + 2] = src[4 * i + 2];
+    }
+}
+#endif
+
+template <Bitmap::PIXEL_FORMAT srcFormat>
+CopyRowKernel copyRowKernel(Bitmap::PIXEL_FORMAT destFormat)
+{
+    switch(destFormat)
+    {
+    case Bitmap::PIXEL_FORMAT::R8:
+        return &copyRow<srcFormat, Bitmap::PIXEL_FORMAT::R8>;
+    case Bitmap::PIXEL_FORMAT::RGB8:
+        return &copyRow<srcFormat, Bitmap::PIXEL_FORMAT::RGB8>;
+    case Bitmap::PIXEL_FORMAT::RGBA8:
+        return &copyRow<srcFormat, Bitmap::PIXEL_FORMAT::RGBA8>;
+    default:
+        return nullptr;
+    }
+}
+
+// nullptr if there is no row kernel for the formats
+CopyRowKernel copyRowKernel(Bitmap::PIXEL_FORMAT srcFormat, Bitmap::PIXEL_FORMAT destFormat)
+{
+    switch(srcFormat)
+    {
+    case Bitmap::PIXEL_FORMAT::R8:
+        return copyRowKernel<Bitmap::PIXEL_FORMAT::R8>(destFormat);
+    case Bitmap::PIXEL_FORMAT::RGB8:
+        return copyRowKernel<Bitmap::PIXEL_FORMAT::RGB8>(destFormat);
+    case Bitmap::PIXEL_FORMAT::RGBA8:
+        return copyRowKernel<Bitmap::PIXEL_FORMAT::RGBA8>(destFormat);
+    default:
+        return nullptr;
+    }
+}
+
+template <Bitmap::PIXEL_FORMAT srcFormat>
+DeflateRowKernel deflateRowKernel(Bitmap::PIXEL_FORMAT destFormat)
+{
+    switch(destFormat)
+    {
+    case Bitmap::PIXEL_FORMAT::R8:
+        return &deflateRow<srcFormat, Bitmap::PIXEL_FORMAT::R8>;
+    case Bitmap::PIXEL_FORMAT::RGB8:
+        return &deflateRow<srcFormat, Bitmap::PIXEL_FORMAT::RGB8>;
+    case Bitmap::PIXEL_FORMAT::RGBA8:
+        return &deflateRow<srcFormat, Bitmap::PIXEL_FORMAT::RGBA8>;
+    default:
+        return nullptr;
+    }
+}
+
+// nullptr if there is no row kernel for the formats
+DeflateRowKernel deflateRowKernel(Bitmap::PIXEL_FORMAT srcFormat, Bitmap::PIXEL_FORMAT destFormat)
+{
+    switch(srcFormat)
+    {
+    case Bitmap::PIXEL_FORMAT::R8:
+        return deflateRowKernel<Bitmap::PIXEL_FORMAT::R8>(destFormat);
+    case Bitmap::PIXEL_FORMAT::RGB8:
+        return deflateRowKernel<Bitmap::PIXEL_FORMAT::RGB8>(destFormat);
+    case Bitmap::PIXEL_FORMAT::RGBA8:
+        return deflateRowKernel<Bitmap::PIXEL_FORMAT::RGBA8>(destFormat);
+    default:
+        return nullptr;
+    }
+}
+} // namespace
+
 void Bitmap::_copyPixel(const uint8_t* const srcPx, PIXEL_FORMAT srcFormat, uint8_t* const destPx, PIXEL_FORMAT destFormat)
 {
     switch(srcFormat)
@@ -519,6 +902,18 @@ void Bitmap::copyRectFrom(const Bitmap& src, size_t srcX, size_t srcY, size_t de
     size_t srcPixelSize = pixelSize(src._format);
     size_t destPixelSize = pixelSize(_format);
 
+    CopyRowKernel copyRow = copyRowKernel(src._format, _format);
+
+    if(copyRow != nullptr)
+    {
+        for(size_t y = 0; y < cpyHeight; ++y)
+        {
+            copyRow(&src._data[((srcY + y) * src._width + srcX) * srcPixelSize], &_data[((destY + y) * _width + destX) * destPixelSize], cpyWidth);
+        }
+
+        return;
+    }
+
     for(size_t y = 0; y < cpyHeight; ++y)
     {
         for(size_t x = 0; x < cpyWidth; ++x)
@@ -545,6 +940,22 @@ void Bitmap::deflateRectFrom(const Bitmap& src, size_t srcX, size_t srcY, size_t
     size_t srcPixelSize = pixelSize(src._format);
     size_t destPixelSize = pixelSize(_format);
 
+    DeflateRowKernel deflateRow = deflateRowKernel(src._format, _format);
+
+    if(deflateRow != nullptr)
+    {
+        // like the pixel loop below, an odd width or height reads one pixel or row past the rect
+        for(size_t y = 0; y < cpyHeight; y += 2)
+        {
+            deflateRow(&src._data[((srcY + y) * src._width + srcX) * srcPixelSize],
+                       &src._data[((srcY + y + 1) * src._width + srcX) * srcPixelSize],
+                       &_data[((destY + (y >> 1)) * _width + destX) * destPixelSize],
+                       (cpyWidth + 1) >> 1);
+        }
+
+        return;
+    }
+
     for(size_t y = 0; y < cpyHeight; y += 2)
     {
         for(size_t x = 0; x < cpyWidth; x += 2)
@@ -603,13 +1014,39 @@ void Bitmap::smearHorizontal(size_t srcX, size_t srcY, size_t destX, size_t dest
 
     size_t pxSize = pixelSize(_format);
 
+    if(!isByteFormat(_format))
+    {
+        for(size_t y = 0; y < height; ++y)
+        {
+            uint8_t* srcPx = &_data[((srcY + y) * _width + srcX) * pxSize];
+
+            for(size_t x = 0; x < width; ++x)
+            {
+                _copyPixel(srcPx, _format, &_data[((destY + y) * _width + destX + x) * pxSize], _format);
+            }
+        }
+
+        return;
+    }
+
     for(size_t y = 0; y < height; ++y)
     {
-        uint8_t* srcPx = &_data[((srcY + y) * _width + srcX) * pxSize];
+        // the source pixel may lie inside the destination rect
+        uint8_t px[4];
+        std::memcpy(px, &_data[((srcY + y) * _width + srcX) * pxSize], pxSize);
+
+        uint8_t* destPx = &_data[((destY + y) * _width + destX) * pxSize];
 
-        for(size_t x = 0; x < width; ++x)
+        if(pxSize == 1)
         {
-            _copyPixel(srcPx, _format, &_data[((destY + y) * _width + destX + x) * pxSize], _format);
+            std::memset(destPx, px[0], width);
+
+            continue;
+        }
+
+        for(size_t x = 0; x < width; ++x, destPx += pxSize)
+        {
+            std::memcpy(destPx, px, pxSize);
         }
     }
 }
@@ -625,6 +1062,24 @@ void Bitmap::smearVertical(size_t srcX, size_t srcY, size_t destX, size_t destY,
 
     size_t pxSize = pixelSize(_format);
 
+    if(isByteFormat(_format) && srcX == destX)
+    {
+        // the source row is contiguous, copy it into every destination row
+        const uint8_t* srcRow = &_data[(srcY * _width + srcX) * pxSize];
+
+        for(size_t y = 0; y < height; ++y)
+        {
+            uint8_t* destRow = &_data[((destY + y) * _width + destX) * pxSize];
+
+            if(destRow != srcRow)
+            {
+                std::memcpy(destRow, srcRow, width * pxSize);
+            }
+        }
+
+        return;
+    }
+
     for(size_t x = 0; x < width; ++x)
     {
         uint8_t* srcPx = &_data[(srcY * _width + srcX + x) * pxSize];
@@ -647,11 +1102,42 @@ void Bitmap::fillRect(const uint8_t* const px, PIXEL_FORMAT format, size_t x, si
 
     size_t pxSize = pixelSize(_format);
 
+    if(width == 0 || height == 0)
+    {
+        return;
+    }
+
+    if(!isByteFormat(_format))
+    {
+        for(size_t yPos = 0; yPos < height; ++yPos)
+        {
+            for(size_t xPos = 0; xPos < width; ++xPos)
+            {
+                _copyPixel(px, format, &_data[((y + yPos) * _width + x + xPos) * pxSize], _format);
+            }
+        }
+
+        return;
+    }
+
+    // convert the fill pixel once, then replicate it
+    uint8_t destPx[4];
+    _copyPixel(px, format, destPx, _format);
+
     for(size_t yPos = 0; yPos < height; ++yPos)
     {
-        for(size_t xPos = 0; xPos < width; ++xPos)
+        uint8_t* row = &_data[((y + yPos) * _width + x) * pxSize];
+
+        if(pxSize == 1)
+        {
+            std::memset(row, destPx[0], width);
+
+            continue;
+        }
+
+        for(size_t xPos = 0; xPos < width; ++xPos, row += pxSize)
         {
-            _copyPixel(px, format, &_data[((y + yPos) * _width + x + xPos) * pxSize], _format);
+            std::memcpy(row, destPx, pxSize);
         }
     }
 }
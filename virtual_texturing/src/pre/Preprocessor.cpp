@@ -21,8 +21,127 @@ void memset_volatile(volatile uint8_t* s, uint8_t val, size_t n)
     }
 }
 
+Preprocessor::WorkerPool::WorkerPool(size_t threadCount) : _job(nullptr), _count(0), _next(0), _batch(0), _busyThreads(0), _running(true), _error(nullptr)
+{
+    for(size_t i = 1; i < threadCount; ++i)
+    {
+        _threads.emplace_back(&WorkerPool::_work, this);
+    }
+}
+
+Preprocessor::WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        _running = false;
+    }
+
+    _batchStarted.notify_all();
+
+    for(auto& thread : _threads)
+    {
+        thread.join();
+    }
+}
+
+void Preprocessor::WorkerPool::_work()
+{
+    uint64_t batch = 0;
+
+    while(true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(_lock);
+            _batchStarted.wait(lock, [&] { return !_running || _batch != batch; });
+
+            if(!_running)
+            {
+                return;
+            }
+
+            batch = _batch;
+        }
+
+        _runJobs();
+
+        std::lock_guard<std::mutex> lock(_lock);
+
+        if(--_busyThreads == 0)
+        {
+            _batchDone.notify_one();
+        }
+    }
+}
+
+void Preprocessor::WorkerPool::_runJobs()
+{
+    try
+    {
+        for(size_t i = _next++; i < _count; i = _next++)
+        {
+            (*_job)(i);
+        }
+    }
+    catch(...)
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+
+        if(_error == nullptr)
+        {
+            _error = std::current_exception();
+        }
+    }
+}
+
+void Preprocessor::WorkerPool::parallelFor(size_t count, const std::function<void(size_t)>& job)
+{
+    if(_threads.empty() || count <= 1)
+    {
+        for(size_t i = 0; i < count; ++i)
+        {
+            job(i);
+        }
+
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        _job = &job;
+        _count = count;
+        _next = 0;
+        _error = nullptr;
+        _busyThreads = _threads.size();
+        ++_batch;
+    }
+
+    _batchStarted.notify_all();
+
+    _runJobs();
+
+    // the batch ends when every worker has seen it, so no worker can miss or repeat a batch
+    std::unique_lock<std::mutex> lock(_lock);
+    _batchDone.wait(lock, [&] { return _busyThreads == 0; });
+
+    _job = nullptr;
+
+    if(_error != nullptr)
+    {
+        std::rethrow_exception(_error);
+    }
+}
+
 void Preprocessor::_deflate(size_t writeBufferSize)
 {
+    // Tiles of a level are deflated in batches. The tiles of the finer level a batch needs are gathered in order, the
+    // batch is deflated in parallel and then completed in order, because the right and bottom padding is copied from
+    // the neighbours of the same level, which are completed before (descending ids).
+    size_t batchSize = _threadCount * 4;
+    WorkerPool workers(_threadCount);
+    size_t jobByteSize = _destTileByteSize * 12;
+
+    writeBufferSize -= std::min(writeBufferSize / 2, (batchSize - 1) * jobByteSize);
+
     size_t writeBufferTileSize = writeBufferSize / _destTileByteSize;
     writeBufferSize = writeBufferTileSize * _destTileByteSize;
 
@@ -51,23 +170,10 @@ void Preprocessor::_deflate(size_t writeBufferSize)
         }
     }
 
-    size_t bufferSize = _destTileByteSize * 12;
-    auto buffer = new uint8_t[bufferSize];
+    // 11 source tiles and the deflated tile per job
+    auto buffer = new uint8_t[batchSize * jobByteSize];
     auto writeBuffer = new uint8_t[writeBufferSize];
 
-    Bitmap bufferBitmap0(_tileWidth, _tileHeight, _destPxFormat, buffer);
-    Bitmap bufferBitmap1(_tileWidth, _tileHeight, _destPxFormat, &buffer[_destTileByteSize]);
-    Bitmap bufferBitmap2(_tileWidth, _tileHeight, _destPxFormat, &buffer[_destTileByteSize * 2]);
-    Bitmap bufferBitmap3(_tileWidth, _tileHeight, _destPxFormat, &buffer[_destTileByteSize * 3]);
-    Bitmap bufferBitmap4(_tileWidth, _tileHeight, _destPxFormat, &buffer[_destTileByteSize * 4]);
-    Bitmap bufferBitmap5(_tileWidth, _tileHeight, _destPxFormat, &buffer[_destTileByteSize * 5]);
-    Bitmap bufferBitmap6(_tileWidth, _tileHeight, _destPxFormat, &buffer[_destTileByteSize * 6]);
-    Bitmap bufferBitmap7(_tileWidth, _tileHeight, _destPxFormat, &buffer[_destTileByteSize * 7]);
-    Bitmap bufferBitmap8(_tileWidth, _tileHeight, _destPxFormat, &buffer[_destTileByteSize * 8]);
-    Bitmap bufferBitmap9(_tileWidth, _tileHeight, _destPxFormat, &buffer[_destTileByteSize * 9]);
-    Bitmap bufferBitmap10(_tileWidth, _tileHeight, _destPxFormat, &buffer[_destTileByteSize * 10]);
-    Bitmap writeBitmap(_tileWidth, _tileHeight, _destPxFormat, &buffer[_destTileByteSize * 11]);
-
     auto levelTileWidth = _imageTileWidth;
     auto levelTileHeight = _imageTileHeight;
     auto levelPixelWidth = _imageWidth;
@@ -105,19 +211,8 @@ void Preprocessor::_deflate(size_t writeBufferSize)
             std::cout.flush();
 #endif
 
-            for(uint64_t relIterationId = tilesInIterationLevel - 1; /* relIterationId > 0 */; --relIterationId)
-            {
-                uint64_t x;
-                uint64_t y;
-
-                QuadTree::getCoordinatesInLevel(relIterationId, iterationLevel, x, y);
-
-                if(x >= iterationLevelTileWidth || y >= iterationLevelTileHeight)
-                {
-                    continue;
-                }
-
-                uint64_t absIterationId = firstIdOfIterationLevel + relIterationId;
+            // loads the tiles of the finer level into the first 9 tiles of the job buffer
+            auto gather = [&](uint64_t relIterationId, uint8_t* buffer) {
                 size_t bufferOffset = 0;
 
                 for(uint8_t relQuadId = 3;; --relQuadId)
@@ -183,8 +278,6 @@ void Preprocessor::_deflate(size_t writeBufferSize)
 
                 len = 0;
 
-                QuadTree::getCoordinatesInLevel(relId2, iterationLevel + 1, x, y);
-
                 bufferOffset += _destTileByteSize;
                 if(relId0 != relId)
                     len = _getTileById(firstIdOfCurrentLevel + relId1, writeBuffer, writeBufferFirstId, writeBufferLastId, idLookup, writeBufferTileSize, &buffer[bufferOffset]);
@@ -196,29 +289,30 @@ void Preprocessor::_deflate(size_t writeBufferSize)
                     len = _getTileById(firstIdOfCurrentLevel + relId0, writeBuffer, writeBufferFirstId, writeBufferLastId, idLookup, writeBufferTileSize, &buffer[bufferOffset]);
                 if(len == 0)
                     memset_volatile(&buffer[bufferOffset], 0, _destTileByteSize);
-
-                relId0 = relIterationId;
-                relId1 = QuadTree::getNeighbour(relId0, QuadTree::NEIGHBOUR::RIGHT);
-                relId2 = QuadTree::getNeighbour(relId0, QuadTree::NEIGHBOUR::BOTTOM);
-
-                bufferOffset += _destTileByteSize;
-                len = _getTileById(firstIdOfIterationLevel + relId2, writeBuffer, writeBufferFirstId, writeBufferLastId, idLookup, writeBufferTileSize, &buffer[bufferOffset]);
-                if(len == 0)
-                    memset_volatile(&buffer[bufferOffset], 0, _destTileByteSize);
-
-                bufferOffset += _destTileByteSize;
-                len = _getTileById(firstIdOfIterationLevel + relId1, writeBuffer, writeBufferFirstId, writeBufferLastId, idLookup, writeBufferTileSize, &buffer[bufferOffset]);
-                if(len == 0)
-                    memset_volatile(&buffer[bufferOffset], 0, _destTileByteSize);
-
-                bufferOffset += _destTileByteSize;
+            };
+
+            // deflates the finer tiles into the last tile of the job buffer, only reads shared state
+            auto deflateTile = [&](uint64_t relIterationId, uint8_t* buffer) {
+                Bitmap bufferBitmap0(_tileWidth, _tileHeight, _destPxFormat, buffer);
+                Bitmap bufferBitmap1(_tileWidth, _tileHeight, _destPxFormat, &buffer[_destTileByteSize]);
+                Bitmap bufferBitmap2(_tileWidth, _tileHeight, _destPxFormat, &buffer[_destTileByteSize * 2]);
+                Bitmap bufferBitmap3(_tileWidth, _tileHeight, _destPxFormat, &buffer[_destTileByteSize * 3]);
+                Bitmap bufferBitmap4(_tileWidth, _tileHeight, _destPxFormat, &buffer[_destTileByteSize * 4]);
+                Bitmap bufferBitmap5(_tileWidth, _tileHeight, _destPxFormat, &buffer[_destTileByteSize * 5]);
+                Bitmap bufferBitmap6(_tileWidth, _tileHeight, _destPxFormat, &buffer[_destTileByteSize * 6]);
+                Bitmap bufferBitmap7(_tileWidth, _tileHeight, _destPxFormat, &buffer[_destTileByteSize * 7]);
+                Bitmap bufferBitmap8(_tileWidth, _tileHeight, _destPxFormat, &buffer[_destTileByteSize * 8]);
+                Bitmap writeBitmap(_tileWidth, _tileHeight, _destPxFormat, &buffer[_destTileByteSize * 11]);
 
                 size_t halfTileWidthInner = _innerTileWidth >> 1;
                 size_t halfTileHeightInner = _innerTileHeight >> 1;
 
+                uint64_t x;
+                uint64_t y;
+
                 QuadTree::getCoordinatesInLevel(relIterationId, iterationLevel, x, y);
 
-                std::memset((void*)&buffer[bufferOffset], 0, _destTileByteSize);
+                std::memset((void*)&buffer[_destTileByteSize * 11], 0, _destTileByteSize);
 
                 writeBitmap.deflateRectFrom(bufferBitmap0, _padding, _padding, _padding + halfTileWidthInner, _padding + (_innerTileHeight >> 1), _innerTileWidth, _innerTileHeight);
 
@@ -266,6 +360,36 @@ void Preprocessor::_deflate(size_t writeBufferSize)
                         writeBitmap.smearHorizontal(_padding, 0, 0, 0, _padding, _padding);
                     }
                 }
+            };
+
+            // pads the deflated tile towards its completed right and bottom neighbours and writes it
+            auto complete = [&](uint64_t relIterationId, uint8_t* buffer) {
+                Bitmap bufferBitmap9(_tileWidth, _tileHeight, _destPxFormat, &buffer[_destTileByteSize * 9]);
+                Bitmap bufferBitmap10(_tileWidth, _tileHeight, _destPxFormat, &buffer[_destTileByteSize * 10]);
+                Bitmap writeBitmap(_tileWidth, _tileHeight, _destPxFormat, &buffer[_destTileByteSize * 11]);
+
+                uint64_t absIterationId = firstIdOfIterationLevel + relIterationId;
+                size_t bufferOffset = _destTileByteSize * 9;
+
+                uint64_t relId0 = relIterationId;
+                uint64_t relId1 = QuadTree::getNeighbour(relId0, QuadTree::NEIGHBOUR::RIGHT);
+                uint64_t relId2 = QuadTree::getNeighbour(relId0, QuadTree::NEIGHBOUR::BOTTOM);
+
+                uint64_t len = _getTileById(firstIdOfIterationLevel + relId2, writeBuffer, writeBufferFirstId, writeBufferLastId, idLookup, writeBufferTileSize, &buffer[bufferOffset]);
+                if(len == 0)
+                    memset_volatile(&buffer[bufferOffset], 0, _destTileByteSize);
+
+                bufferOffset += _destTileByteSize;
+                len = _getTileById(firstIdOfIterationLevel + relId1, writeBuffer, writeBufferFirstId, writeBufferLastId, idLookup, writeBufferTileSize, &buffer[bufferOffset]);
+                if(len == 0)
+                    memset_volatile(&buffer[bufferOffset], 0, _destTileByteSize);
+
+                bufferOffset += _destTileByteSize;
+
+                uint64_t x;
+                uint64_t y;
+
+                QuadTree::getCoordinatesInLevel(relIterationId, iterationLevel, x, y);
 
                 bool xIsLast = x == (iterationLevelTileWidth - 1);
                 bool yIsLast = y == (iterationLevelTileHeight - 1);
@@ -352,7 +476,6 @@ void Preprocessor::_deflate(size_t writeBufferSize)
                         writeBufferOffset += writeBufferSize;
                     }
 
-                    // std::cout << currentOffset << std::endl;
                     _offsetIndex->set(absIterationId, currentOffset, _destTileByteSize);
 
                     std::memcpy(&writeBuffer[currentOffset - writeBufferOffset], (char*)&buffer[bufferOffset], _destTileByteSize);
@@ -373,6 +496,39 @@ void Preprocessor::_deflate(size_t writeBufferSize)
                     std::cout.flush();
                 }
 #endif
+            };
+
+            std::vector<uint64_t> batch;
+            batch.reserve(batchSize);
+
+            for(uint64_t relIterationId = tilesInIterationLevel - 1; /* relIterationId > 0 */; --relIterationId)
+            {
+                uint64_t x;
+                uint64_t y;
+
+                QuadTree::getCoordinatesInLevel(relIterationId, iterationLevel, x, y);
+
+                if(x < iterationLevelTileWidth && y < iterationLevelTileHeight)
+                {
+                    batch.push_back(relIterationId);
+                }
+
+                if(batch.size() == batchSize || (relIterationId == 0 && !batch.empty()))
+                {
+                    for(size_t i = 0; i < batch.size(); ++i)
+                    {
+                        gather(batch[i], &buffer[i * jobByteSize]);
+                    }
+
+                    workers.parallelFor(batch.size(), [&](size_t i) { deflateTile(batch[i], &buffer[i * jobByteSize]); });
+
+                    for(size_t i = 0; i < batch.size(); ++i)
+                    {
+                        complete(batch[i], &buffer[i * jobByteSize]);
+                    }
+
+                    batch.clear();
+                }
 
                 if(relIterationId == 0)
                 {
@@ -505,6 +661,8 @@ Preprocessor::Preprocessor(const std::string& srcFileName, Bitmap::PIXEL_FORMAT
     _destIndexFile = nullptr;
     _destCombined = DEST_COMBINED::NONE;
 
+    setThreadCount(0);
+
     _srcFileName = srcFileName;
     _srcPxFormat = srcPxFormat;
     _imageWidth = imageWidth;
@@ -621,6 +779,16 @@ void Preprocessor::_writeHeader()
     delete [] data;
 }
 
+void Preprocessor::setThreadCount(size_t threadCount)
+{
+    if(threadCount == 0)
+    {
+        threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    _threadCount = threadCount;
+}
+
 void Preprocessor::setOutput(const std::string& destFileName, Bitmap::PIXEL_FORMAT destPxFormat, AtlasFile::LAYOUT format, size_t tileWidth, size_t tileHeight, size_t padding, bool combine)
 {
     _destFileName = destFileName;
@@ -776,13 +944,18 @@ void Preprocessor::_extract(size_t bufferTileWidth, size_t writeBufferSize)
     auto bufferPxWidth = bufferPxWidthInner + (_padding << 1);
     auto bufferPxHeight = bufferPxHeightInner + (_padding << 1);
 
+    // with more than one thread the next block of the image is read while the tiles of the current one are cut
+    bool readAhead = _threadCount > 1;
+
     auto bufferSize = bufferPxWidth * bufferPxHeight * srcPxSize;
-    auto buffer = new uint8_t[bufferSize];
+    uint8_t* buffers[2] = {new uint8_t[bufferSize], readAhead ? new uint8_t[bufferSize] : nullptr};
 
     size_t writeBufferTileSize = writeBufferSize / _destTileByteSize;
     writeBufferSize = writeBufferTileSize * _destTileByteSize;
 
-    auto outTile = new uint8_t[_destTileByteSize];
+    size_t cutTileCount = _threadCount * 2;
+    WorkerPool workers(_threadCount);
+    auto outTiles = new uint8_t[cutTileCount * _destTileByteSize];
     auto writeBuffer = new uint8_t[writeBufferSize];
     uint64_t writeBufferOffset = 0;
     uint64_t offsetAfterLastTile = QuadTree::firstIdOfLevel(_treeDepth) * _destTileByteSize;
@@ -794,9 +967,6 @@ void Preprocessor::_extract(size_t bufferTileWidth, size_t writeBufferSize)
         writeBufferOffset = offsetAfterLastTile - (tilesInFinestLevel % writeBufferTileSize) * _destTileByteSize;
     }
 
-    Bitmap bufferBitmap(bufferPxWidth, bufferPxHeight, _srcPxFormat, buffer);
-    Bitmap writeBitmap(_tileWidth, _tileHeight, _destPxFormat, outTile);
-
     size_t finestLevel = _treeDepth - 1;
     size_t bufferLevel = QuadTree::getDepth(bufferTileWidth, bufferTileHeight) - 1;
     size_t iterationLevel = finestLevel - bufferLevel;
@@ -813,31 +983,14 @@ void Preprocessor::_extract(size_t bufferTileWidth, size_t writeBufferSize)
 
     auto firstId = QuadTree::firstIdOfLevel(finestLevel);
 
-    for(uint64_t relIterationId = tilesToIterate - 1; /*relIterationId >= 0*/; --relIterationId)
-    {
+    // reads the block of the image and pads it where it touches the image border
+    auto readBlock = [&](uint64_t relIterationId, uint8_t* buffer) {
         uint64_t x;
         uint64_t y;
 
         QuadTree::getCoordinatesInLevel(relIterationId, iterationLevel, x, y);
 
-        if(x >= iterTileWidth || y >= iterTileHeight)
-        {
-            if(_destLayout == AtlasFile::LAYOUT::RAW)
-            {
-                currentOffset = (firstId + relIterationId * tilesInBuffer) * _destTileByteSize;
-                auto dataLen = (uint64_t)bufferTileWidth * bufferTileHeight * _destTileByteSize;
-                auto data = new uint8_t[dataLen];
-
-                std::memset(data, 0x00, dataLen);
-
-                _destPayloadFile.seekp(_destPayloadOffset + currentOffset);
-                _destPayloadFile.write((char*)data, dataLen);
-
-                delete data;
-            }
-
-            continue;
-        }
+        Bitmap bufferBitmap(bufferPxWidth, bufferPxHeight, _srcPxFormat, buffer);
 
         size_t offsetX = (size_t)x * bufferPxWidthInner;
         size_t offsetY = (size_t)y * bufferPxHeightInner;
@@ -909,100 +1062,184 @@ void Preprocessor::_extract(size_t bufferTileWidth, size_t writeBufferSize)
 
         // pad bottom side
         bufferBitmap.smearVertical(0, offsetBufferY + readHeight - 1, 0, offsetBufferY + readHeight, bufferPxWidth, std::min<size_t>(_padding, bufferPxHeight - offsetBufferY - readHeight));
+    };
 
-        for(auto relBufferId = (size_t)(tilesInBuffer - 1); /*relBufferId >= tilesInBuffer*/; --relBufferId)
-        {
-            auto relId = relIterationId * tilesInBuffer + relBufferId;
-            auto absId = firstId + relId;
+    // cuts a tile out of the block, only reads shared state
+    auto cutTile = [&](const Bitmap& bufferBitmap, uint64_t absTileX, uint64_t absTileY, uint64_t bufferTileX, uint64_t bufferTileY, uint8_t* outTile) {
+        Bitmap writeBitmap(_tileWidth, _tileHeight, _destPxFormat, outTile);
 
-            uint64_t bufferTileX;
-            uint64_t bufferTileY;
+        writeBitmap.copyRectFrom(bufferBitmap, (size_t)bufferTileX * _innerTileWidth, (size_t)bufferTileY * _innerTileHeight, 0, 0, _tileWidth, _tileHeight);
 
-            QuadTree::getCoordinatesInLevel(relBufferId, bufferLevel, bufferTileX, bufferTileY);
+        size_t padWidth = _tileWidth;
 
-            auto absTileX = x * bufferTileWidth + bufferTileX;
-            auto absTileY = y * bufferTileHeight + bufferTileY;
+        if(absTileX == (_imageTileWidth - 1))
+        {
+            padWidth = ((_imageWidth - 1) % _innerTileWidth) + 1 + (_padding << 1);
+        }
 
-            if(absTileX >= _imageTileWidth || absTileY >= _imageTileHeight)
-            {
-                continue;
-            }
+        if(absTileY == (_imageTileHeight - 1))
+        {
+            uint8_t transPx[] = {0x00, 0x00, 0x00, 0x00};
+
+            writeBitmap.fillRect(transPx,
+                                 Bitmap::PIXEL_FORMAT::RGBA8,
+                                 0,
+                                 ((_imageHeight - 1) % _innerTileHeight) + 1 + (_padding << 1),
+                                 padWidth,
+                                 _tileHeight - ((_imageHeight - 1) % _innerTileHeight) - 1 - (_padding << 1));
+        }
+
+        if(absTileX == (_imageTileWidth - 1))
+        {
+            uint8_t transPx[] = {0x00, 0x00, 0x00, 0x00};
 
-            writeBitmap.copyRectFrom(bufferBitmap, (size_t)bufferTileX * _innerTileWidth, (size_t)bufferTileY * _innerTileHeight, 0, 0, _tileWidth, _tileHeight);
+            writeBitmap.fillRect(transPx, Bitmap::PIXEL_FORMAT::RGBA8, padWidth, 0, _tileWidth - padWidth, _tileHeight);
+        }
+    };
 
-            size_t padWidth = _tileWidth;
+    // appends the tile to the payload, tiles have to arrive in descending order of ids
+    auto writeTile = [&](uint64_t absId, const uint8_t* outTile) {
+        _offsetIndex->set(absId, currentOffset, _destTileByteSize);
 
-            if(absTileX == (_imageTileWidth - 1))
-            {
-                padWidth = ((_imageWidth - 1) % _innerTileWidth) + 1 + (_padding << 1);
-            }
+        if(_destLayout == AtlasFile::LAYOUT::RAW)
+        {
+            currentOffset = _destTileByteSize * absId;
 
-            if(absTileY == (_imageTileHeight - 1))
+            while(currentOffset < writeBufferOffset)
             {
-                uint8_t transPx[] = {0x00, 0x00, 0x00, 0x00};
-
-                writeBitmap.fillRect(transPx,
-                                     Bitmap::PIXEL_FORMAT::RGBA8,
-                                     0,
-                                     ((_imageHeight - 1) % _innerTileHeight) + 1 + (_padding << 1),
-                                     padWidth,
-                                     _tileHeight - ((_imageHeight - 1) % _innerTileHeight) - 1 - (_padding << 1));
+                std::memset(writeBuffer, 0x00, lastWriteOffset - writeBufferOffset);
+
+                _destPayloadFile.seekp(_destPayloadOffset + writeBufferOffset);
+                _destPayloadFile.write((char*)writeBuffer, std::min(writeBufferSize, offsetAfterLastTile - writeBufferOffset));
+
+                lastWriteOffset = writeBufferOffset;
+                writeBufferOffset -= writeBufferSize;
             }
 
-            if(absTileX == (_imageTileWidth - 1))
+            std::memset(&writeBuffer[currentOffset - writeBufferOffset + _destTileByteSize], 0x00, lastWriteOffset - currentOffset - _destTileByteSize);
+            std::memcpy(&writeBuffer[currentOffset - writeBufferOffset], outTile, _destTileByteSize);
+            lastWriteOffset = currentOffset;
+        }
+        else
+        {
+            if((currentOffset + _destTileByteSize) > (writeBufferOffset + writeBufferSize))
             {
-                uint8_t transPx[] = {0x00, 0x00, 0x00, 0x00};
+                _destPayloadFile.seekp(_destPayloadOffset + writeBufferOffset);
+                _destPayloadFile.write((char*)writeBuffer, (currentOffset - writeBufferOffset));
+                _destPayloadFile.flush();
 
-                writeBitmap.fillRect(transPx, Bitmap::PIXEL_FORMAT::RGBA8, padWidth, 0, _tileWidth - padWidth, _tileHeight);
+                writeBufferOffset = currentOffset;
             }
 
-            _offsetIndex->set(absId, currentOffset, _destTileByteSize);
+            std::memcpy(&writeBuffer[currentOffset - writeBufferOffset], outTile, _destTileByteSize);
+            currentOffset += _destTileByteSize;
+        }
 
-            if(_destLayout == AtlasFile::LAYOUT::RAW)
-            {
-                currentOffset = _destTileByteSize * absId;
+#ifdef PREPROCESSOR_LOG_PROGRESS
+        ++tilesWritten;
+        auto currentProgress = (uint8_t)(tilesWritten * 100 / _imageTileWidth / _imageTileHeight);
 
-                while(currentOffset < writeBufferOffset)
-                {
-                    std::memset(writeBuffer, 0x00, lastWriteOffset - writeBufferOffset);
+        if(currentProgress != progress)
+        {
+            progress = currentProgress;
+            std::cout << '\r' << std::setw(3) << (int)progress << " %";
+            std::cout.flush();
+        }
+#endif
+    };
 
-                    _destPayloadFile.seekp(_destPayloadOffset + writeBufferOffset);
-                    _destPayloadFile.write((char*)writeBuffer, std::min(writeBufferSize, offsetAfterLastTile - writeBufferOffset));
+    // blocks covering the image, in descending order of ids
+    std::vector<uint64_t> blocks;
 
-                    lastWriteOffset = writeBufferOffset;
-                    writeBufferOffset -= writeBufferSize;
-                }
+    for(uint64_t relIterationId = tilesToIterate - 1; /*relIterationId >= 0*/; --relIterationId)
+    {
+        uint64_t x;
+        uint64_t y;
 
-                std::memset(&writeBuffer[currentOffset - writeBufferOffset + _destTileByteSize], 0x00, lastWriteOffset - currentOffset - _destTileByteSize);
-                std::memcpy(&writeBuffer[currentOffset - writeBufferOffset], outTile, _destTileByteSize);
-                lastWriteOffset = currentOffset;
-            }
-            else
+        QuadTree::getCoordinatesInLevel(relIterationId, iterationLevel, x, y);
+
+        if(x < iterTileWidth && y < iterTileHeight)
+        {
+            blocks.push_back(relIterationId);
+        }
+        else if(_destLayout == AtlasFile::LAYOUT::RAW)
+        {
+            currentOffset = (firstId + relIterationId * tilesInBuffer) * _destTileByteSize;
+            auto dataLen = (uint64_t)bufferTileWidth * bufferTileHeight * _destTileByteSize;
+            auto data = new uint8_t[dataLen];
+
+            std::memset(data, 0x00, dataLen);
+
+            _destPayloadFile.seekp(_destPayloadOffset + currentOffset);
+            _destPayloadFile.write((char*)data, dataLen);
+
+            delete[] data;
+        }
+
+        if(relIterationId == 0)
+        {
+            break;
+        }
+    }
+
+    std::thread reader;
+    std::exception_ptr readError = nullptr;
+
+    if(!blocks.empty())
+    {
+        readBlock(blocks[0], buffers[0]);
+    }
+
+    std::vector<uint64_t> blockTiles;
+    blockTiles.reserve(tilesInBuffer);
+
+    for(size_t block = 0; block < blocks.size(); ++block)
+    {
+        auto relIterationId = blocks[block];
+        auto buffer = buffers[readAhead ? (block & 1) : 0];
+
+        if(reader.joinable())
+        {
+            reader.join();
+
+            if(readError != nullptr)
             {
-                if((currentOffset + _destTileByteSize) > (writeBufferOffset + writeBufferSize))
-                {
-                    _destPayloadFile.seekp(_destPayloadOffset + writeBufferOffset);
-                    _destPayloadFile.write((char*)writeBuffer, (currentOffset - writeBufferOffset));
-                    _destPayloadFile.flush();
+                std::rethrow_exception(readError);
+            }
+        }
 
-                    writeBufferOffset = currentOffset;
+        if(readAhead && block + 1 < blocks.size())
+        {
+            reader = std::thread([&, block]() {
+                try
+                {
+                    readBlock(blocks[block + 1], buffers[(block + 1) & 1]);
+                }
+                catch(...)
+                {
+                    readError = std::current_exception();
                 }
+            });
+        }
 
-                std::memcpy(&writeBuffer[currentOffset - writeBufferOffset], outTile, _destTileByteSize);
-                currentOffset += _destTileByteSize;
-            }
+        uint64_t x;
+        uint64_t y;
 
-#ifdef PREPROCESSOR_LOG_PROGRESS
-            ++tilesWritten;
-            auto currentProgress = (uint8_t)(tilesWritten * 100 / _imageTileWidth / _imageTileHeight);
+        QuadTree::getCoordinatesInLevel(relIterationId, iterationLevel, x, y);
+
+        blockTiles.clear();
+
+        for(auto relBufferId = (size_t)(tilesInBuffer - 1); /*relBufferId >= tilesInBuffer*/; --relBufferId)
+        {
+            uint64_t bufferTileX;
+            uint64_t bufferTileY;
 
-            if(currentProgress != progress)
+            QuadTree::getCoordinatesInLevel(relBufferId, bufferLevel, bufferTileX, bufferTileY);
+
+            if(x * bufferTileWidth + bufferTileX < _imageTileWidth && y * bufferTileHeight + bufferTileY < _imageTileHeight)
             {
-                progress = currentProgress;
-                std::cout << '\r' << std::setw(3) << (int)progress << " %";
-                std::cout.flush();
+                blockTiles.push_back(relBufferId);
             }
-#endif
 
             if(relBufferId == 0)
             {
@@ -1010,9 +1247,42 @@ void Preprocessor::_extract(size_t bufferTileWidth, size_t writeBufferSize)
             }
         }
 
-        if(relIterationId == 0)
+        Bitmap bufferBitmap(bufferPxWidth, bufferPxHeight, _srcPxFormat, buffer);
+
+        try
         {
-            break;
+            for(size_t first = 0; first < blockTiles.size(); first += cutTileCount)
+            {
+                size_t count = std::min(cutTileCount, blockTiles.size() - first);
+
+                workers.parallelFor(count, [&](size_t i) {
+                    uint64_t bufferTileX;
+                    uint64_t bufferTileY;
+
+                    QuadTree::getCoordinatesInLevel(blockTiles[first + i], bufferLevel, bufferTileX, bufferTileY);
+
+                    cutTile(bufferBitmap, x * bufferTileWidth + bufferTileX, y * bufferTileHeight + bufferTileY, bufferTileX, bufferTileY, &outTiles[i * _destTileByteSize]);
+                });
+
+                for(size_t i = 0; i < count; ++i)
+                {
+                    writeTile(firstId + relIterationId * tilesInBuffer + blockTiles[first + i], &outTiles[i * _destTileByteSize]);
+                }
+            }
+        }
+        catch(...)
+        {
+            if(reader.joinable())
+            {
+                reader.join();
+            }
+
+            throw;
+        }
+
+        if(!readAhead && block + 1 < blocks.size())
+        {
+            readBlock(blocks[block + 1], buffers[0]);
         }
     }
 
@@ -1037,8 +1307,9 @@ void Preprocessor::_extract(size_t bufferTileWidth, size_t writeBufferSize)
     _destIndexFile->seekp(_destCielabIndexOffset);
     _cielabIndex->writeToFile(*_destIndexFile);
 
-    delete[] buffer;
-    delete[] outTile;
+    delete[] buffers[0];
+    delete[] buffers[1];
+    delete[] outTiles;
     delete[] writeBuffer;
 }
 
@@ -1072,15 +1343,19 @@ void Preprocessor::run(size_t maxMemory)
 
     size_t srcTileSize = _tileWidth * _tileHeight * Bitmap::pixelSize(_srcPxFormat);
 
-    auto bufferSideLen = (size_t)std::sqrt(maxMemory / srcTileSize);
+    // the next block is read ahead when there is more than one thread
+    size_t readBufferCount = _threadCount > 1 ? 2 : 1;
+
+    auto bufferSideLen = (size_t)std::sqrt(maxMemory / readBufferCount / srcTileSize);
     bufferSideLen = (size_t)1 << ((size_t)std::log2(bufferSideLen));
 
 #ifdef PREPROCESSOR_LOG_PROGRESS
     std::cout << "Readbuffer Size: " << bufferSideLen << "x" << bufferSideLen << " Tiles\n";
-    std::cout << "Writebuffer Size: " << (maxMemory - bufferSideLen * bufferSideLen * srcTileSize) << " Bytes\n" << std::endl;
+    std::cout << "Writebuffer Size: " << (maxMemory - readBufferCount * bufferSideLen * bufferSideLen * srcTileSize) << " Bytes\n";
+    std::cout << "Threads: " << _threadCount << "\n" << std::endl;
 #endif
 
-    _extract(bufferSideLen, maxMemory - bufferSideLen * bufferSideLen * srcTileSize);
+    _extract(bufferSideLen, maxMemory - readBufferCount * bufferSideLen * bufferSideLen * srcTileSize);
     _deflate(maxMemory);
     //_calcDeltaE(maxMemory);
 